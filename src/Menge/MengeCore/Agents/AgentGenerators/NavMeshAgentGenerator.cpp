@@ -90,6 +90,7 @@ void NavMeshGenerator::addPosition(const Vector2& p) {
 
 NavMeshGeneratorFactory::NavMeshGeneratorFactory() : AgentGeneratorFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
   _polyGroupID = _attrSet.addStringAttribute("group_name", false /*required*/);
 }
 
@@ -115,7 +116,7 @@ bool NavMeshGeneratorFactory::setFromXML(AgentGenerator* gen, TiXmlElement* node
   // nav mesh
   NavMeshPtr nmPtr;
   try {
-    nmPtr = loadNavMesh(fName);
+    nmPtr = loadNavMesh(fName, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh referenced "
@@ -127,7 +128,7 @@ bool NavMeshGeneratorFactory::setFromXML(AgentGenerator* gen, TiXmlElement* node
   // nav mesh localizer
   NavMeshLocalizerPtr nmlPtr;
   try {
-    nmlPtr = loadNavMeshLocalizer(fName, true);
+    nmlPtr = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh localizer "
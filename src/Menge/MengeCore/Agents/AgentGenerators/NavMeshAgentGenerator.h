@@ -58,6 +58,9 @@ namespace Agents {
  - `file_name`: the relative path to the navigation mesh specification.
  - `group_name`: the name of a polygon group specified in the navigation mesh defined in
  `file_name`.
+ - `reorder_mesh`: (optional) if true, the navigation mesh is reordered for spatial locality as it
+ is loaded (see NavMesh::loadReordered()). Every element which names the same mesh must use the
+ same value; the scene fails to load otherwise.
 
  @sa NavMesh
  */
@@ -217,6 +220,11 @@ class MENGE_API NavMeshGeneratorFactory : public AgentGeneratorFactory {
    */
   size_t _fileNameID;
 
+  /*!
+   @brief    The identifier for the "reorder_mesh" bool attribute.
+   */
+  size_t _reorderID;
+
   /*!
    @brief    The identifier for the navigation mesh "group_name" string attribute.
    */
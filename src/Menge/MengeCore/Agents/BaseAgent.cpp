@@ -172,24 +172,6 @@ void BaseAgent::computeNewVelocity() { throw AgentImplementationException(); }
 
 ////////////////////////////////////////////////////////////////
 
-void BaseAgent::insertAgentNeighbor(const BaseAgent* agent, float distSq) {
-  if (this != agent) {
-    if (_nearAgents.size() != _maxNeighbors || distSq <= getMaxAgentRange()) {
-      if (_nearAgents.size() != _maxNeighbors) {
-        _nearAgents.push_back(NearAgent(distSq, agent));
-      }
-      size_t i = _nearAgents.size() - 1;
-      while (i != 0 && distSq < _nearAgents[i - 1].distanceSquared) {
-        _nearAgents[i] = _nearAgents[i - 1];
-        --i;
-      }
-      _nearAgents[i] = NearAgent(distSq, agent);
-    }
-  }
-}
-
-////////////////////////////////////////////////////////////////
-
 void BaseAgent::insertObstacleNeighbor(const Obstacle* obstacle, float distSq) {
   // the assumption is that two obstacle neighbors MUST have the same classID
   if (obstacle->_class & _obstacleSet) {
@@ -213,30 +195,17 @@ void BaseAgent::addVelModifier(BFSM::VelModifier* v) { _velModifiers.push_back(v
 
 void BaseAgent::startQuery() {
   _nearAgents.clear();
+  _nearAgents.reserve(_maxNeighbors);
   _nearObstacles.clear();
 };
 
 ///////////////////////////////////////////////////////////
 
-void BaseAgent::filterAgent(const BaseAgent* agent, float distance) {
-  insertAgentNeighbor(agent, distance);
-};
-
-///////////////////////////////////////////////////////////
-
 void BaseAgent::filterObstacle(const Obstacle* obstacle, float distance) {
   insertObstacleNeighbor(obstacle, distance);
 };
 
 ///////////////////////////////////////////////////////////
 
-float BaseAgent::getMaxAgentRange() {
-  if (_nearAgents.size() == _maxNeighbors) {
-    return _nearAgents.back().distanceSquared;
-  }
-
-  return _neighborDist * _neighborDist;
-}
-
 }  // namespace Agents
 }  // namespace Menge
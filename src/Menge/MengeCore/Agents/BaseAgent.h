@@ -321,7 +321,9 @@ class MENGE_API BaseAgent : public ProximityQuery {
    @param      agent          A pointer to the agent to be inserted.
    @param      distSq         The distance to the indicated agent
    */
-  void insertAgentNeighbor(const BaseAgent* agent, float distSq);
+  void insertAgentNeighbor(const BaseAgent* agent, float distSq) {
+    if (this != agent) insertNearest(_nearAgents, _maxNeighbors, NearAgent(distSq, agent));
+  }
 
   /*!
    @brief      Inserts a static obstacle neighbor into the set of neighbors of this agent.
@@ -355,7 +357,9 @@ class MENGE_API BaseAgent : public ProximityQuery {
    @param      agent    The agent to consider.
    @param      distance  The distance to the agent.
    */
-  virtual void filterAgent(const BaseAgent* agent, float distance);
+  virtual void filterAgent(const BaseAgent* agent, float distance) {
+    insertAgentNeighbor(agent, distance);
+  }
 
   /*!
    @brief      Filters an obstacle and determines if it needs to be in the near set.
@@ -379,7 +383,13 @@ class MENGE_API BaseAgent : public ProximityQuery {
    @returns  The Max query range. Typically this is the initial range unless some special conditions
             are met.
    */
-  virtual float getMaxAgentRange();
+  virtual float getMaxAgentRange() {
+    if (_nearAgents.size() == _maxNeighbors) {
+      return _nearAgents.back().distanceSquared;
+    }
+
+    return _neighborDist * _neighborDist;
+  }
 
   /*!
    @brief     Updates the max query obstacle range if conditions inside the filter are met.
@@ -0,0 +1,162 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/ColumnReader.h"
+
+#include "MengeCore/Agents/ColumnWriter.h"
+
+#include <cstring>
+#include <limits>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+// The size of a column file's header.
+const size_t HEADER_SIZE = 32;
+
+// The size of the end of a column file: chunk count, frame count, statistics offset and "MCOL".
+const size_t FOOTER_SIZE = 2 * sizeof(unsigned int) + sizeof(unsigned long long) + 4;
+
+template <typename T>
+T getValue(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of ColumnReader
+/////////////////////////////////////////////////////////////////////
+
+ColumnReader::ColumnReader(const std::string& pathName)
+    : _file(),
+      _field(SCBFilter::POSITION),
+      _components(0),
+      _agentCount(0),
+      _timeStep(0.f),
+      _chunkFrames(1),
+      _frameCount(0),
+      _frames(0x0),
+      _stats(0x0) {
+  readHeader(pathName);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+ColumnReader::ColumnReader(const std::string& basePath, SCBFilter::Field field)
+    : _file(),
+      _field(field),
+      _components(0),
+      _agentCount(0),
+      _timeStep(0.f),
+      _chunkFrames(1),
+      _frameCount(0),
+      _frames(0x0),
+      _stats(0x0) {
+  const std::string pathName = ColumnWriter::columnPath(basePath, field);
+  readHeader(pathName);
+  if (_field != field) {
+    throw SCBFileException("The column file holds the wrong field: " + pathName);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void ColumnReader::readHeader(const std::string& pathName) {
+  if (!_file.open(pathName)) {
+    throw SCBFileException("Unable to map the column file: " + pathName);
+  }
+  const char* data = _file.data();
+  const size_t size = _file.size();
+  if (size < HEADER_SIZE || memcmp(data, "MENGECOL", 8) != 0 ||
+      getValue<unsigned int>(data + 8) != 1) {
+    throw SCBFileException("The file is not a column file: " + pathName);
+  }
+  const unsigned int field = getValue<unsigned int>(data + 12);
+  _components = getValue<unsigned int>(data + 16);
+  _agentCount = getValue<unsigned int>(data + 20);
+  _timeStep = getValue<float>(data + 24);
+  _chunkFrames = getValue<unsigned int>(data + 28);
+  if (field == 0 || field > SCBFilter::ELEVATION || (field & (field - 1)) != 0 ||
+      _chunkFrames == 0 ||
+      _components != ColumnWriter::componentCount(static_cast<SCBFilter::Field>(field))) {
+    throw SCBFileException("The column file's header is malformed: " + pathName);
+  }
+  _field = static_cast<SCBFilter::Field>(field);
+  // The header's size keeps the frames aligned for floats.
+  _frames = reinterpret_cast<const float*>(data + HEADER_SIZE);
+
+  const unsigned long long FRAME_SIZE = _agentCount * _components * sizeof(float);
+  if (size >= HEADER_SIZE + FOOTER_SIZE && memcmp(data + size - 4, "MCOL", 4) == 0) {
+    const char* footer = data + size - FOOTER_SIZE;
+    const unsigned long long chunkCount = getValue<unsigned int>(footer);
+    const unsigned long long frameCount = getValue<unsigned int>(footer + 4);
+    const unsigned long long statsOffset = getValue<unsigned long long>(footer + 8);
+    const unsigned long long STATS_SIZE = chunkCount * _components * 2 * sizeof(float);
+    if (statsOffset == HEADER_SIZE + frameCount * FRAME_SIZE &&
+        statsOffset + STATS_SIZE + FOOTER_SIZE == size &&
+        chunkCount == (frameCount + _chunkFrames - 1) / _chunkFrames) {
+      _frameCount = static_cast<size_t>(frameCount);
+      _stats = reinterpret_cast<const float*>(data + statsOffset);
+      return;
+    }
+  }
+  // The file wasn't finished; use its complete frames.
+  _frameCount = FRAME_SIZE > 0 ? static_cast<size_t>((size - HEADER_SIZE) / FRAME_SIZE) : 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t ColumnReader::getChunkEnd(size_t chunk) const {
+  const size_t end = (chunk + 1) * _chunkFrames;
+  return end < _frameCount ? end : _frameCount;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool ColumnReader::chunkOverlaps(size_t chunk, size_t component, float low, float high) const {
+  if (_stats == 0x0) return true;
+  return getChunkMin(chunk, component) <= high && getChunkMax(chunk, component) >= low;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float ColumnReader::getChunkMin(size_t chunk, size_t component) const {
+  if (_stats == 0x0) return -std::numeric_limits<float>::infinity();
+  return _stats[(chunk * _components + component) * 2];
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float ColumnReader::getChunkMax(size_t chunk, size_t component) const {
+  if (_stats == 0x0) return std::numeric_limits<float>::infinity();
+  return _stats[(chunk * _components + component) * 2 + 1];
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const float* ColumnReader::getFrame(size_t frame) const {
+  if (frame >= _frameCount) return 0x0;
+  return _frames + frame * _agentCount * _components;
+}
+
+}  // namespace Agents
+}  // namespace Menge
@@ -0,0 +1,220 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    ColumnReader.h
+ @brief   Reads the column files written by ColumnWriter.
+ */
+
+#ifndef __COLUMN_READER_H__
+#define __COLUMN_READER_H__
+
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Runtime/MappedFile.h"
+
+#include <string>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief   Reads one field of a recorded simulation, frame by frame, from its column file (see
+          ColumnWriter.h).
+
+ The file is memory mapped, so only the frames which are read are loaded, and no other field's file
+ is touched. A typical pass over a field skips the chunks whose statistics lie outside the range of
+ interest:
+
+ @code
+ ColumnReader speeds("run", SCBFilter::VELOCITY);
+ for (size_t c = 0; c < speeds.getChunkCount(); ++c) {
+   if (!speeds.chunkOverlaps(c, 0, 1.f, 2.f)) continue;
+   for (size_t f = speeds.getChunkStart(c); f < speeds.getChunkEnd(c); ++f) {
+     const float* vel = speeds.getFrame(f);  // x- and y-velocity of each agent
+     ...
+   }
+ }
+ @endcode
+ */
+class MENGE_API ColumnReader {
+ public:
+  /*!
+   @brief   Constructor. Maps the column file and reads its header.
+
+   @param   pathName    The path to the column file.
+   @throws  SCBFileException if the file can't be mapped or is malformed.
+   */
+  explicit ColumnReader(const std::string& pathName);
+
+  /*!
+   @brief   Constructor. Maps the column file of a field and reads its header.
+
+   @param   basePath    The base path given to the ColumnWriter.
+   @param   field       The field to read.
+   @throws  SCBFileException if the file can't be mapped or is malformed.
+   */
+  ColumnReader(const std::string& basePath, SCBFilter::Field field);
+
+  /*!
+   @brief   Reports the column's field.
+   */
+  SCBFilter::Field getField() const { return _field; }
+
+  /*!
+   @brief   Reports the number of floats per agent.
+   */
+  size_t getComponentCount() const { return _components; }
+
+  /*!
+   @brief   Reports the number of agents in each frame.
+   */
+  size_t getAgentCount() const { return _agentCount; }
+
+  /*!
+   @brief   Reports the time between frames (in seconds).
+   */
+  float getTimeStep() const { return _timeStep; }
+
+  /*!
+   @brief   Reports the number of frames.
+   */
+  size_t getFrameCount() const { return _frameCount; }
+
+  /*!
+   @brief   Reports the number of chunks.
+   */
+  size_t getChunkCount() const { return (_frameCount + _chunkFrames - 1) / _chunkFrames; }
+
+  /*!
+   @brief   Reports the first frame of a chunk.
+
+   @param   chunk     The index of the chunk.
+   */
+  size_t getChunkStart(size_t chunk) const { return chunk * _chunkFrames; }
+
+  /*!
+   @brief   Reports the frame following the last frame of a chunk.
+
+   @param   chunk     The index of the chunk.
+   */
+  size_t getChunkEnd(size_t chunk) const;
+
+  /*!
+   @brief   Reports if the file has chunk statistics (a file which wasn't finished has none).
+   */
+  bool hasStatistics() const { return _stats != 0x0; }
+
+  /*!
+   @brief   Reports if the values of one of the agents' floats in a chunk can lie in a range.
+
+   @param   chunk       The index of the chunk.
+   @param   component   The index of the float, in the range [0, getComponentCount()).
+   @param   low         The lower bound of the range.
+   @param   high        The upper bound of the range.
+   @returns False if the chunk's statistics show that no value lies in the range.
+   */
+  bool chunkOverlaps(size_t chunk, size_t component, float low, float high) const;
+
+  /*!
+   @brief   Reports the minimum of one of the agents' floats in a chunk.
+
+   @param   chunk       The index of the chunk.
+   @param   component   The index of the float, in the range [0, getComponentCount()).
+   @returns The minimum, or negative infinity if the file has no statistics (see hasStatistics()).
+   */
+  float getChunkMin(size_t chunk, size_t component) const;
+
+  /*!
+   @brief   Reports the maximum of one of the agents' floats in a chunk.
+
+   @param   chunk       The index of the chunk.
+   @param   component   The index of the float, in the range [0, getComponentCount()).
+   @returns The maximum, or infinity if the file has no statistics (see hasStatistics()).
+   */
+  float getChunkMax(size_t chunk, size_t component) const;
+
+  /*!
+   @brief   Provides a frame's values: getComponentCount() floats for each agent, agent by agent.
+
+   @param   frame     The index of the frame.
+   @returns A pointer into the mapped file (valid for the reader's lifetime), or null if there is
+            no such frame.
+   */
+  const float* getFrame(size_t frame) const;
+
+ protected:
+  /*!
+   @brief   Reads the header and chunk statistics of the mapped file.
+
+   @param   pathName    The path to the column file (for error messages).
+   @throws  SCBFileException if the file is malformed.
+   */
+  void readHeader(const std::string& pathName);
+
+  /*!
+   @brief   The mapped file.
+   */
+  MappedFile _file;
+
+  /*!
+   @brief   The column's field.
+   */
+  SCBFilter::Field _field;
+
+  /*!
+   @brief   The number of floats per agent.
+   */
+  size_t _components;
+
+  /*!
+   @brief   The number of agents.
+   */
+  size_t _agentCount;
+
+  /*!
+   @brief   The time between frames.
+   */
+  float _timeStep;
+
+  /*!
+   @brief   The number of frames per chunk.
+   */
+  size_t _chunkFrames;
+
+  /*!
+   @brief   The number of frames.
+   */
+  size_t _frameCount;
+
+  /*!
+   @brief   The first frame's values.
+   */
+  const float* _frames;
+
+  /*!
+   @brief   The chunk statistics (null if the file has none).
+   */
+  const float* _stats;
+};
+
+}  // namespace Agents
+}  // namespace Menge
+
+#endif  // __COLUMN_READER_H__
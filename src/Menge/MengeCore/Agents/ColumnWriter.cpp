@@ -0,0 +1,208 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/ColumnWriter.h"
+
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Core.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+// The format version of the column files.
+const unsigned int COLUMN_VERSION = 1;
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+  file.write((const char*)&value, sizeof(T));
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of ColumnWriter
+/////////////////////////////////////////////////////////////////////
+
+size_t ColumnWriter::DEFAULT_CHUNK_FRAMES = 256;
+
+/////////////////////////////////////////////////////////////////////
+
+ColumnWriter::ColumnWriter(const std::string& basePath, SimulatorInterface* sim,
+                           const SCBFilter& filter)
+    : _sim(sim),
+      _agentCount(sim->getNumAgents()),
+      _chunkFrames(std::max(DEFAULT_CHUNK_FRAMES, size_t(1))),
+      _stride(filter.getStride(sim->getTimeStep())),
+      _stepCount(0),
+      _frameCount(0),
+      _columns(),
+      _values() {
+  if (filter.selectsAgents()) {
+    logger << Logger::WARN_MSG << "Column output records every agent; the agent selection is "
+                                  "ignored.";
+  }
+  const unsigned int fields = filter.getFields();
+  for (unsigned int f = SCBFilter::POSITION; f <= SCBFilter::ELEVATION; f <<= 1) {
+    if ((fields & f) == 0) continue;
+    Column column;
+    column._field = static_cast<SCBFilter::Field>(f);
+    column._components = componentCount(column._field);
+    const std::string path = columnPath(basePath, column._field);
+    column._file = new std::ofstream(path.c_str(), std::ios::out | std::ios::binary);
+    if (!column._file->is_open()) {
+      delete column._file;
+      for (size_t c = 0; c < _columns.size(); ++c) delete _columns[c]._file;
+      throw SCBFileException("Unable to open the column file: " + path);
+    }
+    std::ofstream& file = *column._file;
+    file.write("MENGECOL", 8);
+    writeValue(file, COLUMN_VERSION);
+    writeValue(file, f);
+    writeValue(file, static_cast<unsigned int>(column._components));
+    writeValue(file, static_cast<unsigned int>(_agentCount));
+    writeValue(file, sim->getTimeStep() * _stride);
+    writeValue(file, static_cast<unsigned int>(_chunkFrames));
+    _columns.push_back(column);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+ColumnWriter::~ColumnWriter() {
+  for (size_t c = 0; c < _columns.size(); ++c) {
+    finishColumn(_columns[c]);
+    delete _columns[c]._file;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+std::string ColumnWriter::columnPath(const std::string& basePath, SCBFilter::Field field) {
+  return basePath + "." + SCBFilter::fieldName(field) + ".col";
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t ColumnWriter::componentCount(SCBFilter::Field field) {
+  switch (field) {
+    case SCBFilter::POSITION:
+    case SCBFilter::VELOCITY:
+    case SCBFilter::PREF_VELOCITY:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void ColumnWriter::writeFrame(BFSM::FSM* fsm) {
+  if (_stepCount++ % _stride != 0) return;
+  for (size_t c = 0; c < _columns.size(); ++c) {
+    Column& column = _columns[c];
+    fillColumn(column, fsm);
+    if (!_values.empty()) {
+      column._file->write((const char*)&_values[0], _values.size() * sizeof(float));
+    }
+  }
+  ++_frameCount;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void ColumnWriter::fillColumn(Column& column, BFSM::FSM* fsm) {
+  const size_t COMPONENTS = column._components;
+  const int AGT_COUNT = static_cast<int>(std::min(_agentCount, _sim->getNumAgents()));
+  // Agents removed since the writer was created are recorded as zeros.
+  _values.assign(_agentCount * COMPONENTS, 0.f);
+  float* values = _values.empty() ? 0x0 : &_values[0];
+  const SCBFilter::Field field = column._field;
+#pragma omp parallel for
+  for (int i = 0; i < AGT_COUNT; ++i) {
+    const BaseAgent* agt = _sim->getAgentById(i);
+    float* v = values + i * COMPONENTS;
+    switch (field) {
+      case SCBFilter::POSITION:
+        v[0] = agt->_pos.x();
+        v[1] = agt->_pos.y();
+        break;
+      case SCBFilter::ORIENTATION:
+        v[0] = atan2(agt->_orient.y(), agt->_orient.x());
+        break;
+      case SCBFilter::STATE:
+        v[0] = static_cast<float>(fsm->getAgentStateID(agt->_id));
+        break;
+      case SCBFilter::VELOCITY:
+        v[0] = agt->_vel.x();
+        v[1] = agt->_vel.y();
+        break;
+      case SCBFilter::PREF_VELOCITY: {
+        // As in scb version 2.2, this factors out the speed changes of intention filters.
+        const Math::Vector2 vPref = agt->_velPref.getPreferredVel();
+        v[0] = vPref.x();
+        v[1] = vPref.y();
+        break;
+      }
+      case SCBFilter::ELEVATION:
+        v[0] = _sim->getElevation(agt);
+        break;
+    }
+  }
+
+  // Update the chunk's statistics; a new chunk starts with this frame's values.
+  if (_frameCount % _chunkFrames == 0) {
+    for (size_t k = 0; k < COMPONENTS; ++k) {
+      const float first = _values.empty() ? 0.f : _values[k];
+      column._stats.push_back(first);
+      column._stats.push_back(first);
+    }
+  }
+  float* stats = &column._stats[column._stats.size() - 2 * COMPONENTS];
+  for (size_t i = 0; i < _values.size(); i += COMPONENTS) {
+    for (size_t k = 0; k < COMPONENTS; ++k) {
+      stats[2 * k] = std::min(stats[2 * k], _values[i + k]);
+      stats[2 * k + 1] = std::max(stats[2 * k + 1], _values[i + k]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void ColumnWriter::finishColumn(Column& column) {
+  std::ofstream& file = *column._file;
+  const unsigned long long STATS_OFFSET = static_cast<unsigned long long>(file.tellp());
+  if (!column._stats.empty()) {
+    file.write((const char*)&column._stats[0], column._stats.size() * sizeof(float));
+  }
+  writeValue(file, static_cast<unsigned int>(column._stats.size() / (2 * column._components)));
+  writeValue(file, static_cast<unsigned int>(_frameCount));
+  writeValue(file, STATS_OFFSET);
+  file.write("MCOL", 4);
+  file.close();
+  if (file.fail()) {
+    logger << Logger::ERR_MSG << "Error writing the column file of the "
+           << SCBFilter::fieldName(column._field) << " field.";
+  }
+}
+
+}  // namespace Agents
+}  // namespace Menge
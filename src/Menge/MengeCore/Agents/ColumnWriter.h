@@ -0,0 +1,208 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    ColumnWriter.h
+ @brief   Writes the crowd trajectories as one column file per field, for analytics.
+
+ Each recorded field (see SCBFilter::Field) is written to its own file, named
+ <base path>.<field name>.col (e.g., "run.position.col"). A column file consists of a 32-byte
+ header:
+
+     8 bytes         "MENGECOL"
+     4-byte uint     format version (1)
+     4-byte uint     the field (an SCBFilter::Field value)
+     4-byte uint     the number of floats per agent (e.g., 2 for positions)
+     4-byte uint     the number of agents
+     4-byte float    the time between frames (in seconds)
+     4-byte uint     the number of frames per chunk
+
+ followed by the frames, each the agents' floats in agent order, and then by the chunk statistics:
+
+     for each chunk, for each float of an agent: 4-byte float minimum, 4-byte float maximum
+     4-byte uint     chunk count
+     4-byte uint     frame count
+     8-byte uint     file offset of the chunk statistics
+     4 bytes         "MCOL"
+
+ A chunk is a run of "frames per chunk" consecutive frames (the last may be partial). The frames
+ are stored as is, so a reader can map the file and index any frame directly; the statistics let
+ it skip the chunks whose values lie outside a range of interest.
+ */
+
+#ifndef __COLUMN_WRITER_H__
+#define __COLUMN_WRITER_H__
+
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/CoreConfig.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+// Forward declaration
+class SimulatorInterface;
+
+/*!
+ @brief   Writes the fields of the agents' states to column files (see ColumnWriter.h).
+
+ The recorded fields and frames are selected with an SCBFilter. Every agent in the simulation when
+ the writer is created is recorded in every frame; agent selections are ignored.
+ */
+class MENGE_API ColumnWriter {
+ public:
+  /*!
+   @brief   Constructor; creates the column files and writes their headers.
+
+   @param   basePath    The path to which the fields' names and the ".col" extension are appended.
+   @param   sim         The simulator whose agents are recorded.
+   @param   filter      The frames and fields to record.
+   @throws  SCBFileException if a column file can't be opened for writing.
+   */
+  ColumnWriter(const std::string& basePath, SimulatorInterface* sim,
+               const SCBFilter& filter = SCBFilter());
+
+  /*!
+   @brief   Destructor; writes the chunk statistics and closes the files.
+   */
+  ~ColumnWriter();
+
+  /*!
+   @brief   Writes the current frame of the simulator (unless the filter skips it).
+
+   @param   fsm     The simulator's behavior fsm.
+   */
+  void writeFrame(BFSM::FSM* fsm);
+
+  /*!
+   @brief   Sets the number of frames per chunk of new writers.
+
+   @param   frameCount    The number of frames per chunk.
+   */
+  static void setDefaultChunkFrames(size_t frameCount) { DEFAULT_CHUNK_FRAMES = frameCount; }
+
+  /*!
+   @brief   Reports the path of a field's column file.
+
+   @param   basePath    The base path given to the writer.
+   @param   field       The field.
+   */
+  static std::string columnPath(const std::string& basePath, SCBFilter::Field field);
+
+  /*!
+   @brief   Reports the number of floats each agent has in a field's column.
+
+   @param   field       The field.
+   */
+  static size_t componentCount(SCBFilter::Field field);
+
+ protected:
+  /*!
+   @brief   The number of frames per chunk of new writers.
+   */
+  static size_t DEFAULT_CHUNK_FRAMES;
+
+  /*!
+   @brief   A column being written.
+   */
+  struct Column {
+    /*!
+     @brief   The column's field.
+     */
+    SCBFilter::Field _field;
+
+    /*!
+     @brief   The number of floats per agent.
+     */
+    size_t _components;
+
+    /*!
+     @brief   The column file.
+     */
+    std::ofstream* _file;
+
+    /*!
+     @brief   The minimum and maximum of each float, chunk by chunk.
+     */
+    std::vector<float> _stats;
+  };
+
+  /*!
+   @brief   Fills a column's values for the current frame and updates its chunk statistics.
+
+   @param   column    The column.
+   @param   fsm       The simulator's behavior fsm.
+   */
+  void fillColumn(Column& column, BFSM::FSM* fsm);
+
+  /*!
+   @brief   Writes the statistics and end of a column file.
+
+   @param   column    The column.
+   */
+  void finishColumn(Column& column);
+
+  /*!
+   @brief   The simulator whose agents are recorded.
+   */
+  SimulatorInterface* _sim;
+
+  /*!
+   @brief   The number of agents recorded.
+   */
+  size_t _agentCount;
+
+  /*!
+   @brief   The number of frames per chunk.
+   */
+  size_t _chunkFrames;
+
+  /*!
+   @brief   The number of simulation steps between recorded frames.
+   */
+  size_t _stride;
+
+  /*!
+   @brief   The number of calls to writeFrame().
+   */
+  size_t _stepCount;
+
+  /*!
+   @brief   The number of frames written.
+   */
+  size_t _frameCount;
+
+  /*!
+   @brief   The columns being written.
+   */
+  std::vector<Column> _columns;
+
+  /*!
+   @brief   The current frame's values of a column.
+   */
+  std::vector<float> _values;
+};
+
+}  // namespace Agents
+}  // namespace Menge
+
+#endif  // __COLUMN_WRITER_H__
@@ -101,7 +101,8 @@ Vector2 NavMeshElevation::getGradient(const Vector2& point) const {
 /////////////////////////////////////////////////////////////////////
 
 BFSM::Task* NavMeshElevation::getTask() {
-  return new BFSM::NavMeshLocalizerTask(_navMesh->getName(), false /*usePlanner*/);
+  return new BFSM::NavMeshLocalizerTask(_navMesh->getName(), false /*usePlanner*/,
+                                        _navMesh->isReordered());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -110,6 +111,7 @@ BFSM::Task* NavMeshElevation::getTask() {
 
 NavMeshElevationFactory::NavMeshElevationFactory() : ElevationFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -130,7 +132,7 @@ bool NavMeshElevationFactory::setFromXML(Elevation* e, TiXmlElement* node,
   // nav mesh
   NavMeshPtr nmPtr;
   try {
-    nmPtr = loadNavMesh(fName);
+    nmPtr = loadNavMesh(fName, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh referenced "
@@ -142,7 +144,7 @@ bool NavMeshElevationFactory::setFromXML(Elevation* e, TiXmlElement* node,
   // nav mesh localizer
   NavMeshLocalizerPtr nmlPtr;
   try {
-    nmlPtr = loadNavMeshLocalizer(fName, true);
+    nmlPtr = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh localizer "
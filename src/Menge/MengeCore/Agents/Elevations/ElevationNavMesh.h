@@ -192,6 +192,11 @@ class MENGE_API NavMeshElevationFactory : public ElevationFactory {
    @brief    The identifier for the "file_name" string attribute.
    */
   size_t _fileNameID;
+
+  /*!
+   @brief    The identifier for the "reorder_mesh" bool attribute.
+   */
+  size_t _reorderID;
 };
 }  // namespace Agents
 }  // namespace Menge
@@ -0,0 +1,55 @@
+#include "MengeCore/Agents/Events/NavMeshEdgeEffect.h"
+
+#include "MengeCore/Agents/Events/NavMeshEdgeTarget.h"
+#include "MengeCore/resources/PathPlanner.h"
+#include "thirdParty/tinyxml.h"
+
+#include <cassert>
+
+namespace Menge {
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of NavMeshEdgeEffect
+/////////////////////////////////////////////////////////////////////
+
+bool NavMeshEdgeEffect::isCompatible(EventTarget* target) {
+  return dynamic_cast<NavMeshEdgeTarget*>(target) != 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void NavMeshEdgeEffect::apply(EventTarget* target) {
+  NavMeshEdgeTarget* edgeTarget = dynamic_cast<NavMeshEdgeTarget*>(target);
+  assert(edgeTarget != 0x0 && "Applying a nav mesh edge effect to an incompatible target");
+  PathPlanner* planner = edgeTarget->getPlanner();
+  if (_width >= 0.f) planner->setEdgeWidth(edgeTarget->getEdgeID(), _width);
+  if (_setsBlocked) planner->setEdgeBlocked(edgeTarget->getEdgeID(), _blocked);
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of NavMeshEdgeEffectFactory
+/////////////////////////////////////////////////////////////////////
+
+NavMeshEdgeEffectFactory::NavMeshEdgeEffectFactory() : EventEffectFactory() {
+  _blockedID = _attrSet.addBoolAttribute("blocked", false /*required*/, false /*default*/);
+  _widthID = _attrSet.addFloatAttribute("width", false /*required*/, -1.f /*default*/);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool NavMeshEdgeEffectFactory::setFromXML(EventEffect* effect, TiXmlElement* node,
+                                          const std::string& behaveFldr) const {
+  NavMeshEdgeEffect* edgeEffect = dynamic_cast<NavMeshEdgeEffect*>(effect);
+  assert(edgeEffect != 0x0 &&
+         "Trying to set attributes of a nav mesh edge event effect on an incompatible object");
+
+  if (!EventEffectFactory::setFromXML(edgeEffect, node, behaveFldr)) return false;
+
+  edgeEffect->_setsBlocked = node->Attribute("blocked") != 0x0;
+  edgeEffect->_blocked = _attrSet.getBool(_blockedID);
+  edgeEffect->_width = _attrSet.getFloat(_widthID);
+
+  return true;
+}
+
+}  // namespace Menge
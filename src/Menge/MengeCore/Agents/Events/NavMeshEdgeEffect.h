@@ -0,0 +1,151 @@
+/*
+Menge Crowd Simulation Framework
+
+Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+or
+LICENSE.txt in the root of the Menge repository.
+
+Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+<http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    NavMeshEdgeEffect.h
+ @brief   The definition of an event effect that blocks, unblocks or resizes a navigation mesh edge.
+ */
+
+#ifndef __NAV_MESH_EDGE_EFFECT_H__
+#define __NAV_MESH_EDGE_EFFECT_H__
+
+#include "MengeCore/Agents/Events/EventEffect.h"
+#include "MengeCore/Agents/Events/EventEffectFactory.h"
+
+namespace Menge {
+
+/*!
+ @brief    An event effect that changes the traversability of a navigation mesh edge (see
+          NavMeshEdgeTarget).
+
+ ```xml
+ <Effect name="close_door" type="nav_mesh_edge" blocked="1" />
+ <Effect name="open_door" type="nav_mesh_edge" blocked="0" width="1.5" />
+ <Effect name="narrow_door" type="nav_mesh_edge" width="0.5" />
+ ```
+
+ - The optional `blocked` value reports if the edge can be traversed after the effect is applied.
+   If omitted, the edge stays blocked or open, as another effect left it.
+ - The optional `width` value sets the width of the edge. If omitted, the width is unchanged.
+
+ Only the agents whose routes cross the edge replan (see PathPlanner::setEdgeBlocked()).
+ */
+class MENGE_API NavMeshEdgeEffect : public EventEffect {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  NavMeshEdgeEffect() : EventEffect(), _setsBlocked(false), _blocked(false), _width(-1.f) {}
+
+  /*!
+   @brief    Reports if the given target is compatible with this effect.
+
+   @param    target    The target instance to test.
+   @returns  True if the target is a NavMeshEdgeTarget.
+   */
+  virtual bool isCompatible(EventTarget* target);
+
+  /*!
+   @brief    Applies the effect to the targeted edge.
+
+   @param    target    The target to apply the event to.
+   */
+  virtual void apply(EventTarget* target);
+
+  friend class NavMeshEdgeEffectFactory;
+
+ protected:
+  /*!
+   @brief    Determines if the effect changes whether the edge is blocked.
+   */
+  bool _setsBlocked;
+
+  /*!
+   @brief    Determines if the edge is blocked by the effect (if _setsBlocked is true).
+   */
+  bool _blocked;
+
+  /*!
+   @brief    The width the edge is given; negative values leave the width unchanged.
+   */
+  float _width;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    The factory for NavMeshEdgeEffect event effects.
+ */
+class MENGE_API NavMeshEdgeEffectFactory : public EventEffectFactory {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  NavMeshEdgeEffectFactory();
+
+  /*!
+   @brief    The name of the effect.
+
+   @returns  A string containing the unique effect name.
+   */
+  virtual const char* name() const { return "nav_mesh_edge"; }
+
+  /*!
+   @brief    A description of the effect.
+
+   @returns  A string containing the effect description.
+   */
+  virtual const char* description() const {
+    return "Blocks, unblocks or resizes the targeted navigation mesh edge; agents whose routes "
+           "cross the edge replan.";
+  };
+
+ protected:
+  /*!
+   @brief    Create an instance of this class's effect.
+
+   @returns    A pointer to a newly instantiated EventEffect class.
+   */
+  EventEffect* instance() const { return new NavMeshEdgeEffect(); }
+
+  /*!
+   @brief    Given a pointer to an EventEffect instance, sets the appropriate fields from the
+            provided XML node.
+
+   @param    effect        A pointer to the effect whose attributes are to be set.
+   @param    node          The XML node containing the effect attributes.
+   @param    behaveFldr    The path to the behavior file.
+   @returns  A boolean reporting success (true) or failure (false).
+   */
+  virtual bool setFromXML(EventEffect* effect, TiXmlElement* node,
+                          const std::string& behaveFldr) const;
+
+  /*!
+   @brief    The identifier for the "blocked" bool attribute.
+   */
+  size_t _blockedID;
+
+  /*!
+   @brief    The identifier for the "width" float attribute.
+   */
+  size_t _widthID;
+};
+
+}  // namespace Menge
+
+#endif  // __NAV_MESH_EDGE_EFFECT_H__
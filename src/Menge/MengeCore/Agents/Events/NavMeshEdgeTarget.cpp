@@ -0,0 +1,56 @@
+#include "MengeCore/Agents/Events/NavMeshEdgeTarget.h"
+
+#include "MengeCore/Runtime/Logger.h"
+#include "MengeCore/Runtime/os.h"
+#include "thirdParty/tinyxml.h"
+
+#include <cassert>
+
+namespace Menge {
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of NavMeshEdgeTargetFactory
+/////////////////////////////////////////////////////////////////////
+
+NavMeshEdgeTargetFactory::NavMeshEdgeTargetFactory() : EventTargetFactory() {
+  _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
+  _edgeID = _attrSet.addSizeTAttribute("edge", true /*required*/);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool NavMeshEdgeTargetFactory::setFromXML(EventTarget* target, TiXmlElement* node,
+                                          const std::string& behaveFldr) const {
+  NavMeshEdgeTarget* edgeTarget = dynamic_cast<NavMeshEdgeTarget*>(target);
+  assert(edgeTarget != 0x0 &&
+         "Trying to set attributes of a nav mesh edge event target "
+         "on an incompatible object");
+
+  if (!EventTargetFactory::setFromXML(target, node, behaveFldr)) return false;
+
+  std::string fName;
+  std::string path = os::path::join(2, behaveFldr.c_str(), _attrSet.getString(_fileNameID).c_str());
+  os::path::absPath(path, fName);
+  try {
+    edgeTarget->_localizer = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
+  } catch (const ResourceException&) {
+    logger << Logger::ERR_MSG << "Couldn't instantiate the navigation mesh referenced by the ";
+    logger << "event target on line " << node->Row() << ".";
+    return false;
+  }
+
+  const NavMeshPtr navMesh = edgeTarget->_localizer->getNavMesh();
+  const size_t fileID = _attrSet.getSizeT(_edgeID);
+  if (fileID >= navMesh->getEdgeCount()) {
+    logger << Logger::ERR_MSG << "The nav mesh edge event target on line " << node->Row();
+    logger << " references edge " << fileID << ", but the navigation mesh only has ";
+    logger << navMesh->getEdgeCount() << " edges.";
+    return false;
+  }
+  edgeTarget->_edgeID = navMesh->getEdgeIndex(static_cast<unsigned int>(fileID));
+
+  return true;
+}
+
+}  // namespace Menge
@@ -0,0 +1,153 @@
+/*
+Menge Crowd Simulation Framework
+
+Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+or
+LICENSE.txt in the root of the Menge repository.
+
+Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+<http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    NavMeshEdgeTarget.h
+ @brief   Defines the EventTarget that targets an edge of a navigation mesh.
+ */
+
+#ifndef __NAV_MESH_EDGE_TARGET_H__
+#define __NAV_MESH_EDGE_TARGET_H__
+
+#include "MengeCore/Agents/Events/EventTarget.h"
+#include "MengeCore/Agents/Events/EventTargetFactory.h"
+#include "MengeCore/resources/NavMeshLocalizer.h"
+
+namespace Menge {
+
+// forward declaration
+class PathPlanner;
+
+/*!
+ @brief    This class defines the target of an event as being a single edge of a navigation mesh
+          (e.g., a door).
+
+ ```xml
+ <Target name="door" type="nav_mesh_edge" file_name="office.nav" edge="12" />
+ ```
+
+ - The value `name` must be unique and is referenced in the Event response.
+ - The `type` value specifies this target -- a navigation mesh edge.
+ - The `file_name` value is the navigation mesh, relative to the behavior file. It should be the
+   same mesh the `nav_mesh` velocity components use so that their path planner sees the change.
+ - The `edge` value is the index of the edge in the navigation mesh file.
+ - The optional `reorder_mesh` value must match the `reorder_mesh` value of the other elements
+   which use the mesh (e.g., the velocity components); the behavior fails to load otherwise.
+ */
+class MENGE_API NavMeshEdgeTarget : public EventTarget {
+ public:
+  /*!
+   @brief    Default constructor.
+   */
+  NavMeshEdgeTarget() : EventTarget(), _localizer(0x0), _edgeID(0) {}
+
+  /*!
+   @brief    Returns the planner which plans routes across the targeted edge.
+   */
+  PathPlanner* getPlanner() { return _localizer->getPlanner(); }
+
+  /*!
+   @brief    Returns the index of the targeted edge in the navigation mesh.
+   */
+  unsigned int getEdgeID() const { return _edgeID; }
+
+  friend class NavMeshEdgeTargetFactory;
+
+ protected:
+  /*!
+   @brief    The localizer which owns the path planner for the targeted mesh.
+   */
+  NavMeshLocalizerPtr _localizer;
+
+  /*!
+   @brief    The index of the targeted edge in the navigation mesh (not the id in the file; see
+            NavMesh::getEdgeIndex()).
+   */
+  unsigned int _edgeID;
+};
+
+/*!
+ @brief    The factory to generate NavMeshEdgeTarget instances.
+ */
+class MENGE_API NavMeshEdgeTargetFactory : public EventTargetFactory {
+ public:
+  /*!
+  @brief    Constructor.
+  */
+  NavMeshEdgeTargetFactory();
+
+  /*!
+   @brief    The name of the target.
+
+   The target's name must be unique among all registered targets. Each target factory must override
+   this function.
+
+   @returns  A string containing the unique target name.
+   */
+  virtual const char* name() const { return "nav_mesh_edge"; }
+
+  /*!
+   @brief    A description of the target.
+
+   Each target factory must override this function.
+
+   @returns  A string containing the target description.
+   */
+  virtual const char* description() const {
+    return "Defines an edge of a navigation mesh as a target based on its index in the mesh file.";
+  };
+
+ protected:
+  /*!
+   @brief    Create an instance of this class's target.
+
+   @returns    A pointer to a newly instantiated EventTarget class.
+   */
+  EventTarget* instance() const { return new NavMeshEdgeTarget(); }
+
+  /*!
+   @brief    Given a pointer to an EventTarget instance, sets the appropriate fields from the
+            provided XML node.
+
+   @param    target        A pointer to the target whose attributes are to be set.
+   @param    node          The XML node containing the target attributes.
+   @param    behaveFldr    The path to the behavior file. The navigation mesh is defined relative
+                          to this folder.
+   @returns  A boolean reporting success (true) or failure (false).
+   */
+  virtual bool setFromXML(EventTarget* target, TiXmlElement* node,
+                          const std::string& behaveFldr) const;
+
+  /*!
+  @brief    The identifier for the "file_name" string attribute.
+  */
+  size_t _fileNameID;
+
+  /*!
+  @brief    The identifier for the "reorder_mesh" bool attribute.
+  */
+  size_t _reorderID;
+
+  /*!
+  @brief    The identifier for the "edge" size_t attribute.
+  */
+  size_t _edgeID;
+};
+}  // namespace Menge
+
+#endif  // __NAV_MESH_EDGE_TARGET_H__
@@ -0,0 +1,376 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/InteractionKernels.h"
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Math/consts.h"
+#include "MengeCore/Math/geomQuery.h"
+#include "MengeCore/Runtime/SimpleLock.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KERNELS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Menge {
+
+namespace Agents {
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of InteractionBatch
+/////////////////////////////////////////////////////////////////////
+
+InteractionBatch::InteractionBatch() : _count(0), _columns(0), _stride(0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+void InteractionBatch::resize(size_t count, size_t columns) {
+  _count = count;
+  _columns = columns;
+  // Columns start on four-float boundaries.
+  _stride = (count + 3) & ~static_cast<size_t>(3);
+  if (_scratch.size() < _stride * columns) {
+    _scratch.resize(_stride * columns);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void InteractionBatch::gatherAgents(const BaseAgent* agent, size_t columns) {
+  const size_t count = agent->_nearAgents.size();
+  resize(count, columns);
+  _posX.resize(count);
+  _posY.resize(count);
+  _velX.resize(count);
+  _velY.resize(count);
+  _radius.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const BaseAgent* other = agent->_nearAgents[i].agent;
+    _posX[i] = other->_pos._x;
+    _posY[i] = other->_pos._y;
+    _velX[i] = other->_vel._x;
+    _velY[i] = other->_vel._y;
+    _radius[i] = other->_radius;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float* InteractionBatch::column(size_t i) {
+  assert(i < _columns && "Requested a scratch column which wasn't reserved");
+  return _scratch.empty() ? 0x0 : &_scratch[i * _stride];
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of the kernels
+/////////////////////////////////////////////////////////////////////
+
+namespace Kernels {
+
+namespace {
+
+/*!
+ @brief   Reports if the exponential kernel uses the polynomial approximation.
+ */
+bool approximatingExp = false;
+
+/*!
+ @brief   Reports if validation mode is enabled.
+ */
+bool validating = false;
+
+/*!
+ @brief   The largest relative deviation recorded in validation mode.
+ */
+float validationError = 0.f;
+
+/*!
+ @brief   Serializes the updates of the validation error.
+ */
+SimpleLock validationLock;
+
+/*!
+ @brief   Records the largest relative deviation between batched and reference values.
+ */
+void recordDeviation(const float* values, const float* reference, size_t count) {
+  float maxError = 0.f;
+  for (size_t i = 0; i < count; ++i) {
+    const float v = values[i];
+    const float ref = reference[i];
+    if (v == ref || (v != v && ref != ref)) continue;
+    float error = std::numeric_limits<float>::infinity();
+    if (std::isfinite(v) && std::isfinite(ref)) {
+      error = std::fabs(v - ref) / std::max(std::fabs(ref), std::numeric_limits<float>::min());
+    }
+    maxError = std::max(maxError, error);
+  }
+  if (maxError > 0.f) {
+    validationLock.lock();
+    validationError = std::max(validationError, maxError);
+    validationLock.release();
+  }
+}
+
+#ifdef KERNELS_SSE
+/*!
+ @brief   Computes 2^n for integers in the range [-126, 127].
+ */
+inline __m128 pow2(__m128i n) {
+  return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+}
+
+/*!
+ @brief   Evaluates exp for four values.
+
+ The argument is reduced to x = n ln(2) + r with |r| <= ln(2) / 2 and exp(r) is approximated by a
+ polynomial (the coefficients are those of the Cephes library). The scaling by 2^n is split in two
+ so that results which overflow or are denormal are also produced correctly.
+ */
+inline __m128 expSSE(__m128 x) {
+  const __m128 clamped = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-104.f)), _mm_set1_ps(88.8f));
+  const __m128i n = _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(1.44269504088896341f)));
+  const __m128 nf = _mm_cvtepi32_ps(n);
+  __m128 r = _mm_sub_ps(clamped, _mm_mul_ps(nf, _mm_set1_ps(0.693359375f)));
+  r = _mm_sub_ps(r, _mm_mul_ps(nf, _mm_set1_ps(-2.12194440e-4f)));
+
+  __m128 p = _mm_set1_ps(1.9875691500e-4f);
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+  p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, r), r), r), _mm_set1_ps(1.f));
+
+  const __m128i half = _mm_srai_epi32(n, 1);
+  const __m128 result = _mm_mul_ps(_mm_mul_ps(p, pow2(half)), pow2(_mm_sub_epi32(n, half)));
+  // NaN arguments produce NaN.
+  const __m128 nan = _mm_cmpunord_ps(x, x);
+  return _mm_or_ps(_mm_and_ps(nan, x), _mm_andnot_ps(nan, result));
+}
+#endif  // KERNELS_SSE
+
+/////////////////////////////////////////////////////////////////////
+
+void expBatch(const float* x, float* result, size_t count) {
+  size_t i = 0;
+#ifdef KERNELS_SSE
+  if (approximatingExp) {
+    for (; i + 4 <= count; i += 4) {
+      _mm_storeu_ps(result + i, expSSE(_mm_loadu_ps(x + i)));
+    }
+    // The remainder uses the same approximation so results don't depend on a neighbor's position
+    // in the batch.
+    for (; i < count; ++i) {
+      _mm_store_ss(result + i, expSSE(_mm_set1_ps(x[i])));
+    }
+    return;
+  }
+#endif
+  for (; i < count; ++i) {
+    result[i] = std::exp(x[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void sqrtBatch(const float* x, float* result, size_t count) {
+  size_t i = 0;
+#ifdef KERNELS_SSE
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(result + i, _mm_sqrt_ps(_mm_loadu_ps(x + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    result[i] = std::sqrt(x[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void lengthBatch(const float* x, const float* y, float* result, size_t count) {
+  size_t i = 0;
+#ifdef KERNELS_SSE
+  for (; i + 4 <= count; i += 4) {
+    const __m128 vx = _mm_loadu_ps(x + i);
+    const __m128 vy = _mm_loadu_ps(y + i);
+    _mm_storeu_ps(result + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy))));
+  }
+#endif
+  for (; i < count; ++i) {
+    result[i] = abs(Math::Vector2(x[i], y[i]));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void rayCircleTTCBatch(const float* dirX, const float* dirY, const float* centerX,
+                       const float* centerY, const float* radius, float* result, size_t count) {
+  size_t i = 0;
+#ifdef KERNELS_SSE
+  // Performs the operations of Math::rayCircleTTC() in the same order.
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 infty = _mm_set1_ps(INFTY);
+  const __m128 signBit = _mm_set1_ps(-0.f);
+  for (; i + 4 <= count; i += 4) {
+    const __m128 dx = _mm_loadu_ps(dirX + i);
+    const __m128 dy = _mm_loadu_ps(dirY + i);
+    const __m128 cx = _mm_loadu_ps(centerX + i);
+    const __m128 cy = _mm_loadu_ps(centerY + i);
+    const __m128 r = _mm_loadu_ps(radius + i);
+    const __m128 a = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    const __m128 b = _mm_mul_ps(_mm_set1_ps(-2.f),
+                                _mm_add_ps(_mm_mul_ps(dx, cx), _mm_mul_ps(dy, cy)));
+    const __m128 c =
+        _mm_sub_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(r, r));
+    const __m128 discr =
+        _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(4.f), a), c));
+    const __m128 sqrtDiscr = _mm_sqrt_ps(discr);
+    const __m128 negB = _mm_xor_ps(b, signBit);
+    const __m128 twoA = _mm_mul_ps(_mm_set1_ps(2.f), a);
+    const __m128 t0 = _mm_div_ps(_mm_sub_ps(negB, sqrtDiscr), twoA);
+    const __m128 t1 = _mm_div_ps(_mm_add_ps(negB, sqrtDiscr), twoA);
+
+    // The cases are resolved from the last to the first so that earlier cases take precedence.
+    const __m128 t1Positive = _mm_cmpgt_ps(t1, zero);
+    const __m128 t0Positive = _mm_cmpgt_ps(t0, zero);
+    __m128 t = _mm_or_ps(_mm_and_ps(t1Positive, t1), _mm_andnot_ps(t1Positive, infty));
+    const __m128 useT0 = _mm_and_ps(_mm_cmplt_ps(t0, t1), t0Positive);
+    t = _mm_or_ps(_mm_and_ps(useT0, t0), _mm_andnot_ps(useT0, t));
+    const __m128 inside =
+        _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(t0, zero), t1Positive),
+                  _mm_and_ps(_mm_cmplt_ps(t1, zero), t0Positive));
+    t = _mm_andnot_ps(inside, t);
+    const __m128 miss = _mm_cmplt_ps(discr, zero);
+    t = _mm_or_ps(_mm_and_ps(miss, infty), _mm_andnot_ps(miss, t));
+    _mm_storeu_ps(result + i, t);
+  }
+#endif
+  for (; i < count; ++i) {
+    result[i] = Math::rayCircleTTC(Math::Vector2(dirX[i], dirY[i]),
+                                   Math::Vector2(centerX[i], centerY[i]), radius[i]);
+  }
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+
+void exp(const float* x, float* result, size_t count) {
+  if (!validating || count == 0) {
+    expBatch(x, result, count);
+    return;
+  }
+  std::vector<float> reference(count);
+  for (size_t i = 0; i < count; ++i) {
+    reference[i] = std::exp(x[i]);
+  }
+  expBatch(x, result, count);
+  recordDeviation(result, &reference[0], count);
+  std::copy(reference.begin(), reference.end(), result);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void sqrt(const float* x, float* result, size_t count) {
+  if (!validating || count == 0) {
+    sqrtBatch(x, result, count);
+    return;
+  }
+  std::vector<float> reference(count);
+  for (size_t i = 0; i < count; ++i) {
+    reference[i] = std::sqrt(x[i]);
+  }
+  sqrtBatch(x, result, count);
+  recordDeviation(result, &reference[0], count);
+  std::copy(reference.begin(), reference.end(), result);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void length(const float* x, const float* y, float* result, size_t count) {
+  if (!validating || count == 0) {
+    lengthBatch(x, y, result, count);
+    return;
+  }
+  std::vector<float> reference(count);
+  for (size_t i = 0; i < count; ++i) {
+    reference[i] = abs(Math::Vector2(x[i], y[i]));
+  }
+  lengthBatch(x, y, result, count);
+  recordDeviation(result, &reference[0], count);
+  std::copy(reference.begin(), reference.end(), result);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void rayCircleTTC(const float* dirX, const float* dirY, const float* centerX,
+                  const float* centerY, const float* radius, float* result, size_t count) {
+  if (!validating || count == 0) {
+    rayCircleTTCBatch(dirX, dirY, centerX, centerY, radius, result, count);
+    return;
+  }
+  std::vector<float> reference(count);
+  for (size_t i = 0; i < count; ++i) {
+    reference[i] = Math::rayCircleTTC(Math::Vector2(dirX[i], dirY[i]),
+                                      Math::Vector2(centerX[i], centerY[i]), radius[i]);
+  }
+  rayCircleTTCBatch(dirX, dirY, centerX, centerY, radius, result, count);
+  recordDeviation(result, &reference[0], count);
+  std::copy(reference.begin(), reference.end(), result);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void setApproximateExp(bool state) { approximatingExp = state; }
+
+/////////////////////////////////////////////////////////////////////
+
+bool getApproximateExp() { return approximatingExp; }
+
+/////////////////////////////////////////////////////////////////////
+
+void setValidation(bool state) { validating = state; }
+
+/////////////////////////////////////////////////////////////////////
+
+bool getValidation() { return validating; }
+
+/////////////////////////////////////////////////////////////////////
+
+float getValidationError() {
+  validationLock.lock();
+  const float error = validationError;
+  validationLock.release();
+  return error;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void resetValidationError() {
+  validationLock.lock();
+  validationError = 0.f;
+  validationLock.release();
+}
+}  // namespace Kernels
+}  // namespace Agents
+}  // namespace Menge
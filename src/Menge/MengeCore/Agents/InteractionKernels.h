@@ -0,0 +1,203 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __INTERACTION_KERNELS_H__
+#define __INTERACTION_KERNELS_H__
+
+/*!
+ @file    InteractionKernels.h
+ @brief   Batched evaluation of the per-neighbor terms of force-based pedestrian models.
+
+ A pedestrian model gathers its neighbors into an InteractionBatch, computes the arguments of the
+ expensive terms (exponentials, square roots, times to collision) for all neighbors, evaluates those
+ terms with a single kernel call per term and then accumulates its forces. On x86 platforms the
+ kernels process four neighbors at a time with SSE instructions.
+
+ The square root, length and time-to-collision kernels produce exactly the values of the
+ corresponding scalar functions. The exponential kernel does too unless the polynomial approximation
+ is enabled (see setApproximateExp()); its relative error is a few units in the last place, so it
+ changes trajectories slightly. In validation mode, every kernel also evaluates
+ the scalar functions, records the largest relative deviation and returns the *scalar* values, so a
+ simulation run in validation mode reproduces the scalar results.
+ */
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+class BaseAgent;
+
+/*!
+ @brief   The per-neighbor data of a force evaluation, stored as a structure of arrays.
+
+ In addition to the gathered neighbor data, the batch provides a number of scratch columns (one
+ float per neighbor each) for the intermediate values of the force evaluation.
+ */
+class MENGE_API InteractionBatch {
+ public:
+  /*!
+   @brief   Constructor.
+   */
+  InteractionBatch();
+
+  /*!
+   @brief   Sizes the batch for the given number of elements without gathering any data.
+
+   @param   count     The number of elements.
+   @param   columns   The number of scratch columns required.
+   */
+  void resize(size_t count, size_t columns);
+
+  /*!
+   @brief   Gathers the positions, velocities and radii of the agent's nearby agents.
+
+   @param   agent     The agent whose neighbors are gathered.
+   @param   columns   The number of scratch columns required.
+   */
+  void gatherAgents(const BaseAgent* agent, size_t columns);
+
+  /*!
+   @brief   Reports the number of elements in the batch.
+   */
+  size_t size() const { return _count; }
+
+  /*!
+   @brief   Returns a scratch column.
+
+   @param   i   The index of the column; must be less than the number of columns requested.
+   @returns A pointer to size() floats. The contents are undefined until written.
+   */
+  float* column(size_t i);
+
+  /*!
+   @brief   The x-positions of the gathered neighbors.
+   */
+  std::vector<float> _posX;
+
+  /*!
+   @brief   The y-positions of the gathered neighbors.
+   */
+  std::vector<float> _posY;
+
+  /*!
+   @brief   The x-velocities of the gathered neighbors.
+   */
+  std::vector<float> _velX;
+
+  /*!
+   @brief   The y-velocities of the gathered neighbors.
+   */
+  std::vector<float> _velY;
+
+  /*!
+   @brief   The radii of the gathered neighbors.
+   */
+  std::vector<float> _radius;
+
+ protected:
+  /*!
+   @brief   The number of elements in the batch.
+   */
+  size_t _count;
+
+  /*!
+   @brief   The number of scratch columns.
+   */
+  size_t _columns;
+
+  /*!
+   @brief   The distance between the starts of consecutive scratch columns.
+   */
+  size_t _stride;
+
+  /*!
+   @brief   The storage of the scratch columns.
+   */
+  std::vector<float> _scratch;
+};
+
+/*!
+ @brief   The batched kernels. Every kernel allows its result to overwrite one of its inputs.
+ */
+namespace Kernels {
+
+/*!
+ @brief   Computes result[i] = exp(x[i]). Overflows to infinity and underflows to zero like
+          std::exp. The values are those of std::exp unless the approximation is enabled (see
+          setApproximateExp()).
+ */
+MENGE_API void exp(const float* x, float* result, size_t count);
+
+/*!
+ @brief   Computes result[i] = sqrt(x[i]).
+ */
+MENGE_API void sqrt(const float* x, float* result, size_t count);
+
+/*!
+ @brief   Computes result[i] = |(x[i], y[i])|.
+ */
+MENGE_API void length(const float* x, const float* y, float* result, size_t count);
+
+/*!
+ @brief   Computes result[i] = Math::rayCircleTTC((dirX[i], dirY[i]), (centerX[i], centerY[i]),
+          radius[i]).
+ */
+MENGE_API void rayCircleTTC(const float* dirX, const float* dirY, const float* centerX,
+                            const float* centerY, const float* radius, float* result,
+                            size_t count);
+
+/*!
+ @brief   Enables or disables the vectorized polynomial approximation of the exponential kernel.
+          It is disabled by default.
+ */
+MENGE_API void setApproximateExp(bool state);
+
+/*!
+ @brief   Reports if the exponential kernel uses the polynomial approximation.
+ */
+MENGE_API bool getApproximateExp();
+
+/*!
+ @brief   Enables or disables validation mode.
+ */
+MENGE_API void setValidation(bool state);
+
+/*!
+ @brief   Reports if validation mode is enabled.
+ */
+MENGE_API bool getValidation();
+
+/*!
+ @brief   Reports the largest relative deviation between the batched and scalar evaluations observed
+          in validation mode since the last reset.
+ */
+MENGE_API float getValidationError();
+
+/*!
+ @brief   Resets the recorded validation deviation to zero.
+ */
+MENGE_API void resetValidationError();
+}  // namespace Kernels
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __INTERACTION_KERNELS_H__
@@ -72,6 +72,7 @@ bool NavMeshObstacleSet::extractFromNavMesh(NavMeshPtr nm) {
 
 NavMeshObstacleSetFactory::NavMeshObstacleSetFactory() : ObstacleSetFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -92,7 +93,7 @@ bool NavMeshObstacleSetFactory::setFromXML(ObstacleSet* gen, TiXmlElement* node,
   // nav mesh
   NavMeshPtr nmPtr;
   try {
-    nmPtr = loadNavMesh(fName);
+    nmPtr = loadNavMesh(fName, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh "
@@ -0,0 +1,200 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SCBChunks.h"
+
+#include "MengeCore/Runtime/LZCodec.h"
+
+#include <cstring>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+// Zig-zag encodes a (wrapping) difference so that small magnitudes become small unsigned values.
+inline unsigned int zigzag(unsigned int delta) { return (delta << 1) ^ (0u - (delta >> 31)); }
+
+inline unsigned int unzigzag(unsigned int code) { return (code >> 1) ^ (0u - (code & 1)); }
+
+inline void putVarint(std::vector<char>& data, unsigned int value) {
+  while (value >= 0x80) {
+    data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  data.push_back(static_cast<char>(value));
+}
+
+// Reads a variable-length integer; returns false if the data runs out or the value is too long.
+inline bool getVarint(const unsigned char*& p, const unsigned char* end, unsigned int& value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (p == end) return false;
+    const unsigned char b = *p++;
+    value |= static_cast<unsigned int>(b & 0x7F) << shift;
+    if (b < 0x80) return true;
+  }
+  return false;
+}
+
+inline void putUInt(std::ofstream& file, unsigned int value) {
+  file.write((char*)&value, sizeof(unsigned int));
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBChunkEncoder
+/////////////////////////////////////////////////////////////////////
+
+SCBChunkEncoder::SCBChunkEncoder(size_t framesPerChunk, size_t valueCount, bool recordIds)
+    : _framesPerChunk(framesPerChunk > 0 ? framesPerChunk : 1),
+      _valueCount(valueCount),
+      _recordIds(recordIds),
+      _chunkFrames(0),
+      _frameCount(0),
+      _records(),
+      _history(valueCount),
+      _encoded(),
+      _compressed(),
+      _chunkOffsets() {}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::addFrame(const std::vector<char>& frame, std::ofstream& file) {
+  const size_t RECORD_SIZE = (1 + _valueCount) * sizeof(int);
+  std::vector<size_t> ids;
+  _records.clear();
+  for (size_t offset = 0; offset + RECORD_SIZE <= frame.size(); offset += RECORD_SIZE) {
+    int id;
+    memcpy(&id, &frame[offset], sizeof(int));
+    if (id < 0) continue;
+    // Without recorded identifiers, the agents are implicitly numbered in order.
+    ids.push_back(_recordIds ? static_cast<size_t>(id) : _records.size());
+    _records.push_back(&frame[offset + sizeof(int)]);
+  }
+  const size_t AGT_COUNT = _records.size();
+  _history.startFrame(_chunkFrames == 0);
+  if (AGT_COUNT > 0) _history.reserve(ids.back() + 1);
+
+  putVarint(_encoded, static_cast<unsigned int>(AGT_COUNT));
+  if (_recordIds) {
+    for (size_t a = 0; a < AGT_COUNT; ++a) {
+      putVarint(_encoded, static_cast<unsigned int>(a > 0 ? ids[a] - ids[a - 1] : ids[a]));
+    }
+  }
+  for (size_t v = 0; v < _valueCount; ++v) {
+    for (size_t a = 0; a < AGT_COUNT; ++a) {
+      int value;
+      memcpy(&value, _records[a] + v * sizeof(int), sizeof(int));
+      const unsigned int prev = static_cast<unsigned int>(_history.previous(ids[a], v));
+      putVarint(_encoded, zigzag(static_cast<unsigned int>(value) - prev));
+      _history.set(ids[a], v, value);
+    }
+  }
+  for (size_t a = 0; a < AGT_COUNT; ++a) _history.mark(ids[a]);
+
+  ++_frameCount;
+  if (++_chunkFrames == _framesPerChunk) writeChunk(file);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::finish(std::ofstream& file) {
+  writeChunk(file);
+  const unsigned long long INDEX_OFFSET = static_cast<unsigned long long>(file.tellp());
+  if (!_chunkOffsets.empty()) {
+    file.write((char*)&_chunkOffsets[0], _chunkOffsets.size() * sizeof(unsigned long long));
+  }
+  putUInt(file, static_cast<unsigned int>(_chunkOffsets.size()));
+  putUInt(file, static_cast<unsigned int>(_frameCount));
+  file.write((char*)&INDEX_OFFSET, sizeof(unsigned long long));
+  file.write("SCBI", 4);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::writeChunk(std::ofstream& file) {
+  if (_chunkFrames == 0) return;
+  _chunkOffsets.push_back(static_cast<unsigned long long>(file.tellp()));
+  _compressed.clear();
+  LZCodec::compress(&_encoded[0], _encoded.size(), _compressed);
+  putUInt(file, static_cast<unsigned int>(_chunkFrames));
+  putUInt(file, static_cast<unsigned int>(_encoded.size()));
+  putUInt(file, static_cast<unsigned int>(_compressed.size()));
+  file.write(&_compressed[0], _compressed.size());
+  _encoded.clear();
+  _chunkFrames = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBChunkDecoder
+/////////////////////////////////////////////////////////////////////
+
+bool SCBChunkDecoder::decode(const char* data, size_t size, size_t encodedSize, size_t frameCount,
+                             size_t agentCount, size_t valueCount, bool recordIds,
+                             std::vector<std::vector<int> >& frames,
+                             std::vector<std::vector<size_t> >& ids) {
+  std::vector<char> encoded(encodedSize + 1);
+  if (!LZCodec::decompress(data, size, &encoded[0], encodedSize)) return false;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(&encoded[0]);
+  const unsigned char* const END = p + encodedSize;
+
+  SCBChunkHistory history(valueCount);
+  history.reserve(agentCount);
+  frames.resize(frameCount);
+  ids.resize(frameCount);
+  for (size_t i = 0; i < frameCount; ++i) {
+    unsigned int count;
+    if (!getVarint(p, END, count) || count > agentCount) return false;
+    const size_t AGT_COUNT = count;
+    std::vector<size_t>& frameIds = ids[i];
+    frameIds.resize(AGT_COUNT);
+    for (size_t a = 0; a < AGT_COUNT; ++a) {
+      unsigned int id = static_cast<unsigned int>(a);
+      if (recordIds) {
+        if (!getVarint(p, END, id)) return false;
+        if (a > 0) {
+          // Identifiers strictly increase.
+          if (id == 0 || id > 0xFFFFFFFFu - frameIds[a - 1]) return false;
+          id += static_cast<unsigned int>(frameIds[a - 1]);
+        }
+      }
+      frameIds[a] = id;
+    }
+    if (AGT_COUNT > 0 && frameIds.back() >= agentCount) return false;
+    history.startFrame(i == 0);
+
+    std::vector<int>& frame = frames[i];
+    frame.resize(AGT_COUNT * valueCount);
+    for (size_t v = 0; v < valueCount; ++v) {
+      for (size_t a = 0; a < AGT_COUNT; ++a) {
+        unsigned int code;
+        if (!getVarint(p, END, code)) return false;
+        const unsigned int prev = static_cast<unsigned int>(history.previous(frameIds[a], v));
+        const int value = static_cast<int>(prev + unzigzag(code));
+        frame[a * valueCount + v] = value;
+        history.set(frameIds[a], v, value);
+      }
+    }
+    for (size_t a = 0; a < AGT_COUNT; ++a) history.mark(frameIds[a]);
+  }
+  return p == END;
+}
+
+}  // namespace Agents
+}  // namespace Menge
@@ -0,0 +1,281 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    SCBChunks.h
+ @brief   The chunked, compressed frame encoding of scb versions 3.x.
+
+ A version 3.x file has the version 2.0 header (the version string, agent count, time step and agent
+ class ids) followed by:
+
+     4-byte float    position precision (meters)
+     4-byte float    orientation precision (radians)
+     4-byte uint     frames per chunk
+
+ Version 3.1 continues the header with:
+
+     4-byte uint     the recorded fields (a combination of SCBFilter::Field)
+     4-byte uint     1 if the frames record the identifiers of their agents, 0 otherwise
+
+ Version 3.0 records the position, orientation and state of every agent. The chunks follow the
+ header. Each chunk holds up to "frames per chunk" frames:
+
+     4-byte uint     frame count
+     4-byte uint     encoded size (bytes)
+     4-byte uint     compressed size (bytes)
+     compressed bytes (see LZCodec)
+
+ Every agent's recorded fields are quantized to integers, in this order: x- and y-position,
+ orientation, state id, x- and y-velocity, x- and y-preferred velocity and elevation (lengths in
+ units of the position precision, angles in units of the orientation precision). A frame is encoded
+ as its agent count, then (if the frames record them) the agents' identifiers in increasing order
+ as the first identifier and the gaps between the following ones, and then, one integer at a time,
+ every agent's difference from its value in the previous frame of the chunk (its value, if the
+ agent is not in the previous frame or this is the chunk's first frame). Without recorded
+ identifiers, the agents of a frame are the agents 0, 1, 2, etc. All of these integers are written
+ as variable-length (base-128) integers; differences are zig-zag encoded. So, a chunk can be decoded
+ without any other chunk.
+
+ The file ends with an index of the chunks:
+
+     8-byte uint     file offset of each chunk
+     4-byte uint     chunk count
+     4-byte uint     frame count
+     8-byte uint     file offset of the index
+     4 bytes         "SCBI"
+
+ Because every chunk but the last is full, the chunk holding a frame is found directly. If a file
+ has no index (e.g., the simulation was killed), the chunks can still be read in order.
+ */
+
+#ifndef __SCB_CHUNKS_H__
+#define __SCB_CHUNKS_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <fstream>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief   The values of the agents in the previous frame of a chunk, by agent identifier.
+ */
+class MENGE_API SCBChunkHistory {
+ public:
+  /*!
+   @brief   Constructor.
+
+   @param   valueCount    The number of integers per agent.
+   */
+  explicit SCBChunkHistory(size_t valueCount)
+      : _valueCount(valueCount), _frame(2), _seen(), _values() {}
+
+  /*!
+   @brief   Starts a new frame; the agents marked in the current frame become the previous frame.
+
+   @param   chunkStart    True if the new frame starts a chunk (it has no previous frame).
+   */
+  void startFrame(bool chunkStart) { _frame += chunkStart ? 2 : 1; }
+
+  /*!
+   @brief   Makes room for the agents with identifiers less than the given count.
+
+   @param   count   The number of agents.
+   */
+  void reserve(size_t count) {
+    if (count > _seen.size()) {
+      _seen.resize(count, 0);
+      _values.resize(count * _valueCount, 0);
+    }
+  }
+
+  /*!
+   @brief   Reports an agent's value in the previous frame (zero if it wasn't in it).
+
+   @param   id      The agent's identifier; room must have been made for it.
+   @param   v       The index of the value.
+   */
+  int previous(size_t id, size_t v) const {
+    return _seen[id] + 1 == _frame ? _values[id * _valueCount + v] : 0;
+  }
+
+  /*!
+   @brief   Sets an agent's value in the current frame. Its previous value is lost, so it must be
+            read first.
+
+   @param   id      The agent's identifier; room must have been made for it.
+   @param   v       The index of the value.
+   @param   value   The value.
+   */
+  void set(size_t id, size_t v, int value) { _values[id * _valueCount + v] = value; }
+
+  /*!
+   @brief   Marks an agent as being in the current frame, once all of its values are set.
+
+   @param   id      The agent's identifier; room must have been made for it.
+   */
+  void mark(size_t id) { _seen[id] = _frame; }
+
+ protected:
+  /*!
+   @brief   The number of integers per agent.
+   */
+  size_t _valueCount;
+
+  /*!
+   @brief   The stamp of the current frame.
+   */
+  size_t _frame;
+
+  /*!
+   @brief   The stamp of the last frame each agent was in.
+   */
+  std::vector<size_t> _seen;
+
+  /*!
+   @brief   Each agent's values in the last frame it was in.
+   */
+  std::vector<int> _values;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   Encodes quantized frames into compressed chunks and writes them, and the final index, to
+          a file.
+ */
+class MENGE_API SCBChunkEncoder {
+ public:
+  /*!
+   @brief   Constructor.
+
+   @param   framesPerChunk    The number of frames in each chunk.
+   @param   valueCount        The number of integers per agent.
+   @param   recordIds         True if the frames record their agents' identifiers.
+   */
+  SCBChunkEncoder(size_t framesPerChunk, size_t valueCount, bool recordIds);
+
+  /*!
+   @brief   Adds a frame, writing the chunk once it is full.
+
+   @param   frame     For each agent, in increasing order of identifier, a 32-bit identifier
+                      followed by its 32-bit integers. Agents with a negative identifier are
+                      skipped.
+   @param   file      The file to write to.
+   */
+  void addFrame(const std::vector<char>& frame, std::ofstream& file);
+
+  /*!
+   @brief   Writes the partial chunk (if any) and the index.
+
+   @param   file      The file to write to.
+   */
+  void finish(std::ofstream& file);
+
+ protected:
+  /*!
+   @brief   Compresses and writes the current chunk.
+   */
+  void writeChunk(std::ofstream& file);
+
+  /*!
+   @brief   The number of frames in each chunk.
+   */
+  size_t _framesPerChunk;
+
+  /*!
+   @brief   The number of integers per agent.
+   */
+  size_t _valueCount;
+
+  /*!
+   @brief   Determines if the frames record their agents' identifiers.
+   */
+  bool _recordIds;
+
+  /*!
+   @brief   The number of frames in the current chunk.
+   */
+  size_t _chunkFrames;
+
+  /*!
+   @brief   The number of frames added.
+   */
+  size_t _frameCount;
+
+  /*!
+   @brief   The frame records of the agents in the current frame.
+   */
+  std::vector<const char*> _records;
+
+  /*!
+   @brief   The history of each agent's values (see SCBChunkHistory).
+   */
+  SCBChunkHistory _history;
+
+  /*!
+   @brief   The encoded (uncompressed) frames of the current chunk.
+   */
+  std::vector<char> _encoded;
+
+  /*!
+   @brief   Buffer for the compressed chunk.
+   */
+  std::vector<char> _compressed;
+
+  /*!
+   @brief   The file offset of each chunk written.
+   */
+  std::vector<unsigned long long> _chunkOffsets;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   Decodes the chunks written by SCBChunkEncoder.
+ */
+class MENGE_API SCBChunkDecoder {
+ public:
+  /*!
+   @brief   Decodes a chunk.
+
+   @param   data          The chunk's compressed bytes.
+   @param   size          The number of compressed bytes.
+   @param   encodedSize   The size of the chunk's encoded frames.
+   @param   frameCount    The number of frames in the chunk.
+   @param   agentCount    The number of agents in the file; identifiers are less than it.
+   @param   valueCount    The number of integers per agent.
+   @param   recordIds     True if the frames record their agents' identifiers.
+   @param   frames        Set to each frame's integers, agent by agent.
+   @param   ids           Set to the identifiers of each frame's agents.
+   @returns True if the chunk was well formed.
+   */
+  static bool decode(const char* data, size_t size, size_t encodedSize, size_t frameCount,
+                     size_t agentCount, size_t valueCount, bool recordIds,
+                     std::vector<std::vector<int> >& frames,
+                     std::vector<std::vector<size_t> >& ids);
+};
+
+}  // namespace Agents
+}  // namespace Menge
+
+#endif  // __SCB_CHUNKS_H__
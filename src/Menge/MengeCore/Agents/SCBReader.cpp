@@ -0,0 +1,247 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SCBReader.h"
+
+#include "MengeCore/Agents/SCBChunks.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+// The size of a version 3.x chunk's header: frame count, encoded size and compressed size.
+const unsigned long long CHUNK_HEADER_SIZE = 3 * sizeof(unsigned int);
+
+// The size of the end of a version 3.x index: chunk count, frame count, index offset and "SCBI".
+const unsigned long long INDEX_FOOTER_SIZE =
+    2 * sizeof(unsigned int) + sizeof(unsigned long long) + 4;
+
+// Reads a value at the offset in the mapped file, advancing the offset; false if the file is too
+// short.
+template <typename T>
+bool readValue(const MappedFile& file, unsigned long long& offset, T& value) {
+  if (offset + sizeof(T) > file.size()) return false;
+  memcpy(&value, file.data() + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBReader
+/////////////////////////////////////////////////////////////////////
+
+SCBReader::SCBReader(const std::string& pathName)
+    : _file(),
+      _fileSize(0),
+      _agentCount(0),
+      _timeStep(0.f),
+      _classes(),
+      _agentFloats(0),
+      _frameCount(0),
+      _dataOffset(0),
+      _precision(0.f),
+      _orientPrecision(0.f),
+      _chunkFrames(0),
+      _fields(0),
+      _recordIds(false),
+      _scales(),
+      _chunkOffsets(),
+      _loadedChunk(0),
+      _chunk(),
+      _chunkIds() {
+  if (!_file.open(pathName)) {
+    throw SCBFileException("Unable to open the scb file: " + pathName);
+  }
+  _fileSize = _file.size();
+
+  std::string version;
+  unsigned long long offset = 0;
+  char c = 1;
+  while (offset < _fileSize && version.size() < 8) {
+    c = _file.data()[offset++];
+    if (c == '\0') break;
+    version += c;
+  }
+  const size_t dotPos = version.find_first_of(".");
+  if (c != '\0' || dotPos == std::string::npos) {
+    throw SCBFileException("The file is not an scb file: " + pathName);
+  }
+  _version[0] = atoi(version.substr(0, dotPos).c_str());
+  _version[1] = atoi(version.substr(dotPos + 1).c_str());
+  if (_version[0] == 1 && _version[1] == 0) {
+    _agentFloats = 3;
+  } else if (_version[0] == 2 && _version[1] >= 0 && _version[1] <= 4) {
+    const size_t FLOATS[] = {3, 4, 8, 4, 4};
+    _agentFloats = FLOATS[_version[1]];
+  } else if (_version[0] == 3 && (_version[1] == 0 || _version[1] == 1)) {
+    _fields = SCBFilter::DEFAULT_FIELDS;
+  } else {
+    throw SCBVersionException("Unsupported scb version: " + version);
+  }
+
+  unsigned int agentCount = 0;
+  bool valid = readValue(_file, offset, agentCount);
+  _agentCount = agentCount;
+  if (_version[0] >= 2) {
+    valid = valid && readValue(_file, offset, _timeStep);
+    // Each class takes four bytes; don't trust a count the file can't hold.
+    valid = valid && _agentCount <= (_fileSize - offset) / sizeof(unsigned int);
+    if (valid) _classes.resize(_agentCount);
+    for (size_t i = 0; valid && i < _agentCount; ++i) {
+      unsigned int cID = 0;
+      valid = readValue(_file, offset, cID);
+      _classes[i] = cID;
+    }
+  }
+  if (_version[0] == 3) {
+    unsigned int chunkFrames = 0;
+    valid = valid && readValue(_file, offset, _precision) &&
+            readValue(_file, offset, _orientPrecision) && readValue(_file, offset, chunkFrames);
+    _chunkFrames = chunkFrames;
+    valid = valid && _chunkFrames > 0;
+    if (_version[1] == 1) {
+      unsigned int flags = 0;
+      valid = valid && readValue(_file, offset, _fields) && readValue(_file, offset, flags);
+      _recordIds = (flags & 1) != 0;
+    }
+    // The scales of the values, in the order of SCBFrameWriter3_0.
+    const float p = _precision;
+    const float SCALES[] = {p, p, _orientPrecision, 1.f, p, p, p, p, p};
+    const unsigned int FIELDS[] = {SCBFilter::POSITION,      SCBFilter::POSITION,
+                                   SCBFilter::ORIENTATION,   SCBFilter::STATE,
+                                   SCBFilter::VELOCITY,      SCBFilter::VELOCITY,
+                                   SCBFilter::PREF_VELOCITY, SCBFilter::PREF_VELOCITY,
+                                   SCBFilter::ELEVATION};
+    for (size_t v = 0; v < 9; ++v) {
+      if (_fields & FIELDS[v]) _scales.push_back(SCALES[v]);
+    }
+    _agentFloats = _scales.size();
+  }
+  if (!valid) {
+    throw SCBFileException("The scb file's header is truncated: " + pathName);
+  }
+  _dataOffset = offset;
+
+  if (_version[0] == 3) {
+    if (!readChunkIndex()) {
+      throw SCBFileException("The scb file's chunks are malformed: " + pathName);
+    }
+    _loadedChunk = _chunkOffsets.size();
+  } else {
+    const unsigned long long FRAME_SIZE = _agentCount * _agentFloats * sizeof(float);
+    _frameCount = FRAME_SIZE > 0 ? static_cast<size_t>((_fileSize - _dataOffset) / FRAME_SIZE) : 0;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::readFrame(size_t frame, std::vector<float>& data, std::vector<size_t>* ids) {
+  if (frame >= _frameCount) return false;
+  if (_version[0] < 3) {
+    if (ids != 0x0) {
+      ids->resize(_agentCount);
+      for (size_t i = 0; i < _agentCount; ++i) (*ids)[i] = i;
+    }
+    const size_t FLOAT_COUNT = _agentCount * _agentFloats;
+    data.resize(FLOAT_COUNT);
+    // The frame count guarantees that the whole frame is in the file.
+    if (FLOAT_COUNT > 0) {
+      memcpy(&data[0], _file.data() + _dataOffset + frame * FLOAT_COUNT * sizeof(float),
+             FLOAT_COUNT * sizeof(float));
+    }
+    return true;
+  }
+
+  if (!loadChunk(frame / _chunkFrames) || frame % _chunkFrames >= _chunk.size()) return false;
+  const std::vector<int>& values = _chunk[frame % _chunkFrames];
+  data.resize(values.size());
+  for (size_t i = 0; i < values.size(); i += _agentFloats) {
+    for (size_t v = 0; v < _agentFloats; ++v) data[i + v] = values[i + v] * _scales[v];
+  }
+  if (ids != 0x0) *ids = _chunkIds[frame % _chunkFrames];
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::readChunkIndex() {
+  _chunkOffsets.clear();
+  if (_fileSize >= _dataOffset + INDEX_FOOTER_SIZE &&
+      memcmp(_file.data() + _fileSize - 4, "SCBI", 4) == 0) {
+    unsigned int chunkCount = 0, frameCount = 0;
+    unsigned long long indexOffset = 0;
+    unsigned long long offset = _fileSize - INDEX_FOOTER_SIZE;
+    if (readValue(_file, offset, chunkCount) && readValue(_file, offset, frameCount) &&
+        readValue(_file, offset, indexOffset) && indexOffset >= _dataOffset &&
+        indexOffset + chunkCount * sizeof(unsigned long long) + INDEX_FOOTER_SIZE == _fileSize) {
+      _chunkOffsets.resize(chunkCount);
+      if (chunkCount > 0) {
+        memcpy(&_chunkOffsets[0], _file.data() + indexOffset,
+               chunkCount * sizeof(unsigned long long));
+      }
+      _frameCount = frameCount;
+      return (_frameCount + _chunkFrames - 1) / _chunkFrames == chunkCount;
+    }
+  }
+
+  // There is no index; find the complete chunks by reading their headers.
+  _frameCount = 0;
+  unsigned long long offset = _dataOffset;
+  while (offset + CHUNK_HEADER_SIZE <= _fileSize) {
+    const unsigned long long chunkOffset = offset;
+    unsigned int frameCount = 0, encodedSize = 0, compressedSize = 0;
+    readValue(_file, offset, frameCount);
+    readValue(_file, offset, encodedSize);
+    readValue(_file, offset, compressedSize);
+    if (offset + compressedSize > _fileSize) break;
+    // Only the last chunk can be partial.
+    if (frameCount == 0 || frameCount > _chunkFrames || _frameCount % _chunkFrames != 0) {
+      return false;
+    }
+    _chunkOffsets.push_back(chunkOffset);
+    _frameCount += frameCount;
+    offset += compressedSize;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::loadChunk(size_t chunk) {
+  if (chunk == _loadedChunk) return true;
+  if (chunk >= _chunkOffsets.size()) return false;
+  _loadedChunk = _chunkOffsets.size();
+  unsigned long long offset = _chunkOffsets[chunk];
+  unsigned int frameCount = 0, encodedSize = 0, compressedSize = 0;
+  if (!readValue(_file, offset, frameCount) || !readValue(_file, offset, encodedSize) ||
+      !readValue(_file, offset, compressedSize) || offset + compressedSize > _fileSize ||
+      !SCBChunkDecoder::decode(_file.data() + offset, compressedSize, encodedSize, frameCount,
+                               _agentCount, _agentFloats, _recordIds, _chunk, _chunkIds)) {
+    return false;
+  }
+  _loadedChunk = chunk;
+  return true;
+}
+
+}  // namespace Agents
+}  // namespace Menge
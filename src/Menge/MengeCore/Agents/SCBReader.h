@@ -0,0 +1,234 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    SCBReader.h
+ @brief   Reads the crowd trajectories written by SCBWriter.
+ */
+
+#ifndef __SCB_READER_H__
+#define __SCB_READER_H__
+
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Runtime/MappedFile.h"
+
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief   Reads the frames of an scb file of any version, in any order.
+
+ A frame is read as a set of floats per agent. For the uncompressed versions, these are the values
+ in the file (see the SCBFrameWriter classes). For version 3.0, they are the values of version 2.1:
+ x-pos, y-pos, orientation (radians) and stateID, restored from their quantized values. For version
+ 3.1, they are the recorded fields (see getFields() and SCBFrameWriter3_0), restored likewise.
+
+ Version 3.1 files may record a subset of the agents in each frame; readFrame() reports the
+ identifiers of the agents it read. In all other versions, every frame holds every agent, in order.
+
+ The file is memory mapped, so reading a frame only loads that frame (or its chunk) from the disk;
+ frames can be read in any order (e.g., for seeking in a replay) without reading the whole file.
+ The frames of uncompressed files are found by their size, so the agent count must be constant. The
+ frames of version 3.x files are found through the file's chunk index (or by reading the chunks in
+ order, if the file has no index).
+ */
+class MENGE_API SCBReader {
+ public:
+  /*!
+   @brief   Constructor. Opens the file and reads its header.
+
+   @param   pathName    The path to the scb file.
+   @throws  SCBFileException if the file can't be opened or is malformed.
+   @throws  SCBVersionException if the file's version is not supported.
+   */
+  explicit SCBReader(const std::string& pathName);
+
+  /*!
+   @brief   Reports the major version of the file.
+   */
+  int getMajorVersion() const { return _version[0]; }
+
+  /*!
+   @brief   Reports the minor version of the file.
+   */
+  int getMinorVersion() const { return _version[1]; }
+
+  /*!
+   @brief   Reports the number of agents in the file's header.
+   */
+  size_t getAgentCount() const { return _agentCount; }
+
+  /*!
+   @brief   Reports the time step between frames (zero if the version doesn't record it).
+   */
+  float getTimeStep() const { return _timeStep; }
+
+  /*!
+   @brief   Reports an agent's class (zero if the version doesn't record it).
+
+   @param   i     The agent's identifier, in the range [0, getAgentCount()).
+   */
+  size_t getAgentClass(size_t i) const { return _classes.empty() ? 0 : _classes[i]; }
+
+  /*!
+   @brief   Reports the number of floats per agent in the frames read by readFrame().
+   */
+  size_t getAgentFloatCount() const { return _agentFloats; }
+
+  /*!
+   @brief   Reports the fields recorded by a version 3.x file (a combination of SCBFilter::Field
+            values); zero for the other versions.
+   */
+  unsigned int getFields() const { return _fields; }
+
+  /*!
+   @brief   Reports the number of frames in the file.
+   */
+  size_t getFrameCount() const { return _frameCount; }
+
+  /*!
+   @brief   Reads a frame.
+
+   @param   frame     The index of the frame, in the range [0, getFrameCount()).
+   @param   data      Set to getAgentFloatCount() floats for each agent in the frame.
+   @param   ids       If not null, set to the identifiers of the agents in the frame.
+   @returns True if the frame was read.
+   */
+  bool readFrame(size_t frame, std::vector<float>& data, std::vector<size_t>* ids = 0x0);
+
+ protected:
+  /*!
+   @brief   Reads the chunk index of a version 3.x file, or rebuilds it if the file has none.
+
+   @returns True if the index is valid.
+   */
+  bool readChunkIndex();
+
+  /*!
+   @brief   Reads and decodes a chunk of a version 3.x file (unless it's already decoded).
+
+   @param   chunk     The index of the chunk.
+   @returns True if the chunk was decoded.
+   */
+  bool loadChunk(size_t chunk);
+
+  /*!
+   @brief   The mapped file being read.
+   */
+  MappedFile _file;
+
+  /*!
+   @brief   The size of the file (in bytes).
+   */
+  unsigned long long _fileSize;
+
+  /*!
+   @brief   The version of the file (major, minor).
+   */
+  int _version[2];
+
+  /*!
+   @brief   The number of agents in the header.
+   */
+  size_t _agentCount;
+
+  /*!
+   @brief   The time step between frames.
+   */
+  float _timeStep;
+
+  /*!
+   @brief   The agents' classes.
+   */
+  std::vector<size_t> _classes;
+
+  /*!
+   @brief   The number of floats per agent.
+   */
+  size_t _agentFloats;
+
+  /*!
+   @brief   The number of frames.
+   */
+  size_t _frameCount;
+
+  /*!
+   @brief   The file offset of the first frame (or chunk).
+   */
+  unsigned long long _dataOffset;
+
+  /*!
+   @brief   The position precision of version 3.x files.
+   */
+  float _precision;
+
+  /*!
+   @brief   The orientation precision of version 3.x files.
+   */
+  float _orientPrecision;
+
+  /*!
+   @brief   The frames per chunk of version 3.x files.
+   */
+  size_t _chunkFrames;
+
+  /*!
+   @brief   The fields recorded by version 3.x files.
+   */
+  unsigned int _fields;
+
+  /*!
+   @brief   Determines if the frames of a version 3.x file record their agents' identifiers.
+   */
+  bool _recordIds;
+
+  /*!
+   @brief   The factor restoring each of an agent's quantized values in version 3.x files.
+   */
+  std::vector<float> _scales;
+
+  /*!
+   @brief   The file offset of each chunk of version 3.x files.
+   */
+  std::vector<unsigned long long> _chunkOffsets;
+
+  /*!
+   @brief   The index of the decoded chunk (or the chunk count if none is).
+   */
+  size_t _loadedChunk;
+
+  /*!
+   @brief   The quantized frames of the decoded chunk.
+   */
+  std::vector<std::vector<int> > _chunk;
+
+  /*!
+   @brief   The identifiers of the agents in each frame of the decoded chunk.
+   */
+  std::vector<std::vector<size_t> > _chunkIds;
+};
+
+}  // namespace Agents
+}  // namespace Menge
+
+#endif  // __SCB_READER_H__
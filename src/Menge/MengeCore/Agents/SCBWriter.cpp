@@ -38,24 +38,233 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/Agents/SCBWriter.h"
 
+#include "MengeCore/Agents/SCBChunks.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/State.h"
 #include "MengeCore/Core.h"
+#include "MengeCore/Runtime/Utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 
 namespace Menge {
 
 namespace Agents {
 
+namespace {
+// Copies a float into unaligned frame data, returning the position of the next value.
+inline char* putFloat(char* data, float value) {
+  memcpy(data, &value, sizeof(float));
+  return data + sizeof(float);
+}
+
+// Version 3.x quantizes orientations to 16 bits.
+const float ORIENTATION_PRECISION = 6.28318530718f / 65536.f;
+
+// Splits a comma-separated list, dropping the whitespace around the items.
+std::vector<std::string> splitList(const std::string& list) {
+  std::vector<std::string> items;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    const size_t first = list.find_first_not_of(" \t", start);
+    const size_t last = list.find_last_not_of(" \t", end == 0 ? 0 : end - 1);
+    if (first < end && last != std::string::npos && last >= first) {
+      items.push_back(list.substr(first, last - first + 1));
+    }
+    start = end + 1;
+  }
+  return items;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBFilter
+/////////////////////////////////////////////////////////////////////
+
+const unsigned int SCBFilter::DEFAULT_FIELDS;
+
+/////////////////////////////////////////////////////////////////////
+
+SCBFilter::SCBFilter()
+    : _frameStride(1),
+      _timeInterval(0.f),
+      _classes(),
+      _stateNames(),
+      _useRegion(false),
+      _regionMin(),
+      _regionMax(),
+      _fields(0),
+      _states() {}
+
+/////////////////////////////////////////////////////////////////////
+
+const char* SCBFilter::fieldName(Field field) {
+  switch (field) {
+    case POSITION:
+      return "position";
+    case ORIENTATION:
+      return "orientation";
+    case STATE:
+      return "state";
+    case VELOCITY:
+      return "velocity";
+    case PREF_VELOCITY:
+      return "prefVelocity";
+    case ELEVATION:
+      return "elevation";
+  }
+  return "unknown";
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBFilter::getStride(float timeStep) const {
+  size_t stride = std::max(_frameStride, size_t(1));
+  if (_timeInterval > 0.f && timeStep > 0.f) {
+    // Tolerate round-off in intervals which are multiples of the time step.
+    const size_t steps = static_cast<size_t>(ceil(_timeInterval / timeStep - 1e-4f));
+    stride = std::max(stride, steps);
+  }
+  return stride;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBFilter::resolveStates(BFSM::FSM* fsm) {
+  _states.clear();
+  bool valid = true;
+  for (size_t i = 0; i < _stateNames.size(); ++i) {
+    BFSM::State* state = fsm->getNode(_stateNames[i]);
+    if (state == 0x0) {
+      logger << Logger::ERR_MSG << "SCBWRITER: the recorded state \"" << _stateNames[i];
+      logger << "\" doesn't exist.";
+      valid = false;
+      continue;
+    }
+    const size_t id = state->getID();
+    if (id >= _states.size()) _states.resize(id + 1, false);
+    _states[id] = true;
+  }
+  // If no selected state exists, no agent is recorded (rather than all of them).
+  if (!_stateNames.empty() && _states.empty()) _states.push_back(false);
+  return valid;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBFilter::selects(const BaseAgent* agt, size_t stateId) const {
+  if (!_classes.empty() &&
+      std::find(_classes.begin(), _classes.end(), agt->_class) == _classes.end()) {
+    return false;
+  }
+  if (!_states.empty() && (stateId >= _states.size() || !_states[stateId])) return false;
+  if (_useRegion) {
+    const Math::Vector2& p = agt->_pos;
+    if (p.x() < _regionMin.x() || p.x() > _regionMax.x() || p.y() < _regionMin.y() ||
+        p.y() > _regionMax.y()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBFilter::parseClasses(const std::string& classes) {
+  const std::vector<std::string> items = splitList(classes);
+  _classes.clear();
+  try {
+    for (size_t i = 0; i < items.size(); ++i) _classes.push_back(toSize_t(items[i]));
+  } catch (const UtilException&) {
+    _classes.clear();
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFilter::parseStates(const std::string& states) { _stateNames = splitList(states); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBFilter::parseRegion(const std::string& region) {
+  const std::vector<std::string> items = splitList(region);
+  if (items.size() != 4) return false;
+  float values[4];
+  try {
+    for (size_t i = 0; i < 4; ++i) values[i] = toFloat(items[i]);
+  } catch (const UtilException&) {
+    return false;
+  }
+  if (values[0] > values[2] || values[1] > values[3]) return false;
+  _useRegion = true;
+  _regionMin.set(values[0], values[1]);
+  _regionMax.set(values[2], values[3]);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBFilter::parseFields(const std::string& fields) {
+  const std::vector<std::string> items = splitList(fields);
+  unsigned int selected = 0;
+  for (size_t i = 0; i < items.size(); ++i) {
+    unsigned int field = POSITION;
+    while (field <= ELEVATION && items[i] != fieldName(static_cast<Field>(field))) field <<= 1;
+    if (field > ELEVATION) {
+      logger << Logger::ERR_MSG << "Unknown scb field: " << items[i];
+      return false;
+    }
+    selected |= field;
+  }
+  _fields = selected;
+  return true;
+}
+
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBWriter
 /////////////////////////////////////////////////////////////////////
 
+size_t SCBWriter::DEFAULT_ASYNC_FRAMES = 0;
+
+float SCBWriter::DEFAULT_PRECISION = 0.001f;
+
+size_t SCBWriter::DEFAULT_CHUNK_FRAMES = 64;
+
+/////////////////////////////////////////////////////////////////////
+
 SCBWriter::SCBWriter(const std::string& pathName, const std::string& version,
-                     SimulatorInterface* sim)
-    : _frameWriter(0x0) {
+                     SimulatorInterface* sim, const SCBFilter& filter)
+    : _frameWriter(0x0),
+      _chunkEncoder(0x0),
+      _precision(DEFAULT_PRECISION),
+      _chunkFrames(DEFAULT_CHUNK_FRAMES),
+      _filter(filter),
+      _stride(filter.getStride(sim->getTimeStep())),
+      _stepCount(0),
+      _frames(1),
+      _head(0),
+      _queued(0),
+      _stopping(false),
+      _framesWritten(0),
+      _stalledFrames(0),
+      _stallTime(0.0),
+      _maxQueued(0) {
+  if ((_filter.selectsAgents() || _filter._fields != 0) && version != "3.1") {
+    logger << Logger::ERR_MSG << "Recording selected agents or fields requires SCB version 3.1; ";
+    logger << "version " << version << " was requested.\n";
+    throw SCBVersionException();
+  }
   if (!validateVersion(version)) {
     logger << Logger::ERR_MSG << "Invalid SCB version: " << version << "\n";
     throw SCBVersionException();
   }
+
   logger << Logger::INFO_MSG << "SCBWRITER: version: " << _version[0] << ".";
   logger << _version[1] << "\n";
   _file.open(pathName.c_str(), std::ios::out | std::ios::binary);
@@ -64,21 +273,110 @@ SCBWriter::SCBWriter(const std::string& pathName, const std::string& version,
   }
   _sim = sim;
   writeHeader();
+  if (DEFAULT_ASYNC_FRAMES > 0) setAsync(DEFAULT_ASYNC_FRAMES);
 }
 
 /////////////////////////////////////////////////////////////////////
 
 SCBWriter::~SCBWriter() {
-  if (_file.is_open()) _file.close();
+  stopAsync();
+  if (_chunkEncoder) {
+    _chunkEncoder->finish(_file);
+    delete _chunkEncoder;
+  }
+  if (_file.is_open()) {
+    _file.close();
+    if (_file.fail()) {
+      logger << Logger::ERR_MSG << "SCBWRITER: error writing the trajectory file.";
+    }
+  }
   if (_frameWriter) delete _frameWriter;
 }
 
 /////////////////////////////////////////////////////////////////////
 
+void SCBWriter::setAsync(size_t frameCount) {
+  stopAsync();
+  _frames.resize(std::max(frameCount, size_t(1)));
+  _head = 0;
+  if (frameCount > 0) {
+    _stopping = false;
+    _thread = std::thread(&SCBWriter::writeQueuedFrames, this);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBWriter::getFramesWritten() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _framesWritten;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBWriter::getStalledFrames() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stalledFrames;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+double SCBWriter::getStallTime() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stallTime;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::storeFrame(const std::vector<char>& frame) {
+  if (_chunkEncoder) {
+    _chunkEncoder->addFrame(frame, _file);
+  } else if (!frame.empty()) {
+    _file.write(&frame[0], frame.size());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::writeQueuedFrames() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _frameQueued.wait(lock, [this]() { return _queued > 0 || _stopping; });
+    if (_queued == 0) break;
+    const size_t oldest = (_head + _frames.size() - _queued) % _frames.size();
+    const std::vector<char>& frame = _frames[oldest];
+    // The producer never touches a queued buffer, so it can be written without holding the lock.
+    lock.unlock();
+    storeFrame(frame);
+    lock.lock();
+    --_queued;
+    ++_framesWritten;
+    _frameWritten.notify_one();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::stopAsync() {
+  if (!_thread.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _frameQueued.notify_one();
+  _thread.join();
+  logger << Logger::INFO_MSG << "SCBWRITER: " << _framesWritten << " frames written with ";
+  logger << _frames.size() << " buffers; at most " << _maxQueued << " frames waited to be written.";
+  logger << " Waited for a free buffer on " << _stalledFrames << " frames (" << _stallTime;
+  logger << " s).";
+}
+
+/////////////////////////////////////////////////////////////////////
+
 bool SCBWriter::validateVersion(const std::string& version) {
   bool valid = (version == "1.0" ||  // a simple exhaustive list of valid versions
                 version == "2.0" || version == "2.1" || version == "2.2" || version == "2.3" ||
-                version == "2.4");
+                version == "2.4" || version == "3.0" || version == "3.1");
   if (valid) {
     // convert string to ints
     size_t dotPos = version.find_first_of(".");
@@ -98,6 +396,19 @@ bool SCBWriter::validateVersion(const std::string& version) {
       } else if (_version[1] == 4) {
         _frameWriter = new SCBFrameWriter2_4();
       }
+    } else if (_version[0] == 3) {
+      if (!(_precision > 0.f)) {
+        logger << Logger::ERR_MSG << "SCB precision must be positive: " << _precision;
+        return false;
+      }
+      // Version 3.0 is version 3.1 with the default fields for every agent.
+      const bool selectsAgents = _version[1] == 1 && _filter.selectsAgents();
+      const unsigned int fields =
+          _version[1] == 1 ? _filter.getFields() : SCBFilter::DEFAULT_FIELDS;
+      _frameWriter = new SCBFrameWriter3_0(_precision, ORIENTATION_PRECISION, fields,
+                                           selectsAgents ? &_filter : 0x0);
+      _chunkEncoder =
+          new SCBChunkEncoder(_chunkFrames, SCBFrameWriter3_0::valueCount(fields), selectsAgents);
     }
     assert(_frameWriter != 0x0 && "Valid version didn't produce a frame writer");
   }
@@ -106,7 +417,35 @@ bool SCBWriter::validateVersion(const std::string& version) {
 
 /////////////////////////////////////////////////////////////////////
 
-void SCBWriter::writeFrame(BFSM::FSM* fsm) { _frameWriter->writeFrame(_file, _sim, fsm); }
+void SCBWriter::writeFrame(BFSM::FSM* fsm) {
+  if (_stepCount++ % _stride != 0) return;
+  if (_stepCount == 1 && _chunkEncoder != 0x0 && _version[1] == 1) _filter.resolveStates(fsm);
+
+  if (!_thread.joinable()) {
+    std::vector<char>& frame = _frames[0];
+    _frameWriter->fillFrame(frame, _sim, fsm);
+    storeFrame(frame);
+    ++_framesWritten;
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_queued == _frames.size()) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    _frameWritten.wait(lock, [this]() { return _queued < _frames.size(); });
+    ++_stalledFrames;
+    _stallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  std::vector<char>& frame = _frames[_head];
+  lock.unlock();
+  _frameWriter->fillFrame(frame, _sim, fsm);
+  lock.lock();
+  _head = (_head + 1) % _frames.size();
+  ++_queued;
+  _maxQueued = std::max(_maxQueued, _queued);
+  lock.unlock();
+  _frameQueued.notify_one();
+}
 
 /////////////////////////////////////////////////////////////////////
 
@@ -116,6 +455,12 @@ void SCBWriter::writeHeader() {
     writeHeader1_0();
   } else if (_version[0] == 2) {
     writeHeader2_0();
+  } else if (_version[0] == 3) {
+    if (_version[1] == 0) {
+      writeHeader3_0();
+    } else {
+      writeHeader3_1();
+    }
   }
 }
 
@@ -131,124 +476,192 @@ void SCBWriter::writeHeader1_0() {
 void SCBWriter::writeHeader2_0() {
   const size_t AGT_COUNT = _sim->getNumAgents();
   _file.write((char*)&AGT_COUNT, sizeof(int));
-  float step = _sim->getTimeStep();
+  float step = _sim->getTimeStep() * _stride;
   _file.write((char*)&step, sizeof(float));
   // write ids
   for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = _sim->getAgent(i);
+    Agents::BaseAgent* agt = _sim->getAgentById(i);
     unsigned int cID = static_cast<unsigned int>(agt->_class);
     _file.write((char*)&cID, sizeof(unsigned int));
   }
 }
 
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::writeHeader3_0() {
+  writeHeader2_0();
+  _file.write((char*)&_precision, sizeof(float));
+  _file.write((char*)&ORIENTATION_PRECISION, sizeof(float));
+  unsigned int chunkFrames = static_cast<unsigned int>(_chunkFrames);
+  _file.write((char*)&chunkFrames, sizeof(unsigned int));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::writeHeader3_1() {
+  writeHeader3_0();
+  const unsigned int fields = _filter.getFields();
+  _file.write((char*)&fields, sizeof(unsigned int));
+  const unsigned int flags = _filter.selectsAgents() ? 1 : 0;
+  _file.write((char*)&flags, sizeof(unsigned int));
+}
+
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter
 /////////////////////////////////////////////////////////////////////
 
 const int SCBFrameWriter::ZERO = 0;
 
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter::fillFrame(std::vector<char>& buffer, SimulatorInterface* sim,
+                               BFSM::FSM* fsm) const {
+  const int AGT_COUNT = static_cast<int>(sim->getNumAgents());
+  const size_t AGT_SIZE = agentSize();
+  buffer.resize(AGT_COUNT * AGT_SIZE);
+  if (AGT_COUNT == 0) return;
+  char* data = &buffer[0];
+#pragma omp parallel for
+  for (int i = 0; i < AGT_COUNT; ++i) {
+    writeAgent(data + i * AGT_SIZE, sim->getAgentById(i), sim, fsm);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter1_0
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter1_0::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-  }
+void SCBFrameWriter1_0::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  data = putFloat(data, agt->_pos.x());
+  data = putFloat(data, agt->_pos.y());
+  putFloat(data, atan2(agt->_orient.y(), agt->_orient.x()));
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_0
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_0::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-  }
+void SCBFrameWriter2_0::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  data = putFloat(data, agt->_pos.x());
+  data = putFloat(data, agt->_pos.y());
+  putFloat(data, atan2(agt->_orient.y(), agt->_orient.x()));
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_1
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_1::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-    float state = (float)fsm->getAgentStateID(i);
-    file.write((char*)&state, sizeof(float));
-  }
+void SCBFrameWriter2_1::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  data = putFloat(data, agt->_pos.x());
+  data = putFloat(data, agt->_pos.y());
+  data = putFloat(data, atan2(agt->_orient.y(), agt->_orient.x()));
+  putFloat(data, (float)fsm->getAgentStateID(agt->_id));
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_2
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_2::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-    float state = (float)fsm->getAgentStateID(i);
-    file.write((char*)&state, sizeof(float));
-    // pref velocity
-    // NOTE: This does not use _velPref.getSpeed() because it may be modified
-    //    by intention filters.  This factors those out.
-    const Math::Vector2 vDir = agt->_velPref.getPreferredVel();
-    file.write((char*)&vDir, 2 * sizeof(float));
-    // velocity
-    const Math::Vector2& v = agt->_vel;
-    file.write((char*)&v, 2 * sizeof(float));
-  }
+void SCBFrameWriter2_2::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  data = putFloat(data, agt->_pos.x());
+  data = putFloat(data, agt->_pos.y());
+  data = putFloat(data, atan2(agt->_orient.y(), agt->_orient.x()));
+  data = putFloat(data, (float)fsm->getAgentStateID(agt->_id));
+  // pref velocity
+  // NOTE: This does not use _velPref.getSpeed() because it may be modified
+  //    by intention filters.  This factors those out.
+  const Math::Vector2 vDir = agt->_velPref.getPreferredVel();
+  data = putFloat(data, vDir.x());
+  data = putFloat(data, vDir.y());
+  // velocity
+  data = putFloat(data, agt->_vel.x());
+  putFloat(data, agt->_vel.y());
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_3
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_3::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    file.write((char*)&agt->_orient, 2 * sizeof(float));
-  }
+void SCBFrameWriter2_3::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  data = putFloat(data, agt->_pos.x());
+  data = putFloat(data, agt->_pos.y());
+  data = putFloat(data, agt->_orient.x());
+  putFloat(data, agt->_orient.y());
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_4
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_4::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    float elevation = sim->getElevation(agt);
-    file.write((char*)&p._x, sizeof(float));
-    file.write((char*)&elevation, sizeof(float));
-    file.write((char*)&p._y, sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
+void SCBFrameWriter2_4::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  data = putFloat(data, agt->_pos.x());
+  data = putFloat(data, sim->getElevation(agt));
+  data = putFloat(data, agt->_pos.y());
+  putFloat(data, atan2(agt->_orient.y(), agt->_orient.x()));
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBFrameWriter3_0
+/////////////////////////////////////////////////////////////////////
+
+SCBFrameWriter3_0::SCBFrameWriter3_0(float precision, float orientPrecision, unsigned int fields,
+                                     const SCBFilter* filter)
+    : _precision(precision),
+      _orientPrecision(orientPrecision),
+      _fields(fields),
+      _valueCount(valueCount(fields)),
+      _filter(filter) {}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBFrameWriter3_0::valueCount(unsigned int fields) {
+  size_t count = 0;
+  if (fields & SCBFilter::POSITION) count += 2;
+  if (fields & SCBFilter::ORIENTATION) count += 1;
+  if (fields & SCBFilter::STATE) count += 1;
+  if (fields & SCBFilter::VELOCITY) count += 2;
+  if (fields & SCBFilter::PREF_VELOCITY) count += 2;
+  if (fields & SCBFilter::ELEVATION) count += 1;
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter3_0::writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  const size_t stateId = fsm->getAgentStateID(agt->_id);
+  int values[10];
+  values[0] = _filter == 0x0 || _filter->selects(agt, stateId) ? static_cast<int>(agt->_id) : -1;
+  int* v = values + 1;
+  if (_fields & SCBFilter::POSITION) {
+    *v++ = static_cast<int>(lround(agt->_pos.x() / _precision));
+    *v++ = static_cast<int>(lround(agt->_pos.y() / _precision));
+  }
+  if (_fields & SCBFilter::ORIENTATION) {
+    const float orient = atan2(agt->_orient.y(), agt->_orient.x());
+    *v++ = static_cast<int>(lround(orient / _orientPrecision));
+  }
+  if (_fields & SCBFilter::STATE) *v++ = static_cast<int>(stateId);
+  if (_fields & SCBFilter::VELOCITY) {
+    *v++ = static_cast<int>(lround(agt->_vel.x() / _precision));
+    *v++ = static_cast<int>(lround(agt->_vel.y() / _precision));
+  }
+  if (_fields & SCBFilter::PREF_VELOCITY) {
+    // As in version 2.2, this factors out the speed changes of intention filters.
+    const Math::Vector2 vPref = agt->_velPref.getPreferredVel();
+    *v++ = static_cast<int>(lround(vPref.x() / _precision));
+    *v++ = static_cast<int>(lround(vPref.y() / _precision));
+  }
+  if (_fields & SCBFilter::ELEVATION) {
+    *v++ = static_cast<int>(lround(sim->getElevation(agt) / _precision));
   }
+  memcpy(data, values, (1 + _valueCount) * sizeof(int));
 }
 
 /////////////////////////////////////////////////////////////////////
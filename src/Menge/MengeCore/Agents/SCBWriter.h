@@ -28,8 +28,12 @@
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/mengeCommon.h"
 
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace Menge {
 
@@ -114,7 +118,166 @@ class MENGE_API SCBFileException : public SCBException {
   SCBFileException(const std::string& s) : SCBException(s) {}
 };
 
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Selects the frames, agents and per-agent values an SCBWriter records.
+
+ Frames are selected for every version: every frameStride-th simulation step, or every step at
+ least timeInterval seconds after the previous recorded one (whichever is the sparser). The header's
+ time step is the time between recorded frames.
+
+ Selecting agents or fields requires version 3.1. An agent is recorded if it passes all of the
+ given criteria: its class is one of the given classes, its state is one of the given states and its
+ position lies in the given region. Because the recorded agents change from frame to frame, such
+ frames record the identifiers of their agents (which index the classes in the header).
+ */
+class MENGE_API SCBFilter {
+ public:
+  /*!
+   @brief    The per-agent values which version 3.1 can record.
+   */
+  enum Field {
+    POSITION = 1,       ///< x- and y-position.
+    ORIENTATION = 2,    ///< Orientation (radians).
+    STATE = 4,          ///< The id of the agent's state.
+    VELOCITY = 8,       ///< x- and y-velocity.
+    PREF_VELOCITY = 16, ///< x- and y-preferred velocity.
+    ELEVATION = 32      ///< The elevation of the agent's position.
+  };
+
+  /*!
+   @brief    The fields recorded if none are selected (and the fields of version 3.0).
+   */
+  static const unsigned int DEFAULT_FIELDS = POSITION | ORIENTATION | STATE;
+
+  /*!
+   @brief    Constructor; the filter records everything.
+   */
+  SCBFilter();
+
+  /*!
+   @brief    Reports if the filter selects a subset of the agents.
+   */
+  bool selectsAgents() const { return !_classes.empty() || !_stateNames.empty() || _useRegion; }
+
+  /*!
+   @brief    Reports the fields to record.
+   */
+  unsigned int getFields() const { return _fields != 0 ? _fields : DEFAULT_FIELDS; }
+
+  /*!
+   @brief    Reports the name of a field, as parsed by parseFields() (e.g., "prefVelocity").
+
+   @param    field    The field.
+   */
+  static const char* fieldName(Field field);
+
+  /*!
+   @brief    Reports the number of simulation steps between recorded frames.
+
+   @param    timeStep    The simulation's time step.
+   */
+  size_t getStride(float timeStep) const;
+
+  /*!
+   @brief    Resolves the selected states' names to their ids; this must be called before
+            selects() is used.
+
+   @param    fsm      The behavior fsm.
+   @returns  False if a selected state doesn't exist.
+   */
+  bool resolveStates(BFSM::FSM* fsm);
+
+  /*!
+   @brief    Reports if the filter selects the given agent.
+
+   @param    agt      The agent.
+   @param    stateId  The id of the agent's current state.
+   */
+  bool selects(const BaseAgent* agt, size_t stateId) const;
+
+  /*!
+   @brief    Sets the classes to record from a comma-separated list (e.g., "0,2").
+
+   @param    classes    The list of classes.
+   @returns  False if the list is malformed.
+   */
+  bool parseClasses(const std::string& classes);
+
+  /*!
+   @brief    Sets the states to record from a comma-separated list of state names.
+
+   @param    states    The list of state names.
+   */
+  void parseStates(const std::string& states);
+
+  /*!
+   @brief    Sets the region to record from a string of the form "minX,minY,maxX,maxY".
+
+   @param    region    The region's definition.
+   @returns  False if the definition is malformed.
+   */
+  bool parseRegion(const std::string& region);
+
+  /*!
+   @brief    Sets the fields to record from a comma-separated list of field names: position,
+            orientation, state, velocity, prefVelocity and elevation.
+
+   @param    fields    The list of fields.
+   @returns  False if the list contains an unknown field.
+   */
+  bool parseFields(const std::string& fields);
+
+  /*!
+   @brief    Record every frameStride-th frame.
+   */
+  size_t _frameStride;
+
+  /*!
+   @brief    The minimum time between recorded frames (in seconds).
+   */
+  float _timeInterval;
+
+  /*!
+   @brief    The classes of the agents to record (all classes if empty).
+   */
+  std::vector<size_t> _classes;
+
+  /*!
+   @brief    The names of the states of the agents to record (all states if empty).
+   */
+  std::vector<std::string> _stateNames;
+
+  /*!
+   @brief    Determines if only agents inside the region are recorded.
+   */
+  bool _useRegion;
+
+  /*!
+   @brief    The minimum corner of the region.
+   */
+  Math::Vector2 _regionMin;
+
+  /*!
+   @brief    The maximum corner of the region.
+   */
+  Math::Vector2 _regionMax;
+
+  /*!
+   @brief    The fields to record (a combination of Field values); zero for the default fields.
+   */
+  unsigned int _fields;
+
+ protected:
+  /*!
+   @brief    For each state id, true if the state is selected (empty if all states are).
+   */
+  std::vector<bool> _states;
+};
+
 // Forward declaration
+class SCBChunkEncoder;
 class SCBFrameWriter;
 class SimulatorInterface;
 
@@ -122,38 +285,153 @@ class SimulatorInterface;
 
 /*!
  @brief    Class responsible for writing the agent state of the simulator and fsm into a file.
+
+ Each frame is serialized into a buffer and written with a single call. Optionally, the writing is
+ done asynchronously (see setAsync()): the frame is copied into one of a fixed number of buffers
+ and a dedicated thread writes the filled buffers to the file, in order. The file contents are the
+ same in both modes.
+
+ Version 3.0 quantizes the agents' states and writes the frames in compressed chunks followed by an
+ index of the chunks (see SCBChunks.h). Its precision and chunk size are set with
+ setDefaultPrecision() and setDefaultChunkFrames() before the writer is created. Version 3.1 is
+ version 3.0 restricted to the agents and fields selected by an SCBFilter.
  */
-class SCBWriter {
+class MENGE_API SCBWriter {
  public:
   /*!
    @brief    Constructor for SCBWriter
 
+   The writer is asynchronous if a default number of frame buffers has been set (see
+   setDefaultAsyncFrames()).
+
    @param    pathName    The path for the desired output file.
    @param    version      A string representing the version to write out.
    @param    sim          A pointer to the simulator to process
-   @throws  SCBVersionException  if the version string is not considered to be a valid version.
+   @param    filter      The frames, agents and fields to record.
+   @throws  SCBVersionException  if the version string is not considered to be a valid version, or
+                                the filter selects agents or fields and the version isn't 3.1.
    @throws  SCBFileException if there is a problem opening the given path for writing.
    */
-  SCBWriter(const std::string& pathName, const std::string& version, SimulatorInterface* sim);
+  SCBWriter(const std::string& pathName, const std::string& version, SimulatorInterface* sim,
+            const SCBFilter& filter = SCBFilter());
 
   /*!
    @brief    Destructor.
+
+   Waits for the pending frames to be written.
    */
   ~SCBWriter();
 
   /*!
-   @brief    Writes the current frame of the stored simulator to the file.
+   @brief    Writes the current frame of the stored simulator to the file (unless the filter skips
+            it).
+
+   In asynchronous mode, this only waits if all of the frame buffers are still waiting to be
+   written.
 
    @param    fsm    A pointer to the simulator's fsm
    */
   void writeFrame(BFSM::FSM* fsm);
 
+  /*!
+   @brief    Switches between synchronous and asynchronous writing.
+
+   Any pending frames are written first.
+
+   @param    frameCount    The number of frames which can wait to be written. If zero, frames are
+                          written synchronously.
+   */
+  void setAsync(size_t frameCount);
+
+  /*!
+   @brief    Sets the number of frame buffers with which new writers write asynchronously.
+
+   @param    frameCount    The number of frame buffers (see setAsync()).
+   */
+  static void setDefaultAsyncFrames(size_t frameCount) { DEFAULT_ASYNC_FRAMES = frameCount; }
+
+  /*!
+   @brief    Sets the precision (in meters) to which new version 3.0 writers quantize positions.
+
+   @param    precision    The precision; it must be positive.
+   */
+  static void setDefaultPrecision(float precision) { DEFAULT_PRECISION = precision; }
+
+  /*!
+   @brief    Sets the number of frames in the chunks of new version 3.0 writers.
+
+   Larger chunks compress better; smaller chunks make seeking to a frame cheaper.
+
+   @param    frameCount    The number of frames per chunk.
+   */
+  static void setDefaultChunkFrames(size_t frameCount) { DEFAULT_CHUNK_FRAMES = frameCount; }
+
+  /*!
+   @brief    Reports the number of frames written to the file.
+   */
+  size_t getFramesWritten() const;
+
+  /*!
+   @brief    Reports the number of frames for which writeFrame() had to wait for a free buffer.
+   */
+  size_t getStalledFrames() const;
+
+  /*!
+   @brief    Reports the total time (in seconds) writeFrame() has spent waiting for free buffers.
+   */
+  double getStallTime() const;
+
  protected:
+  /*!
+   @brief    The number of frame buffers of new writers.
+   */
+  static size_t DEFAULT_ASYNC_FRAMES;
+
+  /*!
+   @brief    The position precision of new version 3.0 writers.
+   */
+  static float DEFAULT_PRECISION;
+
+  /*!
+   @brief    The number of frames per chunk of new version 3.0 writers.
+   */
+  static size_t DEFAULT_CHUNK_FRAMES;
+
   /*!
    @brief    The frame writer -- defines the format of the frame's data.
    */
   SCBFrameWriter* _frameWriter;
 
+  /*!
+   @brief    The chunk encoder of chunked versions (null for the others).
+   */
+  SCBChunkEncoder* _chunkEncoder;
+
+  /*!
+   @brief    The position precision of chunked versions.
+   */
+  float _precision;
+
+  /*!
+   @brief    The number of frames per chunk of chunked versions.
+   */
+  size_t _chunkFrames;
+
+  /*!
+   @brief    The frames, agents and fields to record.
+   */
+  SCBFilter _filter;
+
+  /*!
+   @brief    The number of simulation steps between recorded frames.
+   */
+  size_t _stride;
+
+  /*!
+   @brief    The number of calls to writeFrame().
+   */
+  size_t _stepCount;
+
   /*!
    @brief    The version of the scb file to be written.
 
@@ -171,6 +449,83 @@ class SCBWriter {
    */
   std::ofstream _file;
 
+  /*!
+   @brief    The ring of frame buffers. Synchronous writing uses a single buffer.
+   */
+  std::vector<std::vector<char> > _frames;
+
+  /*!
+   @brief    The index of the next buffer to fill.
+   */
+  size_t _head;
+
+  /*!
+   @brief    The number of filled buffers waiting to be written; they precede _head in the ring.
+   */
+  size_t _queued;
+
+  /*!
+   @brief    Set to make the writing thread exit once all frames are written.
+   */
+  bool _stopping;
+
+  /*!
+   @brief    The number of frames written.
+   */
+  size_t _framesWritten;
+
+  /*!
+   @brief    The number of frames for which writeFrame() waited for a free buffer.
+   */
+  size_t _stalledFrames;
+
+  /*!
+   @brief    The time (in seconds) spent waiting for free buffers.
+   */
+  double _stallTime;
+
+  /*!
+   @brief    The largest number of frames that have waited to be written.
+   */
+  size_t _maxQueued;
+
+  /*!
+   @brief    The thread writing the frames in asynchronous mode.
+   */
+  std::thread _thread;
+
+  /*!
+   @brief    Guards the ring state and statistics.
+   */
+  mutable std::mutex _mutex;
+
+  /*!
+   @brief    Signaled when a frame has been queued or the writing thread should stop.
+   */
+  std::condition_variable _frameQueued;
+
+  /*!
+   @brief    Signaled when a buffer has been written.
+   */
+  std::condition_variable _frameWritten;
+
+  /*!
+   @brief    Writes a filled frame buffer to the file (encoding it for chunked versions).
+
+   @param    frame    The frame's data.
+   */
+  void storeFrame(const std::vector<char>& frame);
+
+  /*!
+   @brief    The body of the writing thread.
+   */
+  void writeQueuedFrames();
+
+  /*!
+   @brief    Waits for the pending frames and stops the writing thread (if running).
+   */
+  void stopAsync();
+
   /*!
    @brief    Confirms that the given version is valid.
 
@@ -196,6 +551,16 @@ class SCBWriter {
    @brief    Writes the header appropriate to major version 2 formats.
    */
   void writeHeader2_0();
+
+  /*!
+   @brief    Writes the header appropriate to major version 3 formats.
+   */
+  void writeHeader3_0();
+
+  /*!
+   @brief    Writes the header appropriate to version 3.1.
+   */
+  void writeHeader3_1();
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -218,13 +583,29 @@ class SCBFrameWriter {
   virtual ~SCBFrameWriter() {}
 
   /*!
-   @brief    Function to write current frame's state to the file.
+   @brief    Serializes the current frame's state; the agents are serialized in parallel.
+
+   @param    buffer    The buffer for the frame's data; it is resized to fit the frame.
+   @param    sim      A pointer to the simulator.
+   @param    fsm      A pointer to the behavior fsm for the simulator.
+   */
+  void fillFrame(std::vector<char>& buffer, SimulatorInterface* sim, BFSM::FSM* fsm) const;
+
+  /*!
+   @brief    Reports the number of bytes of each agent's data.
+   */
+  virtual size_t agentSize() const = 0;
 
-   @param    file    The file object to write to.
+  /*!
+   @brief    Serializes a single agent's state.
+
+   @param    data    The memory to write the agent's agentSize() bytes to.
+   @param    agt      The agent.
    @param    sim      A pointer to the simulator.
    @param    fsm      A pointer to the behavior fsm for the simulator.
    */
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) = 0;
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const = 0;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -239,7 +620,9 @@ class SCBFrameWriter {
  */
 class SCBFrameWriter1_0 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const { return 3 * sizeof(float); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -254,7 +637,9 @@ class SCBFrameWriter1_0 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_0 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const { return 3 * sizeof(float); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -270,7 +655,9 @@ class SCBFrameWriter2_0 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_1 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const { return 4 * sizeof(float); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -290,7 +677,9 @@ class SCBFrameWriter2_1 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_2 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const { return 8 * sizeof(float); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -308,7 +697,9 @@ class SCBFrameWriter2_2 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_3 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const { return 4 * sizeof(float); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -324,7 +715,81 @@ class SCBFrameWriter2_3 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_4 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const { return 4 * sizeof(float); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Writer for versions 3.0 and 3.1
+
+ The data for an agent consists of 4-byte integers, which SCBChunkEncoder then encodes and
+ compresses:
+     the agent's id, or -1 if the filter doesn't select the agent
+     for version 3.0, and 3.1 by default:
+         x-pos, in units of the position precision
+         y-pos, in units of the position precision
+         orientation, in units of the orientation precision
+         stateID
+     otherwise, the selected fields (see SCBFilter::Field) in this order:
+         x- and y-pos, in units of the position precision
+         orientation, in units of the orientation precision
+         stateID
+         x- and y-vel, in units of the position precision
+         x- and y-vPref, in units of the position precision
+         elevation, in units of the position precision
+ */
+class SCBFrameWriter3_0 : public SCBFrameWriter {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    precision          The quantization step of positions.
+   @param    orientPrecision    The quantization step of orientations.
+   @param    fields             The fields to record (a combination of SCBFilter::Field values).
+   @param    filter             The filter selecting the agents to record; if null, all agents are
+                                recorded.
+   */
+  SCBFrameWriter3_0(float precision, float orientPrecision, unsigned int fields,
+                    const SCBFilter* filter);
+  virtual size_t agentSize() const { return (1 + _valueCount) * sizeof(int); }
+  virtual void writeAgent(char* data, const BaseAgent* agt, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
+
+  /*!
+   @brief    Reports the number of integers recorded for the given fields.
+
+   @param    fields      A combination of SCBFilter::Field values.
+   */
+  static size_t valueCount(unsigned int fields);
+
+ protected:
+  /*!
+   @brief    The quantization step of positions.
+   */
+  float _precision;
+
+  /*!
+   @brief    The quantization step of orientations.
+   */
+  float _orientPrecision;
+
+  /*!
+   @brief    The fields to record.
+   */
+  unsigned int _fields;
+
+  /*!
+   @brief    The number of integers recorded per agent (excluding its id).
+   */
+  size_t _valueCount;
+
+  /*!
+   @brief    The filter selecting the agents to record (null to record all agents).
+   */
+  const SCBFilter* _filter;
 };
 
 }  // namespace Agents
@@ -26,11 +26,18 @@
  */
 
 #include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/InteractionKernels.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Agents/SpatialQueries/AgentKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleKDTree.h"
 #include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
+#include "MengeCore/Math/SpaceFillingCurve.h"
+#include "MengeCore/Runtime/ScratchArena.h"
 #include "MengeCore/Runtime/Utils.h"
 #include "MengeCore/mengeCommon.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #if HAVE_OPENMP || _OPENMP
@@ -100,6 +107,35 @@ class SimulatorBase : public SimulatorInterface {
    */
   virtual const BaseAgent* getAgent(size_t agentNo) const { return &_agents[agentNo]; }
 
+  /*!
+   @brief      Accessor for agents by identifier.
+
+   @param      id     The identifier of the agent, in the range [0, getNumAgents()).
+   @returns    A pointer to the agent.
+   */
+  virtual BaseAgent* getAgentById(size_t id) { return &_agents[_agentIndex[id]]; }
+
+  /*!
+   @brief      Const accessor for agents by identifier.
+
+   @param      id     The identifier of the agent, in the range [0, getNumAgents()).
+   @returns    A pointer to the agent.
+   */
+  virtual const BaseAgent* getAgentById(size_t id) const { return &_agents[_agentIndex[id]]; }
+
+  /*!
+   @brief      Sets how often the agents are reordered in memory.
+
+   Every given number of time steps, the agents are sorted along a space-filling curve (Morton
+   order) by position so that agents which are near each other are stored near each other. The
+   agents' identifiers do not change, but their indices for getAgent() do; the agents must be looked
+   up with getAgentById() across time steps. Any pointer to an agent is invalidated by a reorder.
+
+   @param      steps    The number of time steps between reorders; zero (the default) never
+                        reorders.
+   */
+  void setReorderInterval(size_t steps) { _reorderInterval = steps; }
+
   /*!
    @brief    Add an agent with specified position to the simulator whose properties are defined by
             the given agent initializer.
@@ -156,10 +192,47 @@ class SimulatorBase : public SimulatorInterface {
    */
   void computeNeighbors(Agent* agent);
 
+  /*!
+   @brief    Reports the obstacles near the given agent to the agent.
+
+   @param    agent    The agent whose obstacle neighbors are to be computed.
+   */
+  void obstacleQuery(Agent* agent);
+
+  /*!
+   @brief    Computes the neighbors and new velocities of the agents in one leaf of an agent
+            <i>k</i>d-tree, querying the tree for the whole leaf at once.
+
+   @param    agentTree    The agent <i>k</i>d-tree.
+   @param    leaf         The index of the leaf.
+   */
+  void computeLeafVelocities(const AgentKDTree* agentTree, size_t leaf);
+
+  /*!
+   @brief    Sorts the agents along a space-filling curve by position and updates the index of each
+            agent identifier and the spatial query's agents.
+   */
+  void reorderAgents();
+
   /*!
    @brief    The collection of agents in the simulation
    */
   std::vector<Agent> _agents;
+
+  /*!
+   @brief    The index in _agents of each agent, by agent identifier.
+   */
+  std::vector<size_t> _agentIndex;
+
+  /*!
+   @brief    The number of time steps between reorders of the agents; zero for never.
+   */
+  size_t _reorderInterval;
+
+  /*!
+   @brief    The number of time steps since the agents were last reordered.
+   */
+  size_t _stepsSinceReorder;
 };
 
 ////////////////////////////////////////////////////////////////
@@ -167,13 +240,23 @@ class SimulatorBase : public SimulatorInterface {
 ////////////////////////////////////////////////////////////////
 
 template <class Agent>
-SimulatorBase<Agent>::SimulatorBase() : SimulatorInterface(), _agents() {}
+SimulatorBase<Agent>::SimulatorBase()
+    : SimulatorInterface(),
+      _agents(),
+      _agentIndex(),
+      _reorderInterval(0),
+      _stepsSinceReorder(0) {}
 
 ////////////////////////////////////////////////////////////////
 
 template <class Agent>
 SimulatorBase<Agent>::~SimulatorBase() {
+  if (Kernels::getValidation()) {
+    logger << Logger::INFO_MSG << "Largest relative deviation of the batched interaction kernels "
+           << "from the scalar evaluation: " << Kernels::getValidationError() << "\n";
+  }
   _agents.clear();
+  _agentIndex.clear();
 }
 
 ////////////////////////////////////////////////////////////////
@@ -182,12 +265,25 @@ template <class Agent>
 void SimulatorBase<Agent>::doStep() {
   assert(_spatialQuery != 0x0 && "Can't run without a spatial query instance defined");
 
+  if (_reorderInterval > 0 && ++_stepsSinceReorder >= _reorderInterval) {
+    _stepsSinceReorder = 0;
+    reorderAgents();
+  }
   _spatialQuery->updateAgents();
   int AGT_COUNT = static_cast<int>(_agents.size());
+  const AgentKDTree* agentTree = _spatialQuery->getAgentKDTree();
+  if (agentTree != 0x0 && agentTree->getBatchQueries()) {
+    const int LEAF_COUNT = static_cast<int>(agentTree->getLeafCount());
 #pragma omp parallel for
-  for (int i = 0; i < AGT_COUNT; ++i) {
-    computeNeighbors(&(_agents[i]));
-    _agents[i].computeNewVelocity();
+    for (int l = 0; l < LEAF_COUNT; ++l) {
+      computeLeafVelocities(agentTree, l);
+    }
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < AGT_COUNT; ++i) {
+      computeNeighbors(&(_agents[i]));
+      _agents[i].computeNewVelocity();
+    }
   }
 
 #pragma omp parallel for
@@ -240,6 +336,7 @@ BaseAgent* SimulatorBase<Agent>::addAgent(const Vector2& pos, AgentInitializer*
     logger << Logger::ERR_MSG << "Error initializing agent " << agent._id << "\n";
     return 0x0;
   }
+  _agentIndex.push_back(_agents.size());
   _agents.push_back(agent);
 
   return &_agents[_agents.size() - 1];
@@ -259,6 +356,33 @@ bool SimulatorBase<Agent>::setExpParam(const std::string& paramName,
                       "to a float.  Found the value: ") +
           value);
     }
+  } else if (paramName == "reorder_interval") {
+    try {
+      setReorderInterval(static_cast<size_t>(std::max(0, toInt(value))));
+    } catch (UtilException) {
+      throw XMLParamException(
+          std::string("Common parameters \"reorder_interval\" value couldn't be converted "
+                      "to an int.  Found the value: ") +
+          value);
+    }
+  } else if (paramName == "approximate_exp") {
+    try {
+      Kernels::setApproximateExp(toInt(value) != 0);
+    } catch (UtilException) {
+      throw XMLParamException(
+          std::string("Common parameters \"approximate_exp\" value couldn't be converted "
+                      "to an int.  Found the value: ") +
+          value);
+    }
+  } else if (paramName == "kernel_validation") {
+    try {
+      Kernels::setValidation(toInt(value) != 0);
+    } catch (UtilException) {
+      throw XMLParamException(
+          std::string("Common parameters \"kernel_validation\" value couldn't be converted "
+                      "to an int.  Found the value: ") +
+          value);
+    }
   } else {
     return false;
   }
@@ -268,17 +392,104 @@ bool SimulatorBase<Agent>::setExpParam(const std::string& paramName,
 
 ////////////////////////////////////////////////////////////////
 
+template <class Agent>
+void SimulatorBase<Agent>::obstacleQuery(Agent* agent) {
+  // The agents' concrete type is known here, so a k-d tree can call their filter functions
+  // directly; other spatial queries go through the virtual interface.
+  const ObstacleKDTree* obstacleTree = _spatialQuery->getObstacleKDTree();
+  if (obstacleTree != 0x0) {
+    ExactProximityQuery<Agent> query(agent);
+    obstacleTree->obstacleQuery(&query);
+  } else {
+    _spatialQuery->obstacleQuery(agent);
+  }
+}
+
+////////////////////////////////////////////////////////////////
+
 template <class Agent>
 void SimulatorBase<Agent>::computeNeighbors(Agent* agent) {
   // obstacles
   agent->startQuery();
-  _spatialQuery->obstacleQuery(agent);
+  obstacleQuery(agent);
 
   // agents
   if (agent->_maxNeighbors > 0) {
-    _spatialQuery->agentQuery(agent);
+    // As for obstacles, a k-d tree calls the filter functions directly.
+    const AgentKDTree* agentTree = _spatialQuery->getAgentKDTree();
+    if (agentTree != 0x0) {
+      ExactProximityQuery<Agent> query(agent);
+      agentTree->agentQuery(&query);
+    } else {
+      _spatialQuery->agentQuery(agent);
+    }
   }
 }
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+void SimulatorBase<Agent>::computeLeafVelocities(const AgentKDTree* agentTree, size_t leaf) {
+  ScratchArena::Scope scope;
+  const size_t COUNT = agentTree->getLeafSize(leaf);
+  std::vector<Agent*, ScratchAllocator<Agent*> > agents(COUNT);
+  std::vector<ExactProximityQuery<Agent>, ScratchAllocator<ExactProximityQuery<Agent> > > queries;
+  queries.reserve(COUNT);
+  for (size_t i = 0; i < COUNT; ++i) {
+    // The tree holds pointers into _agents; recover the mutable agent from its index.
+    const Agent* agent = static_cast<const Agent*>(agentTree->getLeafAgent(leaf, i));
+    agents[i] = &_agents[agent - &_agents[0]];
+    agents[i]->startQuery();
+    obstacleQuery(agents[i]);
+    if (agents[i]->_maxNeighbors > 0) {
+      queries.push_back(ExactProximityQuery<Agent>(agents[i]));
+    }
+  }
+  agentTree->leafQuery(leaf, queries.data(), queries.size());
+  for (size_t i = 0; i < COUNT; ++i) {
+    agents[i]->computeNewVelocity();
+  }
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+void SimulatorBase<Agent>::reorderAgents() {
+  const size_t AGT_COUNT = _agents.size();
+  if (AGT_COUNT < 2) return;
+
+  Vector2 minPt(_agents[0]._pos);
+  Vector2 maxPt(_agents[0]._pos);
+  for (size_t i = 1; i < AGT_COUNT; ++i) {
+    const Vector2& pos = _agents[i]._pos;
+    minPt.set(std::min(minPt.x(), pos.x()), std::min(minPt.y(), pos.y()));
+    maxPt.set(std::max(maxPt.x(), pos.x()), std::max(maxPt.y(), pos.y()));
+  }
+
+  // Sorting (key, index) pairs keeps agents with equal keys in their current order.
+  std::vector<std::pair<uint32_t, size_t> > order(AGT_COUNT);
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    order[i] = std::make_pair(Math::mortonKey(_agents[i]._pos, minPt, maxPt), i);
+  }
+  std::sort(order.begin(), order.end());
+  size_t first = 0;
+  while (first < AGT_COUNT && order[first].second == first) ++first;
+  if (first == AGT_COUNT) return;
+
+  std::vector<Agent> agents;
+  agents.reserve(AGT_COUNT);
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    agents.push_back(_agents[order[i].second]);
+  }
+  _agents.swap(agents);
+
+  std::vector<BaseAgent*> agtPointers(AGT_COUNT);
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    _agentIndex[_agents[i]._id] = i;
+    agtPointers[_agents[i]._id] = &_agents[i];
+  }
+  _spatialQuery->setAgents(agtPointers);
+}
 }  // namespace Agents
 }  // namespace Menge
 #endif  // __SIMULATOR_BASE_H__
@@ -38,17 +38,31 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/Agents/SimulatorInterface.h"
 
+#include "MengeCore/Agents/ColumnWriter.h"
 #include "MengeCore/Agents/Elevations/ElevationFlat.h"
+#include "MengeCore/Agents/InteractionKernels.h"
 #include "MengeCore/Agents/Obstacle.h"
 #include "MengeCore/Agents/SCBWriter.h"
 #include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/Core.h"
+#include "MengeCore/Runtime/AllocationTracker.h"
+
+#include <cstring>
+#include <map>
+#include <mutex>
 
 namespace Menge {
 
 namespace Agents {
 
+namespace {
+// The defaults of the registered model parameters, by address: their values when they were first
+// registered.
+std::mutex defaultsLock;
+std::map<void*, std::vector<char> > parameterDefaults;
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////
 //      Implementation of SimulatorInterface
 ////////////////////////////////////////////////////////////////
@@ -68,12 +82,27 @@ SimulatorInterface::SimulatorInterface()
       _spatialQuery(0x0),
       _fsm(0x0),
       _scbWriter(0x0),
+      _columnWriter(0x0),
       _isRunning(true),
-      _maxDuration(100.f) {}
+      _maxDuration(100.f),
+      _modelParameters(),
+      _approximateExp(false),
+      _kernelValidation(false) {
+  for (int i = 0; i < PHASE_COUNT; ++i) _stepAllocations[i] = 0;
+  // Like the model parameters, the kernels' settings start from their values when the first
+  // simulator was created.
+  static const bool APPROXIMATE_EXP = Kernels::getApproximateExp();
+  static const bool KERNEL_VALIDATION = Kernels::getValidation();
+  Kernels::setApproximateExp(APPROXIMATE_EXP);
+  Kernels::setValidation(KERNEL_VALIDATION);
+  saveModelParameters();
+}
 
 ////////////////////////////////////////////////////////////////////////////
 
 SimulatorInterface::~SimulatorInterface() {
+  if (_scbWriter) delete _scbWriter;
+  if (_columnWriter) delete _columnWriter;
   if (_fsm) delete _fsm;
   if (_spatialQuery != 0x0) _spatialQuery->destroy();
   if (_elevation) _elevation->destroy();
@@ -87,8 +116,12 @@ void SimulatorInterface::setBFSM(BFSM::FSM* fsm) { _fsm = fsm; }
 
 bool SimulatorInterface::step() {
   const int agtCount = static_cast<int>(getNumAgents());
+  for (int i = 0; i < PHASE_COUNT; ++i) _stepAllocations[i] = 0;
+  size_t mark = AllocationTracker::getCount();
   if (_isRunning) {
     if (_scbWriter) _scbWriter->writeFrame(_fsm);
+    if (_columnWriter) _columnWriter->writeFrame(_fsm);
+    countAllocations(OUTPUT_PHASE, mark);
     if (_globalTime >= _maxDuration) {
       _isRunning = false;
     } else {
@@ -96,9 +129,13 @@ bool SimulatorInterface::step() {
         try {
           // TODO: doStep for FSM is a *bad* name; it should be "evaluate".
           _isRunning = !_fsm->doStep();
+          countAllocations(BFSM_PHASE, mark);
           doStep();
+          countAllocations(AGENT_PHASE, mark);
           _fsm->doTasks();
+          countAllocations(TASK_PHASE, mark);
           _fsm->moveGoals(TIME_STEP);
+          countAllocations(GOAL_PHASE, mark);
         } catch (BFSM::FSMFatalException& e) {
           logger << Logger::ERR_MSG << "Error in updating the finite state ";
           logger << "machine -- stopping!\n";
@@ -113,6 +150,14 @@ bool SimulatorInterface::step() {
 
 ////////////////////////////////////////////////////////////////////////////
 
+void SimulatorInterface::countAllocations(StepPhase phase, size_t& mark) {
+  const size_t count = AllocationTracker::getCount();
+  _stepAllocations[phase] += count - mark;
+  mark = count;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 float SimulatorInterface::getElevation(const BaseAgent* agent) const {
   return _elevation->getElevation(agent);
 }
@@ -152,9 +197,10 @@ void SimulatorInterface::finalize() {
 
 ////////////////////////////////////////////////////////////////
 
-bool SimulatorInterface::setOutput(const std::string& outFileName, const std::string& scbVersion) {
+bool SimulatorInterface::setOutput(const std::string& outFileName, const std::string& scbVersion,
+                                   const SCBFilter* filter) {
   try {
-    _scbWriter = new SCBWriter(outFileName, scbVersion, this);
+    _scbWriter = new SCBWriter(outFileName, scbVersion, this, filter ? *filter : SCBFilter());
     return true;
   } catch (SCBFileException) {
     logger << Logger::WARN_MSG << "Error preparing output trajectory file: ";
@@ -163,6 +209,58 @@ bool SimulatorInterface::setOutput(const std::string& outFileName, const std::st
   }
 }
 
+////////////////////////////////////////////////////////////////
+
+bool SimulatorInterface::setColumnOutput(const std::string& basePath, const SCBFilter* filter) {
+  try {
+    _columnWriter = new ColumnWriter(basePath, this, filter ? *filter : SCBFilter());
+    return true;
+  } catch (SCBFileException& e) {
+    logger << Logger::WARN_MSG << "Error preparing column output: " << e.what();
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::saveModelParameters() {
+  for (ModelParameter& param : _modelParameters) {
+    std::memcpy(param._value.data(), param._address, param._value.size());
+  }
+  _approximateExp = Kernels::getApproximateExp();
+  _kernelValidation = Kernels::getValidation();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::restoreModelParameters() {
+  for (const ModelParameter& param : _modelParameters) {
+    std::memcpy(param._address, param._value.data(), param._value.size());
+  }
+  Kernels::setApproximateExp(_approximateExp);
+  Kernels::setValidation(_kernelValidation);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::registerModelParameter(void* parameter, size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(defaultsLock);
+    std::vector<char>& defaultValue = parameterDefaults[parameter];
+    if (defaultValue.empty()) {
+      const char* bytes = static_cast<const char*>(parameter);
+      defaultValue.assign(bytes, bytes + size);
+    } else {
+      std::memcpy(parameter, defaultValue.data(), size);
+    }
+  }
+  ModelParameter param;
+  param._address = parameter;
+  param._value.assign(static_cast<const char*>(parameter),
+                      static_cast<const char*>(parameter) + size);
+  _modelParameters.push_back(param);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 
 }  // namespace Agents
@@ -28,6 +28,7 @@
 #include "MengeCore/CoreConfig.h"
 #include "MengeCore/Math/Vector2.h"
 
+#include <type_traits>
 #include <vector>
 
 namespace Menge {
@@ -40,8 +41,10 @@ class FSM;
 namespace Agents {
 // forward declaration
 class BaseAgent;
+class ColumnWriter;
 class Elevation;
 class Obstacle;
+class SCBFilter;
 class SCBWriter;
 class SpatialQuery;
 
@@ -50,6 +53,18 @@ class SpatialQuery;
  */
 class MENGE_API SimulatorInterface : public XMLSimulatorBase {
  public:
+  /*!
+   @brief    The phases of a call to step(), for the purpose of allocation tracking.
+   */
+  enum StepPhase {
+    OUTPUT_PHASE,  ///< Writing the trajectory frame.
+    BFSM_PHASE,    ///< Evaluating the BFSM (transitions and preferred velocities).
+    AGENT_PHASE,   ///< Computing and applying the agents' new velocities.
+    TASK_PHASE,    ///< Performing the BFSM tasks.
+    GOAL_PHASE,    ///< Moving the goals.
+    PHASE_COUNT    ///< The number of phases.
+  };
+
   /*!
    @brief    Default constructor.
    */
@@ -82,6 +97,19 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   bool step();
 
+  /*!
+   @brief    Reports the number of heap allocations performed during a phase of the most recent call
+            to step(), summed over sub-steps.
+
+   The counts are only available if MengeCore was built with MENGE_TRACK_ALLOCATIONS (see
+   AllocationTracker); otherwise they are zero. The counts cover the thread calling step() and
+   its OpenMP team (see AllocationTracker::getCount()); other threads are not included.
+
+   @param    phase    The phase of interest.
+   @returns  The number of allocations.
+   */
+  size_t getStepAllocations(StepPhase phase) const { return _stepAllocations[phase]; }
+
   /*!
    @brief      Returns the count of agents in the simulation.
 
@@ -109,6 +137,27 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   virtual const BaseAgent* getAgent(size_t agentNo) const = 0;
 
+  /*!
+   @brief      Accessor for agents by identifier.
+
+   An agent's identifier (BaseAgent::_id) is assigned when it is added to the simulator and never
+   changes. Its index in the simulator's local store may change during the simulation (see
+   SimulatorBase::setReorderInterval()), so anything that refers to agents across time steps should
+   use the identifier.
+
+   @param      id     The identifier of the agent, in the range [0, getNumAgents()).
+   @returns    A pointer to the agent.
+   */
+  virtual BaseAgent* getAgentById(size_t id) { return getAgent(id); }
+
+  /*!
+   @brief      Const accessor for agents by identifier.
+
+   @param      id     The identifier of the agent, in the range [0, getNumAgents()).
+   @returns    A pointer to the agent.
+   */
+  virtual const BaseAgent* getAgentById(size_t id) const { return getAgent(id); }
+
   /*!
    @brief    After all agents and all obstacles have been added to the scene does the work to finish
             preparing the simulation to be run.
@@ -243,11 +292,61 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
 
    @param    outFileName        The path to the file to write trajectories to.
    @param    scbVersion        The version of scb file to write.
+   @param    filter            The frames, agents and fields to write; if null, every agent's
+                              state is written every step.
    @returns  True if the SCB writer has been successfully configured.
    */
-  bool setOutput(const std::string& outFileName, const std::string& scbVersion);
+  bool setOutput(const std::string& outFileName, const std::string& scbVersion,
+                 const SCBFilter* filter = 0x0);
+
+  /*!
+   @brief    Sets the column output, which writes each recorded field to its own file (see
+            ColumnWriter).
+
+   @param    basePath    The path to which the fields' names and extension are appended.
+   @param    filter      The frames and fields to write; if null, the default fields are written
+                        every step.
+   @returns  True if the column writer has been successfully configured.
+   */
+  bool setColumnOutput(const std::string& basePath, const SCBFilter* filter = 0x0);
+
+  /*!
+   @brief    Records the current values of the model's static parameters (see addModelParameter())
+            and of the interaction kernels' settings as this simulator's values.
+
+   Models keep their parameters in static members, which all simulators of the model share. A
+   process which holds several simulators (e.g., through the C API's handles) makes them take
+   turns: each installs its values with restoreModelParameters() before it is used and records
+   them with saveModelParameters() afterwards.
+   */
+  void saveModelParameters();
+
+  /*!
+   @brief    Sets the model's static parameters and the interaction kernels' settings to the values
+            most recently recorded by saveModelParameters().
+   */
+  void restoreModelParameters();
 
  protected:
+  /*!
+   @brief    Registers a static parameter of the model, so that it is saved and restored with the
+            simulator (see saveModelParameters()).
+
+   The parameter is reset to its default -- its value when it was first registered in the process --
+   so that each simulator parses its parameters starting from the defaults rather than from the
+   values of the simulator created before it. Models register their static parameters in their
+   constructors.
+
+   @param    parameter    The static parameter; its value is saved and restored as bytes, so its
+                          type must be trivially copyable.
+   */
+  template <typename T>
+  void addModelParameter(T* parameter) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Model parameters are copied as bytes; they must be trivially copyable.");
+    registerModelParameter(parameter, sizeof(T));
+  }
+
   /*!
    @brief       Lets the simulator perform a simulation step and updates the two-dimensional _p and
                 two-dimensional velocity of each agent.
@@ -261,6 +360,15 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   void updateEffTimeStep() { SIM_TIME_STEP = TIME_STEP = LOGICAL_TIME_STEP / (1.f + SUB_STEPS); }
 
+  /*!
+   @brief    Attributes the allocations performed since the given mark to the given phase and
+            advances the mark.
+
+   @param    phase    The phase that has just completed.
+   @param    mark     The allocation count at the start of the phase; set to the current count.
+   */
+  void countAllocations(StepPhase phase, size_t& mark);
+
   /*!
    @brief    The logical simulation time step.
    
@@ -307,6 +415,11 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   SCBWriter* _scbWriter;
 
+  /*!
+   @brief    The optional column writer (if a column output has been successfully specified).
+   */
+  ColumnWriter* _columnWriter;
+
   /*!
    @brief    Indicates if the simulation is running.
    */
@@ -316,6 +429,48 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    @brief    Maximum length of simulation time to compute (in simulation time).
    */
   float _maxDuration;
+
+  /*!
+   @brief    The number of allocations per phase during the most recent call to step().
+   */
+  size_t _stepAllocations[PHASE_COUNT];
+
+  /*!
+   @brief    A static parameter of the model and this simulator's value of it.
+   */
+  struct ModelParameter {
+    /*!
+     @brief    The address of the parameter.
+     */
+    void* _address;
+
+    /*!
+     @brief    The simulator's value of the parameter, as bytes.
+     */
+    std::vector<char> _value;
+  };
+
+  /*!
+   @brief    The model's static parameters.
+   */
+  std::vector<ModelParameter> _modelParameters;
+
+  /*!
+   @brief    The simulator's value of Kernels::getApproximateExp().
+   */
+  bool _approximateExp;
+
+  /*!
+   @brief    The simulator's value of Kernels::getValidation().
+   */
+  bool _kernelValidation;
+
+ private:
+  /*!
+   @brief    Registers a static parameter of the model by its address and size in bytes; see
+            addModelParameter().
+   */
+  void registerModelParameter(void* parameter, size_t size);
 };
 }  // namespace Agents
 }  // namespace Menge
@@ -42,18 +42,26 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KDTREE_SSE
+#include <emmintrin.h>
+#endif
+
 namespace Menge {
 
 namespace Agents {
 
-using Math::sqr;
 using Math::Vector2;
 
 /////////////////////////////////////////////////////////////////////////////
 //                     Implementation of AgentKDTree
 /////////////////////////////////////////////////////////////////////////////
 
-AgentKDTree::AgentKDTree() : _agents(), _tree() {}
+const size_t AgentKDTree::MAX_LEAF_SIZE;
+
+/////////////////////////////////////////////////////////////////////////////
+
+AgentKDTree::AgentKDTree() : _agents(), _tree(), _leaves(), _batchQueries(false) {}
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -64,6 +72,7 @@ void AgentKDTree::setAgents(const std::vector<BaseAgent*>& agents) {
     _agents[i] = agents[i];
   }
   _tree.resize(2 * AGT_COUNT - 1);
+  _leaves.clear();
 
   if (AGT_COUNT > 0) {
     buildTreeRecursive(0, AGT_COUNT, 0);
@@ -73,6 +82,7 @@ void AgentKDTree::setAgents(const std::vector<BaseAgent*>& agents) {
 /////////////////////////////////////////////////////////////////////////////
 
 void AgentKDTree::buildTree() {
+  _leaves.clear();
   if (_agents.size() > 0) {
     buildTreeRecursive(0, _agents.size(), 0);
   }
@@ -80,10 +90,7 @@ void AgentKDTree::buildTree() {
 
 /////////////////////////////////////////////////////////////////////////////
 
-void AgentKDTree::agentQuery(ProximityQuery* filter) const {
-  float range = filter->getMaxAgentRange();
-  queryTreeRecursive(filter, filter->getQueryPoint(), range, 0);
-}
+void AgentKDTree::agentQuery(ProximityQuery* filter) const { agentQuery<ProximityQuery>(filter); }
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -145,52 +152,47 @@ void AgentKDTree::buildTreeRecursive(size_t begin, size_t end, size_t node) {
 
     buildTreeRecursive(begin, left, _tree[node]._left);
     buildTreeRecursive(left, end, _tree[node]._right);
+  } else {
+    _leaves.push_back(node);
   }
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-void AgentKDTree::queryTreeRecursive(ProximityQuery* filter, Vector2 pt, float& rangeSq,
-                                     size_t node) const {
-  if (_tree[node]._end - _tree[node]._begin <= MAX_LEAF_SIZE) {
-    for (size_t i = _tree[node]._begin; i < _tree[node]._end; ++i) {
-      float distance = pt.distanceSq(_agents[i]->_pos);
-      if (distance < rangeSq) {
-        filter->filterAgent(_agents[i], distance);
-      }
-      rangeSq = filter->getMaxAgentRange();
-    }
-  } else {
-    float x = pt.x();
-    float y = pt.y();
-    const float distSqLeft = sqr(std::max(0.0f, _tree[_tree[node]._left]._minX - x)) +
-                             sqr(std::max(0.0f, x - _tree[_tree[node]._left]._maxX)) +
-                             sqr(std::max(0.0f, _tree[_tree[node]._left]._minY - y)) +
-                             sqr(std::max(0.0f, y - _tree[_tree[node]._left]._maxY));
-
-    const float distSqRight = sqr(std::max(0.0f, _tree[_tree[node]._right]._minX - x)) +
-                              sqr(std::max(0.0f, x - _tree[_tree[node]._right]._maxX)) +
-                              sqr(std::max(0.0f, _tree[_tree[node]._right]._minY - y)) +
-                              sqr(std::max(0.0f, y - _tree[_tree[node]._right]._maxY));
-
-    if (distSqLeft < distSqRight) {
-      if (distSqLeft < rangeSq) {
-        queryTreeRecursive(filter, pt, rangeSq, _tree[node]._left);
-
-        if (distSqRight < rangeSq) {
-          queryTreeRecursive(filter, pt, rangeSq, _tree[node]._right);
-        }
-      }
-    } else if (distSqRight < rangeSq) {
-      queryTreeRecursive(filter, pt, rangeSq, _tree[node]._right);
-
-      if (distSqLeft < rangeSq) {
-        queryTreeRecursive(filter, pt, rangeSq, _tree[node]._left);
-      }
+size_t AgentKDTree::filterPoints(const float* x, const float* y, size_t count, const Vector2& pt,
+                                 float rangeSq, float* distSq, unsigned int* indices) {
+  const unsigned int COUNT = static_cast<unsigned int>(count);
+  const float px = pt.x();
+  const float py = pt.y();
+  size_t found = 0;
+  unsigned int i = 0;
+#ifdef KDTREE_SSE
+  // Same operations, in the same order, as Vector2::distanceSq() so the distances are identical.
+  const __m128 PX = _mm_set1_ps(px);
+  const __m128 PY = _mm_set1_ps(py);
+  const __m128 RANGE = _mm_set1_ps(rangeSq);
+  for (; i + 4 <= COUNT; i += 4) {
+    const __m128 dx = _mm_sub_ps(PX, _mm_loadu_ps(x + i));
+    const __m128 dy = _mm_sub_ps(PY, _mm_loadu_ps(y + i));
+    const __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    _mm_storeu_ps(distSq + i, d);
+    int mask = _mm_movemask_ps(_mm_cmplt_ps(d, RANGE));
+    for (unsigned int j = i; mask != 0; mask >>= 1, ++j) {
+      if (mask & 1) indices[found++] = j;
     }
   }
+#endif
+  for (; i < COUNT; ++i) {
+    const float dx = px - x[i];
+    const float dy = py - y[i];
+    distSq[i] = dx * dx + dy * dy;
+    if (distSq[i] < rangeSq) indices[found++] = i;
+  }
+  return found;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+
 /////////////////////////////////////////////////////////////////////////////
 }  // namespace Agents
 }  // namespace Menge
@@ -25,10 +25,12 @@
  */
 
 // STL
+#include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
 #include "MengeCore/CoreConfig.h"
 #include "MengeCore/Math/Vector2.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 
@@ -40,9 +42,6 @@ namespace Menge {
  */
 namespace Agents {
 
-// FORWARD DECLARATIONS
-class BaseAgent;
-
 // TODO: Adapt this so that the number of agents can be changed -- i.e. removing and
 //  introducing new agents in the simulation
 
@@ -50,6 +49,10 @@ class BaseAgent;
  @brief    A <i>k</i>d-tree for performing nearest-neighbor searches.
 
  The agents are partitioned according to a greedy partitioning algorithm.
+
+ Besides querying for one agent at a time, the tree can answer the queries of all agents in one of
+ its leaves at once (see leafQuery()). Agents sharing a leaf are close to each other, so their
+ searches would visit largely the same nodes; the batched query visits them once.
  */
 class MENGE_API AgentKDTree {
  private:
@@ -114,12 +117,90 @@ class MENGE_API AgentKDTree {
    */
   void buildTree();
 
+  /*!
+   @brief      Sets whether simulators should query the tree one leaf at a time (see leafQuery()).
+
+   @param      batch     True to use batched queries.
+   */
+  void setBatchQueries(bool batch) { _batchQueries = batch; }
+
+  /*!
+   @brief      Reports whether simulators should query the tree one leaf at a time.
+   */
+  bool getBatchQueries() const { return _batchQueries; }
+
+  /*!
+   @brief      Reports the number of leaves in the tree.
+   */
+  size_t getLeafCount() const { return _leaves.size(); }
+
+  /*!
+   @brief      Reports the number of agents in a leaf.
+
+   @param      leaf     The index of the leaf, in the range [0, getLeafCount()).
+   */
+  size_t getLeafSize(size_t leaf) const {
+    return _tree[_leaves[leaf]]._end - _tree[_leaves[leaf]]._begin;
+  }
+
+  /*!
+   @brief      Reports an agent in a leaf.
+
+   @param      leaf     The index of the leaf, in the range [0, getLeafCount()).
+   @param      i        The index of the agent in the leaf, in the range [0, getLeafSize(leaf)).
+   @returns    The agent.
+   */
+  const BaseAgent* getLeafAgent(size_t leaf, size_t i) const {
+    return _agents[_tree[_leaves[leaf]]._begin + i];
+  }
+
   /*!
    @brief      Gets agents within a range, and passes them to the supplied filter.
    @param      filter          a pointer for the filter object
    */
   void agentQuery(ProximityQuery* filter) const;
 
+  /*!
+   @brief      Gets agents within a range, and passes them to the supplied filter.
+
+   The filter's functions are called through its static type, so an ExactProximityQuery avoids
+   virtual dispatch for every candidate agent.
+
+   @param      filter          a pointer for the filter object
+   @tparam     Filter          The filter type; ProximityQuery or an ExactProximityQuery.
+   */
+  template <class Filter>
+  void agentQuery(Filter* filter) const {
+    if (_agents.empty()) return;
+    float range = filter->getMaxAgentRange();
+    queryTreeRecursive(filter, filter->getQueryPoint(), range, 0);
+  }
+
+  /*!
+   @brief      Performs the agent queries of agents in a leaf.
+
+   The tree is traversed once for the whole leaf, pruning the nodes farther from the leaf's bounding
+   box than the largest of the filters' ranges. Each node's agents are offered to every filter; the
+   distances are computed and tested several agents at a time.
+
+   Each filter receives the same agents, with the same distances, as a query by agentQuery(), but
+   possibly in a different order. A filter which resolves equal distances by the order in which the
+   agents are reported may therefore break ties differently.
+
+   @param      leaf       The index of the leaf, in the range [0, getLeafCount()).
+   @param      filters    The filters. Each filter's query point must be the position of one of
+                          the leaf's agents (see getLeafAgent()).
+   @param      count      The number of filters.
+   @tparam     Filter     The filter type; ProximityQuery or an ExactProximityQuery.
+   */
+  template <class Filter>
+  void leafQuery(size_t leaf, Filter* filters, size_t count) const;
+
+  /*!
+   @brief    The maximum number of agents allowed in a tree leaf node.
+   */
+  static const size_t MAX_LEAF_SIZE = 10;
+
  protected:
   /*!
    @brief      Does the full work of constructing the <i>k</i>d-tree.
@@ -139,8 +220,46 @@ class MENGE_API AgentKDTree {
    @param   rangeSq         The squared range around the agent.
    @param   node            The current node to search in.
    */
-  void queryTreeRecursive(ProximityQuery* filter, Math::Vector2 pt, float& rangeSq,
-                          size_t node) const;
+  template <class Filter>
+  void queryTreeRecursive(Filter* filter, Math::Vector2 pt, float& rangeSq, size_t node) const;
+
+  /*!
+   @brief      Performs the agent queries of several agents in a leaf by doing a recursive search.
+
+   @param   leaf            The leaf node containing the agents.
+   @param   filters         The spatial query filters to use.
+   @param   count           The number of filters.
+   @param   rangeSq         The largest of the filters' squared ranges.
+   @param   node            The current node to search in.
+   */
+  template <class Filter>
+  void leafQueryRecursive(const AgentTreeNode& leaf, Filter* filters, size_t count,
+                          float& rangeSq, size_t node) const;
+
+  /*!
+   @brief      Computes the squared distance between the bounding boxes of two nodes.
+   */
+  static float boxDistanceSq(const AgentTreeNode& a, const AgentTreeNode& b) {
+    using Math::sqr;
+    return sqr(std::max(0.0f, a._minX - b._maxX)) + sqr(std::max(0.0f, b._minX - a._maxX)) +
+           sqr(std::max(0.0f, a._minY - b._maxY)) + sqr(std::max(0.0f, b._minY - a._maxY));
+  }
+
+  /*!
+   @brief      Finds the points whose squared distance to a query point is less than a range.
+
+   @param   x               The x-coordinates of the points.
+   @param   y               The y-coordinates of the points.
+   @param   count           The number of points.
+   @param   pt              The query point.
+   @param   rangeSq         The squared range around the query point.
+   @param   distSq          The squared distance to each point; there must be room for every point.
+   @param   indices         The indices of the points in range, in increasing order; there must be
+                            room for every point.
+   @returns The number of points in range.
+   */
+  static size_t filterPoints(const float* x, const float* y, size_t count, const Math::Vector2& pt,
+                             float rangeSq, float* distSq, unsigned int* indices);
 
   /*!
    @brief    The agents being partitioned by the <i>k</i>d-tree.
@@ -153,11 +272,129 @@ class MENGE_API AgentKDTree {
   std::vector<AgentTreeNode> _tree;
 
   /*!
-   @brief    The maximum number of agents allowed in a tree leaf node.
+   @brief    The indices of the tree's leaf nodes.
    */
-  static const size_t MAX_LEAF_SIZE = 10;
+  std::vector<size_t> _leaves;
+
+  /*!
+   @brief    Determines if simulators should query the tree one leaf at a time.
+   */
+  bool _batchQueries;
 };
 
+////////////////////////////////////////////////////////////////
+//          Implementation of AgentKDTree templates
+////////////////////////////////////////////////////////////////
+
+template <class Filter>
+void AgentKDTree::queryTreeRecursive(Filter* filter, Math::Vector2 pt, float& rangeSq,
+                                     size_t node) const {
+  if (_tree[node]._end - _tree[node]._begin <= MAX_LEAF_SIZE) {
+    for (size_t i = _tree[node]._begin; i < _tree[node]._end; ++i) {
+      float distance = pt.distanceSq(_agents[i]->_pos);
+      if (distance < rangeSq) {
+        filter->filterAgent(_agents[i], distance);
+      }
+      rangeSq = filter->getMaxAgentRange();
+    }
+  } else {
+    using Math::sqr;
+    float x = pt.x();
+    float y = pt.y();
+    const float distSqLeft = sqr(std::max(0.0f, _tree[_tree[node]._left]._minX - x)) +
+                             sqr(std::max(0.0f, x - _tree[_tree[node]._left]._maxX)) +
+                             sqr(std::max(0.0f, _tree[_tree[node]._left]._minY - y)) +
+                             sqr(std::max(0.0f, y - _tree[_tree[node]._left]._maxY));
+
+    const float distSqRight = sqr(std::max(0.0f, _tree[_tree[node]._right]._minX - x)) +
+                              sqr(std::max(0.0f, x - _tree[_tree[node]._right]._maxX)) +
+                              sqr(std::max(0.0f, _tree[_tree[node]._right]._minY - y)) +
+                              sqr(std::max(0.0f, y - _tree[_tree[node]._right]._maxY));
+
+    if (distSqLeft < distSqRight) {
+      if (distSqLeft < rangeSq) {
+        queryTreeRecursive(filter, pt, rangeSq, _tree[node]._left);
+
+        if (distSqRight < rangeSq) {
+          queryTreeRecursive(filter, pt, rangeSq, _tree[node]._right);
+        }
+      }
+    } else if (distSqRight < rangeSq) {
+      queryTreeRecursive(filter, pt, rangeSq, _tree[node]._right);
+
+      if (distSqLeft < rangeSq) {
+        queryTreeRecursive(filter, pt, rangeSq, _tree[node]._left);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Filter>
+void AgentKDTree::leafQuery(size_t leaf, Filter* filters, size_t count) const {
+  if (count == 0) return;
+  float rangeSq = 0.f;
+  for (size_t i = 0; i < count; ++i) {
+    rangeSq = std::max(rangeSq, filters[i].getMaxAgentRange());
+  }
+  leafQueryRecursive(_tree[_leaves[leaf]], filters, count, rangeSq, 0);
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Filter>
+void AgentKDTree::leafQueryRecursive(const AgentTreeNode& leaf, Filter* filters, size_t count,
+                                     float& rangeSq, size_t node) const {
+  const AgentTreeNode& curr = _tree[node];
+  if (curr._end - curr._begin <= MAX_LEAF_SIZE) {
+    const size_t AGT_COUNT = curr._end - curr._begin;
+    float x[MAX_LEAF_SIZE];
+    float y[MAX_LEAF_SIZE];
+    for (size_t i = 0; i < AGT_COUNT; ++i) {
+      x[i] = _agents[curr._begin + i]->_pos.x();
+      y[i] = _agents[curr._begin + i]->_pos.y();
+    }
+    float distSq[MAX_LEAF_SIZE];
+    unsigned int inRange[MAX_LEAF_SIZE];
+    rangeSq = 0.f;
+    for (size_t f = 0; f < count; ++f) {
+      Filter& filter = filters[f];
+      float range = filter.getMaxAgentRange();
+      const size_t IN_RANGE =
+          filterPoints(x, y, AGT_COUNT, filter.getQueryPoint(), range, distSq, inRange);
+      for (size_t j = 0; j < IN_RANGE; ++j) {
+        const unsigned int i = inRange[j];
+        // The filter's range shrinks as it fills up.
+        if (distSq[i] < range) {
+          filter.filterAgent(_agents[curr._begin + i], distSq[i]);
+          range = filter.getMaxAgentRange();
+        }
+      }
+      rangeSq = std::max(rangeSq, range);
+    }
+  } else {
+    const float distSqLeft = boxDistanceSq(leaf, _tree[curr._left]);
+    const float distSqRight = boxDistanceSq(leaf, _tree[curr._right]);
+
+    if (distSqLeft < distSqRight) {
+      if (distSqLeft < rangeSq) {
+        leafQueryRecursive(leaf, filters, count, rangeSq, curr._left);
+
+        if (distSqRight < rangeSq) {
+          leafQueryRecursive(leaf, filters, count, rangeSq, curr._right);
+        }
+      }
+    } else if (distSqRight < rangeSq) {
+      leafQueryRecursive(leaf, filters, count, rangeSq, curr._right);
+
+      if (distSqLeft < rangeSq) {
+        leafQueryRecursive(leaf, filters, count, rangeSq, curr._left);
+      }
+    }
+  }
+}
+
 }  // namespace Agents
 }  // namespace Menge
 
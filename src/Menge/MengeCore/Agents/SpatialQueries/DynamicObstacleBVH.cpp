@@ -0,0 +1,332 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SpatialQueries/DynamicObstacleBVH.h"
+
+#include <algorithm>
+
+namespace Menge {
+
+namespace Agents {
+
+using Math::sqr;
+using Math::Vector2;
+
+namespace {
+/*!
+ @brief   Computes the squared distance from a point to an axis-aligned box.
+ */
+float distSqPointBox(const Vector2& p, const Vector2& minPt, const Vector2& maxPt) {
+  const float dx = std::max(std::max(minPt._x - p._x, 0.f), p._x - maxPt._x);
+  const float dy = std::max(std::max(minPt._y - p._y, 0.f), p._y - maxPt._y);
+  return dx * dx + dy * dy;
+}
+
+/*!
+ @brief   Reports if two axis-aligned boxes overlap.
+ */
+bool boxesOverlap(const Vector2& min0, const Vector2& max0, const Vector2& min1,
+                  const Vector2& max1) {
+  return min0._x <= max1._x && min1._x <= max0._x && min0._y <= max1._y && min1._y <= max0._y;
+}
+
+/*!
+ @brief   Computes the perimeter of the union of two axis-aligned boxes.
+ */
+float unionPerimeter(const Vector2& min0, const Vector2& max0, const Vector2& min1,
+                     const Vector2& max1) {
+  return std::max(max0._x, max1._x) - std::min(min0._x, min1._x) + std::max(max0._y, max1._y) -
+         std::min(min0._y, min1._y);
+}
+
+/*!
+ @brief   Reports if the obstacle segment (p0, p1) blocks the link from q1 to q2 for an agent with
+          the given radius -- the test ObstacleKDTree::linkIsTraversible() performs at each node.
+ */
+bool segmentBlocksLink(const Vector2& p0, const Vector2& p1, const Vector2& q1, const Vector2& q2,
+                       float radius) {
+  const float q1LeftOfObst = leftOf(p0, p1, q1);
+  const float q2LeftOfObst = leftOf(p0, p1, q2);
+  // Only links which cross the obstacle's line from its right to its left can be blocked.
+  if (q1LeftOfObst >= 0.0f || q2LeftOfObst <= 0.0f) return false;
+  const float invObstLengthSqd = 1.0f / absSq(p1 - p0);
+  const float point1LeftOfQ = leftOf(q1, q2, p0);
+  const float point2LeftOfQ = leftOf(q1, q2, p1);
+  const float invQLengthSqd = 1.0f / absSq(q2 - q1);
+  const float radSqd = sqr(radius);
+  return !(point1LeftOfQ * point2LeftOfQ >= 0.0f &&
+           ((sqr(point1LeftOfQ) * invQLengthSqd > radSqd &&
+             sqr(point2LeftOfQ) * invQLengthSqd > radSqd) ||
+            (sqr(q1LeftOfObst) * invObstLengthSqd <= radSqd &&
+             sqr(q2LeftOfObst) * invObstLengthSqd >= radSqd)));
+}
+
+/*!
+ @brief   Reports if the obstacle segment (p0, p1) blocks visibility between q1 and q2 -- the test
+          ObstacleKDTree::queryVisibility() performs at each node.
+ */
+bool segmentBlocksVisibility(const Vector2& p0, const Vector2& p1, const Vector2& q1,
+                             const Vector2& q2, float radius) {
+  const float q1LeftOfI = leftOf(p0, p1, q1);
+  const float q2LeftOfI = leftOf(p0, p1, q2);
+  if (q1LeftOfI >= 0.0f || q2LeftOfI <= 0.0f) return false;
+  const float point1LeftOfQ = leftOf(q1, q2, p0);
+  const float point2LeftOfQ = leftOf(q1, q2, p1);
+  const float invLengthQ = 1.0f / absSq(q2 - q1);
+  return !(point1LeftOfQ * point2LeftOfQ >= 0.0f &&
+           sqr(point1LeftOfQ) * invLengthQ > sqr(radius) &&
+           sqr(point2LeftOfQ) * invLengthQ > sqr(radius));
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//                     Implementation of DynamicObstacleBVH
+/////////////////////////////////////////////////////////////////////////////
+
+DynamicObstacleBVH::DynamicObstacleBVH()
+    : _nodes(), _root(NO_NODE), _freeNode(NO_NODE), _leaves() {}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::insert(const Obstacle* obstacle) {
+  if (_leaves.find(obstacle) != _leaves.end()) return;
+  const int leaf = allocateNode();
+  _nodes[leaf]._obstacle = obstacle;
+  boundObstacle(_nodes[leaf]);
+  insertLeaf(leaf);
+  _leaves[obstacle] = leaf;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool DynamicObstacleBVH::remove(const Obstacle* obstacle) {
+  HASH_MAP<const Obstacle*, int>::iterator itr = _leaves.find(obstacle);
+  if (itr == _leaves.end()) return false;
+  removeLeaf(itr->second);
+  freeNode(itr->second);
+  _leaves.erase(itr);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool DynamicObstacleBVH::refit(const Obstacle* obstacle) {
+  HASH_MAP<const Obstacle*, int>::const_iterator itr = _leaves.find(obstacle);
+  if (itr == _leaves.end()) return false;
+  boundObstacle(_nodes[itr->second]);
+  refitAncestors(_nodes[itr->second]._parent);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::obstacleQuery(ProximityQuery* query, std::vector<int>& stack) const {
+  if (_root == NO_NODE) return;
+  const Vector2 pt = query->getQueryPoint();
+  float rangeSq = query->getMaxObstacleRange();
+
+  stack.assign(1, _root);
+  while (!stack.empty()) {
+    const Node& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (distSqPointBox(pt, node._min, node._max) >= rangeSq) continue;
+    if (node.isLeaf()) {
+      const Vector2 P0 = node._obstacle->getP0();
+      const Vector2 P1 = node._obstacle->getP1();
+      // Only report obstacles whose right side faces the query point (or double-sided ones).
+      if (node._obstacle->_doubleSided || leftOf(P0, P1, pt) < 0.0f) {
+        const float distSq = distSqPointLineSegment(P0, P1, pt);
+        if (distSq < rangeSq) {
+          query->filterObstacle(node._obstacle, distSq);
+          rangeSq = query->getMaxObstacleRange();
+        }
+      }
+    } else {
+      stack.push_back(node._left);
+      stack.push_back(node._right);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool DynamicObstacleBVH::linkIsTraversible(const Vector2& q1, const Vector2& q2, float radius,
+                                           std::vector<int>& stack) const {
+  if (_root == NO_NODE) return true;
+  // Only obstacles whose boxes overlap the bounding box of the link's capsule are considered.
+  const Vector2 linkMin(std::min(q1._x, q2._x) - radius, std::min(q1._y, q2._y) - radius);
+  const Vector2 linkMax(std::max(q1._x, q2._x) + radius, std::max(q1._y, q2._y) + radius);
+
+  stack.assign(1, _root);
+  while (!stack.empty()) {
+    const Node& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!boxesOverlap(node._min, node._max, linkMin, linkMax)) continue;
+    if (node.isLeaf()) {
+      if (segmentBlocksLink(node._obstacle->getP0(), node._obstacle->getP1(), q1, q2, radius)) {
+        return false;
+      }
+    } else {
+      stack.push_back(node._left);
+      stack.push_back(node._right);
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool DynamicObstacleBVH::queryVisibility(const Vector2& q1, const Vector2& q2, float radius,
+                                         std::vector<int>& stack) const {
+  if (_root == NO_NODE) return true;
+  const Vector2 linkMin(std::min(q1._x, q2._x) - radius, std::min(q1._y, q2._y) - radius);
+  const Vector2 linkMax(std::max(q1._x, q2._x) + radius, std::max(q1._y, q2._y) + radius);
+
+  stack.assign(1, _root);
+  while (!stack.empty()) {
+    const Node& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!boxesOverlap(node._min, node._max, linkMin, linkMax)) continue;
+    if (node.isLeaf()) {
+      if (segmentBlocksVisibility(node._obstacle->getP0(), node._obstacle->getP1(), q1, q2,
+                                  radius)) {
+        return false;
+      }
+    } else {
+      stack.push_back(node._left);
+      stack.push_back(node._right);
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int DynamicObstacleBVH::allocateNode() {
+  int node = _freeNode;
+  if (node == NO_NODE) {
+    node = static_cast<int>(_nodes.size());
+    _nodes.push_back(Node());
+  } else {
+    _freeNode = _nodes[node]._parent;
+  }
+  Node& n = _nodes[node];
+  n._parent = n._left = n._right = NO_NODE;
+  n._obstacle = 0x0;
+  return node;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::freeNode(int node) {
+  _nodes[node]._parent = _freeNode;
+  _nodes[node]._obstacle = 0x0;
+  _freeNode = node;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::insertLeaf(int leaf) {
+  if (_root == NO_NODE) {
+    _root = leaf;
+    _nodes[leaf]._parent = NO_NODE;
+    return;
+  }
+
+  // Descend towards the child whose box grows the least to contain the leaf.
+  const Vector2 leafMin = _nodes[leaf]._min;
+  const Vector2 leafMax = _nodes[leaf]._max;
+  int sibling = _root;
+  while (!_nodes[sibling].isLeaf()) {
+    const Node& left = _nodes[_nodes[sibling]._left];
+    const Node& right = _nodes[_nodes[sibling]._right];
+    const float leftCost = unionPerimeter(left._min, left._max, leafMin, leafMax) -
+                           unionPerimeter(left._min, left._max, left._min, left._max);
+    const float rightCost = unionPerimeter(right._min, right._max, leafMin, leafMax) -
+                            unionPerimeter(right._min, right._max, right._min, right._max);
+    sibling = leftCost <= rightCost ? _nodes[sibling]._left : _nodes[sibling]._right;
+  }
+
+  // Replace the sibling with a new parent of the sibling and the leaf.
+  const int oldParent = _nodes[sibling]._parent;
+  const int newParent = allocateNode();
+  _nodes[newParent]._parent = oldParent;
+  _nodes[newParent]._left = sibling;
+  _nodes[newParent]._right = leaf;
+  _nodes[sibling]._parent = newParent;
+  _nodes[leaf]._parent = newParent;
+  if (oldParent == NO_NODE) {
+    _root = newParent;
+  } else if (_nodes[oldParent]._left == sibling) {
+    _nodes[oldParent]._left = newParent;
+  } else {
+    _nodes[oldParent]._right = newParent;
+  }
+  refitAncestors(newParent);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::removeLeaf(int leaf) {
+  if (leaf == _root) {
+    _root = NO_NODE;
+    return;
+  }
+
+  // The leaf's sibling takes the place of their parent.
+  const int parent = _nodes[leaf]._parent;
+  const int grandParent = _nodes[parent]._parent;
+  const int sibling = _nodes[parent]._left == leaf ? _nodes[parent]._right : _nodes[parent]._left;
+  _nodes[sibling]._parent = grandParent;
+  if (grandParent == NO_NODE) {
+    _root = sibling;
+  } else {
+    if (_nodes[grandParent]._left == parent) {
+      _nodes[grandParent]._left = sibling;
+    } else {
+      _nodes[grandParent]._right = sibling;
+    }
+    refitAncestors(grandParent);
+  }
+  freeNode(parent);
+  _nodes[leaf]._parent = NO_NODE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::refitAncestors(int node) {
+  while (node != NO_NODE) {
+    Node& n = _nodes[node];
+    const Node& left = _nodes[n._left];
+    const Node& right = _nodes[n._right];
+    n._min.set(std::min(left._min._x, right._min._x), std::min(left._min._y, right._min._y));
+    n._max.set(std::max(left._max._x, right._max._x), std::max(left._max._y, right._max._y));
+    node = n._parent;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void DynamicObstacleBVH::boundObstacle(Node& leaf) {
+  const Vector2 P0 = leaf._obstacle->getP0();
+  const Vector2 P1 = leaf._obstacle->getP1();
+  leaf._min.set(std::min(P0._x, P1._x), std::min(P0._y, P1._y));
+  leaf._max.set(std::max(P0._x, P1._x), std::max(P0._y, P1._y));
+}
+}  // namespace Agents
+}  // namespace Menge
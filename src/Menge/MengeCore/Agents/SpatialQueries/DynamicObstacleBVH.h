@@ -0,0 +1,234 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __DYNAMIC_OBSTACLE_BVH_H__
+#define __DYNAMIC_OBSTACLE_BVH_H__
+
+/*!
+ @file    DynamicObstacleBVH.h
+ @brief   Contains the definition of the DynamicObstacleBVH class. Performs spatial queries for
+          obstacles which can be inserted, removed and moved at runtime.
+ */
+
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Vector2.h"
+#include "MengeCore/mengeCommon.h"
+
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief   A dynamic bounding volume hierarchy of axis-aligned boxes over obstacle segments.
+
+ Each leaf bounds a single obstacle. Obstacles are inserted by descending towards the child whose
+ box grows the least and removed by splicing their leaf out of the tree. An obstacle that moves
+ only has its leaf and the leaf's ancestors refit; the tree is never rebuilt.
+
+ The queries have the same per-obstacle semantics as those of the ObstacleKDTree.
+ */
+class MENGE_API DynamicObstacleBVH {
+ public:
+  /*!
+   @brief   Constructor.
+   */
+  DynamicObstacleBVH();
+
+  /*!
+   @brief   Reports if the hierarchy contains no obstacles.
+   */
+  bool empty() const { return _root == NO_NODE; }
+
+  /*!
+   @brief   Reports the number of obstacles in the hierarchy.
+   */
+  size_t size() const { return _leaves.size(); }
+
+  /*!
+   @brief   Adds an obstacle to the hierarchy. The hierarchy does not take ownership.
+
+   @param   obstacle    The obstacle to add.
+   */
+  void insert(const Obstacle* obstacle);
+
+  /*!
+   @brief   Removes an obstacle from the hierarchy.
+
+   @param   obstacle    The obstacle to remove.
+   @returns True if the obstacle was in the hierarchy.
+   */
+  bool remove(const Obstacle* obstacle);
+
+  /*!
+   @brief   Updates the hierarchy after an obstacle in it has moved.
+
+   @param   obstacle    The obstacle that moved.
+   @returns True if the obstacle was in the hierarchy.
+   */
+  bool refit(const Obstacle* obstacle);
+
+  /*!
+   @brief   Computes the obstacles within range of the query point.
+
+   The queries traverse the hierarchy with a stack provided by the caller, so that a caller which
+   reuses the stack performs no allocations once it has grown to the depth of the hierarchy.
+
+   @param   query   A pointer for the query to be performed.
+   @param   stack   The traversal stack; its contents are overwritten.
+   */
+  void obstacleQuery(ProximityQuery* query, std::vector<int>& stack) const;
+
+  /*!
+   @brief   Implementation of SpatialQuery::linkIsTraversible() for the obstacles in the hierarchy.
+
+   @param   q1        The start point of the link.
+   @param   q2        The end point of the link.
+   @param   radius    The radius of the agent to traverse the link.
+   @param   stack     The traversal stack; its contents are overwritten.
+   @returns True if no obstacle in the hierarchy blocks the link.
+   */
+  bool linkIsTraversible(const Math::Vector2& q1, const Math::Vector2& q2, float radius,
+                         std::vector<int>& stack) const;
+
+  /*!
+   @brief   Queries the visibility between two points within a specified radius.
+
+   @param   q1        The first point between which visibility is to be tested.
+   @param   q2        The second point between which visibility is to be tested.
+   @param   radius    The radius within which visibility is to be tested.
+   @param   stack     The traversal stack; its contents are overwritten.
+   @returns True if q1 and q2 are mutually visible within the radius; false otherwise.
+   */
+  bool queryVisibility(const Math::Vector2& q1, const Math::Vector2& q2, float radius,
+                       std::vector<int>& stack) const;
+
+ protected:
+  /*!
+   @brief   A node of the hierarchy.
+   */
+  struct Node {
+    /*!
+     @brief   The minimum corner of the node's bounding box.
+     */
+    Math::Vector2 _min;
+
+    /*!
+     @brief   The maximum corner of the node's bounding box.
+     */
+    Math::Vector2 _max;
+
+    /*!
+     @brief   The index of the parent node (or, for unused nodes, the next unused node).
+     */
+    int _parent;
+
+    /*!
+     @brief   The index of the left child (NO_NODE for leaves).
+     */
+    int _left;
+
+    /*!
+     @brief   The index of the right child (NO_NODE for leaves).
+     */
+    int _right;
+
+    /*!
+     @brief   The obstacle of a leaf node.
+     */
+    const Obstacle* _obstacle;
+
+    /*!
+     @brief   Reports if the node is a leaf.
+     */
+    bool isLeaf() const { return _left == NO_NODE; }
+  };
+
+  /*!
+   @brief   Takes an unused node (or creates a new one).
+
+   @returns The index of the node.
+   */
+  int allocateNode();
+
+  /*!
+   @brief   Returns a node to the set of unused nodes.
+
+   @param   node    The index of the node.
+   */
+  void freeNode(int node);
+
+  /*!
+   @brief   Inserts the leaf into the tree.
+
+   @param   leaf    The index of the leaf node.
+   */
+  void insertLeaf(int leaf);
+
+  /*!
+   @brief   Removes the leaf from the tree (the leaf itself remains allocated).
+
+   @param   leaf    The index of the leaf node.
+   */
+  void removeLeaf(int leaf);
+
+  /*!
+   @brief   Recomputes the bounding boxes of the given node and all of its ancestors.
+
+   @param   node    The index of the first node to refit.
+   */
+  void refitAncestors(int node);
+
+  /*!
+   @brief   Sets the bounding box of a leaf node to that of its obstacle.
+
+   @param   leaf    The leaf node.
+   */
+  static void boundObstacle(Node& leaf);
+
+  /*!
+   @brief   The index value indicating the absence of a node.
+   */
+  static const int NO_NODE = -1;
+
+  /*!
+   @brief   The nodes of the hierarchy, including the unused ones.
+   */
+  std::vector<Node> _nodes;
+
+  /*!
+   @brief   The index of the root node.
+   */
+  int _root;
+
+  /*!
+   @brief   The index of the first unused node.
+   */
+  int _freeNode;
+
+  /*!
+   @brief   The leaf node of each obstacle in the hierarchy.
+   */
+  HASH_MAP<const Obstacle*, int> _leaves;
+};
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __DYNAMIC_OBSTACLE_BVH_H__
@@ -50,64 +50,42 @@ using Math::Vector2;
 ////////////////////////////////////////////////////////////////////////
 
 void KNearestQuery::filterAgent(const BaseAgent* agent, float distanceSquared) {
-  // if the agent is too far, and we have enough agents, just exit
-  if (distanceSquared >= _maxAgentResultDistance && _agentResults.size() == _maxAgentResults)
-    return;
-
-  // if not, add the agent
-  if (_agentResults.size() < _maxAgentResults) {
-    _agentResults.push_back(NearAgent(distanceSquared, agent));
-  }
-
-  // we are trusting that results are in order
-  size_t i = _agentResults.size() - 1;
-  while (i != 0 && distanceSquared < _agentResults[i - 1].distanceSquared) {
-    _agentResults[i] = _agentResults[i - 1];
-    --i;
-  }
-
-  _agentResults[i] = NearAgent(distanceSquared, agent);
-
-  if (distanceSquared > _maxAgentResultDistance) _maxAgentResultDistance = distanceSquared;
-};
+  insertNearest(_agentResults, _maxAgentResults, NearAgent(distanceSquared, agent));
+}
 
 ///////////////////////////////////////////////////////////
 
 void KNearestQuery::filterObstacle(const Obstacle* obstacle, float distanceSquared) {
-  // make sure that the obstacle is not already disqualified
-  if (distanceSquared >= _maxObstacleResultDistance &&
-      _obstacleResults.size() == _maxObstacleResults)
-    return;
-
-  if (_obstacleResults.size() != _maxObstacleResults) {
-    _obstacleResults.push_back(NearObstacle(distanceSquared, obstacle));
-  }
-
-  size_t i = _obstacleResults.size() - 1;
-  while (i != 0 && distanceSquared < _obstacleResults[i - 1].distanceSquared) {
-    _obstacleResults[i] = _obstacleResults[i - 1];
-    --i;
-  }
-
-  _obstacleResults[i] = NearObstacle(distanceSquared, obstacle);
-
-  if (distanceSquared > _maxObstacleResultDistance) _maxObstacleResultDistance = distanceSquared;
-};
+  insertNearest(_obstacleResults, _maxObstacleResults, NearObstacle(distanceSquared, obstacle));
+}
 
 ///////////////////////////////////////////////////////////
 
 void KNearestQuery::startQuery() {
   _agentResults.clear();
+  _agentResults.reserve(_maxAgentResults);
   _obstacleResults.clear();
-  _maxAgentResultDistance = 9999;
-  _maxObstacleResultDistance = 9999;
+  _obstacleResults.reserve(_maxObstacleResults);
   _queryPoint = Vector2(0, 0);
 }
 
 ///////////////////////////////////////////////////////////
 
 float KNearestQuery::getMaxAgentRange() {
-  if (_agentResults.size() == _maxAgentResults) return _maxAgentResultDistance;
+  // The results only limit the range once there are enough of them.
+  if (_agentResults.size() == _maxAgentResults && _maxAgentResults > 0) {
+    return _agentResults.back().distanceSquared;
+  }
+
+  return _initialRange;
+}
+
+///////////////////////////////////////////////////////////
+
+float KNearestQuery::getMaxObstacleRange() {
+  if (_obstacleResults.size() == _maxObstacleResults && _maxObstacleResults > 0) {
+    return _obstacleResults.back().distanceSquared;
+  }
 
   return _initialRange;
 }
@@ -49,8 +49,8 @@ class KNearestQuery : public ProximityQuery {
    */
   KNearestQuery()
       : ProximityQuery(),
-        _maxAgentResultDistance(0.0f),
-        _maxObstacleResultDistance(0.0f),
+        _maxAgentResults(0),
+        _maxObstacleResults(0),
         _queryPoint(0, 0),
         _initialRange(100) {}
 
@@ -168,7 +168,7 @@ class KNearestQuery : public ProximityQuery {
 
    @returns   The new query distance. Typically this is the initial value.
    */
-  virtual float getMaxObstacleRange() { return _initialRange; };
+  virtual float getMaxObstacleRange();
 
  protected:
   /*!
@@ -181,18 +181,6 @@ class KNearestQuery : public ProximityQuery {
    */
   size_t _maxObstacleResults;
 
-  /*!
-   @brief   The max distance to an agent result. Useful for informing the spatial query to stop
-            searching further.
-   */
-  float _maxAgentResultDistance;
-
-  /*!
-   @brief   The max distance to an obstacle result. Useful for informing the spatial query to stop
-            searching further.
-   */
-  float _maxObstacleResultDistance;
-
   /*!
    @brief   Pairs of agents and distance to agent.
    */
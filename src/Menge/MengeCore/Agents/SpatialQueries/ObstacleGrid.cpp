@@ -0,0 +1,222 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SpatialQueries/ObstacleGrid.h"
+
+#include "MengeCore/Math/consts.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Menge {
+
+namespace Agents {
+
+using Math::Vector2;
+
+namespace {
+/*!
+ @brief   Computes the squared distance from a point to an axis-aligned box.
+
+ @param   p         The point.
+ @param   minPt     The minimum corner of the box.
+ @param   maxPt     The maximum corner of the box.
+ @returns The squared distance; zero if the point lies inside the box.
+ */
+float distSqPointBox(const Vector2& p, const Vector2& minPt, const Vector2& maxPt) {
+  const float dx = std::max(std::max(minPt._x - p._x, 0.f), p._x - maxPt._x);
+  const float dy = std::max(std::max(minPt._y - p._y, 0.f), p._y - maxPt._y);
+  return dx * dx + dy * dy;
+}
+
+/*!
+ @brief   Reports if a line segment intersects an axis-aligned box (by clipping the segment against
+          the box's slabs).
+
+ @param   p0        The first end point of the segment.
+ @param   p1        The second end point of the segment.
+ @param   minPt     The minimum corner of the box.
+ @param   maxPt     The maximum corner of the box.
+ @returns True if some point of the segment lies in the box.
+ */
+bool segmentIntersectsBox(const Vector2& p0, const Vector2& p1, const Vector2& minPt,
+                          const Vector2& maxPt) {
+  float t0 = 0.f;
+  float t1 = 1.f;
+  const float start[2] = {p0._x, p0._y};
+  const float delta[2] = {p1._x - p0._x, p1._y - p0._y};
+  const float lo[2] = {minPt._x, minPt._y};
+  const float hi[2] = {maxPt._x, maxPt._y};
+  for (int i = 0; i < 2; ++i) {
+    if (std::fabs(delta[i]) < EPS) {
+      if (start[i] < lo[i] || start[i] > hi[i]) return false;
+    } else {
+      float tLo = (lo[i] - start[i]) / delta[i];
+      float tHi = (hi[i] - start[i]) / delta[i];
+      if (tLo > tHi) std::swap(tLo, tHi);
+      t0 = std::max(t0, tLo);
+      t1 = std::min(t1, tHi);
+      if (t0 > t1) return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ @brief   Computes the squared distance between a line segment and an axis-aligned box.
+
+ @param   p0        The first end point of the segment.
+ @param   p1        The second end point of the segment.
+ @param   minPt     The minimum corner of the box.
+ @param   maxPt     The maximum corner of the box.
+ @returns The squared distance; zero if they intersect.
+ */
+float distSqSegmentBox(const Vector2& p0, const Vector2& p1, const Vector2& minPt,
+                       const Vector2& maxPt) {
+  if (segmentIntersectsBox(p0, p1, minPt, maxPt)) return 0.f;
+  // Two disjoint convex shapes are closest at a vertex of one of them.
+  float distSq = std::min(distSqPointBox(p0, minPt, maxPt), distSqPointBox(p1, minPt, maxPt));
+  distSq = std::min(distSq, distSqPointLineSegment(p0, p1, minPt));
+  distSq = std::min(distSq, distSqPointLineSegment(p0, p1, maxPt));
+  distSq = std::min(distSq, distSqPointLineSegment(p0, p1, Vector2(minPt._x, maxPt._y)));
+  distSq = std::min(distSq, distSqPointLineSegment(p0, p1, Vector2(maxPt._x, minPt._y)));
+  return distSq;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//                     Implementation of ObstacleGrid
+/////////////////////////////////////////////////////////////////////////////
+
+ObstacleGrid::ObstacleGrid()
+    : _origin(0.f, 0.f), _cellSize(1.f), _cols(0), _rows(0), _range(0.f), _cells() {}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ObstacleGrid::build(const std::vector<Obstacle*>& obstacles, float range, float cellSize) {
+  clear();
+  _range = range;
+  if (obstacles.empty()) return;
+
+  // The grid covers the obstacles' bounding box expanded by the range; no point outside of it can
+  // be within range of any obstacle.
+  Vector2 minPt(obstacles[0]->getP0());
+  Vector2 maxPt(minPt);
+  for (size_t i = 0; i < obstacles.size(); ++i) {
+    const Vector2 p0 = obstacles[i]->getP0();
+    const Vector2 p1 = obstacles[i]->getP1();
+    minPt.set(std::min(minPt._x, std::min(p0._x, p1._x)),
+              std::min(minPt._y, std::min(p0._y, p1._y)));
+    maxPt.set(std::max(maxPt._x, std::max(p0._x, p1._x)),
+              std::max(maxPt._y, std::max(p0._y, p1._y)));
+  }
+  minPt -= Vector2(range, range);
+  maxPt += Vector2(range, range);
+
+  _cellSize = cellSize > EPS ? cellSize : (range > EPS ? range : 1.f);
+  const float width = maxPt._x - minPt._x;
+  const float height = maxPt._y - minPt._y;
+  const float cellCount = (width / _cellSize + 1.f) * (height / _cellSize + 1.f);
+  if (cellCount > MAX_CELLS) {
+    _cellSize *= std::sqrt(cellCount / MAX_CELLS);
+  }
+  _origin = minPt;
+  _cols = static_cast<int>(width / _cellSize) + 1;
+  _rows = static_cast<int>(height / _cellSize) + 1;
+  _cells.resize(static_cast<size_t>(_cols) * _rows);
+
+  const float rangeSq = range * range;
+  for (size_t i = 0; i < obstacles.size(); ++i) {
+    Entry entry;
+    entry._p0 = obstacles[i]->getP0();
+    entry._p1 = obstacles[i]->getP1();
+    entry._obstacle = obstacles[i];
+    // Only the cells overlapping the segment's bounding box expanded by the range can hold it.
+    const int c0 = static_cast<int>(
+        (std::min(entry._p0._x, entry._p1._x) - range - _origin._x) / _cellSize);
+    const int c1 = static_cast<int>(
+        (std::max(entry._p0._x, entry._p1._x) + range - _origin._x) / _cellSize);
+    const int r0 = static_cast<int>(
+        (std::min(entry._p0._y, entry._p1._y) - range - _origin._y) / _cellSize);
+    const int r1 = static_cast<int>(
+        (std::max(entry._p0._y, entry._p1._y) + range - _origin._y) / _cellSize);
+    for (int r = std::max(r0, 0); r <= std::min(r1, _rows - 1); ++r) {
+      for (int c = std::max(c0, 0); c <= std::min(c1, _cols - 1); ++c) {
+        const Vector2 cellMin(_origin._x + c * _cellSize, _origin._y + r * _cellSize);
+        const Vector2 cellMax(cellMin._x + _cellSize, cellMin._y + _cellSize);
+        entry._minDistSq = distSqSegmentBox(entry._p0, entry._p1, cellMin, cellMax);
+        if (entry._minDistSq < rangeSq) {
+          _cells[r * _cols + c].push_back(entry);
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < _cells.size(); ++i) {
+    std::stable_sort(_cells[i].begin(), _cells[i].end());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ObstacleGrid::clear() {
+  _cells.clear();
+  _cols = _rows = 0;
+  _range = 0.f;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool ObstacleGrid::obstacleQuery(ProximityQuery* query) const {
+  float rangeSq = query->getMaxObstacleRange();
+  if (rangeSq > _range * _range) return false;
+
+  const int cell = getCell(query->getQueryPoint());
+  if (cell < 0) return true;
+
+  const Vector2 pt = query->getQueryPoint();
+  const std::vector<Entry>& entries = _cells[cell];
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    if (entry._minDistSq >= rangeSq) break;
+
+    // Only report obstacles whose right side faces the query point (or double-sided ones).
+    if (entry._obstacle->_doubleSided || leftOf(entry._p0, entry._p1, pt) < 0.0f) {
+      const float distSq = distSqPointLineSegment(entry._p0, entry._p1, pt);
+      if (distSq < rangeSq) {
+        query->filterObstacle(entry._obstacle, distSq);
+        rangeSq = query->getMaxObstacleRange();
+      }
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+int ObstacleGrid::getCell(const Vector2& pt) const {
+  const float x = (pt._x - _origin._x) / _cellSize;
+  const float y = (pt._y - _origin._y) / _cellSize;
+  if (x < 0.f || y < 0.f) return -1;
+  const int c = static_cast<int>(x);
+  const int r = static_cast<int>(y);
+  if (c >= _cols || r >= _rows) return -1;
+  return r * _cols + c;
+}
+}  // namespace Agents
+}  // namespace Menge
@@ -0,0 +1,169 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __OBSTACLE_GRID_H__
+#define __OBSTACLE_GRID_H__
+
+/*!
+ @file    ObstacleGrid.h
+ @brief   Contains the definition of the ObstacleGrid class. Answers obstacle proximity queries from
+          precomputed per-cell obstacle lists.
+ */
+
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Vector2.h"
+
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief   A uniform grid over static obstacles.
+
+ For each cell, the grid stores every obstacle segment that lies within a fixed range of *some*
+ point in the cell, sorted by the minimum distance between the cell and the segment. An obstacle
+ query then reduces to a linear scan of the list of the cell containing the query point, which stops
+ as soon as the remaining segments are known to be out of range.
+
+ The grid can only answer queries whose range doesn't exceed the range for which it was built; see
+ obstacleQuery().
+ */
+class MENGE_API ObstacleGrid {
+ public:
+  /*!
+   @brief   Constructor.
+   */
+  ObstacleGrid();
+
+  /*!
+   @brief   Builds the grid on the given obstacles.
+
+   @param   obstacles   The obstacles to place in the grid.
+   @param   range       The maximum query range the grid must support.
+   @param   cellSize    The width of a grid cell. If non-positive, the range is used.
+   */
+  void build(const std::vector<Obstacle*>& obstacles, float range, float cellSize);
+
+  /*!
+   @brief   Removes all obstacles from the grid.
+   */
+  void clear();
+
+  /*!
+   @brief   Reports the maximum query range supported by the grid.
+   */
+  float getRange() const { return _range; }
+
+  /*!
+   @brief   Reports the number of cells in the grid.
+   */
+  size_t getCellCount() const { return _cells.size(); }
+
+  /*!
+   @brief   Computes the obstacles within range of the query point.
+
+   Reports the same obstacles as ObstacleKDTree::obstacleQuery() whose distance to the query point
+   is less than the query's range.
+
+   @param   query   A pointer for the query to be performed.
+   @returns True if the grid could answer the query; false if the query's range is larger than the
+            grid supports (in which case nothing is reported to the query).
+   */
+  bool obstacleQuery(ProximityQuery* query) const;
+
+ protected:
+  /*!
+   @brief   An obstacle segment stored in a grid cell.
+   */
+  struct Entry {
+    /*!
+     @brief   The squared minimum distance between the cell and the segment.
+     */
+    float _minDistSq;
+
+    /*!
+     @brief   The first end point of the segment.
+     */
+    Math::Vector2 _p0;
+
+    /*!
+     @brief   The second end point of the segment.
+     */
+    Math::Vector2 _p1;
+
+    /*!
+     @brief   The obstacle.
+     */
+    const Obstacle* _obstacle;
+
+    /*!
+     @brief   Orders entries by increasing minimum distance.
+     */
+    bool operator<(const Entry& e) const { return _minDistSq < e._minDistSq; }
+  };
+
+  /*!
+   @brief   Computes the index of the cell containing the given point.
+
+   @param   pt    The point.
+   @returns The index of the cell, or -1 if the point lies outside the grid.
+   */
+  int getCell(const Math::Vector2& pt) const;
+
+  /*!
+   @brief   The minimum corner of the grid.
+   */
+  Math::Vector2 _origin;
+
+  /*!
+   @brief   The width of a grid cell.
+   */
+  float _cellSize;
+
+  /*!
+   @brief   The number of columns in the grid.
+   */
+  int _cols;
+
+  /*!
+   @brief   The number of rows in the grid.
+   */
+  int _rows;
+
+  /*!
+   @brief   The maximum query range supported by the grid.
+   */
+  float _range;
+
+  /*!
+   @brief   The obstacle entries for each cell, stored in row-major order.
+   */
+  std::vector<std::vector<Entry> > _cells;
+
+  /*!
+   @brief   The maximum number of cells the grid will create. Larger scenes get coarser cells.
+   */
+  static const size_t MAX_CELLS = 1 << 20;
+};
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __OBSTACLE_GRID_H__
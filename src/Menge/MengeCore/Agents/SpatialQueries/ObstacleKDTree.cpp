@@ -54,7 +54,7 @@ using Math::Vector2;
 //                     Implementation of ObstacleKDTree
 /////////////////////////////////////////////////////////////////////////////
 
-ObstacleKDTree::ObstacleKDTree() : _obstacles(), _tree(0x0) {}
+ObstacleKDTree::ObstacleKDTree() : _obstacles(), _nodes(), _depth(0) {}
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -69,36 +69,147 @@ void ObstacleKDTree::buildTree(const std::vector<Obstacle*> obstacles) {
   if (_obstacles.size() > 0) {
     std::vector<Obstacle*> temp;
     temp.assign(_obstacles.begin(), _obstacles.end());
-    _tree = buildTreeRecursive(temp);
+    _nodes.reserve(2 * _obstacles.size());
+    buildTreeRecursive(temp, 1);
+    // Splitting obstacles changes the end points of the split obstacles; the segments are only
+    // final once the whole tree has been built.
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+      _nodes[i]._p0 = _nodes[i]._obstacle->getP0();
+      _nodes[i]._p1 = _nodes[i]._obstacle->getP1();
+    }
   }
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 void ObstacleKDTree::obstacleQuery(ProximityQuery* filter) const {
-  float range = filter->getMaxObstacleRange();
-  queryTreeRecursive(filter, filter->getQueryPoint(), range, _tree);
+  obstacleQuery<ProximityQuery>(filter);
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 bool ObstacleKDTree::linkIsTraversible(const Vector2& q1, const Vector2& q2, float radius) const {
-  return linkIsTraversibleRecursive(q1, q2, radius, _tree);
+  // The link is traversible if it is traversible with respect to every sub-tree pushed onto the
+  // stack; a single proof of non-traversibility is sufficient to return.
+  NodeStack stack(_depth + 1);
+  if (!_nodes.empty()) stack.push(0);
+  const float rad_sqd = sqr(radius);
+  while (!stack.empty()) {
+    const ObstacleTreeNode& node = _nodes[stack.pop()];
+
+    // Scaled signed distance to the obstacle's line; positive values are on the left of the
+    // obstacle. The distance is scaled by the obstacle's length.
+    const float q1LeftOfObst = leftOf(node._p0, node._p1, q1);
+    const float q2LeftOfObst = leftOf(node._p0, node._p1, q2);
+    const float invObstLengthSqd = 1.0f / absSq(node._p1 - node._p0);
+
+    if (q1LeftOfObst >= 0.0f && q2LeftOfObst >= 0.0f) {
+      // The link lies completely on the "left" side of the obstacle. To be traversible, it must
+      //   - be traversible w.r.t. all the obstacles on the left side AND
+      //   - be at least radius distance away from the obstacle's *line* OR
+      //     be traversible w.r.t. all the obstacles on the right side.
+      //     The "at least radius distance away from the line" is merely a performance
+      //     optimization.
+      // TODO(curds01): Neither this, nor the "completely-on-the-right" case do further tests
+      // against *this* obstacle and it is not clear why. Confirm in testing that this is
+      // correct.
+      stack.pushNode(node._left);
+      if (!(sqr(q1LeftOfObst) * invObstLengthSqd >= rad_sqd &&
+            sqr(q2LeftOfObst) * invObstLengthSqd >= rad_sqd)) {
+        stack.pushNode(node._right);
+      }
+    } else if (q1LeftOfObst <= 0.0f && q2LeftOfObst <= 0.0f) {
+      // The link lies completely on the "right" side of the obstacle. See note on the
+      // "completely-on-the-left-side" case.
+      stack.pushNode(node._right);
+      if (!(sqr(q1LeftOfObst) * invObstLengthSqd >= rad_sqd &&
+            sqr(q2LeftOfObst) * invObstLengthSqd >= rad_sqd)) {
+        stack.pushNode(node._left);
+      }
+    } else if (q1LeftOfObst >= 0.0f && q2LeftOfObst <= 0.0f) {
+      // One can traverse through obstacle from left to right.
+      stack.pushNode(node._left);
+      stack.pushNode(node._right);
+    } else {
+      // q1 on right, q2 on left. This crosses the *line* from outside to inside. Now it depends
+      // on where on the line the obstacle lies -- with radius of the crossing point?
+      const float point1LeftOfQ = leftOf(q1, q2, node._p0);
+      const float point2LeftOfQ = leftOf(q1, q2, node._p1);
+      const float invQLengthSqd = 1.0f / absSq(q2 - q1);
+
+      // Several conditions which make this traversible:
+      //  1. If the obstacle lies entirely on one side of the query link's line AND
+      //  2. The obstacle lies at least radius distance away from the line OR
+      //     q1 is closer than radius to the obstacle and q2 is greater than radius distance AND
+      //  3. It's traversible w.r.t. the right- and left-hand sides of the tree.
+      if (!(point1LeftOfQ * point2LeftOfQ >= 0.0f &&                // test condition 1
+            ((sqr(point1LeftOfQ) * invQLengthSqd > rad_sqd &&       // test condition 2
+              sqr(point2LeftOfQ) * invQLengthSqd > rad_sqd) ||      //        |
+             (sqr(q1LeftOfObst) * invObstLengthSqd <= rad_sqd &&    //        |
+              sqr(q2LeftOfObst) * invObstLengthSqd >= rad_sqd)))) {  //        |
+        return false;
+      }
+      stack.pushNode(node._left);  // test condition 3
+      stack.pushNode(node._right);
+    }
+  }
+  return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 bool ObstacleKDTree::queryVisibility(const Vector2& q1, const Vector2& q2, float radius) const {
-  return queryVisibilityRecursive(q1, q2, radius, _tree);
+  // NOTE: See linkIsTraversible for explanation of this code.
+  NodeStack stack(_depth + 1);
+  if (!_nodes.empty()) stack.push(0);
+  const float radSqd = sqr(radius);
+  while (!stack.empty()) {
+    const ObstacleTreeNode& node = _nodes[stack.pop()];
+
+    const float q1LeftOfI = leftOf(node._p0, node._p1, q1);
+    const float q2LeftOfI = leftOf(node._p0, node._p1, q2);
+    const float invLengthI = 1.0f / absSq(node._p1 - node._p0);
+
+    if (q1LeftOfI >= 0.0f && q2LeftOfI >= 0.0f) {
+      stack.pushNode(node._left);
+      if (!(sqr(q1LeftOfI) * invLengthI >= radSqd && sqr(q2LeftOfI) * invLengthI >= radSqd)) {
+        stack.pushNode(node._right);
+      }
+    } else if (q1LeftOfI <= 0.0f && q2LeftOfI <= 0.0f) {
+      stack.pushNode(node._right);
+      if (!(sqr(q1LeftOfI) * invLengthI >= radSqd && sqr(q2LeftOfI) * invLengthI >= radSqd)) {
+        stack.pushNode(node._left);
+      }
+    } else if (q1LeftOfI >= 0.0f && q2LeftOfI <= 0.0f) {
+      /* One can see through obstacle from left to right. */
+      stack.pushNode(node._left);
+      stack.pushNode(node._right);
+    } else {
+      const float point1LeftOfQ = leftOf(q1, q2, node._p0);
+      const float point2LeftOfQ = leftOf(q1, q2, node._p1);
+      const float invLengthQ = 1.0f / absSq(q2 - q1);
+
+      if (!(point1LeftOfQ * point2LeftOfQ >= 0.0f && sqr(point1LeftOfQ) * invLengthQ > radSqd &&
+            sqr(point2LeftOfQ) * invLengthQ > radSqd)) {
+        return false;
+      }
+      stack.pushNode(node._left);
+      stack.pushNode(node._right);
+    }
+  }
+  return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-ObstacleTreeNode* ObstacleKDTree::buildTreeRecursive(const std::vector<Obstacle*>& obstacles) {
+int ObstacleKDTree::buildTreeRecursive(const std::vector<Obstacle*>& obstacles, size_t depth) {
   if (obstacles.empty()) {
-    return 0x0;
+    return ObstacleTreeNode::NO_CHILD;
   } else {
-    ObstacleTreeNode* const node = new ObstacleTreeNode;
+    if (depth > _depth) _depth = depth;
+    // Nodes are added in pre-order; a node's left child immediately follows it.
+    const int nodeID = static_cast<int>(_nodes.size());
+    _nodes.push_back(ObstacleTreeNode());
 
     size_t optimalSplit = 0;
     size_t minLeft = obstacles.size();
@@ -211,178 +322,20 @@ ObstacleTreeNode* ObstacleKDTree::buildTreeRecursive(const std::vector<Obstacle*
       }
     }
 
-    node->_obstacle = obstacleI;
-    node->_left = buildTreeRecursive(leftObstacles);
-    node->_right = buildTreeRecursive(rightObstacles);
-    return node;
-  }
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-void ObstacleKDTree::queryTreeRecursive(ProximityQuery* filter, Vector2 pt, float& rangeSq,
-                                        const ObstacleTreeNode* node) const {
-  if (node == 0) {
-    return;
-  } else {
-    const Obstacle* const obstacle1 = node->_obstacle;
-
-    const Vector2 P0 = obstacle1->getP0();
-    const Vector2 P1 = obstacle1->getP1();
-
-    const float agentLeftOfLine = leftOf(P0, P1, pt);
-
-    queryTreeRecursive(filter, pt, rangeSq, (agentLeftOfLine >= 0.0f ? node->_left : node->_right));
-
-    const float distSqLine = sqr(agentLeftOfLine) / absSq(P1 - P0);
-
-    if (distSqLine < rangeSq) {
-      if (obstacle1->_doubleSided || agentLeftOfLine < 0.0f) {
-        /*
-         * Try obstacle at this node only if agent is on right side of
-         * obstacle (and can see obstacle).
-         */
-        float distSq =
-            distSqPointLineSegment(node->_obstacle->getP0(), node->_obstacle->getP1(), pt);
-
-        filter->filterObstacle(node->_obstacle, distSq);
-
-        rangeSq = filter->getMaxObstacleRange();
-      }
-
-      /* Try other side of line. */
-      queryTreeRecursive(filter, pt, rangeSq,
-                         (agentLeftOfLine >= 0.0f ? node->_right : node->_left));
-    }
-  }
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-bool ObstacleKDTree::linkIsTraversibleRecursive(const Vector2& q1, const Vector2& q2, float radius,
-                                                const ObstacleTreeNode* node) const {
-  if (node == nullptr) {
-    return true;
-  } else {
-    const Obstacle* const obstacle1 = node->_obstacle;
-    const Obstacle* const obstacle2 = obstacle1->_nextObstacle;
-
-    // Scaled signed distance to the obstacle's line; positive values are on the left of the
-    // obstacle. The distance is scaled by the obstacle's length.
-    const float q1LeftOfObst = leftOf(obstacle1->_point, obstacle2->_point, q1);
-    const float q2LeftOfObst = leftOf(obstacle1->_point, obstacle2->_point, q2);
-    const float invObstLengthSqd = 1.0f / absSq(obstacle2->_point - obstacle1->_point);
-    const float rad_sqd = sqr(radius);
-
-    // In all of these tests we hope for a proof of non-traversibility -- such a proof is
-    // sufficient to return without evaluating any more of the tree.
-
-    if (q1LeftOfObst >= 0.0f && q2LeftOfObst >= 0.0f) {
-      // The link lies completely on the "left" side of the obstacle. To be traversible, it must
-      //   - be traversible w.r.t. all the obstacles on the left side AND
-      //   - be at least radius distance away from the obstacle's *line* OR
-      //     be traversible w.r.t. all the obstacles on the right side.
-      //     The "at least radius distance away from the line" is merely a performance
-      //     optimization.
-      // TODO(curds01): Neither this, nor the "completely-on-the-right" case do further tests
-      // against *this* obstacle and it is not clear why. Confirm in testing that this is
-      // correct.
-      return linkIsTraversibleRecursive(q1, q2, radius, node->_left) &&
-             ((sqr(q1LeftOfObst) * invObstLengthSqd >= rad_sqd &&
-               sqr(q2LeftOfObst) * invObstLengthSqd >= rad_sqd) ||
-              linkIsTraversibleRecursive(q1, q2, radius, node->_right));
-    } else if (q1LeftOfObst <= 0.0f && q2LeftOfObst <= 0.0f) {
-      // The link lies completely on the "right" side of the obstacle. See note on the
-      // "completely-on-the-left-side" case.
-      return linkIsTraversibleRecursive(q1, q2, radius, node->_right) &&
-             ((sqr(q1LeftOfObst) * invObstLengthSqd >= rad_sqd &&
-               sqr(q2LeftOfObst) * invObstLengthSqd >= rad_sqd) ||
-              linkIsTraversibleRecursive(q1, q2, radius, node->_left));
-    } else if (q1LeftOfObst >= 0.0f && q2LeftOfObst <= 0.0f) {
-      // One can traverse through obstacle from left to right.
-      return linkIsTraversibleRecursive(q1, q2, radius, node->_left) &&
-             linkIsTraversibleRecursive(q1, q2, radius, node->_right);
-    } else {
-      // q1 on right, q2 on left. This crosses the *line* from outside to inside. Now it depends
-      // on where on the line the obstacle lies -- with radius of the crossing point?
-      const float point1LeftOfQ = leftOf(q1, q2, obstacle1->_point);
-      const float point2LeftOfQ = leftOf(q1, q2, obstacle2->_point);
-      const float invQLengthSqd = 1.0f / absSq(q2 - q1);
-
-      // Several conditions which make this traversible:
-      //  1. If the obstacle lies entirely on one side of the query link's line AND
-      //  2. The obstacle lies at least radius distance away from the line OR
-      //     q1 is closer than radius to the obstacle and q2 is greater than radius distance AND
-      //  3. It's traversible w.r.t. the right- and left-hand sides of the tree.
-      return (point1LeftOfQ * point2LeftOfQ >= 0.0f &&                    // test condition 1
-              ((sqr(point1LeftOfQ) * invQLengthSqd > rad_sqd &&           // test condition 2
-                sqr(point2LeftOfQ) * invQLengthSqd > rad_sqd) ||          //        |
-               (sqr(q1LeftOfObst) * invObstLengthSqd <= rad_sqd &&        //        |
-                sqr(q2LeftOfObst) * invObstLengthSqd >= rad_sqd)) &&      //        |
-              linkIsTraversibleRecursive(q1, q2, radius, node->_left) &&  // test condition 3
-              linkIsTraversibleRecursive(q1, q2, radius, node->_right));  //        |
-    }
-  }
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-bool ObstacleKDTree::queryVisibilityRecursive(const Vector2& q1, const Vector2& q2, float radius,
-                                              const ObstacleTreeNode* node) const {
-  // NOTE: See linkIsTraversible for explanation of this code.
-  if (node == 0) {
-    return true;
-  } else {
-    const Obstacle* const obstacle1 = node->_obstacle;
-    const Obstacle* const obstacle2 = obstacle1->_nextObstacle;
-
-    const float q1LeftOfI = leftOf(obstacle1->_point, obstacle2->_point, q1);
-    const float q2LeftOfI = leftOf(obstacle1->_point, obstacle2->_point, q2);
-    const float invLengthI = 1.0f / absSq(obstacle2->_point - obstacle1->_point);
-
-    if (q1LeftOfI >= 0.0f && q2LeftOfI >= 0.0f) {
-      return queryVisibilityRecursive(q1, q2, radius, node->_left) &&
-             ((sqr(q1LeftOfI) * invLengthI >= sqr(radius) &&
-               sqr(q2LeftOfI) * invLengthI >= sqr(radius)) ||
-              queryVisibilityRecursive(q1, q2, radius, node->_right));
-    } else if (q1LeftOfI <= 0.0f && q2LeftOfI <= 0.0f) {
-      return queryVisibilityRecursive(q1, q2, radius, node->_right) &&
-             ((sqr(q1LeftOfI) * invLengthI >= sqr(radius) &&
-               sqr(q2LeftOfI) * invLengthI >= sqr(radius)) ||
-              queryVisibilityRecursive(q1, q2, radius, node->_left));
-    } else if (q1LeftOfI >= 0.0f && q2LeftOfI <= 0.0f) {
-      /* One can see through obstacle from left to right. */
-      return queryVisibilityRecursive(q1, q2, radius, node->_left) &&
-             queryVisibilityRecursive(q1, q2, radius, node->_right);
-    } else {
-      const float point1LeftOfQ = leftOf(q1, q2, obstacle1->_point);
-      const float point2LeftOfQ = leftOf(q1, q2, obstacle2->_point);
-      const float invLengthQ = 1.0f / absSq(q2 - q1);
-
-      return (point1LeftOfQ * point2LeftOfQ >= 0.0f &&
-              sqr(point1LeftOfQ) * invLengthQ > sqr(radius) &&
-              sqr(point2LeftOfQ) * invLengthQ > sqr(radius) &&
-              queryVisibilityRecursive(q1, q2, radius, node->_left) &&
-              queryVisibilityRecursive(q1, q2, radius, node->_right));
-    }
+    _nodes[nodeID]._obstacle = obstacleI;
+    const int left = buildTreeRecursive(leftObstacles, depth + 1);
+    _nodes[nodeID]._left = left;
+    const int right = buildTreeRecursive(rightObstacles, depth + 1);
+    _nodes[nodeID]._right = right;
+    return nodeID;
   }
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 void ObstacleKDTree::deleteTree() {
-  deleteSubTree(_tree);
-  _tree = 0x0;
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-void ObstacleKDTree::deleteSubTree(ObstacleTreeNode* node) {
-  if (node != 0x0) {
-    deleteSubTree(node->_left);
-    deleteSubTree(node->_right);
-    delete node;
-  }
+  _nodes.clear();
+  _depth = 0;
 }
 }  // namespace Agents
 }  // namespace Menge
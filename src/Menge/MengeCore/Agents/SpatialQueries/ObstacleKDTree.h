@@ -47,12 +47,31 @@ class BaseAgent;
 
 /*!
  @brief   Defines an obstacle <i>k</i>d-tree node.
+
+ The nodes of a tree are stored contiguously in a single array; children are referenced by their
+ index in that array. The node's splitting segment is stored inline so that traversing the tree
+ only touches the obstacle when it is reported to a query.
  */
 struct ObstacleTreeNode {
   /*!
-   @brief   The left obstacle tree node.
+   @brief   The first end point of the node's obstacle segment.
+   */
+  Math::Vector2 _p0;
+
+  /*!
+   @brief   The second end point of the node's obstacle segment.
+   */
+  Math::Vector2 _p1;
+
+  /*!
+   @brief   The index of the left obstacle tree node (NO_CHILD if there is none).
+   */
+  int _left;
+
+  /*!
+   @brief   The index of the right obstacle tree node (NO_CHILD if there is none).
    */
-  ObstacleTreeNode* _left;
+  int _right;
 
   /*!
    @brief   The obstacle number.
@@ -60,9 +79,9 @@ struct ObstacleTreeNode {
   const Obstacle* _obstacle;
 
   /*!
-   @brief   The right obstacle tree node.
+   @brief   The index value indicating the absence of a child node.
    */
-  ObstacleTreeNode* _right;
+  static const int NO_CHILD = -1;
 };
 
 /*!
@@ -88,12 +107,30 @@ class MENGE_API ObstacleKDTree {
    */
   void buildTree(const std::vector<Obstacle*> obstacles);
 
+  /*!
+   @brief   Reports the obstacles in the tree, including the pieces of obstacles which were split
+            while building it.
+   */
+  const std::vector<Obstacle*>& getObstacles() const { return _obstacles; }
+
   /*!
    @brief   Computes the obstacles within range square of a point
    @param   query   A pointer for the query to be performed.
    */
   void obstacleQuery(ProximityQuery* query) const;
 
+  /*!
+   @brief   Computes the obstacles within range square of a point
+
+   The filter's functions are called through its static type, so an ExactProximityQuery avoids
+   virtual dispatch for every obstacle considered.
+
+   @param   filter    A pointer for the filter object.
+   @tparam  Filter    The filter type; ProximityQuery or an ExactProximityQuery.
+   */
+  template <class Filter>
+  void obstacleQuery(Filter* filter) const;
+
   /*!
    @brief   Implementation of SpatialQuery::linkIsTraversible().
    */
@@ -111,49 +148,69 @@ class MENGE_API ObstacleKDTree {
 
  protected:
   /*!
-   @brief   Does the full work of constructing the <i>k</i>d-tree.
+   @brief   The stack of node indices for an iterative traversal of the tree.
 
-   @param   obstacles   The set of obstacles to construct this tree around
-   @returns The root of the ObstacleKDTree for this set of obstacles
+   The stack of a traversal never holds more than a couple of entries per level of the tree. Stacks
+   for typical trees live on the call stack; deeper trees fall back to the heap.
    */
-  ObstacleTreeNode* buildTreeRecursive(const std::vector<Obstacle*>& obstacles);
+  class NodeStack {
+   public:
+    /*!
+     @brief   Constructor.
 
-  /*!
-   @brief   Computes the obstacle neighbors of the specified point by doing a recursive search.
+     @param   capacity    The maximum number of entries the stack must hold.
+     */
+    explicit NodeStack(size_t capacity) : _data(_local), _size(0) {
+      if (capacity > LOCAL_SIZE) {
+        _heap.resize(capacity);
+        _data = &_heap[0];
+      }
+    }
 
-   @param   query     A pointer to the query being performed.
-   @param   pt        The starting point from the query.
-   @param   rangeSq   The squared range around the agent.
-   @param   node      The current node in the obstacle tree.
-   */
-  void queryTreeRecursive(ProximityQuery* query, Math::Vector2 pt, float& rangeSq,
-                          const ObstacleTreeNode* node) const;
+    /*! @brief  Reports if the stack is empty. */
+    bool empty() const { return _size == 0; }
 
-  /*! @brief  Implementation of linkIsTraversible() via recursion.  */
-  bool linkIsTraversibleRecursive(const Math::Vector2& q1, const Math::Vector2& q2, float radius,
-                                  const ObstacleTreeNode* node) const;
-  /*!
-   @brief   Perform the work, recursively, to determine if q1 can see q2, w.r.t. the obstacles.
+    /*! @brief  Pushes the value onto the stack. */
+    void push(int value) { _data[_size++] = value; }
 
-   @param   q1      The originating position.
-   @param   q2      The target position.
-   @param   radius  The radius within which visibility is to be tested.
-   @param   node    The root of the tree to recursively search.
-   @returns True if q1 and q2 are mutually visible within the radius.
-   */
-  bool queryVisibilityRecursive(const Math::Vector2& q1, const Math::Vector2& q2, float radius,
-                                const ObstacleTreeNode* node) const;
+    /*! @brief  Pushes the node index onto the stack if it refers to an actual node. */
+    void pushNode(int node) {
+      if (node != ObstacleTreeNode::NO_CHILD) _data[_size++] = node;
+    }
+
+    /*! @brief  Pops the top value from the stack. */
+    int pop() { return _data[--_size]; }
+
+   private:
+    /*! @brief  The capacity of the stack-allocated buffer. */
+    static const size_t LOCAL_SIZE = 64;
+
+    /*! @brief  The stack-allocated buffer. */
+    int _local[LOCAL_SIZE];
+
+    /*! @brief  The heap-allocated buffer for deep trees. */
+    std::vector<int> _heap;
+
+    /*! @brief  The active buffer. */
+    int* _data;
+
+    /*! @brief  The number of entries on the stack. */
+    size_t _size;
+  };
 
   /*!
-   @brief   Recursively deletes the obstacle tree.
+   @brief   Does the full work of constructing the <i>k</i>d-tree.
+
+   @param   obstacles   The set of obstacles to construct this tree around
+   @param   depth       The depth of the node being constructed.
+   @returns The index of the root of the ObstacleKDTree for this set of obstacles
    */
-  void deleteTree();
+  int buildTreeRecursive(const std::vector<Obstacle*>& obstacles, size_t depth);
 
   /*!
-   @brief   Recursively deletes an obstacle sub-tree.
-   @param   node    The root of the tree to delete.
+   @brief   Deletes the obstacle tree.
    */
-  void deleteSubTree(ObstacleTreeNode* node);
+  void deleteTree();
 
   /*!
    @brief   The set of obstacles managed by this query structure.
@@ -164,15 +221,66 @@ class MENGE_API ObstacleKDTree {
   std::vector<Obstacle*> _obstacles;
 
   /*!
-   @brief   The query tree root.
+   @brief   The tree nodes; the root, if any, is the first node.
    */
-  ObstacleTreeNode* _tree;
+  std::vector<ObstacleTreeNode> _nodes;
+
+  /*!
+   @brief   The depth of the deepest node in the tree (the root has depth one).
+   */
+  size_t _depth;
 
   /*!
    @brief   The maximum number of obstacles allowed in a tree leaf node.
    */
   static const size_t MAX_LEAF_SIZE = 10;
 };
+
+////////////////////////////////////////////////////////////////
+//          Implementation of ObstacleKDTree templates
+////////////////////////////////////////////////////////////////
+
+template <class Filter>
+void ObstacleKDTree::obstacleQuery(Filter* filter) const {
+  if (_nodes.empty()) return;
+  const Math::Vector2 pt = filter->getQueryPoint();
+  float rangeSq = filter->getMaxObstacleRange();
+
+  // Each node is visited twice: on the way down (the near side of its line is searched first) and
+  // on the way back up (the node's obstacle and the far side are considered with the range as it
+  // stands after searching the near side). The second visit is encoded as the complement of the
+  // node's index.
+  NodeStack stack(2 * _depth + 2);
+  stack.push(0);
+  while (!stack.empty()) {
+    const int entry = stack.pop();
+    const ObstacleTreeNode& node = _nodes[entry >= 0 ? entry : ~entry];
+    const float agentLeftOfLine = leftOf(node._p0, node._p1, pt);
+    if (entry >= 0) {
+      stack.push(~entry);
+      stack.pushNode(agentLeftOfLine >= 0.0f ? node._left : node._right);
+    } else {
+      const float distSqLine = Math::sqr(agentLeftOfLine) / absSq(node._p1 - node._p0);
+
+      if (distSqLine < rangeSq) {
+        if (node._obstacle->_doubleSided || agentLeftOfLine < 0.0f) {
+          /*
+           * Try obstacle at this node only if agent is on right side of
+           * obstacle (and can see obstacle).
+           */
+          float distSq = distSqPointLineSegment(node._p0, node._p1, pt);
+
+          filter->filterObstacle(node._obstacle, distSq);
+
+          rangeSq = filter->getMaxObstacleRange();
+        }
+
+        /* Try other side of line. */
+        stack.pushNode(agentLeftOfLine >= 0.0f ? node._right : node._left);
+      }
+    }
+  }
+}
 }  // namespace Agents
 }  // namespace Menge
 #endif  //__OBSTACLE_KD_TREE_H__
@@ -108,6 +108,54 @@ class MENGE_API ProximityQuery {
    */
   virtual void filterObstacle(const Obstacle* obstacle, float distSq) = 0;
 };
+
+/*!
+ @brief    Adapts a proximity query whose concrete type is known at compile time.
+
+ The spatial queries' templated traversals (e.g., AgentKDTree::agentQuery()) accept either a
+ ProximityQuery, whose filter functions are dispatched virtually, or an ExactProximityQuery, whose
+ filter functions are called directly and can be inlined into the traversal.
+
+ The adapted query's dynamic type must be exactly Query; otherwise, overrides in more-derived types
+ are bypassed.
+
+ @tparam   Query    The concrete type of the adapted query.
+ */
+template <class Query>
+class ExactProximityQuery {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    query    The adapted query.
+   */
+  explicit ExactProximityQuery(Query* query) : _query(query) {}
+
+  /*! @brief  See ProximityQuery::getQueryPoint(). */
+  Math::Vector2 getQueryPoint() { return _query->Query::getQueryPoint(); }
+
+  /*! @brief  See ProximityQuery::getMaxAgentRange(). */
+  float getMaxAgentRange() { return _query->Query::getMaxAgentRange(); }
+
+  /*! @brief  See ProximityQuery::getMaxObstacleRange(). */
+  float getMaxObstacleRange() { return _query->Query::getMaxObstacleRange(); }
+
+  /*! @brief  See ProximityQuery::filterAgent(). */
+  void filterAgent(const BaseAgent* agent, float distSq) {
+    _query->Query::filterAgent(agent, distSq);
+  }
+
+  /*! @brief  See ProximityQuery::filterObstacle(). */
+  void filterObstacle(const Obstacle* obstacle, float distSq) {
+    _query->Query::filterObstacle(obstacle, distSq);
+  }
+
+ private:
+  /*!
+   @brief    The adapted query.
+   */
+  Query* _query;
+};
 }  // namespace Agents
 }  // namespace Menge
 #endif  // __PROXIMITY_QUERY_H__
@@ -55,5 +55,23 @@ void SpatialQuery::addObstacle(Obstacle* obs) {
   _obstacles.push_back(obs);
 }
 
+/////////////////////////////////////////////////////////////////////
+
+size_t SpatialQuery::addDynamicObstacle(const ObstacleVertexList& polyline, size_t obstacleClass) {
+  throw SpatialQueryException("This spatial query does not support dynamic obstacles.");
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SpatialQuery::removeDynamicObstacle(size_t id) {
+  throw SpatialQueryException("This spatial query does not support dynamic obstacles.");
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SpatialQuery::translateDynamicObstacle(size_t id, const Math::Vector2& delta) {
+  throw SpatialQueryException("This spatial query does not support dynamic obstacles.");
+}
+
 }  // namespace Agents
 }  // namespace Menge
@@ -25,6 +25,7 @@
 #define __SPATIAL_QUERY_H__
 
 #include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/ObstacleSets/ObstacleVertexList.h"
 #include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
 #include "MengeCore/CoreConfig.h"
 #include "MengeCore/Math/Vector2.h"
@@ -76,7 +77,9 @@ class MENGE_API SpatialQueryFatalException : public SpatialQueryException,
 };
 
 // FORWARD DECLARATIONS
+class AgentKDTree;
 class BaseAgent;
+class ObstacleKDTree;
 
 /*!
  @brief    The base class for performing spatial queries.
@@ -108,6 +111,9 @@ class MENGE_API SpatialQuery : public Element {
  public:
   /*!
    @brief      Define the set of agents on which query class will operate.
+
+   The agents are ordered by identifier (BaseAgent::_id). This is called again, replacing the
+   previous set, whenever the simulator moves its agents in memory.
    */
   virtual void setAgents(const std::vector<BaseAgent*>& agents) = 0;
 
@@ -137,6 +143,17 @@ class MENGE_API SpatialQuery : public Element {
    */
   virtual void agentQuery(ProximityQuery* query) const = 0;
 
+  /*!
+   @brief      Reports the <i>k</i>d-tree answering the agent queries, if there is one.
+
+   Simulators use the tree's templated query to call their agents' filter functions without virtual
+   dispatch. Spatial queries that answer agent queries by other means return null and are queried
+   through agentQuery().
+
+   @returns    A pointer to the tree, or null.
+   */
+  virtual const AgentKDTree* getAgentKDTree() const { return 0x0; }
+
   // Obstacle operations
 
   /*!
@@ -152,6 +169,17 @@ class MENGE_API SpatialQuery : public Element {
    */
   virtual void obstacleQuery(ProximityQuery* query) const = 0;
 
+  /*!
+   @brief      Reports the <i>k</i>d-tree answering the obstacle queries, if it answers them alone.
+
+   Simulators use the tree's templated query to call their agents' filter functions without virtual
+   dispatch. Spatial queries that answer obstacle queries by other means (or only partly with such a
+   tree) return null and are queried through obstacleQuery().
+
+   @returns    A pointer to the tree, or null.
+   */
+  virtual const ObstacleKDTree* getObstacleKDTree() const { return 0x0; }
+
   /*!
    @brief  Reports if an agent can traverse the straight-line path from `q1` to `q2`.
 
@@ -194,6 +222,42 @@ class MENGE_API SpatialQuery : public Element {
   virtual bool queryVisibility(const Math::Vector2& q1, const Math::Vector2& q2,
                                float radius) const = 0;
 
+  // Dynamic obstacle operations
+
+  /*!
+   @brief    Adds an obstacle polyline which can later be moved or removed.
+
+   Dynamic obstacles participate in all obstacle, traversibility and visibility queries. They must
+   not be added, moved or removed while agents are being updated. The default implementations of
+   the dynamic obstacle operations don't support dynamic obstacles: they all throw.
+
+   @param    polyline        The vertices of the polyline and whether it is closed.
+   @param    obstacleClass   The class of the obstacles (see ObstacleSet::setClass()).
+   @returns  The identifier of the new dynamic obstacle.
+   @throws   SpatialQueryException if dynamic obstacles are not supported or the polyline is
+            malformed.
+   */
+  virtual size_t addDynamicObstacle(const ObstacleVertexList& polyline, size_t obstacleClass = 1);
+
+  /*!
+   @brief    Removes a dynamic obstacle.
+
+   @param    id    The identifier of the dynamic obstacle (see addDynamicObstacle()).
+   @returns  True if the obstacle was removed, false if there is no such obstacle.
+   @throws   SpatialQueryException if dynamic obstacles are not supported.
+   */
+  virtual bool removeDynamicObstacle(size_t id);
+
+  /*!
+   @brief    Translates a dynamic obstacle.
+
+   @param    id       The identifier of the dynamic obstacle (see addDynamicObstacle()).
+   @param    delta    The displacement to apply to all of the obstacle's vertices.
+   @returns  True if the obstacle was moved, false if there is no such obstacle.
+   @throws   SpatialQueryException if dynamic obstacles are not supported.
+   */
+  virtual bool translateDynamicObstacle(size_t id, const Math::Vector2& delta);
+
   /*!
    @brief    Sets the spatial query to include visibility in finding agent neighbors.
 
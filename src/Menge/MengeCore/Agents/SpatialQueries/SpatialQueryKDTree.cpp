@@ -0,0 +1,153 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SpatialQueries/SpatialQueryKDTree.h"
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/ObstacleSets/ListObstacleSet.h"
+
+#include <cassert>
+
+namespace Menge {
+
+namespace Agents {
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of BergKDTree
+/////////////////////////////////////////////////////////////////////
+
+BergKDTree::~BergKDTree() {
+  HASH_MAP<size_t, std::vector<Obstacle*> >::iterator itr = _dynamicObstacles.begin();
+  for (; itr != _dynamicObstacles.end(); ++itr) {
+    for (size_t i = 0; i < itr->second.size(); ++i) {
+      delete itr->second[i];
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void BergKDTree::setAgents(const std::vector<BaseAgent*>& agents) {
+  _agentTree.setAgents(agents);
+  _maxNeighborDist = 0.f;
+  for (size_t i = 0; i < agents.size(); ++i) {
+    if (agents[i]->_neighborDist > _maxNeighborDist) {
+      _maxNeighborDist = agents[i]->_neighborDist;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+std::vector<int>& BergKDTree::dynamicStack() {
+  static thread_local std::vector<int> stack;
+  return stack;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void BergKDTree::processObstacles() {
+  _obstTree.buildTree(_obstacles);
+  if (_useObstacleGrid) {
+    // The tree may have split obstacles; the grid must hold the same pieces the tree reports.
+    _obstGrid.build(_obstTree.getObstacles(), _maxNeighborDist, _obstacleGridCellSize);
+  } else {
+    _obstGrid.clear();
+  }
+}
+
+size_t BergKDTree::addDynamicObstacle(const ObstacleVertexList& polyline, size_t obstacleClass) {
+  // The list obstacle set builds the linked segments exactly as it does for static obstacles.
+  ListObstacleSet* set = new ListObstacleSet();
+  set->setClass(obstacleClass);
+  try {
+    set->addObstacle(polyline);
+  } catch (ObstacleSetException& e) {
+    set->destroy();
+    throw SpatialQueryException(std::string("Invalid dynamic obstacle: ") + e.what());
+  }
+  const size_t id = _nextDynamicID++;
+  std::vector<Obstacle*>& segments = _dynamicObstacles[id];
+  for (size_t i = 0; i < set->obstacleCount(); ++i) {
+    Obstacle* obstacle = set->getObstacle(i);
+    segments.push_back(obstacle);
+    _dynamicTree.insert(obstacle);
+  }
+  set->destroy();
+  return id;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool BergKDTree::removeDynamicObstacle(size_t id) {
+  HASH_MAP<size_t, std::vector<Obstacle*> >::iterator itr = _dynamicObstacles.find(id);
+  if (itr == _dynamicObstacles.end()) return false;
+  for (size_t i = 0; i < itr->second.size(); ++i) {
+    _dynamicTree.remove(itr->second[i]);
+    delete itr->second[i];
+  }
+  _dynamicObstacles.erase(itr);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool BergKDTree::translateDynamicObstacle(size_t id, const Vector2& delta) {
+  HASH_MAP<size_t, std::vector<Obstacle*> >::iterator itr = _dynamicObstacles.find(id);
+  if (itr == _dynamicObstacles.end()) return false;
+  std::vector<Obstacle*>& segments = itr->second;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    segments[i]->_point += delta;
+  }
+  // Segments are only refit once all of their end points have moved.
+  for (size_t i = 0; i < segments.size(); ++i) {
+    _dynamicTree.refit(segments[i]);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Implementation of BergKDTreeFactory
+/////////////////////////////////////////////////////////////////////
+
+BergKDTreeFactory::BergKDTreeFactory() : SpatialQueryFactory() {
+  _obstGridID = _attrSet.addBoolAttribute("obstacle_grid", false /*required*/, false /*default*/);
+  _obstGridCellID =
+      _attrSet.addFloatAttribute("obstacle_grid_cell", false /*required*/, 0.f /*default*/);
+  _batchQueriesID =
+      _attrSet.addBoolAttribute("batch_agent_queries", false /*required*/, false /*default*/);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool BergKDTreeFactory::setFromXML(SpatialQuery* sQuery, TiXmlElement* node,
+                                   const std::string& behaveFldr) const {
+  BergKDTree* kdTree = dynamic_cast<BergKDTree*>(sQuery);
+  assert(kdTree != 0x0 && "Trying to set kd-tree properties on an incompatible object");
+
+  if (!SpatialQueryFactory::setFromXML(sQuery, node, behaveFldr)) {
+    return false;
+  }
+
+  kdTree->setObstacleGrid(_attrSet.getBool(_obstGridID), _attrSet.getFloat(_obstGridCellID));
+  kdTree->setBatchAgentQueries(_attrSet.getBool(_batchQueriesID));
+
+  return true;
+}
+}  // namespace Agents
+}  // namespace Menge
@@ -30,6 +30,8 @@
 #define __SPATIAL_QUERY_KD_TREE_H__
 
 #include "MengeCore/Agents/SpatialQueries/AgentKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/DynamicObstacleBVH.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleGrid.h"
 #include "MengeCore/Agents/SpatialQueries/ObstacleKDTree.h"
 #include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
 #include "MengeCore/Agents/SpatialQueries/SpatialQueryFactory.h"
@@ -42,13 +44,33 @@ namespace Agents {
  @brief    Spatial query object.
  
  Used to determine obstacles and agents near an agent -- based on a <i>k</i>d-tree.
+
+ Optionally, obstacle proximity queries are answered by an ObstacleGrid built over the obstacles for
+ the largest neighbor distance of the agents. Queries the grid can't answer (e.g., because an
+ agent's neighbor distance has since grown) fall back to the obstacle <i>k</i>d-tree.
+
+ Dynamic obstacles are kept in a DynamicObstacleBVH so that they can be added, moved and removed
+ without rebuilding the <i>k</i>d-tree.
  */
 class MENGE_API BergKDTree : public SpatialQuery {
  public:
   /*!
    @brief      Constructor.
    */
-  explicit BergKDTree() : SpatialQuery() {}
+  explicit BergKDTree()
+      : SpatialQuery(),
+        _useObstacleGrid(false),
+        _obstacleGridCellSize(0.f),
+        _maxNeighborDist(0.f),
+        _nextDynamicID(0) {}
+
+ protected:
+  /*!
+   @brief      Destructor.
+   */
+  virtual ~BergKDTree();
+
+ public:
 
   // Agent operations
 
@@ -57,7 +79,7 @@ class MENGE_API BergKDTree : public SpatialQuery {
 
    @param    agents    The set of agents in the simulator to be managed.
    */
-  virtual void setAgents(const std::vector<BaseAgent*>& agents) { _agentTree.setAgents(agents); }
+  virtual void setAgents(const std::vector<BaseAgent*>& agents);
 
   /*!
    @brief      Allows the spatial query structure to update its knowledge of the agent positions.
@@ -71,12 +93,17 @@ class MENGE_API BergKDTree : public SpatialQuery {
    */
   virtual void agentQuery(ProximityQuery* query) const { _agentTree.agentQuery(query); }
 
+  /*!
+   @brief      Implementation of SpatialQuery::getAgentKDTree().
+   */
+  virtual const AgentKDTree* getAgentKDTree() const { return &_agentTree; }
+
   // Obstacle operations
 
   /*!
    @brief      Do the necessary pre-computation to support obstacle definitions.
    */
-  virtual void processObstacles() { _obstTree.buildTree(_obstacles); }
+  virtual void processObstacles();
 
   /*!
    @brief      Perform an obstacle based proximity query.
@@ -84,11 +111,47 @@ class MENGE_API BergKDTree : public SpatialQuery {
    @param      query    A pointer to the proximity query to be performed.
 
    */
-  virtual void obstacleQuery(ProximityQuery* query) const { _obstTree.obstacleQuery(query); }
+  virtual void obstacleQuery(ProximityQuery* query) const {
+    if (!_useObstacleGrid || !_obstGrid.obstacleQuery(query)) _obstTree.obstacleQuery(query);
+    _dynamicTree.obstacleQuery(query, dynamicStack());
+  }
+
+  /*!
+   @brief      Implementation of SpatialQuery::getObstacleKDTree().
+
+   The obstacle <i>k</i>d-tree answers the obstacle queries alone unless the obstacle grid is used
+   or there are dynamic obstacles.
+   */
+  virtual const ObstacleKDTree* getObstacleKDTree() const {
+    return _useObstacleGrid || !_dynamicTree.empty() ? 0x0 : &_obstTree;
+  }
+
+  /*!
+   @brief      Sets whether obstacle queries use a precomputed obstacle grid.
+
+   Takes effect the next time the obstacles are processed.
+
+   @param      useGrid     True to use the grid.
+   @param      cellSize    The width of the grid cells; if non-positive, the largest agent neighbor
+                          distance is used.
+   */
+  void setObstacleGrid(bool useGrid, float cellSize) {
+    _useObstacleGrid = useGrid;
+    _obstacleGridCellSize = cellSize;
+  }
+
+  /*!
+   @brief      Sets whether simulators query the agent tree one leaf at a time (see
+              AgentKDTree::leafQuery()).
+
+   @param      batch     True to use batched queries.
+   */
+  void setBatchAgentQueries(bool batch) { _agentTree.setBatchQueries(batch); }
 
   /*! @brief  Implementation of SpatialQuery::linkIsTraversible().  */
   bool linkIsTraversible(const Math::Vector2& q1, const Vector2& q2, float radius) const override {
-    return _obstTree.linkIsTraversible(q1, q2, radius);
+    return _obstTree.linkIsTraversible(q1, q2, radius) &&
+           _dynamicTree.linkIsTraversible(q1, q2, radius, dynamicStack());
   }
 
   /*!
@@ -100,10 +163,46 @@ class MENGE_API BergKDTree : public SpatialQuery {
    @returns    True if q1 and q2 are mutually visible within the radius.
    */
   virtual bool queryVisibility(const Vector2& q1, const Vector2& q2, float radius) const {
-    return _obstTree.queryVisibility(q1, q2, radius);
+    return _obstTree.queryVisibility(q1, q2, radius) &&
+           _dynamicTree.queryVisibility(q1, q2, radius, dynamicStack());
   }
 
+  // Dynamic obstacle operations
+
+  /*!
+   @brief    Adds an obstacle polyline which can later be moved or removed.
+
+   @param    polyline        The vertices of the polyline and whether it is closed.
+   @param    obstacleClass   The class of the obstacles (see ObstacleSet::setClass()).
+   @returns  The identifier of the new dynamic obstacle.
+   @throws   SpatialQueryException if the polyline is malformed.
+   */
+  virtual size_t addDynamicObstacle(const ObstacleVertexList& polyline, size_t obstacleClass = 1);
+
+  /*!
+   @brief    Removes a dynamic obstacle.
+
+   @param    id    The identifier of the dynamic obstacle (see addDynamicObstacle()).
+   @returns  True if the obstacle was removed, false if there is no such obstacle.
+   */
+  virtual bool removeDynamicObstacle(size_t id);
+
+  /*!
+   @brief    Translates a dynamic obstacle.
+
+   @param    id       The identifier of the dynamic obstacle (see addDynamicObstacle()).
+   @param    delta    The displacement to apply to all of the obstacle's vertices.
+   @returns  True if the obstacle was moved, false if there is no such obstacle.
+   */
+  virtual bool translateDynamicObstacle(size_t id, const Math::Vector2& delta);
+
  protected:
+  /*!
+   @brief      Returns the calling thread's stack for traversing the dynamic obstacle hierarchy. It
+              is reused by every query so that queries do not allocate.
+   */
+  static std::vector<int>& dynamicStack();
+
   /*!
    @brief      A kd-tree for the agent queries.
    */
@@ -113,6 +212,42 @@ class MENGE_API BergKDTree : public SpatialQuery {
    @brief      A kd-tree for the obstacle queries.
    */
   ObstacleKDTree _obstTree;
+
+  /*!
+   @brief      The optional grid for the obstacle queries.
+   */
+  ObstacleGrid _obstGrid;
+
+  /*!
+   @brief      Determines if the obstacle grid is used.
+   */
+  bool _useObstacleGrid;
+
+  /*!
+   @brief      The width of the obstacle grid's cells (non-positive for the default).
+   */
+  float _obstacleGridCellSize;
+
+  /*!
+   @brief      The largest neighbor distance of the agents (the range of the obstacle grid).
+   */
+  float _maxNeighborDist;
+
+  /*!
+   @brief      The hierarchy for the dynamic obstacles.
+   */
+  DynamicObstacleBVH _dynamicTree;
+
+  /*!
+   @brief      The obstacle segments of each dynamic obstacle, keyed by identifier. The spatial
+              query owns them.
+   */
+  HASH_MAP<size_t, std::vector<Obstacle*> > _dynamicObstacles;
+
+  /*!
+   @brief      The identifier of the next dynamic obstacle.
+   */
+  size_t _nextDynamicID;
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -122,6 +257,11 @@ class MENGE_API BergKDTree : public SpatialQuery {
  */
 class MENGE_API BergKDTreeFactory : public SpatialQueryFactory {
  public:
+  /*!
+   @brief    Constructor.
+   */
+  BergKDTreeFactory();
+
   /*!
    @brief    The name of the spatial query implemenation.
 
@@ -156,6 +296,35 @@ class MENGE_API BergKDTreeFactory : public SpatialQueryFactory {
    @returns    A pointer to a newly instantiated SpatialQuery class.
    */
   SpatialQuery* instance() const { return new BergKDTree(); }
+
+  /*!
+   @brief    Given a pointer to a SpatialQuery instance, sets the appropriate fields from the
+            provided XML node.
+
+   @param    sQuery        A pointer to the spatial query whose attributes are to be set.
+   @param    node          The XML node containing the spatial query attributes.
+   @param    behaveFldr    The path to the behavior file. If the condition references resources in
+                          the file system, it should be defined relative to the behavior file
+                          location. This is the folder containing that path.
+   @returns  A boolean reporting success (true) or failure (false).
+   */
+  virtual bool setFromXML(SpatialQuery* sQuery, TiXmlElement* node,
+                          const std::string& behaveFldr) const;
+
+  /*!
+   @brief    The identifier for the "obstacle_grid" bool attribute.
+   */
+  size_t _obstGridID;
+
+  /*!
+   @brief    The identifier for the "obstacle_grid_cell" float attribute.
+   */
+  size_t _obstGridCellID;
+
+  /*!
+   @brief    The identifier for the "batch_agent_queries" bool attribute.
+   */
+  size_t _batchQueriesID;
 };
 }  // namespace Agents
 }  // namespace Menge
@@ -40,6 +40,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/BFSM/Tasks/NavMeshLocalizerTask.h"
+#include "MengeCore/Runtime/ScratchArena.h"
 #include "MengeCore/Runtime/os.h"
 #include "MengeCore/resources/NavMeshEdge.h"
 #include "MengeCore/resources/NavMeshLocalizer.h"
@@ -48,6 +49,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include <cassert>
 #include <list>
 #include <queue>
+#include <set>
 
 namespace Menge {
 
@@ -211,7 +213,7 @@ NavMeshSpatialQuery::NavMeshSpatialQuery() : _localizer(0x0) {}
 ////////////////////////////////////////////////////////////////
 
 void NavMeshSpatialQuery::setAgents(const std::vector<BaseAgent*>& agents) {
-  _agents.insert(_agents.begin(), agents.begin(), agents.end());
+  _agents.assign(agents.begin(), agents.end());
 }
 
 ////////////////////////////////////////////////////////////////
@@ -248,12 +250,13 @@ void NavMeshSpatialQuery::agentQuery(ProximityQuery* filter, float& rangeSq) con
   }
 
   NavMeshPtr navMesh = _localizer->getNavMesh();
+  ScratchArena::Scope scope;
   // Track which nodes have been visited
-  std::set<unsigned int> visited;
+  std::set<unsigned int, std::less<unsigned int>, ScratchAllocator<unsigned int> > visited;
   visited.insert((unsigned int)currNode);
   // now create a min heap of nearby navigation mesh nodes to explore for neighbor
   // candidates
-  std::list<NeighborEntry> queue;
+  std::list<NeighborEntry, ScratchAllocator<NeighborEntry> > queue;
 
   // seed the queue with this node's adjacent nodes
   const NavMeshNode& node = navMesh->getNode((unsigned int)currNode);
@@ -384,7 +387,9 @@ void NavMeshSpatialQuery::obstacleQuery(ProximityQuery* filter, float rangeSq) c
 /////////////////////////////////////////////////////////////////////
 
 BFSM::Task* NavMeshSpatialQuery::getTask() {
-  return new BFSM::NavMeshLocalizerTask(_localizer->getNavMesh()->getName(), false /*usePlanner*/);
+  const NavMeshPtr navMesh = _localizer->getNavMesh();
+  return new BFSM::NavMeshLocalizerTask(navMesh->getName(), false /*usePlanner*/,
+                                        navMesh->isReordered());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -393,6 +398,7 @@ BFSM::Task* NavMeshSpatialQuery::getTask() {
 
 NavMeshSpatialQueryFactory::NavMeshSpatialQueryFactory() : SpatialQueryFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -413,7 +419,7 @@ bool NavMeshSpatialQueryFactory::setFromXML(SpatialQuery* sq, TiXmlElement* node
   // nav mesh localizer
   NavMeshLocalizerPtr nmlPtr;
   try {
-    nmlPtr = loadNavMeshLocalizer(fName, true);
+    nmlPtr = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh localizer "
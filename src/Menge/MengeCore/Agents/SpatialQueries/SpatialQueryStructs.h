@@ -83,6 +83,36 @@ struct NearObstacle {
   NearObstacle(float sqdDist, const Obstacle* obs) : distanceSquared(sqdDist), obstacle(obs){};
 };
 
+/*!
+ @brief    Inserts a result into a list of at most `capacity` results, sorted nearest first.
+
+ If the list is full, the result replaces the farthest result, unless it is farther still. Results
+ at equal distances remain in the order they were inserted. The list never holds more than
+ `capacity` results, so once its storage has been reserved, insertion doesn't allocate.
+
+ The proximity queries receive their candidates roughly nearest first, so this outperforms a
+ bounded max-heap for neighbor counts in the tens: most insertions shift few, if any, results.
+
+ @param    results      The sorted list of results.
+ @param    capacity     The maximum number of results in the list.
+ @param    result       The result to insert (see NearAgent and NearObstacle).
+ @tparam   Result       The type of the results.
+ */
+template <class Result>
+inline void insertNearest(std::vector<Result>& results, size_t capacity, const Result& result) {
+  if (results.size() == capacity) {
+    if (capacity == 0 || !(result.distanceSquared <= results.back().distanceSquared)) return;
+  } else {
+    results.push_back(result);
+  }
+  size_t i = results.size() - 1;
+  while (i != 0 && result.distanceSquared < results[i - 1].distanceSquared) {
+    results[i] = results[i - 1];
+    --i;
+  }
+  results[i] = result;
+}
+
 }  // namespace Agents
 }  // namespace Menge
 #endif  // __SPATIAL_QUERY_STRUCTS_H__
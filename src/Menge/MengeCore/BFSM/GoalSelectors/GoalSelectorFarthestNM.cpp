@@ -116,7 +116,8 @@ Goal* FarthestNMGoalSelector::getGoal(const Agents::BaseAgent* agent) const {
 /////////////////////////////////////////////////////////////////////
 
 BFSM::Task* FarthestNMGoalSelector::getTask() {
-  return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/);
+  return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/,
+                                  _navMesh->isReordered());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -125,6 +126,7 @@ BFSM::Task* FarthestNMGoalSelector::getTask() {
 
 FarthestNMGoalSelectorFactory::FarthestNMGoalSelectorFactory() : SetGoalSelectorFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -145,7 +147,7 @@ bool FarthestNMGoalSelectorFactory::setFromXML(GoalSelector* selector, TiXmlElem
   // nav mesh
   NavMeshPtr nmPtr;
   try {
-    nmPtr = loadNavMesh(fName);
+    nmPtr = loadNavMesh(fName, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG;
     logger << "Couldn't instantiate the navigation mesh referenced on line ";
@@ -156,7 +158,7 @@ bool FarthestNMGoalSelectorFactory::setFromXML(GoalSelector* selector, TiXmlElem
   // nav mesh localizer
   NavMeshLocalizerPtr nmlPtr;
   try {
-    nmlPtr = loadNavMeshLocalizer(fName, true);
+    nmlPtr = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG;
     logger << "Couldn't instantiate the navigation mesh localizer required by the "
@@ -118,7 +118,8 @@ Goal* NearestNMGoalSelector::getGoal(const Agents::BaseAgent* agent) const {
 /////////////////////////////////////////////////////////////////////
 
 BFSM::Task* NearestNMGoalSelector::getTask() {
-  return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/);
+  return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/,
+                                  _navMesh->isReordered());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -127,6 +128,7 @@ BFSM::Task* NearestNMGoalSelector::getTask() {
 
 NearestNMGoalSelectorFactory::NearestNMGoalSelectorFactory() : SetGoalSelectorFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -147,7 +149,7 @@ bool NearestNMGoalSelectorFactory::setFromXML(GoalSelector* selector, TiXmlEleme
   // nav mesh
   NavMeshPtr nmPtr;
   try {
-    nmPtr = loadNavMesh(fName);
+    nmPtr = loadNavMesh(fName, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG;
     logger << "Couldn't instantiate the navigation mesh referenced on line ";
@@ -158,7 +160,7 @@ bool NearestNMGoalSelectorFactory::setFromXML(GoalSelector* selector, TiXmlEleme
   // nav mesh localizer
   NavMeshLocalizerPtr nmlPtr;
   try {
-    nmlPtr = loadNavMeshLocalizer(fName, true);
+    nmlPtr = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh localizer "
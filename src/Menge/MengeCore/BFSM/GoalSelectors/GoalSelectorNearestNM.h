@@ -160,6 +160,11 @@ class MENGE_API NearestNMGoalSelectorFactory : public SetGoalSelectorFactory {
    @brief    The identifier for the "file_name" string attribute.
    */
   size_t _fileNameID;
+
+  /*!
+   @brief    The identifier for the "reorder_mesh" bool attribute.
+   */
+  size_t _reorderID;
 };
 }  // namespace BFSM
 }  // namespace Menge
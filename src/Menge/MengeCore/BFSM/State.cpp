@@ -142,14 +142,15 @@ void State::updateVelCompForMovingGoals(Agents::BaseAgent* agent) {
 /////////////////////////////////////////////////////////////////////
 
 State* State::testTransitions(Agents::BaseAgent* agent) {
-  std::set<State*> visited;
+  ScratchArena::Scope scope;
+  StateSet visited;
   State* newNode = testTransitions(agent, visited);
   return newNode;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-State* State::testTransitions(Agents::BaseAgent* agent, std::set<State*>& visited) {
+State* State::testTransitions(Agents::BaseAgent* agent, StateSet& visited) {
 #ifdef _DEBUG
   _goalLock.lockRead();
   assert(_goals.count(agent->_id) == 1 && "Testing transitions for an agent without a goal!");
@@ -32,6 +32,7 @@
 #include "MengeCore/BFSM/VelocityModifiers/VelModifier.h"
 #include "MengeCore/MengeException.h"
 #include "MengeCore/Runtime/ReadersWriterLock.h"
+#include "MengeCore/Runtime/ScratchArena.h"
 
 #include <cassert>
 #include <set>
@@ -286,6 +287,12 @@ class State {
   const Goal* getGoal(size_t goalId) { return _goals[goalId]; }
 
  protected:
+  /*!
+   @brief    The set of states visited while testing transitions; allocated from the calling
+            thread's ScratchArena.
+   */
+  typedef std::set<State*, std::less<State*>, ScratchAllocator<State*> > StateSet;
+
   /*!
    @brief    Test the transitions out of this state, tracking cycles.
 
@@ -297,7 +304,7 @@ class State {
    @returns    A pointer to the next state if a transition is active, otherwise, it returns NULL,
               meaning the agent remains in this state.
    */
-  State* testTransitions(Agents::BaseAgent* agent, std::set<State*>& visited);
+  State* testTransitions(Agents::BaseAgent* agent, StateSet& visited);
 
   /*!
    @brief    The single velocity component associated with this state.
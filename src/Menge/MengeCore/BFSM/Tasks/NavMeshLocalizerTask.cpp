@@ -52,9 +52,10 @@ namespace BFSM {
 //                   Implementation of NavMeshLocalizerTask
 /////////////////////////////////////////////////////////////////////
 
-NavMeshLocalizerTask::NavMeshLocalizerTask(const std::string& navMeshName, bool usePlanner)
+NavMeshLocalizerTask::NavMeshLocalizerTask(const std::string& navMeshName, bool usePlanner,
+                                           bool reorder)
     : Task() {
-  _localizer = loadNavMeshLocalizer(navMeshName, usePlanner);
+  _localizer = loadNavMeshLocalizer(navMeshName, usePlanner, reorder);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -51,8 +51,10 @@ class MENGE_API NavMeshLocalizerTask : public Task {
 
    @param    navMeshName    The name of the navigation mesh which the task depends on.
    @param    usePlanner    Indicates if the localizer should use a planner (true) or not (false).
+   @param    reorder       Indicates if the navigation mesh is reordered for spatial locality (see
+                          NavMesh::loadReordered()).
    */
-  NavMeshLocalizerTask(const std::string& navMeshName, bool usePlanner);
+  NavMeshLocalizerTask(const std::string& navMeshName, bool usePlanner, bool reorder = false);
 
   /*!
    @brief    The work performed by the task.
@@ -103,7 +103,8 @@ void NavMeshVelComponent::setPrefVelocity(const Agents::BaseAgent* agent, const
 /////////////////////////////////////////////////////////////////////
 
 BFSM::Task* NavMeshVelComponent::getTask() {
-  return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/);
+  return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/,
+                                  _navMesh->isReordered());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -130,6 +131,7 @@ void NavMeshVelComponent::doUpdateGoal(const Agents::BaseAgent* agent, const Goa
 
 NavMeshVCFactory::NavMeshVCFactory() : VelCompFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _reorderID = _attrSet.addBoolAttribute("reorder_mesh", false /*required*/, false /*default*/);
   _headingID = _attrSet.addFloatAttribute("heading_threshold", false /*required*/, 180.f);
 }
 
@@ -152,7 +154,7 @@ bool NavMeshVCFactory::setFromXML(VelComponent* vc, TiXmlElement* node,
   // nav mesh
   NavMeshPtr nmPtr;
   try {
-    nmPtr = loadNavMesh(fName);
+    nmPtr = loadNavMesh(fName, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG;
     logger << "Couldn't instantiate the navigation mesh referenced on line ";
@@ -163,7 +165,7 @@ bool NavMeshVCFactory::setFromXML(VelComponent* vc, TiXmlElement* node,
   // nav mesh localizer
   NavMeshLocalizerPtr nmlPtr;
   try {
-    nmlPtr = loadNavMeshLocalizer(fName, true);
+    nmlPtr = loadNavMeshLocalizer(fName, true, _attrSet.getBool(_reorderID));
   } catch (ResourceException) {
     logger << Logger::ERR_MSG
            << "Couldn't instantiate the navigation mesh localizer "
@@ -228,6 +228,11 @@ class MENGE_API NavMeshVCFactory : public VelCompFactory {
    */
   size_t _fileNameID;
 
+  /*!
+   @brief    The identifier for the "reorder_mesh" bool attribute.
+   */
+  size_t _reorderID;
+
   /*!
    @brief    The identifier for the "heading_threshold" float attribute.
    */
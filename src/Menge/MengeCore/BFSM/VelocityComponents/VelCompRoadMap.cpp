@@ -171,6 +171,7 @@ void RoadMapVelComponent::doUpdateGoal(const Agents::BaseAgent* agent, const Goa
 
 RoadMapVCFactory::RoadMapVCFactory() : VelCompFactory() {
   _fileNameID = _attrSet.addStringAttribute("file_name", true /*required*/);
+  _pathTreesID = _attrSet.addBoolAttribute("path_trees", false /*required*/, false /*default*/);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -197,6 +198,8 @@ bool RoadMapVCFactory::setFromXML(VelComponent* vc, TiXmlElement* node,
     logger << node->Row() << ".";
     return false;
   }
+  // The graph is shared; if any velocity component asks for shortest-path trees, all use them.
+  if (_attrSet.getBool(_pathTreesID)) gPtr->setUseShortestPathTrees(true);
   rmvc->setRoadMap(gPtr);
 
   return true;
@@ -230,6 +230,11 @@ class MENGE_API RoadMapVCFactory : public VelCompFactory {
    @brief    The identifier for the "file_name" string attribute.
    */
   size_t _fileNameID;
+
+  /*!
+   @brief    The identifier for the "path_trees" bool attribute.
+   */
+  size_t _pathTreesID;
 };
 }  // namespace BFSM
 }  // namespace Menge
@@ -0,0 +1,81 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    SpaceFillingCurve.h
+ @brief   Utilities for mapping planar points onto a space-filling curve.
+
+ Sorting elements by their position along a space-filling curve places elements which are close in
+ space close in memory.
+ */
+
+#ifndef __SPACE_FILLING_CURVE_H__
+#define __SPACE_FILLING_CURVE_H__
+
+#include "MengeCore/Math/Vector2.h"
+#include "MengeCore/Math/consts.h"
+
+#include <stdint.h>
+
+namespace Menge {
+
+namespace Math {
+
+/*!
+ @brief    Spreads the lower 16 bits of the given value so that there is a zero bit between each
+          pair of bits.
+
+ @param    v    The value to spread.
+ @returns  The spread value.
+ */
+inline uint32_t spreadBits16(uint32_t v) {
+  v &= 0x0000ffff;
+  v = (v | (v << 8)) & 0x00ff00ff;
+  v = (v | (v << 4)) & 0x0f0f0f0f;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+/*!
+ @brief    Computes the Morton (Z-order) key for the point p in the given bounding box.
+
+ The box is quantized into a 2^16 x 2^16 grid; points outside the box are clamped to it.
+
+ @param    p         The point to compute the key for.
+ @param    minPt     The minimum corner of the bounding box.
+ @param    maxPt     The maximum corner of the bounding box.
+ @returns  The Morton key of the point.
+ */
+inline uint32_t mortonKey(const Vector2& p, const Vector2& minPt, const Vector2& maxPt) {
+  const float CELLS = 65535.f;
+  float w = maxPt._x - minPt._x;
+  float h = maxPt._y - minPt._y;
+  float x = w > EPS ? (p._x - minPt._x) / w : 0.f;
+  float y = h > EPS ? (p._y - minPt._y) / h : 0.f;
+  x = x < 0.f ? 0.f : (x > 1.f ? 1.f : x);
+  y = y < 0.f ? 0.f : (y > 1.f ? 1.f : y);
+  uint32_t ix = static_cast<uint32_t>(x * CELLS);
+  uint32_t iy = static_cast<uint32_t>(y * CELLS);
+  return spreadBits16(ix) | (spreadBits16(iy) << 1);
+}
+
+}  // namespace Math
+}  // namespace Menge
+
+#endif  // __SPACE_FILLING_CURVE_H__
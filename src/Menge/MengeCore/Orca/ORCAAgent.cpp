@@ -340,77 +340,17 @@ size_t Agent::computeORCALines() {
   const size_t numObstLines = _orcaLines.size();
 
   const float invTimeHorizon = 1.0f / _timeHorizon;
+  const float invTimeStep = 1.0f / Simulator::TIME_STEP;
 
   /* Create agent ORCA lines. */
+  _nbrBatch.clear();
   for (size_t i = 0; i < _nearAgents.size(); ++i) {
     const Agent* const other = static_cast<const Agent*>(_nearAgents[i].agent);
-
-    const Vector2 relativePosition = other->_pos - _pos;
-    const Vector2 relativeVelocity = _vel - other->_vel;
-
-    const float distSq = absSq(relativePosition);
-    const float combinedRadius = _radius + other->_radius;
-    const float combinedRadiusSq = sqr(combinedRadius);
-
-    Menge::Math::Line line;
-    Vector2 u;
-
-    if (distSq > combinedRadiusSq) {
-      /* No collision. */
-      const Vector2 w = relativeVelocity - invTimeHorizon * relativePosition;
-      /* Vector from cutoff center to relative velocity. */
-      const float wLengthSq = absSq(w);
-
-      const float dotProduct1 = w * relativePosition;
-
-      if (dotProduct1 < 0.0f && sqr(dotProduct1) > combinedRadiusSq * wLengthSq) {
-        /* Project on cut-off circle. */
-        const float wLength = std::sqrt(wLengthSq);
-        const Vector2 unitW = w / wLength;
-
-        line._direction = Vector2(unitW.y(), -unitW.x());
-        u = (combinedRadius * invTimeHorizon - wLength) * unitW;
-      } else {
-        /* Project on legs. */
-        const float leg = std::sqrt(distSq - combinedRadiusSq);
-
-        if (det(relativePosition, w) > 0.0f) {
-          /* Project on left leg. */
-          line._direction =
-              Vector2(relativePosition.x() * leg - relativePosition.y() * combinedRadius,
-                      relativePosition.x() * combinedRadius + relativePosition.y() * leg) /
-              distSq;
-        } else {
-          /* Project on right leg. */
-          line._direction =
-              -Vector2(relativePosition.x() * leg + relativePosition.y() * combinedRadius,
-                       -relativePosition.x() * combinedRadius + relativePosition.y() * leg) /
-              distSq;
-        }
-
-        const float dotProduct2 = relativeVelocity * line._direction;
-
-        u = dotProduct2 * line._direction - relativeVelocity;
-      }
-
-      line._point = _vel + 0.5f * u;
-    } else {
-      /* Collision. Project on cut-off circle of time timeStep. */
-      const float invTimeStep = 1.0f / Simulator::TIME_STEP;
-
-      /* Vector from cutoff center to relative velocity. */
-      const Vector2 w = relativeVelocity - invTimeStep * relativePosition;
-
-      const float wLength = abs(w);
-      const Vector2 unitW = w / wLength;
-
-      line._direction = Vector2(unitW.y(), -unitW.x());
-      u = (combinedRadius * invTimeStep - wLength) * unitW;
-      float coopWeight = 0.5f;
-      line._point = _vel + coopWeight * u;
-    }
-
-    _orcaLines.push_back(line);
+    _nbrBatch.add(other->_pos - _pos, _vel - other->_vel, _radius + other->_radius);
+  }
+  _orcaLines.resize(numObstLines + _nbrBatch.size());
+  if (!_nbrBatch.empty()) {
+    computeAgentLines(_nbrBatch, _vel, invTimeHorizon, invTimeStep, &_orcaLines[numObstLines]);
   }
   return numObstLines;
 }
@@ -451,32 +391,8 @@ bool linearProgram1(const std::vector<Menge::Math::Line>& lines, size_t lineNo,
   float tLeft = -dotProduct - sqrtDiscriminant;
   float tRight = -dotProduct + sqrtDiscriminant;
 
-  for (size_t i = 0; i < lineNo; ++i) {
-    const float denominator = det(lines[lineNo]._direction, lines[i]._direction);
-    const float numerator = det(lines[i]._direction, lines[lineNo]._point - lines[i]._point);
-
-    if (std::fabs(denominator) <= Menge::EPS) {
-      /* Lines lineNo and i are (almost) parallel. */
-      if (numerator < 0.0f) {
-        return false;
-      } else {
-        continue;
-      }
-    }
-
-    const float t = numerator / denominator;
-
-    if (denominator >= 0.0f) {
-      /* Line i bounds line lineNo on the right. */
-      tRight = std::min(tRight, t);
-    } else {
-      /* Line i bounds line lineNo on the left. */
-      tLeft = std::max(tLeft, t);
-    }
-
-    if (tLeft > tRight) {
-      return false;
-    }
+  if (!clipLine(lines, lineNo, tLeft, tRight)) {
+    return false;
   }
 
   if (directionOpt) {
@@ -522,14 +438,13 @@ size_t linearProgram2(const std::vector<Menge::Math::Line>& lines, float radius,
     result = optVelocity;
   }
 
-  for (size_t i = 0; i < lines.size(); ++i) {
-    if (det(lines[i]._direction, lines[i]._point - result) > 0.0f) {
-      /* Result does not satisfy constraint i. Compute new optimal result. */
-      const Vector2 tempResult = result;
-      if (!linearProgram1(lines, i, radius, optVelocity, directionOpt, result)) {
-        result = tempResult;
-        return i;
-      }
+  for (size_t i = findViolatedLine(lines, 0, result); i < lines.size();
+       i = findViolatedLine(lines, i + 1, result)) {
+    /* Result does not satisfy constraint i. Compute new optimal result. */
+    const Vector2 tempResult = result;
+    if (!linearProgram1(lines, i, radius, optVelocity, directionOpt, result)) {
+      result = tempResult;
+      return i;
     }
   }
 
@@ -541,11 +456,13 @@ size_t linearProgram2(const std::vector<Menge::Math::Line>& lines, float radius,
 void linearProgram3(const std::vector<Menge::Math::Line>& lines, size_t numObstLines,
                     size_t beginLine, float radius, Vector2& result) {
   float distance = 0.0f;
+  // Reused across calls so that the projected constraints do not allocate in the steady state.
+  static thread_local std::vector<Menge::Math::Line> projLines;
 
   for (size_t i = beginLine; i < lines.size(); ++i) {
     if (det(lines[i]._direction, lines[i]._point - result) > distance) {
       /* Result does not satisfy constraint of line i. */
-      std::vector<Menge::Math::Line> projLines(lines.begin(), lines.begin() + numObstLines);
+      projLines.assign(lines.begin(), lines.begin() + numObstLines);
 
       for (size_t j = numObstLines; j < i; ++j) {
         Menge::Math::Line line;
@@ -26,6 +26,7 @@
 
 #include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Math/Line.h"
+#include "MengeCore/Orca/ORCASimd.h"
 
 #include <vector>
 
@@ -70,6 +71,11 @@ class MENGE_API Agent : public Menge::Agents::BaseAgent {
    */
   std::vector<Menge::Math::Line> _orcaLines;
 
+  /*!
+   @brief    Scratch storage for the neighbor data from which the agent ORCA lines are built.
+   */
+  NeighborBatch _nbrBatch;
+
   /*!
    @brief    The time horizon for inter-agent interactions.
    */
@@ -0,0 +1,555 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Orca/ORCASimd.h"
+
+#include "MengeCore/Math/consts.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ORCA_SIMD_SSE
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define ORCA_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only generate AVX instructions in functions which request them; the rest of the
+// library remains executable on processors without AVX.
+#if defined(ORCA_SIMD_AVX2) && defined(__GNUC__)
+#define ORCA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ORCA_TARGET_AVX2
+#endif
+
+namespace ORCA {
+
+using Menge::Math::Line;
+using Menge::Math::Vector2;
+using Menge::Math::sqr;
+
+// The vectorized kernels read and write lines as four packed floats.
+static_assert(sizeof(Line) == 4 * sizeof(float), "Math::Line must consist of four packed floats");
+
+namespace {
+
+/*!
+ @brief    Determines the most capable instruction set supported by the build and the processor.
+ */
+SimdLevel detectSimdLevel() {
+#if defined(ORCA_SIMD_AVX2) && defined(__GNUC__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#elif defined(ORCA_SIMD_AVX2) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] >= 7) {
+    __cpuid(info, 1);
+    // The operating system must preserve the AVX registers (OSXSAVE, AVX and XCR0 bits 1 and 2).
+    const int osxsaveAvx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsaveAvx) == osxsaveAvx && (_xgetbv(0) & 0x6) == 0x6) {
+      __cpuidex(info, 7, 0);
+      if (info[1] & (1 << 5)) return SIMD_AVX2;
+    }
+  }
+#endif
+#ifdef ORCA_SIMD_SSE
+  return SIMD_SSE;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+/*!
+ @brief    The most capable instruction set supported by the build and the processor.
+ */
+const SimdLevel SUPPORTED_LEVEL = detectSimdLevel();
+
+/*!
+ @brief    The instruction set used by the kernels.
+ */
+SimdLevel activeLevel = SUPPORTED_LEVEL;
+
+/////////////////////////////////////////////////////////////////////////////
+//                     Scalar kernels
+/////////////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Constructs the ORCA line for a single neighbor. This is the reference implementation
+          which the vectorized kernels reproduce.
+ */
+void agentLine(const Vector2& relativePosition, const Vector2& relativeVelocity,
+               float combinedRadius, const Vector2& vel, float invTimeHorizon, float invTimeStep,
+               Line& line) {
+  const float distSq = absSq(relativePosition);
+  const float combinedRadiusSq = sqr(combinedRadius);
+
+  Vector2 u;
+
+  if (distSq > combinedRadiusSq) {
+    /* No collision. */
+    const Vector2 w = relativeVelocity - invTimeHorizon * relativePosition;
+    /* Vector from cutoff center to relative velocity. */
+    const float wLengthSq = absSq(w);
+
+    const float dotProduct1 = w * relativePosition;
+
+    if (dotProduct1 < 0.0f && sqr(dotProduct1) > combinedRadiusSq * wLengthSq) {
+      /* Project on cut-off circle. */
+      const float wLength = std::sqrt(wLengthSq);
+      const Vector2 unitW = w / wLength;
+
+      line._direction = Vector2(unitW.y(), -unitW.x());
+      u = (combinedRadius * invTimeHorizon - wLength) * unitW;
+    } else {
+      /* Project on legs. */
+      const float leg = std::sqrt(distSq - combinedRadiusSq);
+
+      if (det(relativePosition, w) > 0.0f) {
+        /* Project on left leg. */
+        line._direction =
+            Vector2(relativePosition.x() * leg - relativePosition.y() * combinedRadius,
+                    relativePosition.x() * combinedRadius + relativePosition.y() * leg) /
+            distSq;
+      } else {
+        /* Project on right leg. */
+        line._direction =
+            -Vector2(relativePosition.x() * leg + relativePosition.y() * combinedRadius,
+                     -relativePosition.x() * combinedRadius + relativePosition.y() * leg) /
+            distSq;
+      }
+
+      const float dotProduct2 = relativeVelocity * line._direction;
+
+      u = dotProduct2 * line._direction - relativeVelocity;
+    }
+
+    line._point = vel + 0.5f * u;
+  } else {
+    /* Collision. Project on cut-off circle of time timeStep. */
+
+    /* Vector from cutoff center to relative velocity. */
+    const Vector2 w = relativeVelocity - invTimeStep * relativePosition;
+
+    const float wLength = abs(w);
+    const Vector2 unitW = w / wLength;
+
+    line._direction = Vector2(unitW.y(), -unitW.x());
+    u = (combinedRadius * invTimeStep - wLength) * unitW;
+    float coopWeight = 0.5f;
+    line._point = vel + coopWeight * u;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void agentLinesScalar(const NeighborBatch& nbrs, size_t begin, const Vector2& vel,
+                      float invTimeHorizon, float invTimeStep, Line* lines) {
+  for (size_t i = begin; i < nbrs.size(); ++i) {
+    agentLine(Vector2(nbrs._relPosX[i], nbrs._relPosY[i]),
+              Vector2(nbrs._relVelX[i], nbrs._relVelY[i]), nbrs._radius[i], vel, invTimeHorizon,
+              invTimeStep, lines[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+size_t findViolatedLineScalar(const std::vector<Line>& lines, size_t begin, const Vector2& point) {
+  for (size_t i = begin; i < lines.size(); ++i) {
+    if (det(lines[i]._direction, lines[i]._point - point) > 0.0f) return i;
+  }
+  return lines.size();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool clipLineScalar(const std::vector<Line>& lines, size_t begin, size_t lineNo, float& tLeft,
+                    float& tRight) {
+  for (size_t i = begin; i < lineNo; ++i) {
+    const float denominator = det(lines[lineNo]._direction, lines[i]._direction);
+    const float numerator = det(lines[i]._direction, lines[lineNo]._point - lines[i]._point);
+
+    if (std::fabs(denominator) <= Menge::EPS) {
+      /* Lines lineNo and i are (almost) parallel. */
+      if (numerator < 0.0f) {
+        return false;
+      } else {
+        continue;
+      }
+    }
+
+    const float t = numerator / denominator;
+
+    if (denominator >= 0.0f) {
+      /* Line i bounds line lineNo on the right. */
+      tRight = std::min(tRight, t);
+    } else {
+      /* Line i bounds line lineNo on the left. */
+      tLeft = std::max(tLeft, t);
+    }
+
+    if (tLeft > tRight) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef ORCA_SIMD_SSE
+
+/////////////////////////////////////////////////////////////////////////////
+//                     SSE kernels
+/////////////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Selects, per lane, a where the mask is set and b elsewhere.
+ */
+inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void agentLinesSSE(const NeighborBatch& nbrs, const Vector2& vel, float invTimeHorizon,
+                   float invTimeStep, Line* lines) {
+  const size_t simdCount = nbrs.size() & ~static_cast<size_t>(3);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 signBit = _mm_set1_ps(-0.f);
+  const __m128 invTau = _mm_set1_ps(invTimeHorizon);
+  const __m128 invDt = _mm_set1_ps(invTimeStep);
+  const __m128 velX = _mm_set1_ps(vel._x);
+  const __m128 velY = _mm_set1_ps(vel._y);
+
+  for (size_t i = 0; i < simdCount; i += 4) {
+    const __m128 px = _mm_loadu_ps(&nbrs._relPosX[i]);
+    const __m128 py = _mm_loadu_ps(&nbrs._relPosY[i]);
+    const __m128 rvx = _mm_loadu_ps(&nbrs._relVelX[i]);
+    const __m128 rvy = _mm_loadu_ps(&nbrs._relVelY[i]);
+    const __m128 r = _mm_loadu_ps(&nbrs._radius[i]);
+
+    const __m128 distSq = _mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py));
+    const __m128 rSq = _mm_mul_ps(r, r);
+    const __m128 apart = _mm_cmpgt_ps(distSq, rSq);
+    // Both branches of the scalar kernel are evaluated and the results blended. Colliding agents
+    // project on the cut-off circle of the time step, the others on that of the time horizon.
+    const __m128 inv = select(apart, invTau, invDt);
+    const __m128 wx = _mm_sub_ps(rvx, _mm_mul_ps(inv, px));
+    const __m128 wy = _mm_sub_ps(rvy, _mm_mul_ps(inv, py));
+    const __m128 wLenSq = _mm_add_ps(_mm_mul_ps(wx, wx), _mm_mul_ps(wy, wy));
+    const __m128 dot1 = _mm_add_ps(_mm_mul_ps(wx, px), _mm_mul_ps(wy, py));
+    const __m128 cutoff = _mm_and_ps(_mm_cmplt_ps(dot1, zero),
+                                     _mm_cmpgt_ps(_mm_mul_ps(dot1, dot1), _mm_mul_ps(rSq, wLenSq)));
+    const __m128 circle = _mm_or_ps(cutoff, _mm_cmpngt_ps(distSq, rSq));
+
+    // Projection on the cut-off circle.
+    const __m128 wLen = _mm_sqrt_ps(wLenSq);
+    const __m128 invWLen = _mm_div_ps(one, wLen);
+    const __m128 unitX = _mm_mul_ps(wx, invWLen);
+    const __m128 unitY = _mm_mul_ps(wy, invWLen);
+    const __m128 scale = _mm_sub_ps(_mm_mul_ps(r, inv), wLen);
+    const __m128 circleDirX = unitY;
+    const __m128 circleDirY = _mm_xor_ps(unitX, signBit);
+    const __m128 circleUX = _mm_mul_ps(scale, unitX);
+    const __m128 circleUY = _mm_mul_ps(scale, unitY);
+
+    // Projection on the legs.
+    const __m128 leg = _mm_sqrt_ps(_mm_sub_ps(distSq, rSq));
+    const __m128 invDistSq = _mm_div_ps(one, distSq);
+    const __m128 left = _mm_cmpgt_ps(_mm_sub_ps(_mm_mul_ps(px, wy), _mm_mul_ps(py, wx)), zero);
+    const __m128 pxLeg = _mm_mul_ps(px, leg);
+    const __m128 pyLeg = _mm_mul_ps(py, leg);
+    const __m128 pxR = _mm_mul_ps(px, r);
+    const __m128 pyR = _mm_mul_ps(py, r);
+    const __m128 leftDirX = _mm_mul_ps(_mm_sub_ps(pxLeg, pyR), invDistSq);
+    const __m128 leftDirY = _mm_mul_ps(_mm_add_ps(pxR, pyLeg), invDistSq);
+    const __m128 rightDirX = _mm_xor_ps(_mm_mul_ps(_mm_add_ps(pxLeg, pyR), invDistSq), signBit);
+    const __m128 rightDirY = _mm_xor_ps(_mm_mul_ps(_mm_sub_ps(pyLeg, pxR), invDistSq), signBit);
+    const __m128 legDirX = select(left, leftDirX, rightDirX);
+    const __m128 legDirY = select(left, leftDirY, rightDirY);
+    const __m128 dot2 = _mm_add_ps(_mm_mul_ps(rvx, legDirX), _mm_mul_ps(rvy, legDirY));
+    const __m128 legUX = _mm_sub_ps(_mm_mul_ps(dot2, legDirX), rvx);
+    const __m128 legUY = _mm_sub_ps(_mm_mul_ps(dot2, legDirY), rvy);
+
+    __m128 pointX = _mm_add_ps(velX, _mm_mul_ps(half, select(circle, circleUX, legUX)));
+    __m128 pointY = _mm_add_ps(velY, _mm_mul_ps(half, select(circle, circleUY, legUY)));
+    __m128 dirX = select(circle, circleDirX, legDirX);
+    __m128 dirY = select(circle, circleDirY, legDirY);
+
+    _MM_TRANSPOSE4_PS(pointX, pointY, dirX, dirY);
+    float* out = reinterpret_cast<float*>(lines + i);
+    _mm_storeu_ps(out, pointX);
+    _mm_storeu_ps(out + 4, pointY);
+    _mm_storeu_ps(out + 8, dirX);
+    _mm_storeu_ps(out + 12, dirY);
+  }
+  agentLinesScalar(nbrs, simdCount, vel, invTimeHorizon, invTimeStep, lines);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Loads four consecutive lines and transposes them into point and direction components.
+ */
+inline void loadLines(const Line* lines, __m128& px, __m128& py, __m128& dx, __m128& dy) {
+  const float* in = reinterpret_cast<const float*>(lines);
+  px = _mm_loadu_ps(in);
+  py = _mm_loadu_ps(in + 4);
+  dx = _mm_loadu_ps(in + 8);
+  dy = _mm_loadu_ps(in + 12);
+  _MM_TRANSPOSE4_PS(px, py, dx, dy);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+size_t findViolatedLineSSE(const std::vector<Line>& lines, size_t begin, const Vector2& point) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 x = _mm_set1_ps(point._x);
+  const __m128 y = _mm_set1_ps(point._y);
+  size_t i = begin;
+  for (; i + 4 <= lines.size(); i += 4) {
+    __m128 px, py, dx, dy;
+    loadLines(&lines[i], px, py, dx, dy);
+    const __m128 d =
+        _mm_sub_ps(_mm_mul_ps(dx, _mm_sub_ps(py, y)), _mm_mul_ps(dy, _mm_sub_ps(px, x)));
+    const int violated = _mm_movemask_ps(_mm_cmpgt_ps(d, zero));
+    if (violated != 0) {
+      size_t lane = 0;
+      while ((violated & (1 << lane)) == 0) ++lane;
+      return i + lane;
+    }
+  }
+  return findViolatedLineScalar(lines, i, point);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool clipLineSSE(const std::vector<Line>& lines, size_t lineNo, float& tLeft, float& tRight) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 eps = _mm_set1_ps(Menge::EPS);
+  const __m128 lpx = _mm_set1_ps(lines[lineNo]._point._x);
+  const __m128 lpy = _mm_set1_ps(lines[lineNo]._point._y);
+  const __m128 ldx = _mm_set1_ps(lines[lineNo]._direction._x);
+  const __m128 ldy = _mm_set1_ps(lines[lineNo]._direction._y);
+  // Each lane clips its own copy of the interval; as the clipping is a running minimum (maximum),
+  // the copies can be combined in any order.
+  __m128 left = _mm_set1_ps(tLeft);
+  __m128 right = _mm_set1_ps(tRight);
+  size_t i = 0;
+  for (; i + 4 <= lineNo; i += 4) {
+    __m128 px, py, dx, dy;
+    loadLines(&lines[i], px, py, dx, dy);
+    const __m128 denominator = _mm_sub_ps(_mm_mul_ps(ldx, dy), _mm_mul_ps(ldy, dx));
+    const __m128 numerator =
+        _mm_sub_ps(_mm_mul_ps(dx, _mm_sub_ps(lpy, py)), _mm_mul_ps(dy, _mm_sub_ps(lpx, px)));
+    const __m128 parallel = _mm_cmple_ps(_mm_and_ps(denominator, absMask), eps);
+    const __m128 t = _mm_div_ps(numerator, denominator);
+    const __m128 bindsRight = _mm_andnot_ps(parallel, _mm_cmpge_ps(denominator, zero));
+    const __m128 bindsLeft = _mm_andnot_ps(parallel, _mm_cmplt_ps(denominator, zero));
+    right = select(bindsRight, _mm_min_ps(t, right), right);
+    left = select(bindsLeft, _mm_max_ps(t, left), left);
+    const __m128 failed =
+        _mm_or_ps(_mm_and_ps(parallel, _mm_cmplt_ps(numerator, zero)), _mm_cmpgt_ps(left, right));
+    if (_mm_movemask_ps(failed) != 0) return false;
+  }
+  left = _mm_max_ps(left, _mm_shuffle_ps(left, left, _MM_SHUFFLE(2, 3, 0, 1)));
+  left = _mm_max_ps(left, _mm_shuffle_ps(left, left, _MM_SHUFFLE(1, 0, 3, 2)));
+  right = _mm_min_ps(right, _mm_shuffle_ps(right, right, _MM_SHUFFLE(2, 3, 0, 1)));
+  right = _mm_min_ps(right, _mm_shuffle_ps(right, right, _MM_SHUFFLE(1, 0, 3, 2)));
+  tLeft = _mm_cvtss_f32(left);
+  tRight = _mm_cvtss_f32(right);
+  if (tLeft > tRight) return false;
+  return clipLineScalar(lines, i, lineNo, tLeft, tRight);
+}
+
+#endif  // ORCA_SIMD_SSE
+
+#ifdef ORCA_SIMD_AVX2
+
+/////////////////////////////////////////////////////////////////////////////
+//                     AVX2 kernels
+/////////////////////////////////////////////////////////////////////////////
+
+ORCA_TARGET_AVX2
+void agentLinesAVX2(const NeighborBatch& nbrs, const Vector2& vel, float invTimeHorizon,
+                    float invTimeStep, Line* lines) {
+  const size_t simdCount = nbrs.size() & ~static_cast<size_t>(7);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 signBit = _mm256_set1_ps(-0.f);
+  const __m256 invTau = _mm256_set1_ps(invTimeHorizon);
+  const __m256 invDt = _mm256_set1_ps(invTimeStep);
+  const __m256 velX = _mm256_set1_ps(vel._x);
+  const __m256 velY = _mm256_set1_ps(vel._y);
+
+  for (size_t i = 0; i < simdCount; i += 8) {
+    const __m256 px = _mm256_loadu_ps(&nbrs._relPosX[i]);
+    const __m256 py = _mm256_loadu_ps(&nbrs._relPosY[i]);
+    const __m256 rvx = _mm256_loadu_ps(&nbrs._relVelX[i]);
+    const __m256 rvy = _mm256_loadu_ps(&nbrs._relVelY[i]);
+    const __m256 r = _mm256_loadu_ps(&nbrs._radius[i]);
+
+    // See agentLinesSSE() for the structure of the computation.
+    const __m256 distSq = _mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py));
+    const __m256 rSq = _mm256_mul_ps(r, r);
+    const __m256 apart = _mm256_cmp_ps(distSq, rSq, _CMP_GT_OQ);
+    const __m256 inv = _mm256_blendv_ps(invDt, invTau, apart);
+    const __m256 wx = _mm256_sub_ps(rvx, _mm256_mul_ps(inv, px));
+    const __m256 wy = _mm256_sub_ps(rvy, _mm256_mul_ps(inv, py));
+    const __m256 wLenSq = _mm256_add_ps(_mm256_mul_ps(wx, wx), _mm256_mul_ps(wy, wy));
+    const __m256 dot1 = _mm256_add_ps(_mm256_mul_ps(wx, px), _mm256_mul_ps(wy, py));
+    const __m256 cutoff =
+        _mm256_and_ps(_mm256_cmp_ps(dot1, zero, _CMP_LT_OQ),
+                      _mm256_cmp_ps(_mm256_mul_ps(dot1, dot1), _mm256_mul_ps(rSq, wLenSq),
+                                    _CMP_GT_OQ));
+    const __m256 circle = _mm256_or_ps(cutoff, _mm256_cmp_ps(distSq, rSq, _CMP_NGT_UQ));
+
+    const __m256 wLen = _mm256_sqrt_ps(wLenSq);
+    const __m256 invWLen = _mm256_div_ps(one, wLen);
+    const __m256 unitX = _mm256_mul_ps(wx, invWLen);
+    const __m256 unitY = _mm256_mul_ps(wy, invWLen);
+    const __m256 scale = _mm256_sub_ps(_mm256_mul_ps(r, inv), wLen);
+    const __m256 circleDirX = unitY;
+    const __m256 circleDirY = _mm256_xor_ps(unitX, signBit);
+    const __m256 circleUX = _mm256_mul_ps(scale, unitX);
+    const __m256 circleUY = _mm256_mul_ps(scale, unitY);
+
+    const __m256 leg = _mm256_sqrt_ps(_mm256_sub_ps(distSq, rSq));
+    const __m256 invDistSq = _mm256_div_ps(one, distSq);
+    const __m256 left = _mm256_cmp_ps(
+        _mm256_sub_ps(_mm256_mul_ps(px, wy), _mm256_mul_ps(py, wx)), zero, _CMP_GT_OQ);
+    const __m256 pxLeg = _mm256_mul_ps(px, leg);
+    const __m256 pyLeg = _mm256_mul_ps(py, leg);
+    const __m256 pxR = _mm256_mul_ps(px, r);
+    const __m256 pyR = _mm256_mul_ps(py, r);
+    const __m256 leftDirX = _mm256_mul_ps(_mm256_sub_ps(pxLeg, pyR), invDistSq);
+    const __m256 leftDirY = _mm256_mul_ps(_mm256_add_ps(pxR, pyLeg), invDistSq);
+    const __m256 rightDirX =
+        _mm256_xor_ps(_mm256_mul_ps(_mm256_add_ps(pxLeg, pyR), invDistSq), signBit);
+    const __m256 rightDirY =
+        _mm256_xor_ps(_mm256_mul_ps(_mm256_sub_ps(pyLeg, pxR), invDistSq), signBit);
+    const __m256 legDirX = _mm256_blendv_ps(rightDirX, leftDirX, left);
+    const __m256 legDirY = _mm256_blendv_ps(rightDirY, leftDirY, left);
+    const __m256 dot2 = _mm256_add_ps(_mm256_mul_ps(rvx, legDirX), _mm256_mul_ps(rvy, legDirY));
+    const __m256 legUX = _mm256_sub_ps(_mm256_mul_ps(dot2, legDirX), rvx);
+    const __m256 legUY = _mm256_sub_ps(_mm256_mul_ps(dot2, legDirY), rvy);
+
+    const __m256 uX = _mm256_blendv_ps(legUX, circleUX, circle);
+    const __m256 uY = _mm256_blendv_ps(legUY, circleUY, circle);
+    float out[4][8];
+    _mm256_storeu_ps(out[0], _mm256_add_ps(velX, _mm256_mul_ps(half, uX)));
+    _mm256_storeu_ps(out[1], _mm256_add_ps(velY, _mm256_mul_ps(half, uY)));
+    _mm256_storeu_ps(out[2], _mm256_blendv_ps(legDirX, circleDirX, circle));
+    _mm256_storeu_ps(out[3], _mm256_blendv_ps(legDirY, circleDirY, circle));
+    for (size_t lane = 0; lane < 8; ++lane) {
+      lines[i + lane]._point.set(out[0][lane], out[1][lane]);
+      lines[i + lane]._direction.set(out[2][lane], out[3][lane]);
+    }
+  }
+  agentLinesScalar(nbrs, simdCount, vel, invTimeHorizon, invTimeStep, lines);
+}
+
+#endif  // ORCA_SIMD_AVX2
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//                     Implementation of the public interface
+/////////////////////////////////////////////////////////////////////////////
+
+SimdLevel getSupportedSimdLevel() { return SUPPORTED_LEVEL; }
+
+/////////////////////////////////////////////////////////////////////////////
+
+SimdLevel getSimdLevel() { return activeLevel; }
+
+/////////////////////////////////////////////////////////////////////////////
+
+SimdLevel setSimdLevel(SimdLevel level) {
+  activeLevel = level > SUPPORTED_LEVEL ? SUPPORTED_LEVEL : level;
+  return activeLevel;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void NeighborBatch::clear() {
+  _relPosX.clear();
+  _relPosY.clear();
+  _relVelX.clear();
+  _relVelY.clear();
+  _radius.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void NeighborBatch::add(const Vector2& relPos, const Vector2& relVel, float radius) {
+  _relPosX.push_back(relPos._x);
+  _relPosY.push_back(relPos._y);
+  _relVelX.push_back(relVel._x);
+  _relVelY.push_back(relVel._y);
+  _radius.push_back(radius);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void computeAgentLines(const NeighborBatch& nbrs, const Vector2& vel, float invTimeHorizon,
+                       float invTimeStep, Line* lines) {
+  switch (activeLevel) {
+#ifdef ORCA_SIMD_AVX2
+    case SIMD_AVX2:
+      agentLinesAVX2(nbrs, vel, invTimeHorizon, invTimeStep, lines);
+      break;
+#endif
+#ifdef ORCA_SIMD_SSE
+    case SIMD_SSE:
+      agentLinesSSE(nbrs, vel, invTimeHorizon, invTimeStep, lines);
+      break;
+#endif
+    default:
+      agentLinesScalar(nbrs, 0, vel, invTimeHorizon, invTimeStep, lines);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+size_t findViolatedLine(const std::vector<Line>& lines, size_t begin, const Vector2& point) {
+#ifdef ORCA_SIMD_SSE
+  // The lines are scanned four at a time at both vector levels; the lists are rarely long enough
+  // to benefit from wider vectors.
+  if (activeLevel != SIMD_SCALAR) return findViolatedLineSSE(lines, begin, point);
+#endif
+  return findViolatedLineScalar(lines, begin, point);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool clipLine(const std::vector<Line>& lines, size_t lineNo, float& tLeft, float& tRight) {
+#ifdef ORCA_SIMD_SSE
+  if (activeLevel != SIMD_SCALAR) return clipLineSSE(lines, lineNo, tLeft, tRight);
+#endif
+  return clipLineScalar(lines, 0, lineNo, tLeft, tRight);
+}
+}  // namespace ORCA
@@ -0,0 +1,164 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file       ORCASimd.h
+ @brief      Vectorized kernels for constructing ORCA lines and solving the ORCA linear programs.
+
+ Each kernel has a scalar implementation and, on x86 platforms, SSE and AVX2 implementations. The
+ implementation is chosen at runtime based on the capabilities of the processor; it can be
+ overridden with setSimdLevel(). The vectorized implementations perform the same floating-point
+ operations as the scalar implementation, in the same order, so the results agree.
+ */
+
+#ifndef __ORCA_SIMD_H__
+#define __ORCA_SIMD_H__
+
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Line.h"
+#include "MengeCore/Math/Vector2.h"
+
+#include <vector>
+
+namespace ORCA {
+
+/*!
+ @brief    The instruction sets the ORCA kernels can use.
+ */
+enum SimdLevel {
+  SIMD_SCALAR = 0,  ///< No vector instructions.
+  SIMD_SSE = 1,     ///< SSE2; four neighbors at a time.
+  SIMD_AVX2 = 2     ///< AVX2; eight neighbors at a time.
+};
+
+/*!
+ @brief    Reports the most capable instruction set supported by both the build and the processor.
+ */
+MENGE_API SimdLevel getSupportedSimdLevel();
+
+/*!
+ @brief    Reports the instruction set currently used by the ORCA kernels.
+ */
+MENGE_API SimdLevel getSimdLevel();
+
+/*!
+ @brief    Sets the instruction set used by the ORCA kernels.
+
+ This should not be changed while a simulation is being stepped.
+
+ @param    level    The requested instruction set. If it is not supported, the most capable
+                    supported instruction set is used instead.
+ @returns  The instruction set which will be used.
+ */
+MENGE_API SimdLevel setSimdLevel(SimdLevel level);
+
+/*!
+ @brief    The neighbor data required to construct agent ORCA lines, stored as a structure of
+          arrays.
+ */
+class MENGE_API NeighborBatch {
+ public:
+  /*!
+   @brief    Removes all neighbors from the batch (retaining the allocated memory).
+   */
+  void clear();
+
+  /*!
+   @brief    Adds a neighbor to the batch.
+
+   @param    relPos       The position of the neighbor relative to the agent.
+   @param    relVel       The velocity of the agent relative to the neighbor.
+   @param    radius       The sum of the radii of the agent and the neighbor.
+   */
+  void add(const Menge::Math::Vector2& relPos, const Menge::Math::Vector2& relVel, float radius);
+
+  /*!
+   @brief    Reports the number of neighbors in the batch.
+   */
+  size_t size() const { return _radius.size(); }
+
+  /*!
+   @brief    Reports if the batch is empty.
+   */
+  bool empty() const { return _radius.empty(); }
+
+  /*!
+   @brief    The x-components of the neighbors' relative positions.
+   */
+  std::vector<float> _relPosX;
+
+  /*!
+   @brief    The y-components of the neighbors' relative positions.
+   */
+  std::vector<float> _relPosY;
+
+  /*!
+   @brief    The x-components of the relative velocities.
+   */
+  std::vector<float> _relVelX;
+
+  /*!
+   @brief    The y-components of the relative velocities.
+   */
+  std::vector<float> _relVelY;
+
+  /*!
+   @brief    The combined radii of the agent and each neighbor.
+   */
+  std::vector<float> _radius;
+};
+
+/*!
+ @brief    Constructs the ORCA line for each neighbor in the batch.
+
+ @param    nbrs             The neighbors.
+ @param    vel              The agent's current velocity.
+ @param    invTimeHorizon   The inverse of the agent's time horizon.
+ @param    invTimeStep      The inverse of the simulation time step.
+ @param    lines            The lines to write; there must be room for nbrs.size() lines.
+ */
+MENGE_API void computeAgentLines(const NeighborBatch& nbrs, const Menge::Math::Vector2& vel,
+                                 float invTimeHorizon, float invTimeStep,
+                                 Menge::Math::Line* lines);
+
+/*!
+ @brief    Finds the first line whose half plane does not contain the given point.
+
+ @param    lines    The lines.
+ @param    begin    The index of the first line to test.
+ @param    point    The point to test.
+ @returns  The index of the first line (no earlier than begin) to the right of which the point lies,
+          or the number of lines if there is none.
+ */
+MENGE_API size_t findViolatedLine(const std::vector<Menge::Math::Line>& lines, size_t begin,
+                                  const Menge::Math::Vector2& point);
+
+/*!
+ @brief    Clips the parameter interval of a line by the half planes of the lines that precede it.
+
+ @param    lines    The lines.
+ @param    lineNo   The index of the line to clip; it is clipped by lines [0, lineNo).
+ @param    tLeft    The lower bound of the interval; updated by the clipping.
+ @param    tRight   The upper bound of the interval; updated by the clipping.
+ @returns  False if the clipped interval is empty; true otherwise.
+ */
+MENGE_API bool clipLine(const std::vector<Menge::Math::Line>& lines, size_t lineNo, float& tLeft,
+                        float& tRight);
+}  // namespace ORCA
+
+#endif  // __ORCA_SIMD_H__
@@ -766,11 +766,13 @@ size_t linearProgram2(const std::vector<Menge::Math::Line>& lines, float radius,
 void linearProgram3(const std::vector<Menge::Math::Line>& lines, size_t numObstLines,
                     size_t beginLine, float radius, float turnBias, Vector2& result) {
   float distance = 0.0f;
+  // Reused across calls so that the projected constraints do not allocate in the steady state.
+  static thread_local std::vector<Menge::Math::Line> projLines;
 
   for (size_t i = beginLine; i < lines.size(); ++i) {
     if (det(lines[i]._direction, lines[i]._point - result) > distance) {
       /* Result does not satisfy constraint of line i. */
-      std::vector<Menge::Math::Line> projLines(lines.begin(), lines.begin() + numObstLines);
+      projLines.assign(lines.begin(), lines.begin() + numObstLines);
 
       for (size_t j = numObstLines; j < i; ++j) {
         Menge::Math::Line line;
@@ -42,7 +42,10 @@ class Simulator : public Menge::Agents::SimulatorBase<Agent> {
   /*!
    @brief      Constructor.
    */
-  Simulator() : Menge::Agents::SimulatorBase<Agent>() {}
+  Simulator() : Menge::Agents::SimulatorBase<Agent>() {
+    addModelParameter(&COS_OBST_TURN);
+    addModelParameter(&SIN_OBST_TURN);
+  }
 
  protected:
   friend class Agent;
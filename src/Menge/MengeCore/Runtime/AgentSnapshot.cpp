@@ -0,0 +1,306 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/AgentSnapshot.h"
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace Menge {
+
+namespace {
+// Arrays (and the buffers) start on this boundary.
+const size_t ALIGNMENT = 64;
+
+inline size_t alignUp(size_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+inline unsigned long long loadAcquire(const volatile unsigned long long* value) {
+  const unsigned long long result = *value;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return result;
+}
+
+inline void storeRelease(volatile unsigned long long* value, unsigned long long result) {
+  std::atomic_thread_fence(std::memory_order_release);
+  *value = result;
+}
+
+inline const AgentSnapshot::Header* header(const void* snapshot) {
+  return static_cast<const AgentSnapshot::Header*>(snapshot);
+}
+
+// The buffer which holds (or will hold) the frame with the given sequence number.
+inline const AgentSnapshot::BufferHeader* buffer(const void* snapshot,
+                                                 unsigned long long sequence) {
+  return reinterpret_cast<const AgentSnapshot::BufferHeader*>(
+      static_cast<const char*>(snapshot) + header(snapshot)->_bufferOffset[sequence % 2]);
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of AgentSnapshot
+/////////////////////////////////////////////////////////////////////
+
+AgentSnapshot::AgentSnapshot()
+    : _data(0x0),
+      _size(0),
+      _sharedName(),
+      _ownsShared(false),
+      _local()
+#ifdef _WIN32
+      ,
+      _mapping(0x0)
+#endif  // _WIN32
+{
+}
+
+/////////////////////////////////////////////////////////////////////
+
+AgentSnapshot::~AgentSnapshot() { close(); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool AgentSnapshot::create(size_t agentCount, const std::string& sharedName) {
+  close();
+  size_t bufferSize = alignUp(sizeof(BufferHeader));
+  unsigned long long fieldOffset[FIELD_COUNT];
+  for (int f = 0; f < FIELD_COUNT; ++f) {
+    fieldOffset[f] = bufferSize;
+    // Every field's values are four bytes.
+    bufferSize = alignUp(bufferSize + agentCount * sizeof(float));
+  }
+  const size_t FIRST_BUFFER = alignUp(sizeof(Header));
+  const size_t SIZE = FIRST_BUFFER + 2 * bufferSize;
+
+  if (sharedName.empty()) {
+    _local.assign(SIZE, 0);
+    _data = &_local[0];
+    _size = SIZE;
+  } else if (!mapShared(sharedName, SIZE)) {
+    return false;
+  }
+
+  Header* head = reinterpret_cast<Header*>(_data);
+  memcpy(head->_magic, "MENGESNP", 8);
+  head->_version = VERSION;
+  head->_agentCount = static_cast<unsigned int>(agentCount);
+  head->_sequence = 0;
+  head->_bufferSize = bufferSize;
+  head->_bufferOffset[0] = FIRST_BUFFER;
+  head->_bufferOffset[1] = FIRST_BUFFER + bufferSize;
+  for (int f = 0; f < FIELD_COUNT; ++f) head->_fieldOffset[f] = fieldOffset[f];
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool AgentSnapshot::open(const std::string& sharedName) {
+  close();
+  if (!mapShared(sharedName, 0)) return false;
+  const Header* head = header(_data);
+  if (_size < sizeof(Header) || memcmp(head->_magic, "MENGESNP", 8) != 0 ||
+      head->_version != VERSION || head->_bufferOffset[1] + head->_bufferSize > _size) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void AgentSnapshot::publish(Agents::SimulatorInterface* sim) {
+  Header* head = reinterpret_cast<Header*>(_data);
+  const unsigned long long SEQUENCE = head->_sequence + 1;
+  BufferHeader* buf = const_cast<BufferHeader*>(buffer(_data, SEQUENCE));
+  char* values = reinterpret_cast<char*>(buf);
+  // Readers of the frame this buffer held must see that it's gone before any new value.
+  buf->_sequence = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+
+  float* fields[STATE];
+  for (int f = 0; f < STATE; ++f) {
+    fields[f] = reinterpret_cast<float*>(values + head->_fieldOffset[f]);
+  }
+  unsigned int* states = reinterpret_cast<unsigned int*>(values + head->_fieldOffset[STATE]);
+  const BFSM::FSM* fsm = sim->getBFSM();
+  const size_t AGT_COUNT = sim->getNumAgents();
+  const int COUNT = static_cast<int>(AGT_COUNT < head->_agentCount ? AGT_COUNT : head->_agentCount);
+#pragma omp parallel for
+  for (int i = 0; i < COUNT; ++i) {
+    const Agents::BaseAgent* agt = sim->getAgentById(i);
+    fields[POS_X][i] = agt->_pos._x;
+    fields[POS_Y][i] = agt->_pos._y;
+    fields[ELEVATION][i] = sim->getElevation(agt);
+    fields[VEL_X][i] = agt->_vel._x;
+    fields[VEL_Y][i] = agt->_vel._y;
+    fields[ORIENT_X][i] = agt->_orient._x;
+    fields[ORIENT_Y][i] = agt->_orient._y;
+    states[i] = fsm != 0x0 ? static_cast<unsigned int>(fsm->getAgentStateID(i)) : 0;
+  }
+  buf->_time = sim->getGlobalTime();
+  storeRelease(&buf->_sequence, SEQUENCE);
+  storeRelease(&head->_sequence, SEQUENCE);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned long long AgentSnapshot::getSequence(const void* snapshot) {
+  return loadAcquire(&header(snapshot)->_sequence);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const void* AgentSnapshot::getField(const void* snapshot, unsigned long long sequence,
+                                    Field field) {
+  if (sequence == 0 || field < 0 || field >= FIELD_COUNT || !isCurrent(snapshot, sequence)) {
+    return 0x0;
+  }
+  return reinterpret_cast<const char*>(buffer(snapshot, sequence)) +
+         header(snapshot)->_fieldOffset[field];
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float AgentSnapshot::getTime(const void* snapshot, unsigned long long sequence) {
+  if (sequence == 0 || !isCurrent(snapshot, sequence)) return -1.f;
+  const float time = buffer(snapshot, sequence)->_time;
+  return isCurrent(snapshot, sequence) ? time : -1.f;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool AgentSnapshot::isCurrent(const void* snapshot, unsigned long long sequence) {
+  // Orders the caller's reads of the frame before the check.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return loadAcquire(&buffer(snapshot, sequence)->_sequence) == sequence;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+bool AgentSnapshot::mapShared(const std::string& name, size_t size) {
+  if (size > 0) {
+    const unsigned long long SIZE = size;
+    _mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0x0, PAGE_READWRITE,
+                                  static_cast<DWORD>(SIZE >> 32), static_cast<DWORD>(SIZE),
+                                  name.c_str());
+  } else {
+    _mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+  }
+  if (_mapping == 0x0) return false;
+  _data = static_cast<char*>(
+      MapViewOfFile(_mapping, size > 0 ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0));
+  if (_data == 0x0) {
+    CloseHandle(_mapping);
+    _mapping = 0x0;
+    return false;
+  }
+  if (size == 0) {
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(_data, &info, sizeof(info));
+    size = info.RegionSize;
+  }
+  _size = size;
+  _sharedName = name;
+  // The mapping object disappears with its last handle.
+  _ownsShared = false;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void AgentSnapshot::close() {
+  if (!_sharedName.empty()) {
+    if (_data != 0x0) UnmapViewOfFile(_data);
+    if (_mapping != 0x0) CloseHandle(_mapping);
+  }
+  _mapping = 0x0;
+  _data = 0x0;
+  _size = 0;
+  _sharedName.clear();
+  _ownsShared = false;
+  _local.clear();
+}
+
+#else  // _WIN32
+
+bool AgentSnapshot::mapShared(const std::string& name, size_t size) {
+  const bool CREATE = size > 0;
+  const int fd = CREATE ? shm_open(name.c_str(), O_CREAT | O_RDWR, 0644)
+                        : shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return false;
+  if (CREATE) {
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      ::close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+  } else {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+      ::close(fd);
+      return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+  }
+  void* data = mmap(0x0, size, CREATE ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the segment open.
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    if (CREATE) shm_unlink(name.c_str());
+    return false;
+  }
+  _data = static_cast<char*>(data);
+  _size = size;
+  _sharedName = name;
+  _ownsShared = CREATE;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void AgentSnapshot::close() {
+  if (!_sharedName.empty()) {
+    if (_data != 0x0) munmap(_data, _size);
+    if (_ownsShared) shm_unlink(_sharedName.c_str());
+  }
+  _data = 0x0;
+  _size = 0;
+  _sharedName.clear();
+  _ownsShared = false;
+  _local.clear();
+}
+
+#endif  // _WIN32
+
+}  // namespace Menge
@@ -0,0 +1,305 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    AgentSnapshot.h
+ @brief   A double-buffered, structure-of-arrays snapshot of the agents' state which a host can
+          read in place, in the same process or (through shared memory) in another one.
+
+ The snapshot is a single block of memory:
+
+     8 bytes         "MENGESNP"
+     4-byte uint     layout version (1)
+     4-byte uint     agent count
+     8-byte uint     sequence number of the latest published frame (0 if none)
+     8-byte uint     buffer size (bytes)
+     8-byte uint     offset of each of the two buffers (from the start of the block)
+     8-byte uint     offset of each field's array (AgentSnapshot::Field order) within a buffer
+
+ Each buffer holds one frame:
+
+     8-byte uint     sequence number of the frame (0 while it is being written)
+     4-byte float    the simulation's global time
+     4 bytes         unused
+     the arrays, one value per agent, in order of agent identifier: x-position, y-position and
+     elevation, x- and y-velocity and x- and y-orientation (4-byte floats), and the id of the BFSM
+     state (4-byte uints). Each array starts on a 64-byte boundary.
+
+ Frame number `s` is written into buffer `s % 2`, so publishing a frame never touches the previous
+ one. A reader finds a consistent frame by (see the static functions of AgentSnapshot):
+
+   1. reading the latest sequence number `s`,
+   2. checking that buffer `s % 2` holds frame `s`,
+   3. reading the arrays in place, and
+   4. checking again that the buffer holds frame `s`; if it doesn't, the writer published two more
+      frames while the arrays were read and they must be read again.
+
+ Sequence numbers are written with release semantics and read with acquire semantics. The block's
+ 8-byte values are naturally aligned, so this requires a 64-bit platform when the reader is another
+ process.
+ */
+
+#ifndef __AGENT_SNAPSHOT_H__
+#define __AGENT_SNAPSHOT_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+// forward declaration
+namespace Agents {
+class SimulatorInterface;
+}
+
+/*!
+ @brief   Publishes the agents' state into a versioned, double-buffered snapshot which hosts read
+          without copying (see AgentSnapshot.h for the layout and the reading protocol).
+
+ The snapshot either lives in the process's own memory or in a named shared-memory segment (a POSIX
+ shared-memory object, or a named file mapping on Windows) which other processes open with open().
+ The snapshot that creates a segment removes it when it is closed.
+ */
+class MENGE_API AgentSnapshot {
+ public:
+  /*!
+   @brief   The agent values in each buffer, in the order of their arrays.
+   */
+  enum Field {
+    POS_X = 0,
+    POS_Y,
+    ELEVATION,
+    VEL_X,
+    VEL_Y,
+    ORIENT_X,
+    ORIENT_Y,
+    STATE,
+    FIELD_COUNT
+  };
+
+  /*!
+   @brief   The header at the start of the snapshot.
+   */
+  struct Header {
+    /*!
+     @brief   The bytes "MENGESNP".
+     */
+    char _magic[8];
+
+    /*!
+     @brief   The version of the layout.
+     */
+    unsigned int _version;
+
+    /*!
+     @brief   The number of agents in each buffer.
+     */
+    unsigned int _agentCount;
+
+    /*!
+     @brief   The sequence number of the latest published frame (0 if none).
+     */
+    volatile unsigned long long _sequence;
+
+    /*!
+     @brief   The size of each buffer (in bytes).
+     */
+    unsigned long long _bufferSize;
+
+    /*!
+     @brief   The offset of each buffer from the start of the snapshot.
+     */
+    unsigned long long _bufferOffset[2];
+
+    /*!
+     @brief   The offset of each field's array from the start of a buffer.
+     */
+    unsigned long long _fieldOffset[FIELD_COUNT];
+  };
+
+  /*!
+   @brief   The header at the start of each buffer.
+   */
+  struct BufferHeader {
+    /*!
+     @brief   The sequence number of the frame in the buffer (0 while it is being written).
+     */
+    volatile unsigned long long _sequence;
+
+    /*!
+     @brief   The simulation's global time at the frame.
+     */
+    float _time;
+
+    /*!
+     @brief   Unused.
+     */
+    unsigned int _reserved;
+  };
+
+  /*!
+   @brief   The current version of the layout.
+   */
+  static const unsigned int VERSION = 1;
+
+  /*!
+   @brief   Constructor; there is no snapshot until create() or open() is called.
+   */
+  AgentSnapshot();
+
+  /*!
+   @brief   Destructor; closes the snapshot.
+   */
+  ~AgentSnapshot();
+
+  /*!
+   @brief   Creates an empty snapshot for publishing, closing the current one (if any).
+
+   @param   agentCount    The number of agents in each frame.
+   @param   sharedName    The name of the shared-memory segment to create (e.g., "/menge"); if
+                          empty, the snapshot is in the process's own memory.
+   @returns True if the snapshot was created.
+   */
+  bool create(size_t agentCount, const std::string& sharedName = "");
+
+  /*!
+   @brief   Opens a snapshot created (and published) by another process, read-only.
+
+   @param   sharedName    The name of the shared-memory segment.
+   @returns True if the segment exists and holds a snapshot.
+   */
+  bool open(const std::string& sharedName);
+
+  /*!
+   @brief   Closes the snapshot, removing its shared-memory segment if this snapshot created it.
+   */
+  void close();
+
+  /*!
+   @brief   Reports if there is a snapshot.
+   */
+  bool isOpen() const { return _data != 0x0; }
+
+  /*!
+   @brief   The snapshot's memory (null if there is no snapshot).
+   */
+  const char* data() const { return _data; }
+
+  /*!
+   @brief   The size of the snapshot (in bytes).
+   */
+  size_t size() const { return _size; }
+
+  /*!
+   @brief   Writes the simulator's current state as the next frame and publishes it. Agents whose
+            identifiers are beyond the snapshot's agent count are not written.
+
+   @param   sim     The simulator.
+   */
+  void publish(Agents::SimulatorInterface* sim);
+
+  /*!
+   @brief   Reports the sequence number of the latest frame published into a snapshot.
+
+   @param   snapshot    The snapshot's memory.
+   @returns The sequence number (zero if no frame has been published).
+   */
+  static unsigned long long getSequence(const void* snapshot);
+
+  /*!
+   @brief   Reports the array of one field of a frame, in place.
+
+   @param   snapshot    The snapshot's memory.
+   @param   sequence    The frame's sequence number.
+   @param   field       The field.
+   @returns The field's array, or null if the frame is no longer (or not yet) in the snapshot.
+   */
+  static const void* getField(const void* snapshot, unsigned long long sequence, Field field);
+
+  /*!
+   @brief   Reports the global time of a frame.
+
+   @param   snapshot    The snapshot's memory.
+   @param   sequence    The frame's sequence number.
+   @returns The time (negative if the frame is not in the snapshot).
+   */
+  static float getTime(const void* snapshot, unsigned long long sequence);
+
+  /*!
+   @brief   Reports if a frame is still in the snapshot; values read from its arrays are only
+            consistent if it is.
+
+   @param   snapshot    The snapshot's memory.
+   @param   sequence    The frame's sequence number.
+   @returns True if the frame's buffer still holds it.
+   */
+  static bool isCurrent(const void* snapshot, unsigned long long sequence);
+
+ private:
+  // Not copyable.
+  AgentSnapshot(const AgentSnapshot&);
+  AgentSnapshot& operator=(const AgentSnapshot&);
+
+  /*!
+   @brief   Maps the shared-memory segment, creating it with the given size or opening it.
+
+   @param   name      The name of the segment.
+   @param   size      The size to create the segment with, or zero to open an existing segment.
+   @returns True if the segment was mapped.
+   */
+  bool mapShared(const std::string& name, size_t size);
+
+  /*!
+   @brief   The snapshot's memory.
+   */
+  char* _data;
+
+  /*!
+   @brief   The size of the snapshot (in bytes).
+   */
+  size_t _size;
+
+  /*!
+   @brief   The name of the shared-memory segment (empty if the snapshot is in local memory).
+   */
+  std::string _sharedName;
+
+  /*!
+   @brief   True if this snapshot created its shared-memory segment.
+   */
+  bool _ownsShared;
+
+  /*!
+   @brief   The memory of a local snapshot.
+   */
+  std::vector<char> _local;
+
+#ifdef _WIN32
+  /*!
+   @brief   The handle of the file mapping object.
+   */
+  void* _mapping;
+#endif  // _WIN32
+};
+
+}  // namespace Menge
+
+#endif  // __AGENT_SNAPSHOT_H__
@@ -0,0 +1,97 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/AllocationTracker.h"
+
+#ifdef MENGE_TRACK_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Each thread counts its own allocations, so that concurrent simulators do not see each other's
+// allocations and counting costs no synchronization.
+thread_local size_t allocationCount = 0;
+
+void* countedAllocation(size_t bytes) {
+  ++allocationCount;
+  void* result = malloc(bytes > 0 ? bytes : 1);
+  if (result == 0x0) throw std::bad_alloc();
+  return result;
+}
+}  // namespace
+
+void* operator new(size_t bytes) { return countedAllocation(bytes); }
+
+void* operator new[](size_t bytes) { return countedAllocation(bytes); }
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+  ++allocationCount;
+  return malloc(bytes > 0 ? bytes : 1);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+  ++allocationCount;
+  return malloc(bytes > 0 ? bytes : 1);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete[](void* ptr) noexcept { free(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+#endif  // MENGE_TRACK_ALLOCATIONS
+
+namespace Menge {
+
+////////////////////////////////////////////////////////////////
+//          Implementation of AllocationTracker
+////////////////////////////////////////////////////////////////
+
+bool AllocationTracker::isEnabled() {
+#ifdef MENGE_TRACK_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+
+size_t AllocationTracker::getThreadCount() {
+#ifdef MENGE_TRACK_ALLOCATIONS
+  return allocationCount;
+#else
+  return 0;
+#endif
+}
+
+////////////////////////////////////////////////////////////////
+
+size_t AllocationTracker::getCount() {
+  size_t count = 0;
+#ifdef MENGE_TRACK_ALLOCATIONS
+  // The team of this region is the team the calling thread uses for its own parallel loops; each
+  // member contributes the allocations it has performed.
+#pragma omp parallel reduction(+ : count)
+  count += allocationCount;
+#endif
+  return count;
+}
+}  // namespace Menge
@@ -0,0 +1,65 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __ALLOCATION_TRACKER_H__
+#define __ALLOCATION_TRACKER_H__
+
+/*!
+ @file    AllocationTracker.h
+ @brief   Optional counting of heap allocations.
+ */
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+
+namespace Menge {
+
+/*!
+ @brief   Counts the heap allocations performed through the global operator new.
+
+ Counting requires building MengeCore with MENGE_TRACK_ALLOCATIONS defined (the CMake option of the
+ same name), which replaces the global operator new and delete. Without it, the count is always
+ zero. Every thread keeps its own count. On platforms where MengeCore is a DLL, only allocations
+ made by MengeCore itself are counted.
+ */
+class MENGE_API AllocationTracker {
+ public:
+  /*!
+   @brief   Reports if allocation counting was compiled in.
+   */
+  static bool isEnabled();
+
+  /*!
+   @brief   Reports the number of allocations performed by the calling thread since it started.
+   */
+  static size_t getThreadCount();
+
+  /*!
+   @brief   Reports the number of allocations performed by the calling thread and the threads of
+            its OpenMP team since they started.
+
+   The team is the one a parallel region entered by the calling thread would use, i.e., the threads
+   which run the calling thread's parallel loops. Allocations made by unrelated threads (e.g.,
+   another simulator stepping on its own thread) are not included. Called from within a parallel
+   region, only the calling thread is counted.
+   */
+  static size_t getCount();
+};
+}  // namespace Menge
+#endif  // __ALLOCATION_TRACKER_H__
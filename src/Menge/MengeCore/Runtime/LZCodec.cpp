@@ -0,0 +1,147 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/LZCodec.h"
+
+#include <cstring>
+
+namespace Menge {
+
+namespace {
+// The shortest match worth encoding.
+const size_t MIN_MATCH = 4;
+// The farthest a match can reach back.
+const size_t MAX_OFFSET = 65535;
+// The hash table has 2^HASH_BITS entries.
+const int HASH_BITS = 13;
+
+inline unsigned int read32(const unsigned char* p) {
+  unsigned int v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline unsigned int hash(unsigned int v) { return (v * 2654435761u) >> (32 - HASH_BITS); }
+
+// Appends the continuation bytes of a length whose nibble was saturated.
+inline void putLength(std::vector<char>& dst, size_t length) {
+  for (; length >= 255; length -= 255) dst.push_back(static_cast<char>(255));
+  dst.push_back(static_cast<char>(length));
+}
+
+// Appends a token, its literals and (if matchLength is non-zero) its match.
+void putSequence(std::vector<char>& dst, const unsigned char* literals, size_t literalCount,
+                 size_t offset, size_t matchLength) {
+  const size_t matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+  const unsigned char token = static_cast<unsigned char>(
+      ((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+  dst.push_back(static_cast<char>(token));
+  if (literalCount >= 15) putLength(dst, literalCount - 15);
+  dst.insert(dst.end(), literals, literals + literalCount);
+  if (matchLength > 0) {
+    dst.push_back(static_cast<char>(offset & 0xFF));
+    dst.push_back(static_cast<char>(offset >> 8));
+    if (matchCode >= 15) putLength(dst, matchCode - 15);
+  }
+}
+
+// Reads the continuation bytes of a saturated length; returns false if the input runs out.
+inline bool getLength(const unsigned char*& ip, const unsigned char* end, size_t& length) {
+  unsigned char b;
+  do {
+    if (ip == end) return false;
+    b = *ip++;
+    length += b;
+  } while (b == 255);
+  return true;
+}
+}  // namespace
+
+////////////////////////////////////////////////////////////////
+//          Implementation of LZCodec
+////////////////////////////////////////////////////////////////
+
+size_t LZCodec::compress(const char* src, size_t size, std::vector<char>& dst) {
+  const size_t START = dst.size();
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+  // Every entry starts out referring to position zero, so the search starts at position one.
+  std::vector<size_t> table(size_t(1) << HASH_BITS, 0);
+  size_t anchor = 0;
+  size_t i = 1;
+  // Incompressible data is skipped over with growing strides.
+  size_t misses = 0;
+  while (i + MIN_MATCH <= size) {
+    const unsigned int word = read32(in + i);
+    const unsigned int h = hash(word);
+    const size_t candidate = table[h];
+    table[h] = i;
+    if (i - candidate > MAX_OFFSET || read32(in + candidate) != word) {
+      i += 1 + (misses++ >> 5);
+      continue;
+    }
+    misses = 0;
+    size_t length = MIN_MATCH;
+    while (i + length < size && in[candidate + length] == in[i + length]) ++length;
+    putSequence(dst, in + anchor, i - anchor, i - candidate, length);
+    i += length;
+    anchor = i;
+  }
+  putSequence(dst, in + anchor, size - anchor, 0, 0);
+  return dst.size() - START;
+}
+
+////////////////////////////////////////////////////////////////
+
+bool LZCodec::decompress(const char* src, size_t size, char* dst, size_t dstSize) {
+  const unsigned char* ip = reinterpret_cast<const unsigned char*>(src);
+  const unsigned char* const END = ip + size;
+  unsigned char* op = reinterpret_cast<unsigned char*>(dst);
+  unsigned char* const DST_START = op;
+  unsigned char* const DST_END = op + dstSize;
+  while (ip < END) {
+    const unsigned char token = *ip++;
+    size_t literalCount = token >> 4;
+    if (literalCount == 15 && !getLength(ip, END, literalCount)) return false;
+    if (literalCount > static_cast<size_t>(END - ip) ||
+        literalCount > static_cast<size_t>(DST_END - op)) {
+      return false;
+    }
+    memcpy(op, ip, literalCount);
+    op += literalCount;
+    ip += literalCount;
+    if (ip == END) break;
+
+    if (END - ip < 2) return false;
+    const size_t offset = ip[0] | (size_t(ip[1]) << 8);
+    ip += 2;
+    size_t length = token & 0x0F;
+    if (length == 15 && !getLength(ip, END, length)) return false;
+    length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - DST_START) ||
+        length > static_cast<size_t>(DST_END - op)) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, so it is copied one byte at a time.
+    const unsigned char* match = op - offset;
+    for (size_t i = 0; i < length; ++i) op[i] = match[i];
+    op += length;
+  }
+  return op == DST_END;
+}
+
+}  // namespace Menge
@@ -0,0 +1,72 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __LZ_CODEC_H__
+#define __LZ_CODEC_H__
+
+/*!
+ @file    LZCodec.h
+ @brief   A small, fast LZ77 compressor for blocks of bytes.
+ */
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Menge {
+
+/*!
+ @brief   Compresses and decompresses blocks of bytes with a byte-oriented LZ77 scheme (in the style
+          of LZ4).
+
+ A compressed block is a sequence of (literals, match) pairs. Each pair starts with a token byte:
+ the high nibble holds the literal count and the low nibble the match length minus four; a nibble
+ of 15 is continued in the following bytes (each byte is added, until a byte less than 255). The
+ literals follow, then the match's two-byte (little-endian) backwards offset and its length
+ continuation. The last pair has only literals.
+
+ Compression favors speed over ratio; it is meant for data with lots of short repetitions.
+ */
+class MENGE_API LZCodec {
+ public:
+  /*!
+   @brief   Compresses a block of bytes.
+
+   @param   src     The bytes to compress.
+   @param   size    The number of bytes to compress.
+   @param   dst     The compressed bytes are appended to this buffer.
+   @returns The number of compressed bytes.
+   */
+  static size_t compress(const char* src, size_t size, std::vector<char>& dst);
+
+  /*!
+   @brief   Decompresses a block of bytes.
+
+   @param   src       The compressed bytes.
+   @param   size      The number of compressed bytes.
+   @param   dst       The memory for the decompressed bytes.
+   @param   dstSize   The number of decompressed bytes expected.
+   @returns True if the block was well formed and decompressed to exactly dstSize bytes.
+   */
+  static bool decompress(const char* src, size_t size, char* dst, size_t dstSize);
+};
+
+}  // namespace Menge
+
+#endif  // __LZ_CODEC_H__
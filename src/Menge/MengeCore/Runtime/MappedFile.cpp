@@ -0,0 +1,132 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace Menge {
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of MappedFile
+/////////////////////////////////////////////////////////////////////
+
+MappedFile::MappedFile()
+    : _data(0x0),
+      _size(0),
+      _isOpen(false)
+#ifdef _WIN32
+      ,
+      _mapping(0x0)
+#endif  // _WIN32
+{
+}
+
+/////////////////////////////////////////////////////////////////////
+
+MappedFile::~MappedFile() { close(); }
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& pathName) {
+  close();
+  HANDLE file = CreateFileA(pathName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0x0,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0x0);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  _size = static_cast<size_t>(size.QuadPart);
+  if (_size > 0) {
+    _mapping = CreateFileMappingA(file, 0x0, PAGE_READONLY, 0, 0, 0x0);
+    if (_mapping != 0x0) {
+      _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+  // The mapping keeps the file open.
+  CloseHandle(file);
+  if (_size > 0 && _data == 0x0) {
+    close();
+    return false;
+  }
+  _isOpen = true;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void MappedFile::close() {
+  if (_data != 0x0) UnmapViewOfFile(_data);
+  if (_mapping != 0x0) CloseHandle(_mapping);
+  _mapping = 0x0;
+  _data = 0x0;
+  _size = 0;
+  _isOpen = false;
+}
+
+#else  // _WIN32
+
+bool MappedFile::open(const std::string& pathName) {
+  close();
+  const int fd = ::open(pathName.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+  _size = static_cast<size_t>(info.st_size);
+  if (_size > 0) {
+    void* data = mmap(0x0, _size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      _size = 0;
+      return false;
+    }
+    _data = static_cast<const char*>(data);
+  }
+  // The mapping keeps the file open.
+  ::close(fd);
+  _isOpen = true;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void MappedFile::close() {
+  if (_data != 0x0) munmap(const_cast<char*>(_data), _size);
+  _data = 0x0;
+  _size = 0;
+  _isOpen = false;
+}
+
+#endif  // _WIN32
+
+}  // namespace Menge
@@ -0,0 +1,110 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+/*!
+ @file    MappedFile.h
+ @brief   Read-only memory mapping of files.
+ */
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Menge {
+
+/*!
+ @brief   Maps a file into memory, read-only.
+
+ The file's pages are loaded by the operating system as they are touched, so only the parts of the
+ file which are actually read cost I/O.
+ */
+class MENGE_API MappedFile {
+ public:
+  /*!
+   @brief   Constructor; no file is mapped.
+   */
+  MappedFile();
+
+  /*!
+   @brief   Destructor; unmaps the file.
+   */
+  ~MappedFile();
+
+  /*!
+   @brief   Maps a file, unmapping the previously mapped file (if any).
+
+   @param   pathName    The path to the file.
+   @returns True if the file was mapped.
+   */
+  bool open(const std::string& pathName);
+
+  /*!
+   @brief   Unmaps the file (if any).
+   */
+  void close();
+
+  /*!
+   @brief   Reports if a file is mapped.
+   */
+  bool isOpen() const { return _isOpen; }
+
+  /*!
+   @brief   The mapped bytes (null if the file is empty or none is mapped).
+   */
+  const char* data() const { return _data; }
+
+  /*!
+   @brief   The size of the mapped file (in bytes).
+   */
+  size_t size() const { return _size; }
+
+ private:
+  // Not copyable.
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  /*!
+   @brief   The mapped bytes.
+   */
+  const char* _data;
+
+  /*!
+   @brief   The size of the mapping (in bytes).
+   */
+  size_t _size;
+
+  /*!
+   @brief   True if a file is open (empty files have no mapping).
+   */
+  bool _isOpen;
+
+#ifdef _WIN32
+  /*!
+   @brief   The handle of the file mapping object.
+   */
+  void* _mapping;
+#endif  // _WIN32
+};
+
+}  // namespace Menge
+
+#endif  // __MAPPED_FILE_H__
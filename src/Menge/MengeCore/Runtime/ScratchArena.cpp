@@ -0,0 +1,108 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/ScratchArena.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace Menge {
+
+namespace {
+// Every allocation is aligned to this many bytes.
+const size_t ALIGNMENT = 16;
+}  // namespace
+
+////////////////////////////////////////////////////////////////
+//          Implementation of ScratchArena::Scope
+////////////////////////////////////////////////////////////////
+
+ScratchArena::Scope::Scope() : _arena(&ScratchArena::local()) {
+  _block = _arena->_block;
+  _offset = _arena->_offset;
+}
+
+////////////////////////////////////////////////////////////////
+
+ScratchArena::Scope::~Scope() {
+  _arena->_block = _block;
+  _arena->_offset = _offset;
+}
+
+////////////////////////////////////////////////////////////////
+//          Implementation of ScratchArena
+////////////////////////////////////////////////////////////////
+
+const size_t ScratchArena::BLOCK_SIZE = 64 * 1024;
+
+////////////////////////////////////////////////////////////////
+
+ScratchArena::ScratchArena() : _blocks(), _block(0), _offset(0) {}
+
+////////////////////////////////////////////////////////////////
+
+ScratchArena::~ScratchArena() {
+  for (size_t i = 0; i < _blocks.size(); ++i) {
+    free(_blocks[i]._data);
+  }
+}
+
+////////////////////////////////////////////////////////////////
+
+ScratchArena& ScratchArena::local() {
+  static thread_local ScratchArena arena;
+  return arena;
+}
+
+////////////////////////////////////////////////////////////////
+
+void* ScratchArena::allocate(size_t bytes) {
+  bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  while (_block < _blocks.size()) {
+    Block& block = _blocks[_block];
+    if (_offset + bytes <= block._size) {
+      void* result = block._data + _offset;
+      _offset += bytes;
+      return result;
+    }
+    // Move on to the next block; the remainder of this one is wasted until the scope closes.
+    ++_block;
+    _offset = 0;
+  }
+
+  // Every block has been used: grow the chain. Blocks are never smaller than BLOCK_SIZE so that
+  // a sequence of small requests settles quickly.
+  Block block;
+  block._size = bytes > BLOCK_SIZE ? bytes : BLOCK_SIZE;
+  block._data = static_cast<char*>(malloc(block._size));
+  if (block._data == 0x0) throw std::bad_alloc();
+  _blocks.push_back(block);
+  _offset = bytes;
+  return block._data;
+}
+
+////////////////////////////////////////////////////////////////
+
+size_t ScratchArena::getCapacity() const {
+  size_t capacity = 0;
+  for (size_t i = 0; i < _blocks.size(); ++i) {
+    capacity += _blocks[i]._size;
+  }
+  return capacity;
+}
+}  // namespace Menge
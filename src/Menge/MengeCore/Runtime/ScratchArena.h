@@ -0,0 +1,224 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#ifndef __SCRATCH_ARENA_H__
+#define __SCRATCH_ARENA_H__
+
+/*!
+ @file    ScratchArena.h
+ @brief   Per-thread bump allocation of temporary memory for the simulation step.
+ */
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Menge {
+
+/*!
+ @brief   A bump allocator for short-lived, per-thread temporaries.
+
+ Each thread owns one arena (see local()). Allocation advances a cursor through a chain of blocks;
+ individual deallocation does nothing. Memory is returned in stack order by a ScratchArena::Scope:
+ everything allocated after a scope was opened is released when the scope closes, but the blocks
+ themselves are kept. Once the blocks have grown to the largest amount of memory a computation
+ needs, repeating the computation performs no heap allocations.
+
+ Memory from the arena must not outlive the innermost scope that was open when it was allocated.
+ */
+class MENGE_API ScratchArena {
+ public:
+  /*!
+   @brief   Releases, on destruction, all memory allocated from the calling thread's arena since
+            construction.
+   */
+  class MENGE_API Scope {
+   public:
+    /*!
+     @brief   Constructor. Records the state of the calling thread's arena.
+     */
+    Scope();
+
+    /*!
+     @brief   Destructor. Restores the recorded state.
+     */
+    ~Scope();
+
+   private:
+    /*!
+     @brief   The arena whose state was recorded.
+     */
+    ScratchArena* _arena;
+
+    /*!
+     @brief   The recorded block index.
+     */
+    size_t _block;
+
+    /*!
+     @brief   The recorded offset into the block.
+     */
+    size_t _offset;
+
+    // Not copyable.
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+  };
+
+  /*!
+   @brief   Constructor.
+   */
+  ScratchArena();
+
+  /*!
+   @brief   Destructor.
+   */
+  ~ScratchArena();
+
+  /*!
+   @brief   Returns the calling thread's arena, creating it on first use.
+   */
+  static ScratchArena& local();
+
+  /*!
+   @brief   Allocates memory aligned for any fundamental type.
+
+   @param   bytes   The number of bytes to allocate.
+   @returns A pointer to the memory.
+   */
+  void* allocate(size_t bytes);
+
+  /*!
+   @brief   Reports the total size of the arena's blocks in bytes.
+   */
+  size_t getCapacity() const;
+
+  /*!
+   @brief   The default size of a block, in bytes.
+   */
+  static const size_t BLOCK_SIZE;
+
+ protected:
+  /*!
+   @brief   A contiguous region of memory.
+   */
+  struct Block {
+    /*!
+     @brief   The start of the block.
+     */
+    char* _data;
+
+    /*!
+     @brief   The size of the block, in bytes.
+     */
+    size_t _size;
+  };
+
+  /*!
+   @brief   The blocks, in order of use.
+   */
+  std::vector<Block> _blocks;
+
+  /*!
+   @brief   The index of the block currently allocated from.
+   */
+  size_t _block;
+
+  /*!
+   @brief   The offset of the first free byte in the current block.
+   */
+  size_t _offset;
+
+ private:
+  // Not copyable.
+  ScratchArena(const ScratchArena&);
+  ScratchArena& operator=(const ScratchArena&);
+};
+
+/*!
+ @brief   A standard library allocator drawing from the calling thread's ScratchArena.
+
+ Containers using this allocator must be created and destroyed within a ScratchArena::Scope on a
+ single thread.
+
+ @tparam  T   The allocated type.
+ */
+template <typename T>
+class ScratchAllocator {
+ public:
+  /*!
+   @brief   The allocated type.
+   */
+  typedef T value_type;
+
+  /*!
+   @brief   The equivalent allocator for another type.
+   */
+  template <typename U>
+  struct rebind {
+    /*!
+     @brief   The rebound allocator type.
+     */
+    typedef ScratchAllocator<U> other;
+  };
+
+  /*!
+   @brief   Constructor. Binds the allocator to the calling thread's arena.
+   */
+  ScratchAllocator() : _arena(&ScratchArena::local()) {}
+
+  /*!
+   @brief   Converting constructor.
+   */
+  template <typename U>
+  ScratchAllocator(const ScratchAllocator<U>& other) : _arena(other._arena) {}
+
+  /*!
+   @brief   Allocates storage for `count` elements.
+   */
+  T* allocate(size_t count) { return static_cast<T*>(_arena->allocate(count * sizeof(T))); }
+
+  /*!
+   @brief   Does nothing; the memory is released by the enclosing ScratchArena::Scope.
+   */
+  void deallocate(T*, size_t) {}
+
+  /*!
+   @brief   The arena memory is drawn from.
+   */
+  ScratchArena* _arena;
+};
+
+/*!
+ @brief   Reports if two scratch allocators draw from the same arena.
+ */
+template <typename T, typename U>
+bool operator==(const ScratchAllocator<T>& a, const ScratchAllocator<U>& b) {
+  return a._arena == b._arena;
+}
+
+/*!
+ @brief   Reports if two scratch allocators draw from different arenas.
+ */
+template <typename T, typename U>
+bool operator!=(const ScratchAllocator<T>& a, const ScratchAllocator<U>& b) {
+  return a._arena != b._arena;
+}
+}  // namespace Menge
+#endif  // __SCRATCH_ARENA_H__
@@ -129,7 +129,7 @@ bool SimulatorDBEntry::finalize(Agents::SimulatorInterface* sim, BFSM::FSM* fsm)
 Agents::SimulatorInterface* SimulatorDBEntry::getSimulator(
     size_t& agentCount, float& simTimeStep, size_t subSteps, float simDuration,
     const std::string& behaveFile, const std::string& sceneFile, const std::string& outFile,
-    const std::string& scbVersion, bool verbose) {
+    const std::string& scbVersion, bool verbose, const Agents::SCBFilter* filter) {
   _sim = initSimulator(sceneFile, verbose);
   if (!_sim) {
     return 0x0;
@@ -172,7 +172,7 @@ Agents::SimulatorInterface* SimulatorDBEntry::getSimulator(
 
   _sim->setMaxDuration(simDuration);
   if (outFile != "") {
-    _sim->setOutput(outFile, scbVersion);
+    _sim->setOutput(outFile, scbVersion, filter);
   }
   agentCount = _sim->getNumAgents();
   return _sim;
@@ -39,6 +39,7 @@ class BaseAgentContext;
 namespace Agents {
 class AgentInitializer;
 class Integrator;
+class SCBFilter;
 class SimulatorInterface;
 }  // namespace Agents
 namespace SceneGraph {
@@ -134,12 +135,15 @@ class MENGE_API SimulatorDBEntry {
                           empty string, no output file will be written.
    @param    scbVersion    The scb version to write.
    @param    verbose        Determines if the initialization process prints status
+   @param    filter        The frames, agents and fields to write to the output file; if null,
+                          every agent's state is written every step.
    @returns  A pointer to the resultant SimulatorInterface. If there is an error, NULL is returned.
    */
   Agents::SimulatorInterface* getSimulator(size_t& agentCount, float& simTimeStep, size_t subSteps,
                                            float simDuration, const std::string& behaveFile,
                                            const std::string& sceneFile, const std::string& outFile,
-                                           const std::string& scbVersion, bool verbose);
+                                           const std::string& scbVersion, bool verbose,
+                                           const Agents::SCBFilter* filter = 0x0);
 
   /*!
    @brief    Reports the current run-time of an instantiated simulation.
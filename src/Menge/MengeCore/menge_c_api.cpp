@@ -10,13 +10,239 @@
 #include "MengeCore/BFSM/State.h"
 #include "MengeCore/Core.h"
 #include "MengeCore/PluginEngine/CorePluginEngine.h"
+#include "MengeCore/MengeException.h"
+#include "MengeCore/Runtime/AgentSnapshot.h"
+#include "MengeCore/Runtime/Logger.h"
 #include "MengeCore/Runtime/SimulatorDB.h"
 
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////////
+//          Simulator handles
+/////////////////////////////////////////////////////////////////////
+
+namespace {
+// The state of a running simulation that the core keeps in process globals (see Core.h).
+struct CoreState {
+  Menge::BFSM::FSM* _fsm;
+  float _time;
+  float _timeStep;
+  Menge::Agents::SpatialQuery* _spatialQuery;
+  Menge::Agents::Elevation* _elevation;
+  Menge::Agents::SimulatorInterface* _simulator;
+  Menge::EventSystem* _events;
+
+  // Copies the globals.
+  void capture() {
+    _fsm = Menge::ACTIVE_FSM;
+    _time = Menge::SIM_TIME;
+    _timeStep = Menge::SIM_TIME_STEP;
+    _spatialQuery = Menge::SPATIAL_QUERY;
+    _elevation = Menge::ELEVATION;
+    _simulator = Menge::SIMULATOR;
+    _events = Menge::EVENT_SYSTEM;
+  }
+
+  // Sets the globals.
+  void install() const {
+    Menge::ACTIVE_FSM = _fsm;
+    Menge::SIM_TIME = _time;
+    Menge::SIM_TIME_STEP = _timeStep;
+    Menge::SPATIAL_QUERY = _spatialQuery;
+    Menge::ELEVATION = _elevation;
+    Menge::SIMULATOR = _simulator;
+    Menge::EVENT_SYSTEM = _events;
+  }
+};
+}  // namespace
+
+// A simulator and everything the C API keeps for it.
+struct MengeSimulator {
+  MengeSimulator()
+      : _sim(0x0),
+        _events(new Menge::EventSystem()),
+        _core(),
+        _timeStep(0.f),
+        _subSteps(0),
+        _snapshot(0x0),
+        _triggers(),
+        _triggersValid(false),
+        _triggerLock(),
+        _firedTriggers(),
+        _worker(),
+        _stepLock(),
+        _stepSignal(),
+        _stepRequested(false),
+        _stepInFlight(false),
+        _stepResult(true),
+        _stepError(),
+        _stopWorker(false) {
+    _core._fsm = 0x0;
+    _core._time = 0.f;
+    _core._timeStep = 0.f;
+    _core._spatialQuery = 0x0;
+    _core._elevation = 0x0;
+    _core._simulator = 0x0;
+    _core._events = _events;
+  }
+
+  Menge::Agents::SimulatorInterface* _sim;
+
+  // The simulator's events; the core parses and evaluates them through Menge::EVENT_SYSTEM.
+  Menge::EventSystem* _events;
+
+  // The simulator's values of the core's globals, between calls.
+  CoreState _core;
+
+  // The simulator's (static) time step and sub steps.
+  float _timeStep;
+  size_t _subSteps;
+
+  // The snapshot published after each step (null if disabled).
+  Menge::AgentSnapshot* _snapshot;
+
+  std::vector<std::string> _triggers;
+  bool _triggersValid;
+
+  // The external triggers fired since the last step started; they are activated when the next
+  // step starts, so they can be fired during a step.
+  std::mutex _triggerLock;
+  std::vector<std::string> _firedTriggers;
+
+  // The thread running the steps started by MengeStepAsync() (created by the first one). It lives
+  // as long as the simulator, so its OpenMP workers are reused from step to step.
+  std::thread _worker;
+
+  // Guards the following members and signals changes to them.
+  std::mutex _stepLock;
+  std::condition_variable _stepSignal;
+
+  // Determines if the worker has a step to take.
+  bool _stepRequested;
+
+  // Determines if an asynchronous step has been started and hasn't finished.
+  bool _stepInFlight;
+
+  // The result of the last asynchronous step.
+  bool _stepResult;
+
+  // Why the last asynchronous step failed (empty if it didn't).
+  std::string _stepError;
+
+  // Determines if the worker must exit.
+  bool _stopWorker;
+};
+
+namespace {
+// Serializes the use of the core's globals by the simulators.
+std::mutex _coreLock;
+
+// While it exists, the core's globals hold a simulator's state. It locks them, installs the
+// simulator's values and, when it is destroyed, records the simulator's values and restores the
+// previous ones. (The simulators' static time step and model parameters aren't restored; each
+// simulator installs its own.)
+class SimulatorContext {
+ public:
+  explicit SimulatorContext(MengeSimulator* sim) : _lock(_coreLock), _sim(sim), _previous() {
+    _previous.capture();
+    _sim->_core.install();
+    if (_sim->_sim != 0x0) {
+      _sim->_sim->setTimeStep(_sim->_timeStep);
+      _sim->_sim->setSubSteps(_sim->_subSteps);
+      _sim->_sim->restoreModelParameters();
+    }
+  }
+
+  ~SimulatorContext() {
+    if (_sim->_sim != 0x0) _sim->_sim->saveModelParameters();
+    _sim->_core.capture();
+    _previous.install();
+  }
+
+ private:
+  std::lock_guard<std::mutex> _lock;
+  MengeSimulator* _sim;
+  CoreState _previous;
+};
+
+// Takes a step: activates the fired triggers, advances the simulation and publishes the snapshot.
+bool stepSimulator(MengeHandle handle) {
+  bool running;
+  {
+    SimulatorContext context(handle);
+    std::vector<std::string> fired;
+    {
+      std::lock_guard<std::mutex> lock(handle->_triggerLock);
+      fired.swap(handle->_firedTriggers);
+    }
+    for (size_t i = 0; i < fired.size(); ++i) {
+      handle->_events->activateExternalTrigger(fired[i]);
+    }
+    running = handle->_sim->step();
+  }
+  if (handle->_snapshot != 0x0) handle->_snapshot->publish(handle->_sim);
+  return running;
+}
+
+// Takes the steps requested by MengeStepAsync(), until the simulator is destroyed.
+void stepWorker(MengeHandle handle) {
+  std::unique_lock<std::mutex> lock(handle->_stepLock);
+  while (true) {
+    handle->_stepSignal.wait(lock,
+                             [handle]() { return handle->_stepRequested || handle->_stopWorker; });
+    if (handle->_stopWorker) return;
+    handle->_stepRequested = false;
+    lock.unlock();
+    bool running = false;
+    std::string error;
+    // The host can't catch the exceptions of this thread; the simulation stops and the failure is
+    // reported by MengeGetStepError() instead.
+    try {
+      running = stepSimulator(handle);
+    } catch (std::exception& e) {
+      error = e.what();
+      if (error.empty()) error = "Unknown error";
+    } catch (...) {
+      error = "Unknown exception";
+    }
+    if (!error.empty()) {
+      Menge::logger << Menge::Logger::ERR_MSG << "Asynchronous step failed: " << error;
+    }
+    lock.lock();
+    handle->_stepResult = running;
+    handle->_stepError = error;
+    handle->_stepInFlight = false;
+    handle->_stepSignal.notify_all();
+  }
+}
+
+// Waits for the simulator's asynchronous step (if any) to finish, returning its result.
+bool waitStep(MengeHandle handle) {
+  std::unique_lock<std::mutex> lock(handle->_stepLock);
+  handle->_stepSignal.wait(lock, [handle]() { return !handle->_stepInFlight; });
+  return handle->_stepResult;
+}
+
+// Clamps a range of agent indices to the agents in the simulation, returning its size.
+size_t agentRange(const Menge::Agents::SimulatorInterface* sim, size_t start, size_t count) {
+  const size_t AGT_COUNT = sim->getNumAgents();
+  if (start >= AGT_COUNT) return 0;
+  return std::min(count, AGT_COUNT - start);
+}
+}  // namespace
+
 /////////////////////////////////////////////////////////////////////
 //          Local Variables
 /////////////////////////////////////////////////////////////////////
 
-Menge::Agents::SimulatorInterface* _simulator = 0x0;
+// The simulator of the functions without a handle.
+MengeHandle _default = 0x0;
+
+// The snapshots of other processes opened with OpenAgentSnapshot().
+std::list<Menge::AgentSnapshot*> _openSnapshots;
 
 /////////////////////////////////////////////////////////////////////
 //          API implementation
@@ -24,85 +250,173 @@ Menge::Agents::SimulatorInterface* _simulator = 0x0;
 
 extern "C" {
 
+using Menge::AgentSnapshot;
 using Menge::Agents::BaseAgent;
 using Menge::Agents::Obstacle;
+using Menge::Agents::ObstacleVertexList;
+using Menge::Agents::SpatialQueryException;
 using Menge::Math::Vector2;
 using std::find;
 
-bool InitSimulator(const char* behaveFile, const char* sceneFile, const char* model,
-                   const char* pluginPath) {
+MengeHandle MengeCreate(const char* behaveFile, const char* sceneFile, const char* model,
+                        const char* pluginPath) {
   const bool VERBOSE = false;
-  if (_simulator != 0x0) delete _simulator;
-  Menge::SimulatorDB simDB;
-  // TODO: Plugin engine is *not* public.  I can't get plugins.
-  Menge::PluginEngine::CorePluginEngine engine(&simDB);
-  if (pluginPath != 0x0) {
-    engine.loadPlugins(pluginPath);
+  MengeHandle handle = new MengeSimulator();
+  {
+    SimulatorContext context(handle);
+    Menge::SimulatorDB simDB;
+    // TODO: Plugin engine is *not* public.  I can't get plugins.
+    Menge::PluginEngine::CorePluginEngine engine(&simDB);
+    if (pluginPath != 0x0) {
+      engine.loadPlugins(pluginPath);
+    }
+    Menge::SimulatorDBEntry* simDBEntry = simDB.getDBEntry(std::string(model));
+    if (simDBEntry != 0x0) {
+      size_t agentCount;
+      float timeStep = 0.1f;        // Default to 10Hz
+      int subSteps = 0;             // take no sub steps
+      float duration = 1e6;         // effectively no simulation duration.
+      std::string outFile = "";     // Don't write an scb file.
+      std::string scbVersion = "";  // No scb version
+      bool verbose = false;
+      handle->_sim = simDBEntry->getSimulator(agentCount, timeStep, subSteps, duration, behaveFile,
+                                              sceneFile, outFile, scbVersion, verbose);
+    }
+    if (handle->_sim != 0x0) {
+      handle->_timeStep = handle->_sim->getTimeStep();
+      handle->_subSteps = handle->_sim->getSubSteps();
+    }
+  }
+  if (handle->_sim == 0x0) {
+    MengeDestroy(handle);
+    return 0x0;
   }
-  Menge::SimulatorDBEntry* simDBEntry = simDB.getDBEntry(std::string(model));
-  if (simDBEntry == 0x0) return false;
+  return handle;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void MengeDestroy(MengeHandle handle) {
+  if (handle == 0x0) return;
+  waitStep(handle);
+  if (handle->_worker.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(handle->_stepLock);
+      handle->_stopWorker = true;
+    }
+    handle->_stepSignal.notify_all();
+    handle->_worker.join();
+  }
+  MengeDisableAgentSnapshot(handle);
+  {
+    SimulatorContext context(handle);
+    delete handle->_sim;
+    delete handle->_events;
+    handle->_sim = 0x0;
+    handle->_events = 0x0;
+  }
+  delete handle;
+}
+
+/////////////////////////////////////////////////////////////////////
 
-  size_t agentCount;
-  float timeStep = 0.1f;        // Default to 10Hz
-  int subSteps = 0;             // take no sub steps
-  float duration = 1e6;         // effectively no simulation duration.
-  std::string outFile = "";     // Don't write an scb file.
-  std::string scbVersion = "";  // No scb version
-  bool verbose = false;
-  _simulator = simDBEntry->getSimulator(agentCount, timeStep, subSteps, duration, behaveFile,
-                                        sceneFile, outFile, scbVersion, verbose);
-  return _simulator != 0x0;
+void MengeSetTimeStep(MengeHandle handle, float timeStep) {
+  assert(handle != 0x0);
+  waitStep(handle);
+  SimulatorContext context(handle);
+  handle->_sim->setTimeStep(timeStep);
+  handle->_timeStep = timeStep;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-void SetTimeStep(float timeStep) {
-  assert(_simulator != 0x0);
-  _simulator->setTimeStep(timeStep);
+bool MengeStep(MengeHandle handle) {
+  assert(handle != 0x0);
+  waitStep(handle);
+  return stepSimulator(handle);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-bool DoStep() {
-  assert(_simulator != 0x0);
-  return _simulator->step();
+bool MengeStepAsync(MengeHandle handle) {
+  assert(handle != 0x0);
+  std::lock_guard<std::mutex> lock(handle->_stepLock);
+  if (handle->_stepInFlight) return false;
+  if (!handle->_worker.joinable()) handle->_worker = std::thread(stepWorker, handle);
+  handle->_stepRequested = true;
+  handle->_stepInFlight = true;
+  handle->_stepSignal.notify_all();
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool MengeWaitStep(MengeHandle handle) {
+  assert(handle != 0x0);
+  return waitStep(handle);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-const char* GetStateName(size_t state_id) {
-  assert(_simulator != nullptr);
-  Menge::BFSM::FSM* bfsm = _simulator->getBFSM();
-  if (state_id < bfsm->getNodeCount()) {
-    Menge::BFSM::State* state = bfsm->getNode(state_id);
-    return state->getName().c_str();
+bool MengeIsStepDone(MengeHandle handle) {
+  assert(handle != 0x0);
+  std::lock_guard<std::mutex> lock(handle->_stepLock);
+  return !handle->_stepInFlight;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const char* MengeGetStepError(MengeHandle handle) {
+  assert(handle != 0x0);
+  std::lock_guard<std::mutex> lock(handle->_stepLock);
+  if (handle->_stepInFlight || handle->_stepError.empty()) return 0x0;
+  return handle->_stepError.c_str();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float MengeGetTime(MengeHandle handle) {
+  assert(handle != 0x0);
+  return handle->_sim->getGlobalTime();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const char* MengeGetStateName(MengeHandle handle, size_t state_id) {
+  assert(handle != nullptr);
+  Menge::BFSM::FSM* bfsm = handle->_sim->getBFSM();
+  // State ids are unique across every simulator in the process, so they only index the nodes of
+  // the first state machine.
+  for (size_t i = 0; i < bfsm->getNodeCount(); ++i) {
+    Menge::BFSM::State* state = bfsm->getNode(i);
+    if (state->getID() == state_id) return state->getName().c_str();
   }
   return nullptr;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-size_t StateCount() {
-  assert(_simulator != nullptr);
-  Menge::BFSM::FSM* bfsm = _simulator->getBFSM();
+size_t MengeStateCount(MengeHandle handle) {
+  assert(handle != nullptr);
+  Menge::BFSM::FSM* bfsm = handle->_sim->getBFSM();
   return bfsm->getNodeCount();
 }
 
 /////////////////////////////////////////////////////////////////////
 
-size_t AgentCount() {
-  assert(_simulator != 0x0);
-  return _simulator->getNumAgents();
+size_t MengeAgentCount(MengeHandle handle) {
+  assert(handle != 0x0);
+  return handle->_sim->getNumAgents();
 }
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetAgentPosition(size_t i, float* x, float* y, float* z) {
-  assert(_simulator != 0x0);
-  BaseAgent* agt = _simulator->getAgent(i);
+bool MengeGetAgentPosition(MengeHandle handle, size_t i, float* x, float* y, float* z) {
+  assert(handle != 0x0);
+  BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != 0x0) {
     *x = agt->_pos._x;
-    *y = _simulator->getElevation(agt);
+    *y = handle->_sim->getElevation(agt);
     *z = agt->_pos._y;
     return true;
   }
@@ -111,9 +425,9 @@ bool GetAgentPosition(size_t i, float* x, float* y, float* z) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetAgentVelocity(size_t i, float* x, float* y, float* z) {
-  assert(_simulator != 0x0);
-  BaseAgent* agt = _simulator->getAgent(i);
+bool MengeGetAgentVelocity(MengeHandle handle, size_t i, float* x, float* y, float* z) {
+  assert(handle != 0x0);
+  BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != 0x0) {
     *x = agt->_vel._x;
     *y = 0;  // get elevation
@@ -125,9 +439,9 @@ bool GetAgentVelocity(size_t i, float* x, float* y, float* z) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetAgentPrefVelocity(size_t i, float* x, float* y) {
-  assert(_simulator != nullptr);
-  Menge::Agents::BaseAgent* agt = _simulator->getAgent(i);
+bool MengeGetAgentPrefVelocity(MengeHandle handle, size_t i, float* x, float* y) {
+  assert(handle != nullptr);
+  Menge::Agents::BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != nullptr) {
     const auto& vel_pref = agt->_velPref.getPreferredVel();
     *x = vel_pref._x;
@@ -139,11 +453,11 @@ bool GetAgentPrefVelocity(size_t i, float* x, float* y) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetAgentState(size_t i, size_t* state_id) {
-  assert(_simulator != nullptr);
-  Menge::Agents::BaseAgent* agt = _simulator->getAgent(i);
+bool MengeGetAgentState(MengeHandle handle, size_t i, size_t* state_id) {
+  assert(handle != nullptr);
+  Menge::Agents::BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != nullptr) {
-    const auto* bfsm = _simulator->getBFSM();
+    const auto* bfsm = handle->_sim->getBFSM();
     *state_id = bfsm->getAgentStateID(agt->_id);
     return true;
   }
@@ -152,9 +466,9 @@ bool GetAgentState(size_t i, size_t* state_id) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetAgentOrient(size_t i, float* x, float* y) {
-  assert(_simulator != 0x0);
-  BaseAgent* agt = _simulator->getAgent(i);
+bool MengeGetAgentOrient(MengeHandle handle, size_t i, float* x, float* y) {
+  assert(handle != 0x0);
+  BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != 0x0) {
     *x = agt->_orient._x;
     *y = agt->_orient._y;
@@ -165,9 +479,9 @@ bool GetAgentOrient(size_t i, float* x, float* y) {
 
 /////////////////////////////////////////////////////////////////////
 
-int GetAgentClass(size_t i) {
-  assert(_simulator != 0x0);
-  BaseAgent* agt = _simulator->getAgent(i);
+int MengeGetAgentClass(MengeHandle handle, size_t i) {
+  assert(handle != 0x0);
+  BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != 0x0) {
     return static_cast<int>(agt->_class);
   }
@@ -176,9 +490,9 @@ int GetAgentClass(size_t i) {
 
 /////////////////////////////////////////////////////////////////////
 
-float GetAgentRadius(size_t i) {
-  assert(_simulator != 0x0);
-  BaseAgent* agt = _simulator->getAgent(i);
+float MengeGetAgentRadius(MengeHandle handle, size_t i) {
+  assert(handle != 0x0);
+  BaseAgent* agt = handle->_sim->getAgentById(i);
   if (agt != 0x0) {
     return agt->_radius;
   }
@@ -187,43 +501,181 @@ float GetAgentRadius(size_t i) {
 
 /////////////////////////////////////////////////////////////////////
 
-std::vector<std::string> triggers;
-bool triggersValid = false;
+size_t MengeGetAgentPositions(MengeHandle handle, size_t start, size_t count, float* positions) {
+  assert(handle != 0x0);
+  const Menge::Agents::SimulatorInterface* sim = handle->_sim;
+  const int COUNT = static_cast<int>(agentRange(sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    const BaseAgent* agt = sim->getAgentById(start + a);
+    float* pos = positions + 3 * a;
+    pos[0] = agt->_pos._x;
+    pos[1] = sim->getElevation(agt);
+    pos[2] = agt->_pos._y;
+  }
+  return static_cast<size_t>(COUNT);
+}
 
 /////////////////////////////////////////////////////////////////////
 
-int ExternalTriggerCount() {
-  if (!triggersValid) triggers = Menge::EVENT_SYSTEM->listExternalTriggers();
-  return static_cast<int>(triggers.size());
+size_t MengeGetAgentVelocities(MengeHandle handle, size_t start, size_t count, float* velocities) {
+  assert(handle != 0x0);
+  const Menge::Agents::SimulatorInterface* sim = handle->_sim;
+  const int COUNT = static_cast<int>(agentRange(sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    const BaseAgent* agt = sim->getAgentById(start + a);
+    float* vel = velocities + 3 * a;
+    vel[0] = agt->_vel._x;
+    vel[1] = 0;  // get elevation
+    vel[2] = agt->_vel._y;
+  }
+  return static_cast<size_t>(COUNT);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-const char* ExternalTriggerName(int i) {
-  if (i < ExternalTriggerCount()) {
-    return triggers[i].c_str();
+size_t MengeGetAgentPrefVelocities(MengeHandle handle, size_t start, size_t count,
+                                   float* velocities) {
+  assert(handle != 0x0);
+  const Menge::Agents::SimulatorInterface* sim = handle->_sim;
+  const int COUNT = static_cast<int>(agentRange(sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    const Vector2& vel_pref = sim->getAgentById(start + a)->_velPref.getPreferredVel();
+    velocities[2 * a] = vel_pref._x;
+    velocities[2 * a + 1] = vel_pref._y;
+  }
+  return static_cast<size_t>(COUNT);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t MengeGetAgentOrients(MengeHandle handle, size_t start, size_t count, float* orients) {
+  assert(handle != 0x0);
+  const Menge::Agents::SimulatorInterface* sim = handle->_sim;
+  const int COUNT = static_cast<int>(agentRange(sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    const BaseAgent* agt = sim->getAgentById(start + a);
+    orients[2 * a] = agt->_orient._x;
+    orients[2 * a + 1] = agt->_orient._y;
+  }
+  return static_cast<size_t>(COUNT);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t MengeGetAgentStates(MengeHandle handle, size_t start, size_t count, size_t* state_ids) {
+  assert(handle != 0x0);
+  const Menge::BFSM::FSM* bfsm = handle->_sim->getBFSM();
+  const int COUNT = static_cast<int>(agentRange(handle->_sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    state_ids[a] = bfsm->getAgentStateID(start + a);
+  }
+  return static_cast<size_t>(COUNT);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t MengeGetAgentClasses(MengeHandle handle, size_t start, size_t count, int* classes) {
+  assert(handle != 0x0);
+  const Menge::Agents::SimulatorInterface* sim = handle->_sim;
+  const int COUNT = static_cast<int>(agentRange(sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    classes[a] = static_cast<int>(sim->getAgentById(start + a)->_class);
+  }
+  return static_cast<size_t>(COUNT);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t MengeGetAgentRadii(MengeHandle handle, size_t start, size_t count, float* radii) {
+  assert(handle != 0x0);
+  const Menge::Agents::SimulatorInterface* sim = handle->_sim;
+  const int COUNT = static_cast<int>(agentRange(sim, start, count));
+#pragma omp parallel for
+  for (int a = 0; a < COUNT; ++a) {
+    radii[a] = sim->getAgentById(start + a)->_radius;
+  }
+  return static_cast<size_t>(COUNT);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool MengeEnableAgentSnapshot(MengeHandle handle, const char* sharedName) {
+  assert(handle != 0x0);
+  waitStep(handle);
+  MengeDisableAgentSnapshot(handle);
+  handle->_snapshot = new AgentSnapshot();
+  if (!handle->_snapshot->create(handle->_sim->getNumAgents(),
+                                 sharedName != 0x0 ? sharedName : "")) {
+    MengeDisableAgentSnapshot(handle);
+    return false;
+  }
+  handle->_snapshot->publish(handle->_sim);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void MengeDisableAgentSnapshot(MengeHandle handle) {
+  assert(handle != 0x0);
+  waitStep(handle);
+  delete handle->_snapshot;
+  handle->_snapshot = 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const void* MengeGetAgentSnapshot(MengeHandle handle) {
+  assert(handle != 0x0);
+  return handle->_snapshot != 0x0 ? handle->_snapshot->data() : 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+int MengeExternalTriggerCount(MengeHandle handle) {
+  assert(handle != 0x0);
+  // The triggers are registered when the behavior is parsed.
+  if (!handle->_triggersValid) {
+    handle->_triggers = handle->_events->listExternalTriggers();
+    handle->_triggersValid = true;
+  }
+  return static_cast<int>(handle->_triggers.size());
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const char* MengeExternalTriggerName(MengeHandle handle, int i) {
+  if (i < MengeExternalTriggerCount(handle)) {
+    return handle->_triggers[i].c_str();
   }
   return nullptr;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-void FireExternalTrigger(const char* triggerName) {
-  Menge::EVENT_SYSTEM->activateExternalTrigger(triggerName);
+void MengeFireExternalTrigger(MengeHandle handle, const char* triggerName) {
+  assert(handle != 0x0);
+  std::lock_guard<std::mutex> lock(handle->_triggerLock);
+  handle->_firedTriggers.push_back(triggerName);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-size_t ObstacleCount() {
-  assert(_simulator != 0x0);
-  return _simulator->getSpatialQuery()->getObstacles().size();
+size_t MengeObstacleCount(MengeHandle handle) {
+  assert(handle != 0x0);
+  return handle->_sim->getSpatialQuery()->getObstacles().size();
 }
 
 /////////////////////////////////////////////////////////////////////
 
-size_t GetNextObstacle(size_t i) {
-  assert(_simulator != 0x0);
-  const std::vector<Obstacle*>& obstacles = _simulator->getSpatialQuery()->getObstacles();
+size_t MengeGetNextObstacle(MengeHandle handle, size_t i) {
+  assert(handle != 0x0);
+  const std::vector<Obstacle*>& obstacles = handle->_sim->getSpatialQuery()->getObstacles();
   assert(i < obstacles.size());
   const Obstacle* queryObstacle = obstacles[i];
   const Obstacle* nextObstacle = queryObstacle->next();
@@ -235,28 +687,16 @@ size_t GetNextObstacle(size_t i) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetObstacleEndPoints(size_t i, float* x0, float* y0, float* z0, float* x1, float* y1,
-                          float* z1) {
-  assert(_simulator != 0x0);
-  const std::vector<Obstacle*>& obstacles = _simulator->getSpatialQuery()->getObstacles();
-  assert(i < obstacles.size());
-  const Obstacle* queryObstacle = obstacles[i];
-  const Vector2& p0 = queryObstacle->getP0();
-  *x0 = p0._x;
-  *y0 = 0.0;  // TODO: Use elevation to set this more intelligently.
-  *z0 = p0._y;
-  const Vector2& p1 = queryObstacle->getP1();
-  *x1 = p1._x;
-  *y1 = 0.0;  // TODO: Use elevation to set this more intelligently.
-  *z1 = p1._y;
-  return true;
+bool MengeGetObstacleEndPoints(MengeHandle handle, size_t i, float* x0, float* y0, float* z0,
+                               float* x1, float* y1, float* z1) {
+  return MengeGetObstacleP0(handle, i, x0, y0, z0) && MengeGetObstacleP1(handle, i, x1, y1, z1);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetObstacleP0(size_t i, float* x0, float* y0, float* z0) {
-  assert(_simulator != 0x0);
-  const std::vector<Obstacle*>& obstacles = _simulator->getSpatialQuery()->getObstacles();
+bool MengeGetObstacleP0(MengeHandle handle, size_t i, float* x0, float* y0, float* z0) {
+  assert(handle != 0x0);
+  const std::vector<Obstacle*>& obstacles = handle->_sim->getSpatialQuery()->getObstacles();
   assert(i < obstacles.size());
   const Obstacle* queryObstacle = obstacles[i];
   const Vector2& p0 = queryObstacle->getP0();
@@ -268,9 +708,9 @@ bool GetObstacleP0(size_t i, float* x0, float* y0, float* z0) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool GetObstacleP1(size_t i, float* x1, float* y1, float* z1) {
-  assert(_simulator != 0x0);
-  const std::vector<Obstacle*>& obstacles = _simulator->getSpatialQuery()->getObstacles();
+bool MengeGetObstacleP1(MengeHandle handle, size_t i, float* x1, float* y1, float* z1) {
+  assert(handle != 0x0);
+  const std::vector<Obstacle*>& obstacles = handle->_sim->getSpatialQuery()->getObstacles();
   assert(i < obstacles.size());
   const Obstacle* queryObstacle = obstacles[i];
   const Vector2& p1 = queryObstacle->getP1();
@@ -279,4 +719,315 @@ bool GetObstacleP1(size_t i, float* x1, float* y1, float* z1) {
   *z1 = p1._y;
   return true;
 }
-}  // extern"C"
\ No newline at end of file
+
+/////////////////////////////////////////////////////////////////////
+
+bool MengeAddDynamicObstacle(MengeHandle handle, const float* vertices, size_t vertexCount,
+                             bool closed, size_t obstacleClass, size_t* id) {
+  assert(handle != 0x0);
+  // Obstacles can't change while the agents are being updated.
+  waitStep(handle);
+  ObstacleVertexList polyline;
+  polyline.closed = closed;
+  for (size_t i = 0; i < vertexCount; ++i) {
+    polyline.vertices.push_back(Vector2(vertices[2 * i], vertices[2 * i + 1]));
+  }
+  try {
+    *id = handle->_sim->getSpatialQuery()->addDynamicObstacle(polyline, obstacleClass);
+  } catch (const SpatialQueryException& e) {
+    Menge::logger << Menge::Logger::ERR_MSG << "Unable to add a dynamic obstacle: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool MengeRemoveDynamicObstacle(MengeHandle handle, size_t id) {
+  assert(handle != 0x0);
+  waitStep(handle);
+  try {
+    return handle->_sim->getSpatialQuery()->removeDynamicObstacle(id);
+  } catch (const SpatialQueryException& e) {
+    Menge::logger << Menge::Logger::ERR_MSG << "Unable to remove a dynamic obstacle: "
+                  << e.what();
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool MengeTranslateDynamicObstacle(MengeHandle handle, size_t id, float dx, float dy) {
+  assert(handle != 0x0);
+  waitStep(handle);
+  try {
+    return handle->_sim->getSpatialQuery()->translateDynamicObstacle(id, Vector2(dx, dy));
+  } catch (const SpatialQueryException& e) {
+    Menge::logger << Menge::Logger::ERR_MSG << "Unable to move a dynamic obstacle: " << e.what();
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////
+//          The default simulator
+/////////////////////////////////////////////////////////////////////
+
+bool InitSimulator(const char* behaveFile, const char* sceneFile, const char* model,
+                   const char* pluginPath) {
+  MengeDestroy(_default);
+  _default = MengeCreate(behaveFile, sceneFile, model, pluginPath);
+  return _default != 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SetTimeStep(float timeStep) { MengeSetTimeStep(_default, timeStep); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool DoStep() { return MengeStep(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool DoStepAsync() { return MengeStepAsync(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool WaitStep() { return MengeWaitStep(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool IsStepDone() { return MengeIsStepDone(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+const char* GetStepError() { return MengeGetStepError(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+const char* GetStateName(size_t state_id) { return MengeGetStateName(_default, state_id); }
+
+/////////////////////////////////////////////////////////////////////
+
+size_t StateCount() { return MengeStateCount(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+size_t AgentCount() { return MengeAgentCount(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetAgentPosition(size_t i, float* x, float* y, float* z) {
+  return MengeGetAgentPosition(_default, i, x, y, z);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetAgentVelocity(size_t i, float* x, float* y, float* z) {
+  return MengeGetAgentVelocity(_default, i, x, y, z);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetAgentPrefVelocity(size_t i, float* x, float* y) {
+  return MengeGetAgentPrefVelocity(_default, i, x, y);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetAgentState(size_t i, size_t* state_id) {
+  return MengeGetAgentState(_default, i, state_id);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetAgentOrient(size_t i, float* x, float* y) {
+  return MengeGetAgentOrient(_default, i, x, y);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+int GetAgentClass(size_t i) { return MengeGetAgentClass(_default, i); }
+
+/////////////////////////////////////////////////////////////////////
+
+float GetAgentRadius(size_t i) { return MengeGetAgentRadius(_default, i); }
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentPositions(size_t start, size_t count, float* positions) {
+  return MengeGetAgentPositions(_default, start, count, positions);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentVelocities(size_t start, size_t count, float* velocities) {
+  return MengeGetAgentVelocities(_default, start, count, velocities);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentPrefVelocities(size_t start, size_t count, float* velocities) {
+  return MengeGetAgentPrefVelocities(_default, start, count, velocities);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentOrients(size_t start, size_t count, float* orients) {
+  return MengeGetAgentOrients(_default, start, count, orients);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentStates(size_t start, size_t count, size_t* state_ids) {
+  return MengeGetAgentStates(_default, start, count, state_ids);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentClasses(size_t start, size_t count, int* classes) {
+  return MengeGetAgentClasses(_default, start, count, classes);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentRadii(size_t start, size_t count, float* radii) {
+  return MengeGetAgentRadii(_default, start, count, radii);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool EnableAgentSnapshot(const char* sharedName) {
+  return MengeEnableAgentSnapshot(_default, sharedName);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void DisableAgentSnapshot() {
+  if (_default != 0x0) MengeDisableAgentSnapshot(_default);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const void* GetAgentSnapshot() { return _default != 0x0 ? MengeGetAgentSnapshot(_default) : 0x0; }
+
+/////////////////////////////////////////////////////////////////////
+
+int ExternalTriggerCount() { return _default != 0x0 ? MengeExternalTriggerCount(_default) : 0; }
+
+/////////////////////////////////////////////////////////////////////
+
+const char* ExternalTriggerName(int i) {
+  return _default != 0x0 ? MengeExternalTriggerName(_default, i) : nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void FireExternalTrigger(const char* triggerName) {
+  if (_default != 0x0) MengeFireExternalTrigger(_default, triggerName);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t ObstacleCount() { return MengeObstacleCount(_default); }
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetNextObstacle(size_t i) { return MengeGetNextObstacle(_default, i); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetObstacleEndPoints(size_t i, float* x0, float* y0, float* z0, float* x1, float* y1,
+                          float* z1) {
+  return MengeGetObstacleEndPoints(_default, i, x0, y0, z0, x1, y1, z1);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetObstacleP0(size_t i, float* x0, float* y0, float* z0) {
+  return MengeGetObstacleP0(_default, i, x0, y0, z0);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool GetObstacleP1(size_t i, float* x1, float* y1, float* z1) {
+  return MengeGetObstacleP1(_default, i, x1, y1, z1);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool AddDynamicObstacle(const float* vertices, size_t vertexCount, bool closed,
+                        size_t obstacleClass, size_t* id) {
+  if (_default == 0x0) return false;
+  return MengeAddDynamicObstacle(_default, vertices, vertexCount, closed, obstacleClass, id);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool RemoveDynamicObstacle(size_t id) {
+  return _default != 0x0 && MengeRemoveDynamicObstacle(_default, id);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool TranslateDynamicObstacle(size_t id, float dx, float dy) {
+  return _default != 0x0 && MengeTranslateDynamicObstacle(_default, id, dx, dy);
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Snapshots of other processes
+/////////////////////////////////////////////////////////////////////
+
+const void* OpenAgentSnapshot(const char* sharedName) {
+  AgentSnapshot* snapshot = new AgentSnapshot();
+  if (sharedName == 0x0 || !snapshot->open(sharedName)) {
+    delete snapshot;
+    return 0x0;
+  }
+  _openSnapshots.push_back(snapshot);
+  return snapshot->data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void CloseAgentSnapshot(const void* snapshot) {
+  for (std::list<AgentSnapshot*>::iterator itr = _openSnapshots.begin();
+       itr != _openSnapshots.end(); ++itr) {
+    if ((*itr)->data() == snapshot) {
+      delete *itr;
+      _openSnapshots.erase(itr);
+      return;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t AgentSnapshotAgentCount(const void* snapshot) {
+  return static_cast<const AgentSnapshot::Header*>(snapshot)->_agentCount;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned long long AgentSnapshotSequence(const void* snapshot) {
+  return AgentSnapshot::getSequence(snapshot);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const void* AgentSnapshotField(const void* snapshot, unsigned long long sequence, int field) {
+  return AgentSnapshot::getField(snapshot, sequence, static_cast<AgentSnapshot::Field>(field));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float AgentSnapshotTime(const void* snapshot, unsigned long long sequence) {
+  return AgentSnapshot::getTime(snapshot, sequence);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool AgentSnapshotIsCurrent(const void* snapshot, unsigned long long sequence) {
+  return AgentSnapshot::isCurrent(snapshot, sequence);
+}
+}  // extern"C"
@@ -63,13 +63,70 @@ MENGE_API bool DoStep();
 
 //@}
 
+/*! @name   Asynchronous stepping
+ @brief   Functions for advancing the simulator while the host keeps running.
+
+ DoStepAsync() starts a step on a worker thread (the step itself still uses Menge's OpenMP threads)
+ and returns immediately; IsStepDone() polls it and WaitStep() waits for it. While a step is in
+ flight, the simulator's agents are being changed, so only the following are safe to call:
+
+   - the snapshot functions that read a published frame (GetAgentSnapshot(), AgentSnapshotField(),
+     etc.): the step publishes its frame into the other buffer when it finishes, so the last frame
+     stays readable (see "Agent snapshot"). This is how a host renders during a step.
+   - IsStepDone() and WaitStep().
+   - FireExternalTrigger(): triggers are activated when the next step starts.
+   - AgentCount(), StateCount(), GetStateName(), ExternalTriggerCount(), ExternalTriggerName() and
+     the obstacle functions, which report what doesn't change during a simulation.
+
+ The other agent functions (GetAgentPosition(), GetAgentPositions(), etc.) report a partially
+ updated state and must not be called until the step is done. DoStep(), SetTimeStep(),
+ EnableAgentSnapshot() and DisableAgentSnapshot() first wait for the step to finish.
+ */
+//@{
+
+/*!
+ @brief    Starts advancing the state of the simulator one time step, without waiting for it.
+
+ @returns  True if the step was started; false if a step is already in flight.
+ */
+MENGE_API bool DoStepAsync();
+
+/*!
+ @brief    Waits for the step started by DoStepAsync() to finish.
+
+ @returns  True if the simulation can keep running (see DoStep()); if no step is in flight, the
+           result of the last asynchronous step. False if the step failed (see GetStepError()).
+ */
+MENGE_API bool WaitStep();
+
+/*!
+ @brief    Reports if the step started by DoStepAsync() has finished (true if none was started).
+ */
+MENGE_API bool IsStepDone();
+
+/*!
+ @brief    Reports why the last asynchronous step failed.
+
+ DoStep() lets the exceptions of a failed step propagate to the caller; an asynchronous step runs
+ on the worker thread, which catches them (of any type) and records the failure instead.
+
+ @returns  The failure's message, or null if the last asynchronous step succeeded or is still in
+           flight. The string is valid until the next step is started.
+ */
+MENGE_API const char* GetStepError();
+
+//@}
+
 /*! @name   FSM introspection */
 //@{
 
 /*!
  @brief    Reports the name of the state with the given id.
 
- @param    state_id   The id of the desired state.
+ State ids are unique across all of the simulators in the process (see MengeCreate()), so they are
+ not necessarily smaller than StateCount().
+
+ @param    state_id   The id of the desired state, as reported by GetAgentState().
  @returns  A pointer to the c-string of the state's name. Nullptr if state_id does not refer to a
            valid state.
  */
@@ -84,6 +141,9 @@ MENGE_API size_t StateCount();
 
 /*! @name   Agent functions
  @brief   Functions for querying the state of the simulator agents.
+
+ Agents are indexed by their identifiers, in the range [0, AgentCount()). An agent's index does not
+ change over the simulation, even if the simulator reorders its agents in memory.
  */
 //@{
 
@@ -164,6 +224,203 @@ MENGE_API float GetAgentRadius(size_t i);
 
 //@}
 
+/*! @name   Bulk agent functions
+ @brief   Functions for querying a field of many agents in a single call.
+
+ Each function reports the agents with indices in the range [start, start + count) (clamped to the
+ agents in the simulation) into a caller-provided buffer, in index order. Multi-component values are
+ interleaved by agent (e.g., x0, y0, z0, x1, y1, z1, ...), with the same components as the
+ corresponding per-agent function, so the buffer must hold `count` times the number of components.
+ The agents are processed in parallel. To query all agents, pass a `start` of zero and a `count` of
+ AgentCount().
+
+ Each returns the number of agents reported (zero if `start` is not a valid index).
+ */
+//@{
+
+/*!
+ @brief   Reports the 3D positions (x, elevation, y) of a range of agents; see GetAgentPosition().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  positions   The buffer for three floats per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentPositions(size_t start, size_t count, float* positions);
+
+/*!
+ @brief   Reports the 3D velocities of a range of agents; see GetAgentVelocity().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  velocities  The buffer for three floats per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentVelocities(size_t start, size_t count, float* velocities);
+
+/*!
+ @brief   Reports the 2D preferred velocities of a range of agents; see GetAgentPrefVelocity().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  velocities  The buffer for two floats per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentPrefVelocities(size_t start, size_t count, float* velocities);
+
+/*!
+ @brief   Reports the 2D orientations of a range of agents; see GetAgentOrient().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  orients     The buffer for two floats per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentOrients(size_t start, size_t count, float* orients);
+
+/*!
+ @brief   Reports the ids of the states a range of agents are currently in; see GetAgentState().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  state_ids   The buffer for one state id per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentStates(size_t start, size_t count, size_t* state_ids);
+
+/*!
+ @brief   Reports the classes of a range of agents; see GetAgentClass().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  classes     The buffer for one class per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentClasses(size_t start, size_t count, int* classes);
+
+/*!
+ @brief   Reports the radii of a range of agents; see GetAgentRadius().
+
+ @param[in]   start       The index of the first agent.
+ @param[in]   count       The number of agents.
+ @param[out]  radii       The buffer for one radius per agent.
+ @returns     The number of agents reported.
+ */
+MENGE_API size_t GetAgentRadii(size_t start, size_t count, float* radii);
+
+//@}
+
+/*! @name   Agent snapshot
+ @brief   A shared, double-buffered view of the agents' state which hosts read without copying.
+
+ When enabled, every DoStep() publishes the agents' positions (x, y and elevation), velocities,
+ orientations and state ids into a snapshot: a versioned block of memory holding two buffers, each
+ with one array per field, indexed by agent (see Menge::AgentSnapshot for the layout). The snapshot
+ can live in a named shared-memory segment, so another process (e.g., a visualizer) can open it with
+ OpenAgentSnapshot() and read it live.
+
+ Each published frame gets the next sequence number and frame `s` is written into buffer `s % 2`, so
+ a frame can be read while the next one is published. To read a consistent frame:
+
+   1. `s = AgentSnapshotSequence(snapshot)` (zero means nothing has been published yet),
+   2. get the arrays with AgentSnapshotField(snapshot, s, field) (null means the frame is gone),
+   3. read them in place, then
+   4. if `AgentSnapshotIsCurrent(snapshot, s)` is false, a later frame overwrote the buffer while
+      it was read; start over.
+
+ The fields are numbered: 0 x-position, 1 y-position, 2 elevation, 3 x-velocity, 4 y-velocity,
+ 5 x-orientation, 6 y-orientation (arrays of `float`) and 7 state id (array of 32-bit `unsigned
+ int`).
+ */
+//@{
+
+/*!
+ @brief   Starts publishing the agents' state into a snapshot after each step (replacing the current
+          snapshot, if any). The current state is published immediately.
+
+ @param   sharedName    The name of the shared-memory segment to create (e.g., "/menge"); if null or
+                        empty, the snapshot is only visible to this process.
+ @returns True if the snapshot was created.
+ */
+MENGE_API bool EnableAgentSnapshot(const char* sharedName = 0x0);
+
+/*!
+ @brief   Stops publishing and releases the snapshot (removing its shared-memory segment). On POSIX
+          systems, a segment outlives a process that exits without calling this; a later
+          EnableAgentSnapshot() with the same name reuses it.
+ */
+MENGE_API void DisableAgentSnapshot();
+
+/*!
+ @brief   Reports the snapshot published by this process's simulator.
+
+ @returns The snapshot, or null if it is not enabled.
+ */
+MENGE_API const void* GetAgentSnapshot();
+
+/*!
+ @brief   Opens, read-only, a snapshot published by another process.
+
+ @param   sharedName    The name the publisher gave to EnableAgentSnapshot().
+ @returns The snapshot, or null if it doesn't exist. It must be closed with CloseAgentSnapshot().
+ */
+MENGE_API const void* OpenAgentSnapshot(const char* sharedName);
+
+/*!
+ @brief   Closes a snapshot opened with OpenAgentSnapshot().
+
+ @param   snapshot    The snapshot.
+ */
+MENGE_API void CloseAgentSnapshot(const void* snapshot);
+
+/*!
+ @brief   Reports the number of agents in each frame of a snapshot.
+
+ @param   snapshot    The snapshot.
+ @returns The agent count.
+ */
+MENGE_API size_t AgentSnapshotAgentCount(const void* snapshot);
+
+/*!
+ @brief   Reports the sequence number of the latest frame published into a snapshot.
+
+ @param   snapshot    The snapshot.
+ @returns The sequence number (zero if no frame has been published).
+ */
+MENGE_API unsigned long long AgentSnapshotSequence(const void* snapshot);
+
+/*!
+ @brief   Reports one field of a frame in a snapshot, in place.
+
+ @param   snapshot    The snapshot.
+ @param   sequence    The frame's sequence number.
+ @param   field       The field's number.
+ @returns The field's array (one value per agent), or null if the frame is not in the snapshot.
+ */
+MENGE_API const void* AgentSnapshotField(const void* snapshot, unsigned long long sequence,
+                                         int field);
+
+/*!
+ @brief   Reports the simulation time of a frame in a snapshot.
+
+ @param   snapshot    The snapshot.
+ @param   sequence    The frame's sequence number.
+ @returns The global time (negative if the frame is not in the snapshot).
+ */
+MENGE_API float AgentSnapshotTime(const void* snapshot, unsigned long long sequence);
+
+/*!
+ @brief   Reports if a frame is still in a snapshot; the values read from its arrays are only
+          consistent if it is.
+
+ @param   snapshot    The snapshot.
+ @param   sequence    The frame's sequence number.
+ @returns True if the frame is still in the snapshot.
+ */
+MENGE_API bool AgentSnapshotIsCurrent(const void* snapshot, unsigned long long sequence);
+
+//@}
+
 /*! @name   External triggers.
  @brief   The interface for working with external triggers.
 
@@ -250,6 +507,216 @@ MENGE_API bool GetObstacleP0(size_t i, float* x0, float* y0, float* z0);
  @returns  True if the values have been properly set.
  */
 MENGE_API bool GetObstacleP1(size_t i, float* x1, float* y1, float* z1);
+
+/*!
+ @brief   Adds a dynamic obstacle: an obstacle which can be moved or removed while the simulation
+          runs (e.g., a door or a vehicle).
+
+ Dynamic obstacles are only supported by the kd-tree spatial query. They affect the agents from the
+ next step on, but they are not among the obstacles reported by ObstacleCount() and its companions.
+
+ @param   vertices      The obstacle's vertices, as `vertexCount` (x, y) pairs in the simulation's
+                        plane (the x- and z-values of the 3D accessors), counter-clockwise if the
+                        obstacle is closed.
+ @param   vertexCount   The number of vertices.
+ @param   closed        True if the last vertex connects to the first.
+ @param   obstacleClass The obstacle's class (see the agents' `obstacleSet` mask).
+ @param   id            The obstacle's identifier, set by this function.
+ @returns True if the obstacle was added, false if the spatial query doesn't support dynamic
+          obstacles or the vertices don't define an obstacle.
+ */
+MENGE_API bool AddDynamicObstacle(const float* vertices, size_t vertexCount, bool closed,
+                                  size_t obstacleClass, size_t* id);
+
+/*!
+ @brief   Removes a dynamic obstacle.
+
+ @param   id    The identifier of the obstacle, given by AddDynamicObstacle().
+ @returns True if the obstacle was removed, false if there is no such obstacle.
+ */
+MENGE_API bool RemoveDynamicObstacle(size_t id);
+
+/*!
+ @brief   Moves a dynamic obstacle.
+
+ @param   id    The identifier of the obstacle, given by AddDynamicObstacle().
+ @param   dx    The displacement along the x-axis.
+ @param   dy    The displacement along the y-axis (in the simulation's plane).
+ @returns True if the obstacle was moved, false if there is no such obstacle.
+ */
+MENGE_API bool TranslateDynamicObstacle(size_t id, float dx, float dy);
+
+/*! @name   Simulator handles
+ @brief   Functions for creating and working with many independent simulators.
+
+ Every function above works on a single, default simulator (the one created by InitSimulator()).
+ The functions below do the same work on the simulator identified by a handle, so a host can create
+ any number of simulators (e.g., to evaluate variations of a scenario) and drive them from different
+ threads. `MengeX(handle, ...)` behaves as `X(...)` on the handle's simulator; the functions above
+ are wrappers around the default simulator's handle.
+
+ Each simulator has its own behavior, events, external triggers and snapshot. Menge's core keeps the
+ state of the running simulation (the time, the time step, the active BFSM, etc.) in process
+ globals, and the pedestrian models keep their parameters (e.g., Helbing's `agent_scale`, GCF's
+ distance table and the interaction kernels' `approximate_exp`) in statics shared by all simulators
+ of the model. So MengeCreate(), MengeDestroy(), MengeSetTimeStep() and MengeStep() install the
+ simulator's state and parameters under a process-wide lock: they can be called from any thread, at
+ any time, but the lock serializes them across all handles. Simulators never step in parallel, not
+ even when they are stepped from different threads or asynchronously (see "Asynchronous stepping");
+ each step uses all of Menge's worker threads instead. Driving several handles from several threads
+ overlaps one simulator's step with the host's work on the others (e.g., reading their results), not
+ with their steps. Simulators of the same model can use different parameters; each parses its
+ parameters starting from the model's defaults. The other functions only use the handle's own
+ simulator and take no process-wide lock, so they can run while other simulators step. A single
+ handle must not be used by two threads at once, except as allowed during an asynchronous step (see
+ "Asynchronous stepping").
+ */
+//@{
+
+/*!
+ @brief   An opaque handle to a simulator.
+ */
+typedef struct MengeSimulator* MengeHandle;
+
+/*!
+ @brief   Creates a simulator; see InitSimulator().
+
+ @returns  The simulator's handle (null if creation failed). It must be released with
+           MengeDestroy().
+ */
+MENGE_API MengeHandle MengeCreate(const char* behaveFile, const char* sceneFile, const char* model,
+                                  const char* pluginPath = 0x0);
+
+/*!
+ @brief   Destroys a simulator created with MengeCreate() (and its snapshot, if any), once its
+          asynchronous step (if any) is done.
+ */
+MENGE_API void MengeDestroy(MengeHandle handle);
+
+/*! @brief   See SetTimeStep(). */
+MENGE_API void MengeSetTimeStep(MengeHandle handle, float timeStep);
+
+/*! @brief   See DoStep(). */
+MENGE_API bool MengeStep(MengeHandle handle);
+
+/*! @brief   See DoStepAsync(). */
+MENGE_API bool MengeStepAsync(MengeHandle handle);
+
+/*! @brief   See WaitStep(). */
+MENGE_API bool MengeWaitStep(MengeHandle handle);
+
+/*! @brief   See IsStepDone(). */
+MENGE_API bool MengeIsStepDone(MengeHandle handle);
+
+/*! @brief   See GetStepError(). */
+MENGE_API const char* MengeGetStepError(MengeHandle handle);
+
+/*! @brief   Reports the simulation time of the simulator. */
+MENGE_API float MengeGetTime(MengeHandle handle);
+
+/*! @brief   See GetStateName(). */
+MENGE_API const char* MengeGetStateName(MengeHandle handle, size_t state_id);
+
+/*! @brief   See StateCount(). */
+MENGE_API size_t MengeStateCount(MengeHandle handle);
+
+/*! @brief   See AgentCount(). */
+MENGE_API size_t MengeAgentCount(MengeHandle handle);
+
+/*! @brief   See GetAgentPosition(). */
+MENGE_API bool MengeGetAgentPosition(MengeHandle handle, size_t i, float* x, float* y, float* z);
+
+/*! @brief   See GetAgentVelocity(). */
+MENGE_API bool MengeGetAgentVelocity(MengeHandle handle, size_t i, float* x, float* y, float* z);
+
+/*! @brief   See GetAgentPrefVelocity(). */
+MENGE_API bool MengeGetAgentPrefVelocity(MengeHandle handle, size_t i, float* x, float* y);
+
+/*! @brief   See GetAgentState(). */
+MENGE_API bool MengeGetAgentState(MengeHandle handle, size_t i, size_t* state_id);
+
+/*! @brief   See GetAgentOrient(). */
+MENGE_API bool MengeGetAgentOrient(MengeHandle handle, size_t i, float* x, float* y);
+
+/*! @brief   See GetAgentClass(). */
+MENGE_API int MengeGetAgentClass(MengeHandle handle, size_t i);
+
+/*! @brief   See GetAgentRadius(). */
+MENGE_API float MengeGetAgentRadius(MengeHandle handle, size_t i);
+
+/*! @brief   See GetAgentPositions(). */
+MENGE_API size_t MengeGetAgentPositions(MengeHandle handle, size_t start, size_t count,
+                                        float* positions);
+
+/*! @brief   See GetAgentVelocities(). */
+MENGE_API size_t MengeGetAgentVelocities(MengeHandle handle, size_t start, size_t count,
+                                         float* velocities);
+
+/*! @brief   See GetAgentPrefVelocities(). */
+MENGE_API size_t MengeGetAgentPrefVelocities(MengeHandle handle, size_t start, size_t count,
+                                             float* velocities);
+
+/*! @brief   See GetAgentOrients(). */
+MENGE_API size_t MengeGetAgentOrients(MengeHandle handle, size_t start, size_t count,
+                                      float* orients);
+
+/*! @brief   See GetAgentStates(). */
+MENGE_API size_t MengeGetAgentStates(MengeHandle handle, size_t start, size_t count,
+                                     size_t* state_ids);
+
+/*! @brief   See GetAgentClasses(). */
+MENGE_API size_t MengeGetAgentClasses(MengeHandle handle, size_t start, size_t count,
+                                      int* classes);
+
+/*! @brief   See GetAgentRadii(). */
+MENGE_API size_t MengeGetAgentRadii(MengeHandle handle, size_t start, size_t count, float* radii);
+
+/*! @brief   See EnableAgentSnapshot(); shared names must be unique across simulators. */
+MENGE_API bool MengeEnableAgentSnapshot(MengeHandle handle, const char* sharedName = 0x0);
+
+/*! @brief   See DisableAgentSnapshot(). */
+MENGE_API void MengeDisableAgentSnapshot(MengeHandle handle);
+
+/*! @brief   See GetAgentSnapshot(). */
+MENGE_API const void* MengeGetAgentSnapshot(MengeHandle handle);
+
+/*! @brief   See ExternalTriggerCount(). */
+MENGE_API int MengeExternalTriggerCount(MengeHandle handle);
+
+/*! @brief   See ExternalTriggerName(). */
+MENGE_API const char* MengeExternalTriggerName(MengeHandle handle, int i);
+
+/*! @brief   See FireExternalTrigger(). */
+MENGE_API void MengeFireExternalTrigger(MengeHandle handle, const char* triggerName);
+
+/*! @brief   See ObstacleCount(). */
+MENGE_API size_t MengeObstacleCount(MengeHandle handle);
+
+/*! @brief   See GetNextObstacle(). */
+MENGE_API size_t MengeGetNextObstacle(MengeHandle handle, size_t i);
+
+/*! @brief   See GetObstacleEndPoints(). */
+MENGE_API bool MengeGetObstacleEndPoints(MengeHandle handle, size_t i, float* x0, float* y0,
+                                         float* z0, float* x1, float* y1, float* z1);
+
+/*! @brief   See GetObstacleP0(). */
+MENGE_API bool MengeGetObstacleP0(MengeHandle handle, size_t i, float* x0, float* y0, float* z0);
+
+/*! @brief   See GetObstacleP1(). */
+MENGE_API bool MengeGetObstacleP1(MengeHandle handle, size_t i, float* x1, float* y1, float* z1);
+
+/*! @brief   See AddDynamicObstacle(). */
+MENGE_API bool MengeAddDynamicObstacle(MengeHandle handle, const float* vertices,
+                                       size_t vertexCount, bool closed, size_t obstacleClass,
+                                       size_t* id);
+
+/*! @brief   See RemoveDynamicObstacle(). */
+MENGE_API bool MengeRemoveDynamicObstacle(MengeHandle handle, size_t id);
+
+/*! @brief   See TranslateDynamicObstacle(). */
+MENGE_API bool MengeTranslateDynamicObstacle(MengeHandle handle, size_t id, float dx, float dy);
+
+//@}
 }
 
 #endif  // __MENGE_C_API__
@@ -166,7 +166,7 @@ void FunnelPlanner::computeCrossing(float radius, const Vector2& startPos, Porta
     pLeft.set(portal->getLeft(radius));
     bool apexMoved = false;
     while (!_right.empty()) {
-      std::list<FunnelEdge>::iterator itr = _right.begin();
+      FunnelQueue::iterator itr = _right.begin();
       Vector2 dir = pLeft - itr->_origin;
       if (itr->isOnRight(dir)) {
         apexMoved = true;
@@ -182,7 +182,7 @@ void FunnelPlanner::computeCrossing(float radius, const Vector2& startPos, Porta
       _left.clear();
       _left.push_back(FunnelEdge(apex._id, i, pLeft - apex._pos, apex._pos));
     } else {
-      std::list<FunnelEdge>::reverse_iterator itr = _left.rbegin();
+      FunnelQueue::reverse_iterator itr = _left.rbegin();
       while (!_left.empty()) {
         Vector2 dir = pLeft - itr->_origin;
         if (itr->isOnRight(dir)) {
@@ -204,7 +204,7 @@ void FunnelPlanner::computeCrossing(float radius, const Vector2& startPos, Porta
     pRight.set(portal->getRight(radius));
     apexMoved = false;
     while (!_left.empty()) {
-      std::list<FunnelEdge>::iterator itr = _left.begin();
+      FunnelQueue::iterator itr = _left.begin();
       Vector2 dir = pRight - itr->_origin;
       if (itr->isOnLeft(dir)) {
         apexMoved = true;
@@ -220,7 +220,7 @@ void FunnelPlanner::computeCrossing(float radius, const Vector2& startPos, Porta
       _right.clear();
       _right.push_back(FunnelEdge(apex._id, i, pRight - apex._pos, apex._pos));
     } else {
-      std::list<FunnelEdge>::reverse_iterator itr = _right.rbegin();
+      FunnelQueue::reverse_iterator itr = _right.rbegin();
       while (!_right.empty()) {
         Vector2 dir = pRight - itr->_origin;
         if (itr->isOnLeft(dir)) {
@@ -244,7 +244,7 @@ void FunnelPlanner::computeCrossing(float radius, const Vector2& startPos, Porta
 
   bool apexMoved = false;
   while (!_left.empty()) {
-    std::list<FunnelEdge>::iterator itr = _left.begin();
+    FunnelQueue::iterator itr = _left.begin();
     goalDir.set(goalPt - itr->_origin);
     if (itr->isOnLeft(goalDir)) {
       apexMoved = true;
@@ -262,7 +262,7 @@ void FunnelPlanner::computeCrossing(float radius, const Vector2& startPos, Porta
   } else {
     // apexMoved is already false -- it is the only way to reach this branch
     while (!_right.empty()) {
-      std::list<FunnelEdge>::iterator itr = _right.begin();
+      FunnelQueue::iterator itr = _right.begin();
       goalDir.set(goalPt - itr->_origin);
       if (itr->isOnRight(goalDir)) {
         apexMoved = true;
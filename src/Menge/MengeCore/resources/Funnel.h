@@ -29,6 +29,8 @@
 
 #include "MengeCore/mengeCommon.h"
 
+#include "MengeCore/Runtime/ScratchArena.h"
+
 #include <list>
 
 namespace Menge {
@@ -185,6 +187,9 @@ class FunnelEdge {
 
 /*!
  @brief    The class that implements the funnel algorithm.
+
+ The funnel queues are allocated from the calling thread's ScratchArena; a planner must be created
+ and destroyed within a ScratchArena::Scope.
  */
 class FunnelPlanner {
  public:
@@ -211,15 +216,20 @@ class FunnelPlanner {
 
 #ifndef SIMPLE_FUNNEL
  protected:
+  /*!
+   @brief    A queue of funnel edges.
+   */
+  typedef std::list<FunnelEdge, ScratchAllocator<FunnelEdge> > FunnelQueue;
+
   /*!
    @brief    The queue for the left side of the funnel.
    */
-  std::list<FunnelEdge> _left;
+  FunnelQueue _left;
 
   /*!
    @brief    The queue for the right side of the funnel.
    */
-  std::list<FunnelEdge> _right;
+  FunnelQueue _right;
 #endif  // SIMPLE_FUNNEL
 };
 }  // namespace Menge
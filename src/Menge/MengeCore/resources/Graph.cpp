@@ -46,9 +46,12 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/resources/MinHeap.h"
 #include "MengeCore/resources/RoadMapPath.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <utility>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -64,10 +67,29 @@ const std::string Graph::LABEL("graph");
 
 /////////////////////////////////////////////////////////////////////
 
+/*!
+ @brief    The default maximum number of routes in a graph's route cache.
+ */
+const size_t DEFAULT_ROUTE_CACHE_SIZE = 4096;
+
+/*!
+ @brief    The default maximum number of shortest-path trees a graph keeps.
+ */
+const size_t DEFAULT_SHORTEST_PATH_TREE_LIMIT = 256;
+
+/////////////////////////////////////////////////////////////////////
+
 Graph::Graph(const std::string& fileName)
     : Resource(fileName),
       _vCount(0),
       _vertices(0x0),
+      _gridOrigin(0.f, 0.f),
+      _cellSize(1.f),
+      _gridCols(0),
+      _gridRows(0),
+      _routeCacheSize(DEFAULT_ROUTE_CACHE_SIZE),
+      _useTrees(false),
+      _treeLimit(DEFAULT_SHORTEST_PATH_TREE_LIMIT),
       DATA_SIZE(0),
       STATE_SIZE(0),
       _HEAP(0x0),
@@ -86,6 +108,13 @@ void Graph::clear() {
     delete[] _vertices;
     _vertices = 0x0;
   }
+  _gridCols = _gridRows = 0;
+  _cellStart.clear();
+  _cellVertices.clear();
+  _routeCache.clear();
+  _routeCacheOrder.clear();
+  _trees.clear();
+  _treeOrder.clear();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -191,6 +220,7 @@ Resource* Graph::load(const std::string& fileName) {
 
   delete[] vertNbr;
   graph->initHeapMemory();
+  graph->initVertexGrid();
   return graph;
 }
 
@@ -241,31 +271,215 @@ const GraphVertex* Graph::getVertex(size_t i) const {
 
 //////////////////////////////////////////////////////////////////////////////////////
 
+void Graph::setRouteCacheSize(size_t size) {
+  _routeLock.lockWrite();
+  _routeCacheSize = size;
+  while (_routeCacheOrder.size() > _routeCacheSize) {
+    _routeCache.erase(_routeCacheOrder.front());
+    _routeCacheOrder.pop_front();
+  }
+  _routeLock.releaseWrite();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+size_t Graph::getCachedRouteCount() const {
+  _routeLock.lockRead();
+  const size_t count = _routeCache.size();
+  _routeLock.releaseRead();
+  return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+bool Graph::isRouteCached(size_t startID, size_t endID) const {
+  _routeLock.lockRead();
+  const bool cached = _routeCache.find(startID * _vCount + endID) != _routeCache.end();
+  _routeLock.releaseRead();
+  return cached;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+void Graph::setUseShortestPathTrees(bool useTrees) { _useTrees = useTrees; }
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+bool Graph::getUseShortestPathTrees() const { return _useTrees; }
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+void Graph::setShortestPathTreeLimit(size_t limit) {
+  _treeLock.lockWrite();
+  _treeLimit = limit;
+  while (_treeOrder.size() > _treeLimit) {
+    _trees.erase(_treeOrder.front());
+    _treeOrder.pop_front();
+  }
+  _treeLock.releaseWrite();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+size_t Graph::getShortestPathTreeLimit() const {
+  _treeLock.lockRead();
+  const size_t limit = _treeLimit;
+  _treeLock.releaseRead();
+  return limit;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+size_t Graph::getShortestPathTreeCount() const {
+  _treeLock.lockRead();
+  const size_t count = _trees.size();
+  _treeLock.releaseRead();
+  return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
 size_t Graph::getClosestVertex(const Vector2& point, float radius, Clearance clearance) {
   assert(_vCount > 0 && "Trying to operate on an empty roadmap");
-  // TODO(curds01): Make this faster via a spatial hash - in other words, test them in the order
-  // of closest to farthest.
-
-  float bestDistSq = INFTY;
-  size_t bestID = -1;
-  for (size_t i = 0; i < _vCount; ++i) {
-    float testDistSq = absSq(_vertices[i].getPosition() - point);
-    if (testDistSq < bestDistSq) {
+  // Vertices are considered in order of increasing distance (ties broken by index) by visiting the
+  // grid cells in rings around the point's cell. Every vertex outside of rings [0, r] is at least
+  // r * _cellSize away, so candidates closer than that can be tested in order and the first one
+  // which is clear is the answer.
+  typedef std::pair<float, size_t> Candidate;  // (squared distance, vertex index)
+  // Reused across calls so that the candidate heap does not allocate in the steady state.
+  static thread_local std::vector<Candidate> candidates;
+  candidates.clear();
+  const int col = getCellCoord(point._x, _gridOrigin._x);
+  const int row = getCellCoord(point._y, _gridOrigin._y);
+  // The first ring which touches the grid and the ring beyond which no cell of the grid lies.
+  const int minRing = std::max(std::max(0, std::max(-col, col - (_gridCols - 1))),
+                               std::max(-row, row - (_gridRows - 1)));
+  const int maxRing =
+      std::max(std::max(col, _gridCols - 1 - col), std::max(row, _gridRows - 1 - row));
+
+  for (int ring = minRing; ring <= maxRing; ++ring) {
+    const int rMin = std::max(row - ring, 0);
+    const int rMax = std::min(row + ring, _gridRows - 1);
+    const int cMin = std::max(col - ring, 0);
+    const int cMax = std::min(col + ring, _gridCols - 1);
+    for (int r = rMin; r <= rMax; ++r) {
+      // Interior rows of the ring only contribute their two end cells.
+      const bool edgeRow = r == row - ring || r == row + ring;
+      for (int c = cMin; c <= cMax; ++c) {
+        if (!edgeRow && c != col - ring && c != col + ring) continue;
+        const size_t cell = r * _gridCols + c;
+        for (size_t i = _cellStart[cell]; i < _cellStart[cell + 1]; ++i) {
+          const size_t v = _cellVertices[i];
+          candidates.push_back(Candidate(absSq(_vertices[v].getPosition() - point), v));
+          std::push_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+        }
+      }
+    }
+
+    // Test every candidate that is guaranteed to be closer than any vertex not yet seen.
+    const float bound = ring * _cellSize;
+    const float boundSq = ring < maxRing ? bound * bound : INFTY;
+    while (!candidates.empty() && candidates.front().first < boundSq) {
+      std::pop_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+      const size_t v = candidates.back().second;
+      candidates.pop_back();
       if ((clearance == Clearance::Full &&
-           Menge::SPATIAL_QUERY->queryVisibility(point, _vertices[i].getPosition(), radius)) ||
-          Menge::SPATIAL_QUERY->linkIsTraversible(point, _vertices[i].getPosition(), radius)) {
-        bestDistSq = testDistSq;
-        bestID = i;
+           Menge::SPATIAL_QUERY->queryVisibility(point, _vertices[v].getPosition(), radius)) ||
+          Menge::SPATIAL_QUERY->linkIsTraversible(point, _vertices[v].getPosition(), radius)) {
+        return v;
       }
     }
   }
 
-  return bestID;
+  return -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+void Graph::initVertexGrid() {
+  _cellStart.clear();
+  _cellVertices.clear();
+  _gridCols = _gridRows = 0;
+  if (_vCount == 0) return;
+
+  Vector2 minPt(_vertices[0].getPosition());
+  Vector2 maxPt(minPt);
+  for (size_t v = 1; v < _vCount; ++v) {
+    const Vector2 p = _vertices[v].getPosition();
+    minPt.set(std::min(minPt._x, p._x), std::min(minPt._y, p._y));
+    maxPt.set(std::max(maxPt._x, p._x), std::max(maxPt._y, p._y));
+  }
+  // Size the cells so that, for a uniform distribution, there are roughly two vertices per cell.
+  const float width = std::max(maxPt._x - minPt._x, EPS);
+  const float height = std::max(maxPt._y - minPt._y, EPS);
+  _cellSize = std::max(sqrtf(2.f * width * height / _vCount), EPS);
+  _gridOrigin = minPt;
+  _gridCols = getCellCoord(maxPt._x, minPt._x) + 1;
+  _gridRows = getCellCoord(maxPt._y, minPt._y) + 1;
+
+  // Counting sort of the vertices into the cells.
+  const size_t CELL_COUNT = static_cast<size_t>(_gridCols) * _gridRows;
+  std::vector<size_t> vertCell(_vCount);
+  _cellStart.assign(CELL_COUNT + 1, 0);
+  for (size_t v = 0; v < _vCount; ++v) {
+    const Vector2 p = _vertices[v].getPosition();
+    vertCell[v] = getCellCoord(p._y, minPt._y) * _gridCols + getCellCoord(p._x, minPt._x);
+    ++_cellStart[vertCell[v] + 1];
+  }
+  for (size_t c = 0; c < CELL_COUNT; ++c) {
+    _cellStart[c + 1] += _cellStart[c];
+  }
+  _cellVertices.resize(_vCount);
+  std::vector<size_t> fill(_cellStart.begin(), _cellStart.end() - 1);
+  for (size_t v = 0; v < _vCount; ++v) {
+    _cellVertices[fill[vertCell[v]]++] = v;
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////
 
 RoadMapPath* Graph::getPath(size_t startID, size_t endID) {
+  std::vector<size_t> route;
+  if (_useTrees) {
+    if (!getTreeRoute(startID, endID, route)) {
+      logger << Logger::ERR_MSG << "Was unable to find a path from " << startID;
+      logger << " to " << endID << "\n";
+      return 0x0;
+    }
+    return makePath(route);
+  }
+
+  const size_t key = startID * _vCount + endID;
+  // A hit moves the route to the back of the eviction order, so even a lookup takes the write lock.
+  _routeLock.lockWrite();
+  HASH_MAP<size_t, CachedRoute>::iterator itr = _routeCache.find(key);
+  const bool cached = itr != _routeCache.end();
+  if (cached) {
+    _routeCacheOrder.splice(_routeCacheOrder.end(), _routeCacheOrder, itr->second._order);
+    route = itr->second._route;
+  }
+  _routeLock.releaseWrite();
+  if (cached) return makePath(route);
+
+  if (!computeRoute(startID, endID, route)) return 0x0;
+
+  _routeLock.lockWrite();
+  if (_routeCacheSize > 0 && _routeCache.find(key) == _routeCache.end()) {
+    if (_routeCacheOrder.size() >= _routeCacheSize) {
+      _routeCache.erase(_routeCacheOrder.front());
+      _routeCacheOrder.pop_front();
+    }
+    CachedRoute& entry = _routeCache[key];
+    entry._route = route;
+    entry._order = _routeCacheOrder.insert(_routeCacheOrder.end(), key);
+  }
+  _routeLock.releaseWrite();
+  return makePath(route);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+bool Graph::computeRoute(size_t startID, size_t endID, std::vector<size_t>& route) {
   const size_t N = _vCount;
 #ifdef _OPENMP
   // Assuming that threadNum \in [0, omp_get_max_threads() )
@@ -319,7 +533,7 @@ RoadMapPath* Graph::getPath(size_t startID, size_t endID) {
   if (!found) {
     logger << Logger::ERR_MSG << "Was unable to find a path from " << startID;
     logger << " to " << endID << "\n";
-    return 0x0;
+    return false;
   }
 
   // Count the number of nodes in the path
@@ -330,13 +544,115 @@ RoadMapPath* Graph::getPath(size_t startID, size_t endID) {
     next = heap.getReachedFrom((unsigned int)next);
   }
 
-  RoadMapPath* path = new RoadMapPath(wayCount);
+  route.resize(wayCount);
   next = endID;
   for (size_t i = wayCount; i > 0; --i) {
-    path->setWayPoint(i - 1, _vertices[next].getPosition());
+    route[i - 1] = next;
     next = heap.getReachedFrom((unsigned int)next);
   }
 
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool Graph::getTreeRoute(size_t startID, size_t endID, std::vector<size_t>& route) {
+  // The route is extracted while the lock is held: once it is released, the tree may be evicted.
+  _treeLock.lockRead();
+  HASH_MAP<size_t, std::vector<size_t> >::const_iterator itr = _trees.find(endID);
+  const bool found = itr != _trees.end();
+  const bool connected = found && extractTreeRoute(itr->second, startID, endID, route);
+  _treeLock.releaseRead();
+  if (found) return connected;
+
+  std::vector<size_t> parents;
+  computeShortestPathTree(endID, parents);
+  const bool treeConnected = extractTreeRoute(parents, startID, endID, route);
+  _treeLock.lockWrite();
+  // Another thread may have computed the same tree in the meantime; both are equivalent.
+  if (_treeLimit > 0 && _trees.find(endID) == _trees.end()) {
+    if (_treeOrder.size() >= _treeLimit) {
+      _trees.erase(_treeOrder.front());
+      _treeOrder.pop_front();
+    }
+    _trees[endID].swap(parents);
+    _treeOrder.push_back(endID);
+  }
+  _treeLock.releaseWrite();
+  return treeConnected;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool Graph::extractTreeRoute(const std::vector<size_t>& parents, size_t startID, size_t endID,
+                             std::vector<size_t>& route) const {
+  if (parents[startID] == _vCount) return false;
+  route.clear();
+  size_t curr = startID;
+  route.push_back(curr);
+  while (curr != endID) {
+    curr = parents[curr];
+    route.push_back(curr);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Graph::computeShortestPathTree(size_t rootID, std::vector<size_t>& parents) {
+  const size_t N = _vCount;
+#ifdef _OPENMP
+  const unsigned int threadNum = omp_get_thread_num();
+  AStarMinHeap heap(_HEAP + threadNum * N, _DATA + threadNum * DATA_SIZE,
+                    _STATE + threadNum * STATE_SIZE, _PATH + threadNum * N, N);
+#else
+  AStarMinHeap heap(_HEAP, _DATA, _STATE, _PATH, N);
+#endif
+
+  // Dijkstra's algorithm is simply A* with h = 0 and no target. The roadmap's edges are
+  //  undirected, so the tree of routes *from* the root is also the tree of routes *to* it.
+  heap.g((unsigned int)rootID, 0);
+  heap.h((unsigned int)rootID, 0);
+  heap.f((unsigned int)rootID, 0);
+  heap.push((unsigned int)rootID);
+  heap.setReachedFrom((unsigned int)rootID, (unsigned int)rootID);
+
+  while (!heap.empty()) {
+    unsigned int x = heap.pop();
+    GraphVertex& vert = _vertices[x];
+    const size_t E_COUNT = vert.getEdgeCount();
+    for (size_t n = 0; n < E_COUNT; ++n) {
+      size_t y = vert.getNeighbor(n)->getID();
+      if (heap.isVisited((unsigned int)y)) continue;
+      float tempG = heap.g(x) + vert.getDistance(n);
+      bool inHeap = heap.isInHeap((unsigned int)y);
+      if (!inHeap) {
+        heap.h((unsigned int)y, 0);
+      }
+      if (tempG < heap.g((unsigned int)y)) {
+        heap.setReachedFrom((unsigned int)y, x);
+        heap.g((unsigned int)y, tempG);
+        heap.f((unsigned int)y, tempG);
+      }
+      if (!inHeap) {
+        heap.push((unsigned int)y);
+      }
+    }
+  }
+
+  parents.resize(N);
+  for (size_t v = 0; v < N; ++v) {
+    parents[v] = heap.isVisited((unsigned int)v) ? heap.getReachedFrom((unsigned int)v) : N;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+RoadMapPath* Graph::makePath(const std::vector<size_t>& route) const {
+  RoadMapPath* path = new RoadMapPath(route.size());
+  for (size_t i = 0; i < route.size(); ++i) {
+    path->setWayPoint(i, _vertices[route[i]].getPosition());
+  }
   return path;
 }
 
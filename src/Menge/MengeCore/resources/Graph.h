@@ -24,14 +24,19 @@
 #ifndef __GRAPH_H__
 #define __GRAPH_H__
 
+#include "MengeCore/Runtime/ReadersWriterLock.h"
 #include "MengeCore/mengeCommon.h"
 #include "MengeCore/resources/GraphVertex.h"
 #include "MengeCore/resources/Resource.h"
 
+#include <list>
+#include <vector>
+
 namespace Menge {
 
 // Forward declarations
 class GraphEdge;
+class GraphTester;
 class RoadMapPath;
 namespace BFSM {
 class Goal;
@@ -45,7 +50,12 @@ using Menge::Math::Vector2;
 
 /*!
  @brief    A roadmap graph and the infrastructure for performing graph searches.
- 
+
+ Routes between vertices are shared by all agents: the most recently used vertex-to-vertex routes
+ are kept in a bounded cache and, optionally, a shortest-path tree is computed for each goal vertex
+ so that all agents heading to that goal reuse a single search. The number of trees kept is also
+ bounded.
+
  NOTE: This implementation assumes that the graph doesn't change.
  */
 class MENGE_API Graph : public Resource {
@@ -124,11 +134,83 @@ class MENGE_API Graph : public Resource {
    */
   const GraphVertex* getVertex(size_t i) const;
 
+  /*!
+   @brief    Sets the maximum number of vertex-to-vertex routes kept in the route cache.
+
+   When the cache is full, the least recently used route is discarded. A size of zero disables
+   caching.
+
+   @param    size    The maximum number of cached routes.
+   */
+  void setRouteCacheSize(size_t size);
+
+  /*!
+   @brief    Reports the maximum number of vertex-to-vertex routes kept in the route cache.
+   */
+  size_t getRouteCacheSize() const { return _routeCacheSize; }
+
+  /*!
+   @brief    Reports the number of vertex-to-vertex routes currently in the route cache.
+   */
+  size_t getCachedRouteCount() const;
+
+  /*!
+   @brief    Reports if the route between the given vertices is in the route cache.
+
+   @param    startID   The index of the start vertex.
+   @param    endID     The index of the end vertex.
+   @returns  True if the route is cached.
+   */
+  bool isRouteCached(size_t startID, size_t endID) const;
+
+  /*!
+   @brief    Sets whether paths are extracted from shortest-path trees.
+
+   When enabled, the first request for a path to a goal vertex computes the shortest-path tree
+   rooted at that vertex (a single Dijkstra search); every subsequent path to that vertex, from any
+   start, is read from the tree.
+
+   @param    useTrees    True to use shortest-path trees.
+   */
+  void setUseShortestPathTrees(bool useTrees);
+
+  /*!
+   @brief    Reports if paths are extracted from shortest-path trees.
+   */
+  bool getUseShortestPathTrees() const;
+
+  /*!
+   @brief    Sets the maximum number of shortest-path trees kept.
+
+   Each tree holds one entry per vertex. When the limit is reached, the oldest tree is discarded
+   and is computed again if its goal is requested again. A limit of zero keeps no trees: every path
+   computes its own tree.
+
+   @param    limit    The maximum number of trees.
+   */
+  void setShortestPathTreeLimit(size_t limit);
+
+  /*!
+   @brief    Reports the maximum number of shortest-path trees kept.
+   */
+  size_t getShortestPathTreeLimit() const;
+
+  /*!
+   @brief    Reports the number of shortest-path trees currently kept (at most one per goal vertex).
+   */
+  size_t getShortestPathTreeCount() const;
+
   /*!
    @brief    The unique label for this data type to be used with resource management.
    */
   static const std::string LABEL;
 
+  /*!
+   @brief    Gives the unit tests and the graph benchmark access to the protected queries
+            (getClosestVertex() and the vertex-to-vertex getPath()). The test code defines it.
+   */
+  friend class GraphTester;
+
  protected:
   /** Definition of the amount of clearance required in connecting a vertex to the graph.  */
   enum class Clearance {
@@ -157,6 +239,78 @@ class MENGE_API Graph : public Resource {
    */
   RoadMapPath* getPath(size_t startID, size_t endID);
 
+  /*!
+   @brief    Builds the uniform grid over the graph's vertices used by getClosestVertex().
+   */
+  void initVertexGrid();
+
+  /*!
+   @brief    Reports the grid cell coordinate of the given value along one axis.
+
+   The coordinate is *not* clamped to the grid; points outside of the grid map to cells outside of
+   the grid.
+
+   @param    value     The value along the axis.
+   @param    origin    The grid origin along the same axis.
+   @returns  The cell coordinate.
+   */
+  inline int getCellCoord(float value, float origin) const {
+    return static_cast<int>(floor((value - origin) / _cellSize));
+  }
+
+  /*!
+   @brief    Computes the sequence of vertices on the shortest route from start to end vertices with
+            A*.
+
+   @param    startID   The index of the start vertex.
+   @param    endID     The index of the end vertex.
+   @param    route     The vertex indices of the route, from start to end, are written here.
+   @returns  True if a route was found.
+   */
+  bool computeRoute(size_t startID, size_t endID, std::vector<size_t>& route);
+
+  /*!
+   @brief    Extracts the sequence of vertices from the start vertex to the root of the given
+            shortest-path tree.
+
+   @param    startID   The index of the start vertex.
+   @param    endID     The index of the end vertex (the root of the tree).
+   @param    route     The vertex indices of the route, from start to end, are written here.
+   @returns  True if the start vertex is connected to the root.
+   */
+  bool getTreeRoute(size_t startID, size_t endID, std::vector<size_t>& route);
+
+  /*!
+   @brief    Extracts the sequence of vertices from the start vertex to the root of a shortest-path
+            tree.
+
+   @param    parents   The shortest-path tree (see computeShortestPathTree()).
+   @param    startID   The index of the start vertex.
+   @param    endID     The index of the root of the tree.
+   @param    route     The vertex indices of the route, from start to end, are written here.
+   @returns  True if the start vertex is connected to the root.
+   */
+  bool extractTreeRoute(const std::vector<size_t>& parents, size_t startID, size_t endID,
+                        std::vector<size_t>& route) const;
+
+  /*!
+   @brief    Computes the shortest-path tree rooted at the given vertex.
+
+   @param    rootID    The index of the root vertex.
+   @param    parents   For each vertex, the index of the next vertex on its shortest route to the
+                      root. The root is its own parent and unreachable vertices have the parent
+                      _vCount.
+   */
+  void computeShortestPathTree(size_t rootID, std::vector<size_t>& parents);
+
+  /*!
+   @brief    Creates a new path from a sequence of vertices.
+
+   @param    route    The vertex indices of the route.
+   @returns  A pointer to a new RoadMapPath; the caller is responsible for deleting it.
+   */
+  RoadMapPath* makePath(const std::vector<size_t>& route) const;
+
   /*!
    @brief    Compute's "h" for the A* algorithm.
 
@@ -180,6 +334,98 @@ class MENGE_API Graph : public Resource {
    */
   GraphVertex* _vertices;
 
+  /*!
+   @brief    The minimum corner of the vertex grid.
+   */
+  Vector2 _gridOrigin;
+
+  /*!
+   @brief    The size of the (square) cells of the vertex grid.
+   */
+  float _cellSize;
+
+  /*!
+   @brief    The number of columns (along the x-axis) in the vertex grid.
+   */
+  int _gridCols;
+
+  /*!
+   @brief    The number of rows (along the y-axis) in the vertex grid.
+   */
+  int _gridRows;
+
+  /*!
+   @brief    For cell c (at index row * _gridCols + col), the vertices in the cell are the entries in
+            _cellVertices in the range [_cellStart[c], _cellStart[c + 1]).
+   */
+  std::vector<size_t> _cellStart;
+
+  /*!
+   @brief    The vertex indices, grouped by cell (see _cellStart).
+   */
+  std::vector<size_t> _cellVertices;
+
+  /*!
+   @brief    A cached vertex-to-vertex route.
+   */
+  struct CachedRoute {
+    /*!
+     @brief    The vertex indices of the route, from start to end.
+     */
+    std::vector<size_t> _route;
+
+    /*!
+     @brief    The position of the route's key in _routeCacheOrder.
+     */
+    std::list<size_t>::iterator _order;
+  };
+
+  /*!
+   @brief    The cached vertex-to-vertex routes, keyed by start * _vCount + end.
+   */
+  HASH_MAP<size_t, CachedRoute> _routeCache;
+
+  /*!
+   @brief    The keys of the cached routes, from the least to the most recently used.
+   */
+  std::list<size_t> _routeCacheOrder;
+
+  /*!
+   @brief    The maximum number of routes in the cache.
+   */
+  size_t _routeCacheSize;
+
+  /*!
+   @brief    Lock for securing the route cache.
+   */
+  ReadersWriterLock _routeLock;
+
+  /*!
+   @brief    Determines if paths are extracted from shortest-path trees.
+   */
+  bool _useTrees;
+
+  /*!
+   @brief    The shortest-path trees, keyed by the index of their root vertex (see
+            computeShortestPathTree()).
+   */
+  HASH_MAP<size_t, std::vector<size_t> > _trees;
+
+  /*!
+   @brief    The roots of the shortest-path trees in the order they were computed.
+   */
+  std::list<size_t> _treeOrder;
+
+  /*!
+   @brief    The maximum number of shortest-path trees kept.
+   */
+  size_t _treeLimit;
+
+  /*!
+   @brief    Lock for securing the shortest-path trees.
+   */
+  ReadersWriterLock _treeLock;
+
   /*!
    @brief    Initializes the heap memory based on current graph state.
    */
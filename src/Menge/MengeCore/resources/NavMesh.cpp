@@ -39,11 +39,13 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/resources/NavMesh.h"
 #include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Math/SpaceFillingCurve.h"
 #include "MengeCore/Runtime/Logger.h"
 #include "MengeCore/resources/NavMeshEdge.h"
 #include "MengeCore/resources/NavMeshNode.h"
 #include "MengeCore/resources/NavMeshObstacle.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace Menge {
@@ -58,6 +60,10 @@ const std::string NavMesh::LABEL("navmesh");
 
 /////////////////////////////////////////////////////////////////////
 
+const std::string NavMesh::REORDERED_LABEL("navmesh_reordered");
+
+/////////////////////////////////////////////////////////////////////
+
 NavMesh::NavMesh(const std::string& name)
     : Resource(name),
       _vCount(0),
@@ -68,7 +74,8 @@ NavMesh::NavMesh(const std::string& name)
       _edges(0x0),
       _obstCount(0),
       _obstacles(0x0),
-      _nodeGroups() {}
+      _nodeGroups(),
+      _reordered(false) {}
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -165,6 +172,42 @@ const NMNodeGroup* NavMesh::getNodeGroup(const std::string& grpName) const {
 
 //////////////////////////////////////////////////////////////////////////////////////
 
+unsigned int NavMesh::getNodeIndex(unsigned int fileID) const {
+  return _nodeIndices.empty() ? fileID : _nodeIndices[fileID];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int NavMesh::getNodeFileID(unsigned int i) const {
+  return _nodeFileIDs.empty() ? i : _nodeFileIDs[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int NavMesh::getEdgeIndex(unsigned int fileID) const {
+  return _edgeIndices.empty() ? fileID : _edgeIndices[fileID];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int NavMesh::getEdgeFileID(unsigned int i) const {
+  return _edgeFileIDs.empty() ? i : _edgeFileIDs[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int NavMesh::getObstacleIndex(unsigned int fileID) const {
+  return _obstIndices.empty() ? fileID : _obstIndices[fileID];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int NavMesh::getObstacleFileID(unsigned int i) const {
+  return _obstFileIDs.empty() ? i : _obstFileIDs[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+
 float NavMesh::getElevation(unsigned int nodeID, const Vector2& p) const {
   const NavMeshNode& node = _nodes[nodeID];
   return node.getElevation(p);
@@ -347,6 +390,138 @@ bool NavMesh::finalize() {
 
 //////////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+/*!
+ @brief    Sorts the indices in the range [first, last) by their Morton keys.
+ */
+void sortByKey(std::vector<unsigned int>::iterator first, std::vector<unsigned int>::iterator last,
+               const std::vector<uint32_t>& keys) {
+  std::stable_sort(first, last,
+                   [&keys](unsigned int a, unsigned int b) { return keys[a] < keys[b]; });
+}
+
+/*!
+ @brief    Given the list of old indices in their new order, computes the map from old index to new.
+ */
+std::vector<unsigned int> invertOrder(const std::vector<unsigned int>& order) {
+  std::vector<unsigned int> newIndex(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    newIndex[order[i]] = static_cast<unsigned int>(i);
+  }
+  return newIndex;
+}
+}  // namespace
+
+#ifdef _WIN32
+// See finalize() for the explanation of the stored indices.
+#pragma warning(disable : 4311)
+#pragma warning(disable : 4312)
+#endif
+void NavMesh::reorderSpatially() {
+  if (_vCount == 0) return;
+  Vector2 minPt(_vertices[0]);
+  Vector2 maxPt(_vertices[0]);
+  for (size_t v = 1; v < _vCount; ++v) {
+    const Vector2& p = _vertices[v];
+    if (p._x < minPt._x) minPt._x = p._x;
+    if (p._y < minPt._y) minPt._y = p._y;
+    if (p._x > maxPt._x) maxPt._x = p._x;
+    if (p._y > maxPt._y) maxPt._y = p._y;
+  }
+
+  // Nodes -- ordered within their groups so that the groups remain contiguous.
+  std::vector<uint32_t> keys(_nCount);
+  std::vector<unsigned int> nodeOrder(_nCount);
+  for (size_t n = 0; n < _nCount; ++n) {
+    keys[n] = Math::mortonKey(_nodes[n]._center, minPt, maxPt);
+    nodeOrder[n] = static_cast<unsigned int>(n);
+  }
+  std::map<const std::string, NMNodeGroup>::const_iterator grpItr = _nodeGroups.begin();
+  for (; grpItr != _nodeGroups.end(); ++grpItr) {
+    const NMNodeGroup& grp = grpItr->second;
+    sortByKey(nodeOrder.begin() + grp._first, nodeOrder.begin() + grp._last + 1, keys);
+  }
+
+  // Edges
+  keys.resize(_eCount);
+  std::vector<unsigned int> edgeOrder(_eCount);
+  for (size_t e = 0; e < _eCount; ++e) {
+    keys[e] = Math::mortonKey(_edges[e].getPoint(0.5f * _edges[e]._width), minPt, maxPt);
+    edgeOrder[e] = static_cast<unsigned int>(e);
+  }
+  sortByKey(edgeOrder.begin(), edgeOrder.end(), keys);
+
+  // Obstacles
+  keys.resize(_obstCount);
+  std::vector<unsigned int> obstOrder(_obstCount);
+  for (size_t o = 0; o < _obstCount; ++o) {
+    keys[o] = Math::mortonKey(_obstacles[o].midPt(), minPt, maxPt);
+    obstOrder[o] = static_cast<unsigned int>(o);
+  }
+  sortByKey(obstOrder.begin(), obstOrder.end(), keys);
+
+  std::vector<unsigned int> newNode = invertOrder(nodeOrder);
+  std::vector<unsigned int> newEdge = invertOrder(edgeOrder);
+  std::vector<unsigned int> newObst = invertOrder(obstOrder);
+
+  // Permute the elements and remap the indices they store.
+  NavMeshNode* nodes = new NavMeshNode[_nCount];
+  for (size_t n = 0; n < _nCount; ++n) {
+    NavMeshNode& node = nodes[n];
+    node = _nodes[nodeOrder[n]];
+    node._id = static_cast<unsigned int>(n);
+    for (size_t e = 0; e < node._edgeCount; ++e) {
+      size_t eID = reinterpret_cast<size_t>(node._edges[e]);
+      node._edges[e] = (NavMeshEdge*)(size_t)newEdge[eID];
+    }
+    for (size_t o = 0; o < node._obstCount; ++o) {
+      size_t oID = reinterpret_cast<size_t>(node._obstacles[o]);
+      node._obstacles[o] = (NavMeshObstacle*)(size_t)newObst[oID];
+    }
+  }
+  delete[] _nodes;
+  _nodes = nodes;
+
+  NavMeshEdge* edges = new NavMeshEdge[_eCount];
+  for (size_t e = 0; e < _eCount; ++e) {
+    NavMeshEdge& edge = edges[e];
+    edge = _edges[edgeOrder[e]];
+    size_t nID = reinterpret_cast<size_t>(edge._node0);
+    edge._node0 = (NavMeshNode*)(size_t)newNode[nID];
+    nID = reinterpret_cast<size_t>(edge._node1);
+    edge._node1 = (NavMeshNode*)(size_t)newNode[nID];
+  }
+  delete[] _edges;
+  _edges = edges;
+
+  NavMeshObstacle* obstacles = new NavMeshObstacle[_obstCount];
+  for (size_t o = 0; o < _obstCount; ++o) {
+    NavMeshObstacle& obst = obstacles[o];
+    obst = _obstacles[obstOrder[o]];
+    size_t nID = reinterpret_cast<size_t>(obst._node);
+    obst._node = (NavMeshNode*)(size_t)newNode[nID];
+    size_t oID = reinterpret_cast<size_t>(obst._nextObstacle);
+    if (oID != NavMeshObstacle::NO_NEIGHBOR_OBST) {
+      obst._nextObstacle = (NavMeshObstacle*)(size_t)newObst[oID];
+    }
+  }
+  delete[] _obstacles;
+  _obstacles = obstacles;
+
+  _nodeFileIDs.swap(nodeOrder);
+  _nodeIndices.swap(newNode);
+  _edgeFileIDs.swap(edgeOrder);
+  _edgeIndices.swap(newEdge);
+  _obstFileIDs.swap(obstOrder);
+  _obstIndices.swap(newObst);
+}
+#ifdef _WIN32
+#pragma warning(default : 4311)
+#pragma warning(default : 4312)
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////
+
 // void NavMesh::addObstacles( Agents::SimulatorInterface * simulator ) {
 //  // Construct each contiguous obstacle
 
@@ -447,7 +622,15 @@ std::vector<Agents::ObstacleVertexList> NavMesh::getObstacles() {
 
 /////////////////////////////////////////////////////////////////////
 
-Resource* NavMesh::load(const std::string& fileName) {
+Resource* NavMesh::load(const std::string& fileName) { return read(fileName, false); }
+
+/////////////////////////////////////////////////////////////////////
+
+Resource* NavMesh::loadReordered(const std::string& fileName) { return read(fileName, true); }
+
+/////////////////////////////////////////////////////////////////////
+
+NavMesh* NavMesh::read(const std::string& fileName, bool reorder) {
   // TODO: Change this to support comments.
   std::ifstream f;
   f.open(fileName.c_str(), std::ios::in);
@@ -561,6 +744,11 @@ Resource* NavMesh::load(const std::string& fileName) {
     }
   }
 
+  if (reorder) {
+    mesh->reorderSpatially();
+    mesh->_reordered = true;
+  }
+
   if (!mesh->finalize()) {
     mesh->destroy();
     return 0x0;
@@ -570,8 +758,24 @@ Resource* NavMesh::load(const std::string& fileName) {
 
 /////////////////////////////////////////////////////////////////////
 
-NavMeshPtr loadNavMesh(const std::string& fileName) throw(ResourceException) {
-  Resource* rsrc = ResourceManager::getResource(fileName, &NavMesh::load, NavMesh::LABEL);
+NavMeshPtr loadNavMesh(const std::string& fileName, bool reorder) throw(ResourceException) {
+  // Elements pass node, edge and obstacle indices to each other (e.g., an edge event target and the
+  //  planner of a velocity component), so they must all number the file's elements the same way.
+  Resource* other = ResourceManager::findResource(
+      fileName, reorder ? NavMesh::LABEL : NavMesh::REORDERED_LABEL);
+  if (other != 0x0 && !other->isUnreferenced()) {
+    logger << Logger::ERR_MSG << "The navigation mesh " << fileName << " is already in use ";
+    logger << (reorder ? "in file order" : "reordered for spatial locality");
+    logger << "; every element which loads it must give the same reorder_mesh value.";
+    throw ResourceException();
+  }
+
+  Resource* rsrc = 0x0;
+  if (reorder) {
+    rsrc = ResourceManager::getResource(fileName, &NavMesh::loadReordered, NavMesh::REORDERED_LABEL);
+  } else {
+    rsrc = ResourceManager::getResource(fileName, &NavMesh::load, NavMesh::LABEL);
+  }
   if (rsrc == 0x0) {
     logger << Logger::ERR_MSG << "No resource available.";
     throw ResourceException();
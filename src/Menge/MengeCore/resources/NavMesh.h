@@ -129,7 +129,7 @@ class MENGE_API NavMesh : public Resource {
    @brief    Returns a unique resource label to be used to identify different resource *types* which
             use the same underlying file data.
    */
-  virtual const std::string& getLabel() const { return LABEL; }
+  virtual const std::string& getLabel() const { return _reordered ? REORDERED_LABEL : LABEL; }
 
   ////////////////////////////////////////////////////////////////
   //          Getters/Setters
@@ -259,6 +259,69 @@ class MENGE_API NavMesh : public Resource {
    */
   const NMNodeGroup* getNodeGroup(const std::string& grpName) const;
 
+  ////////////////////////////////////////////////////////////////
+  //          Identifier mapping
+  ////////////////////////////////////////////////////////////////
+
+  /*!
+   @brief    Reports the index of the node which was defined with the given id in the navigation
+            mesh file.
+
+   If the mesh was not reordered on load (see isReordered()) this is the identity.
+
+   @param    fileID    The id of the node in the navigation mesh file.
+   @returns  The index of the node in this mesh.
+   */
+  unsigned int getNodeIndex(unsigned int fileID) const;
+
+  /*!
+   @brief    Reports the id the node with the given index had in the navigation mesh file.
+
+   @param    i    The index of the node in this mesh.
+   @returns  The id of the node in the navigation mesh file.
+   */
+  unsigned int getNodeFileID(unsigned int i) const;
+
+  /*!
+   @brief    Reports the index of the edge which was defined with the given id in the navigation
+            mesh file.
+
+   @param    fileID    The id of the edge in the navigation mesh file.
+   @returns  The index of the edge in this mesh.
+   */
+  unsigned int getEdgeIndex(unsigned int fileID) const;
+
+  /*!
+   @brief    Reports the id the edge with the given index had in the navigation mesh file.
+
+   @param    i    The index of the edge in this mesh.
+   @returns  The id of the edge in the navigation mesh file.
+   */
+  unsigned int getEdgeFileID(unsigned int i) const;
+
+  /*!
+   @brief    Reports the index of the obstacle which was defined with the given id in the navigation
+            mesh file.
+
+   @param    fileID    The id of the obstacle in the navigation mesh file.
+   @returns  The index of the obstacle in this mesh.
+   */
+  unsigned int getObstacleIndex(unsigned int fileID) const;
+
+  /*!
+   @brief    Reports the id the obstacle with the given index had in the navigation mesh file.
+
+   @param    i    The index of the obstacle in this mesh.
+   @returns  The id of the obstacle in the navigation mesh file.
+   */
+  unsigned int getObstacleFileID(unsigned int i) const;
+
+  /*!
+   @brief    Reports if this mesh was reordered for spatial locality as it was loaded (see
+            loadReordered()).
+   */
+  bool isReordered() const { return _reordered; }
+
   ////////////////////////////////////////////////////////////////
   //          Geometric queries
   ////////////////////////////////////////////////////////////////
@@ -297,6 +360,20 @@ class MENGE_API NavMesh : public Resource {
    */
   static Resource* load(const std::string& fileName);
 
+  /*!
+   @brief    Parses a navigation mesh definition and reorders it for spatial locality.
+
+   The nodes (within each group), edges and obstacles are renumbered along a Morton curve so that
+   elements which are near each other in space are near each other in memory. The ids used in the
+   navigation mesh file can be mapped to the new indices with getNodeIndex(), getEdgeIndex() and
+   getObstacleIndex(). The reordered mesh is a different resource than the mesh in file order; only
+   one of them can be in use (see loadNavMesh()).
+
+   @param    fileName    The path to the file containing the NavMesh definition.
+   @returns  A pointer to the new NavMesh (if the file is valid), NULL if invalid.
+   */
+  static Resource* loadReordered(const std::string& fileName);
+
   /*!
    @brief    Allocates memory for the given number of vertices.
 
@@ -348,6 +425,15 @@ class MENGE_API NavMesh : public Resource {
    */
   bool finalize();
 
+  /*!
+   @brief    Renumbers the nodes, edges, and obstacles so that they are ordered along a Morton
+            curve.
+
+   Nodes are only reordered within their group so that groups remain contiguous blocks. This must be
+   called *before* finalize() (while connectivity is still expressed as indices).
+   */
+  void reorderSpatially();
+
   /*!
    @brief    Adds a group of polygons to the navigation mesh.
 
@@ -384,6 +470,11 @@ class MENGE_API NavMesh : public Resource {
    */
   static const std::string LABEL;
 
+  /*!
+   @brief    The unique label for meshes which were reordered on load.
+   */
+  static const std::string REORDERED_LABEL;
+
   friend class NavMeshFactory;
   friend class PathPlanner;
 
@@ -432,6 +523,54 @@ class MENGE_API NavMesh : public Resource {
    @brief    The mapping from node group name to an instance of a NMNodeGroup.
    */
   std::map<const std::string, NMNodeGroup> _nodeGroups;
+
+  /*!
+   @brief    For each node index, the id of the node in the file. Empty if the mesh was not
+            reordered.
+   */
+  std::vector<unsigned int> _nodeFileIDs;
+
+  /*!
+   @brief    For each file node id, the index of the node. Empty if the mesh was not reordered.
+   */
+  std::vector<unsigned int> _nodeIndices;
+
+  /*!
+   @brief    For each edge index, the id of the edge in the file. Empty if the mesh was not
+            reordered.
+   */
+  std::vector<unsigned int> _edgeFileIDs;
+
+  /*!
+   @brief    For each file edge id, the index of the edge. Empty if the mesh was not reordered.
+   */
+  std::vector<unsigned int> _edgeIndices;
+
+  /*!
+   @brief    For each obstacle index, the id of the obstacle in the file. Empty if the mesh was not
+            reordered.
+   */
+  std::vector<unsigned int> _obstFileIDs;
+
+  /*!
+   @brief    For each file obstacle id, the index of the obstacle. Empty if the mesh was not
+            reordered.
+   */
+  std::vector<unsigned int> _obstIndices;
+
+  /*!
+   @brief    Reports if the mesh was reordered on load (see isReordered()).
+   */
+  bool _reordered;
+
+  /*!
+   @brief    Parses a navigation mesh definition.
+
+   @param    fileName    The path to the file containing the NavMesh definition.
+   @param    reorder     True if the mesh is reordered for spatial locality (see loadReordered()).
+   @returns  A pointer to the new NavMesh (if the file is valid), NULL if invalid.
+   */
+  static NavMesh* read(const std::string& fileName, bool reorder);
 };
 
 /*!
@@ -442,11 +581,18 @@ typedef ResourcePtr<NavMesh> NavMeshPtr;
 /*!
  @brief        Loads the navigation mesh of the given name
 
+ A file can't be in use in file order and reordered for spatial locality at the same time: the
+ elements which use a mesh pass its node, edge and obstacle indices to each other, so they must
+ all request the same order. Requesting the other order while the mesh is referenced fails.
+
  @param  fileName  The name of the file containing the navigation mesh definition.
+ @param  reorder   True if the mesh should be reordered for spatial locality (see
+                   NavMesh::loadReordered()).
  @returns      The NavMeshPtr containing the data.
- @throws        A ResourceException if the data is unable to be *instantiated.
+ @throws        A ResourceException if the data is unable to be *instantiated, or if the file is
+                in use in the other order.
  */
-NavMeshPtr loadNavMesh(const std::string& fileName) throw(ResourceException);
+NavMeshPtr loadNavMesh(const std::string& fileName, bool reorder = false) throw(ResourceException);
 
 }  // namespace Menge
 
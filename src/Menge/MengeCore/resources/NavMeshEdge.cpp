@@ -58,7 +58,13 @@ const float MIN_EDGE_WIDTH = 0.00001f;
 /////////////////////////////////////////////////////////////////////
 
 NavMeshEdge::NavMeshEdge()
-    : _point(0.f, 0.f), _dir(0.f, 0.f), _width(0.f), _distance(0.f), _node0(0x0), _node1(0x0) {}
+    : _point(0.f, 0.f),
+      _dir(0.f, 0.f),
+      _width(0.f),
+      _distance(0.f),
+      _blocked(false),
+      _node0(0x0),
+      _node1(0x0) {}
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -134,7 +140,7 @@ float NavMeshEdge::getSqDist(const Vector2& pt, Vector2& nearPt) const {
 
 float NavMeshEdge::getNodeDistance(float minWidth) {
   float RR = minWidth;
-  if (RR > _width) {
+  if (_blocked || RR > _width) {
     return -1.f;
   } else {
     return _distance;
@@ -169,6 +169,24 @@ class MENGE_API NavMeshEdge {
    */
   inline float getWidth() const { return _width; }
 
+  /*!
+   @brief    Sets the edge's traversability.
+
+   A blocked edge still defines the portal geometry, but the planner will not route through it.
+   Changing this value at runtime should be done through PathPlanner::setEdgeBlocked() so that
+   cached routes are updated.
+
+   @param    blocked    True if the edge can no longer be traversed.
+   */
+  inline void setBlocked(bool blocked) { _blocked = blocked; }
+
+  /*!
+   @brief    Reports if the edge is currently blocked.
+
+   @returns  True if the edge cannot be traversed.
+   */
+  inline bool isBlocked() const { return _blocked; }
+
   /*!
    @brief    Sets the connected node pointers.
 
@@ -285,8 +303,8 @@ class MENGE_API NavMeshEdge {
   /*!
    @brief    Computes the width-dependent distance between the two nodes connected by this edge.
 
-   If the edge width is narrower than the given minimum width the distance is "infinite" (indicated
-   by -1). Otherwise it is the distance between node centers.
+   If the edge width is narrower than the given minimum width, or the edge is blocked, the distance
+   is "infinite" (indicated by -1). Otherwise it is the distance between node centers.
 
    @param    minWidth    The minimum required width.
    @returns  The passable distance between the two nodes.
@@ -359,6 +377,11 @@ class MENGE_API NavMeshEdge {
    */
   float _distance;
 
+  /*!
+   @brief    Indicates that the edge has been closed (e.g., a door) and cannot be traversed.
+   */
+  bool _blocked;
+
   // TODO: Does lower-indexed/upper-indexed really matter?
   /*!
    @brief    A pointer to the first nav mesh node connected by this edge.
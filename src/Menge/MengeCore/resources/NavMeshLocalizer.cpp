@@ -43,12 +43,23 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/resources/PathPlanner.h"
 #include "MengeCore/resources/PortalPath.h"
 
+#include <algorithm>
 #include <limits>
 
 namespace Menge {
 
 using Math::Vector2;
 
+namespace {
+// Removes the id from the sorted set of occupants; reports if it was present.
+bool removeOccupant(OccupantSet& occupants, size_t id) {
+  OccupantSetItr itr = std::lower_bound(occupants.begin(), occupants.end(), id);
+  if (itr == occupants.end() || *itr != id) return false;
+  occupants.erase(itr);
+  return true;
+}
+}  // namespace
+
 /////////////////////////////////////////////////////////////////////
 //          Implementation of NavMeshLocation
 /////////////////////////////////////////////////////////////////////
@@ -105,10 +116,14 @@ const std::string NavMeshLocalizer::LABEL("navmesh_localizer");
 
 /////////////////////////////////////////////////////////////////////
 
-NavMeshLocalizer::NavMeshLocalizer(const std::string& name)
+const std::string NavMeshLocalizer::REORDERED_LABEL("navmesh_localizer_reordered");
+
+/////////////////////////////////////////////////////////////////////
+
+NavMeshLocalizer::NavMeshLocalizer(const std::string& name, bool reorder)
     : Resource(name), _navMesh(0x0), _trackAll(false), _planner(0x0) {
   try {
-    _navMesh = loadNavMesh(name);
+    _navMesh = loadNavMesh(name, reorder);
   } catch (ResourceException) {
     logger << Logger::ERR_MSG;
     logger << "Couldn't instantiate navigation mesh localizer for navigation mesh: ";
@@ -259,25 +274,22 @@ unsigned int NavMeshLocalizer::updateLocation(const Agents::BaseAgent* agent, bo
 #pragma omp critical(NAV_MESH_LOCALIZER_MOVE_AGENT)
     {
       if (oldLoc != NavMeshLocation::NO_NODE) {
-        OccupantSetItr fromItr = _nodeOccupants[oldLoc].find(ID);
-        if (fromItr != _nodeOccupants[oldLoc].end()) {
-          _nodeOccupants[oldLoc].erase(fromItr);
-        } else if (oldLoc != NavMeshLocation::NO_NODE) {
+        if (!removeOccupant(_nodeOccupants[oldLoc], ID)) {
           logger << Logger::ERR_MSG << "Trying to remove agent " << ID;
           logger << " from node " << oldLoc;
           logger << " but it has not been assigned to that node.";
           const size_t NCOUNT = _navMesh->getNodeCount();
           for (size_t i = 0; i < NCOUNT; ++i) {
-            fromItr = _nodeOccupants[i].find(ID);
-            if (fromItr != _nodeOccupants[i].end()) {
+            if (removeOccupant(_nodeOccupants[i], ID)) {
               logger << "\n\tFound the agent in node: " << i << ".";
-              _nodeOccupants[i].erase(fromItr);
               break;
             }
           }
         }
       }
-      _nodeOccupants[newLoc].insert(ID);
+      OccupantSet& occupants = _nodeOccupants[newLoc];
+      OccupantSetItr toItr = std::lower_bound(occupants.begin(), occupants.end(), ID);
+      if (toItr == occupants.end() || *toItr != ID) occupants.insert(toItr, ID);
     }
   }
 
@@ -356,23 +368,34 @@ unsigned int NavMeshLocalizer::testNeighbors(const NavMeshNode& node, const Vect
 /////////////////////////////////////////////////////////////////////
 
 Resource* NavMeshLocalizer::load(const std::string& fileName) {
-  NavMeshPtr mesh;
   try {
-    mesh = loadNavMesh(fileName);
+    return new NavMeshLocalizer(fileName);
   } catch (ResourceException) {
     return 0x0;
   }
-  NavMeshLocalizer* nml = new NavMeshLocalizer(fileName);
-  nml->_navMesh = mesh;
-  return nml;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-NavMeshLocalizerPtr loadNavMeshLocalizer(const std::string& fileName,
-                                         bool usePlanner) throw(ResourceException) {
-  Resource* rsrc =
-      ResourceManager::getResource(fileName, &NavMeshLocalizer::load, NavMeshLocalizer::LABEL);
+Resource* NavMeshLocalizer::loadReordered(const std::string& fileName) {
+  try {
+    return new NavMeshLocalizer(fileName, true);
+  } catch (ResourceException) {
+    return 0x0;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+NavMeshLocalizerPtr loadNavMeshLocalizer(const std::string& fileName, bool usePlanner,
+                                         bool reorder) throw(ResourceException) {
+  Resource* rsrc = 0x0;
+  if (reorder) {
+    rsrc = ResourceManager::getResource(fileName, &NavMeshLocalizer::loadReordered,
+                                        NavMeshLocalizer::REORDERED_LABEL);
+  } else {
+    rsrc = ResourceManager::getResource(fileName, &NavMeshLocalizer::load, NavMeshLocalizer::LABEL);
+  }
   if (rsrc == 0x0) {
     logger << Logger::ERR_MSG << "No resource available.";
     throw ResourceException();
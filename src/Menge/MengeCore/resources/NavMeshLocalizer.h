@@ -32,7 +32,7 @@
 #include "MengeCore/resources/Resource.h"
 
 #include <map>
-#include <set>
+#include <vector>
 
 namespace Menge {
 
@@ -139,10 +139,11 @@ class MENGE_API NavMeshLocation {
 /////////////////////////////////////////////////////////////////////
 
 /*!
- @brief    A collection of agent ids.
- It represents the population of each nav mesh node.
+ @brief    A collection of agent ids, sorted in increasing order.
+ It represents the population of each nav mesh node. It is stored in a vector so that agents
+ moving between nodes do not allocate memory once the vectors have grown to their working size.
  */
-typedef std::set<size_t> OccupantSet;
+typedef std::vector<size_t> OccupantSet;
 
 /*!
  @brief    Iterator for an OccupantSet.
@@ -163,9 +164,11 @@ class MENGE_API NavMeshLocalizer : public Resource {
   /*!
    @brief    Constructor
 
-   @param    name    The name of the underlying navigation mesh.
+   @param    name       The name of the underlying navigation mesh.
+   @param    reorder    True if the navigation mesh is reordered for spatial locality (see
+                       NavMesh::loadReordered()).
    */
-  NavMeshLocalizer(const std::string& name);
+  NavMeshLocalizer(const std::string& name, bool reorder = false);
 
  protected:
   /*!
@@ -178,7 +181,9 @@ class MENGE_API NavMeshLocalizer : public Resource {
    @brief    Returns a unique resource label to be used to identify different resource *types* which
             use the same underlying file data.
    */
-  virtual const std::string& getLabel() const { return LABEL; }
+  virtual const std::string& getLabel() const {
+    return _navMesh->isReordered() ? REORDERED_LABEL : LABEL;
+  }
 
   /*!
    @brief    Reports the node the agent is currently in.
@@ -334,11 +339,25 @@ class MENGE_API NavMeshLocalizer : public Resource {
    */
   static Resource* load(const std::string& fileName);
 
+  /*!
+   @brief    Parses a navigation mesh localizer definition on a navigation mesh which is reordered
+            for spatial locality (see NavMesh::loadReordered()).
+
+   @param    fileName    The path to the file containing the NavMesh definition.
+   @returns  A pointer to the new NavMeshLocalizer (if the file is valid), NULL if invalid.
+   */
+  static Resource* loadReordered(const std::string& fileName);
+
   /*!
    @brief    The unique label for this data type to be used with resource management.
    */
   static const std::string LABEL;
 
+  /*!
+   @brief    The unique label for localizers on reordered navigation meshes.
+   */
+  static const std::string REORDERED_LABEL;
+
   friend class PortalPath;
 
  protected:
@@ -436,11 +455,13 @@ typedef ResourcePtr<NavMeshLocalizer> NavMeshLocalizerPtr;
 
  @param    fileName      The name of the file containing the navigation mesh definition.
  @param    usePlanner    Indicates if a planner is required (true) or not (false).
+ @param    reorder       True if the navigation mesh should be reordered for spatial locality (see
+                        loadNavMesh()).
  @returns  The NavMeshLocalizerPtr containing the data.
  @throws    A ResourceException if the data is unable to be instantiated.
  */
-NavMeshLocalizerPtr loadNavMeshLocalizer(const std::string& fileName,
-                                         bool usePlanner) throw(ResourceException);
+NavMeshLocalizerPtr loadNavMeshLocalizer(const std::string& fileName, bool usePlanner,
+                                         bool reorder = false) throw(ResourceException);
 
 }  // namespace Menge
 
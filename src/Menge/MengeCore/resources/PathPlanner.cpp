@@ -59,23 +59,11 @@ using Math::Vector2;
 //          Implementation of PathPlanner - HELPER
 /////////////////////////////////////////////////////////////////////
 
-/*!
- *  @brief    Creates unique keys for a route based on start and end nodes.
-
- *  Mangles the start and end node identifiers into a RouteKey for
- *  using in the map.  The map is a single, unsigned int of the same
- *  size as size_t.  The value is cut in half with the upper bits
- *  containing the start value, and the lower bits containing the
- *  end value.
- *  This limits the number of nodes in the navigation mesh to the
- *  size of size_t.  On a 32-bit machine, that's 16 bits per node index
- *  (for 65K total nodes). On a 64-bit machine, it is 32 bits per node
- *  index, allowing 4 billion nodes.
-
- *  @param    start    ID of start node.
- *  @param    end      ID of end node.
- *  @returns  A unique node key based on the start and end nodes.
- */
+// The key is a single, unsigned int of the same size as size_t.  The value is cut in half with the
+//  upper bits containing the start value, and the lower bits containing the end value.
+//  This limits the number of nodes in the navigation mesh to the size of size_t.  On a 32-bit
+//  machine, that's 16 bits per node index (for 65K total nodes). On a 64-bit machine, it is 32 bits
+//  per node index, allowing 4 billion nodes.
 RouteKey makeRouteKey(unsigned int start, unsigned int end) {
   const int SHIFT = sizeof(size_t) * 4;  // size in bytes * 8 bits/byte / 2
   const size_t MASK = (1UL << SHIFT) - 1;
@@ -89,20 +77,90 @@ RouteKey makeRouteKey(unsigned int start, unsigned int end) {
 /////////////////////////////////////////////////////////////////////
 
 PathPlanner::PathPlanner(NavMeshPtr ptr)
-    : _navMesh(ptr), DATA_SIZE(0), STATE_SIZE(0), _HEAP(0x0), _DATA(0x0), _STATE(0x0) {
+    : _coalescedCount(0),
+      _navMesh(ptr),
+      DATA_SIZE(0),
+      STATE_SIZE(0),
+      _HEAP(0x0),
+      _DATA(0x0),
+      _STATE(0x0) {
   size_t nCount = _navMesh->getNodeCount();
   initHeapMemory(nCount);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-PathPlanner::~PathPlanner() { initHeapMemory(0); }
+PathPlanner::~PathPlanner() {
+  initHeapMemory(0);
+  for (PRouteListItr itr = _retiredRoutes.begin(); itr != _retiredRoutes.end(); ++itr) {
+    delete *itr;
+  }
+}
 
 /////////////////////////////////////////////////////////////////////
 
 PortalRoute* PathPlanner::getRoute(unsigned int startID, unsigned int endID, float minWidth) {
   RouteKey key = makeRouteKey(startID, endID);
 
+  PortalRoute* route = findCachedRoute(key, minWidth);
+  if (route != 0x0) return route;
+
+  // Before computing a new path, see if an equivalent computation is already in progress (e.g.,
+  //  many agents entering the same state in the same time step).
+  _pendingLock.lock();
+  PendingRoute* pending = findPendingRoute(key, minWidth);
+  if (pending != 0x0) {
+    ++pending->_waiting;
+    ++_coalescedCount;
+    _pendingLock.unlock();
+
+    {
+      std::unique_lock<std::mutex> readyLock(pending->_readyLock);
+      pending->_readyCondition.wait(readyLock, [pending]() { return pending->_ready; });
+    }
+    route = pending->_route;
+
+    _pendingLock.lock();
+    const bool last = --pending->_waiting == 0 && pending->_finished;
+    _pendingLock.unlock();
+    if (last) delete pending;
+
+    // The pending computation may have failed, or may have found a route which is too narrow; in
+    //  that case, this agent computes its own (and reports the failure).
+    if (route != 0x0 && route->_maxWidth > minWidth) return route;
+    return computeRoute(startID, endID, minWidth);
+  }
+
+  // The computation that was pending when the cache was tested may have finished in the interim.
+  route = findCachedRoute(key, minWidth);
+  if (route != 0x0) {
+    _pendingLock.unlock();
+    return route;
+  }
+  pending = beginComputation(key, minWidth);
+  _pendingLock.unlock();
+
+  bool failed = false;
+  try {
+    route = computeRoute(startID, endID, minWidth);
+  } catch (PathPlannerException&) {
+    failed = true;
+  }
+
+  finishComputation(key, pending, route);
+
+  if (failed) {
+    std::stringstream ss;
+    ss << "Trying to find a path from " << startID << " to " << endID;
+    ss << ".  A* finished without a route!";
+    throw PathPlannerException(ss.str());
+  }
+  return route;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PortalRoute* PathPlanner::findCachedRoute(RouteKey key, float minWidth) {
   PortalRoute* route = 0x0;
   _routeLock.lockRead();
   PRouteMapItr itr = _routes.find(key);
@@ -118,12 +176,135 @@ PortalRoute* PathPlanner::getRoute(unsigned int startID, unsigned int endID, flo
     }
   }
   _routeLock.releaseRead();
+  return route;
+}
 
-  // Compute a new path
-  if (route == 0x0) {
-    return computeRoute(startID, endID, minWidth);
+/////////////////////////////////////////////////////////////////////
+
+PendingRoute* PathPlanner::findPendingRoute(RouteKey key, float minWidth) {
+  PendingRouteMap::iterator itr = _pending.find(key);
+  if (itr != _pending.end()) {
+    // Uses the same width tolerance as the cache.
+    std::list<PendingRoute*>::iterator pItr = itr->second.begin();
+    for (; pItr != itr->second.end(); ++pItr) {
+      const float w = (*pItr)->_minWidth;
+      if (w >= minWidth && w <= minWidth * 1.05f) return *pItr;
+    }
+  }
+  return 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PendingRoute* PathPlanner::beginComputation(RouteKey key, float minWidth) {
+  PendingRoute* pending = new PendingRoute(minWidth);
+  _pending[key].push_back(pending);
+  return pending;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::finishComputation(RouteKey key, PendingRoute* pending, PortalRoute* route) {
+  _pendingLock.lock();
+  std::list<PendingRoute*>& pendingList = _pending[key];
+  pendingList.remove(pending);
+  if (pendingList.empty()) _pending.erase(key);
+  pending->_route = route;
+  pending->_finished = true;
+  const bool last = pending->_waiting == 0;
+  _pendingLock.unlock();
+  if (last) {
+    // It is no longer in _pending, so no thread can start waiting on it.
+    delete pending;
+    return;
+  }
+  // The waiters can't see the route (and the last can't delete it) until the lock is released, so
+  //  the notification is sent while holding it.
+  std::lock_guard<std::mutex> readyLock(pending->_readyLock);
+  pending->_ready = true;
+  pending->_readyCondition.notify_all();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::setEdgeBlocked(unsigned int edgeID, bool blocked) {
+  assert(edgeID < _navMesh->getEdgeCount() && "Trying to block an invalid edge");
+  NavMeshEdge& edge = _navMesh->_edges[edgeID];
+  if (edge.isBlocked() == blocked) return;
+  edge.setBlocked(blocked);
+  if (blocked) {
+    invalidateRoutes(&edge, -1.f);
   } else {
-    return route;
+    flushRoutes();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::setEdgeWidth(unsigned int edgeID, float width) {
+  assert(edgeID < _navMesh->getEdgeCount() && "Trying to resize an invalid edge");
+  NavMeshEdge& edge = _navMesh->_edges[edgeID];
+  const float oldWidth = edge.getWidth();
+  if (oldWidth == width) return;
+  edge.setWidth(width);
+  if (width < oldWidth) {
+    invalidateRoutes(&edge, width);
+  } else {
+    flushRoutes();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::invalidateRoutes(const NavMeshEdge* edge, float width) {
+  _routeLock.lockWrite();
+  PRouteMapItr mapItr = _routes.begin();
+  while (mapItr != _routes.end()) {
+    PRouteList& routeList = mapItr->second;
+    PRouteListItr rItr = routeList.begin();
+    while (rItr != routeList.end()) {
+      PortalRoute* route = *rItr;
+      if (route->_maxWidth > width && route->crossesEdge(edge)) {
+        route->_valid = false;
+        _retiredRoutes.push_back(route);
+        rItr = routeList.erase(rItr);
+      } else {
+        ++rItr;
+      }
+    }
+    if (routeList.empty()) {
+      mapItr = _routes.erase(mapItr);
+    } else {
+      ++mapItr;
+    }
+  }
+  reclaimRoutes();
+  _routeLock.releaseWrite();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::flushRoutes() {
+  _routeLock.lockWrite();
+  for (PRouteMapItr mapItr = _routes.begin(); mapItr != _routes.end(); ++mapItr) {
+    _retiredRoutes.splice(_retiredRoutes.end(), mapItr->second);
+  }
+  _routes.clear();
+  reclaimRoutes();
+  _routeLock.releaseWrite();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::reclaimRoutes() {
+  PRouteListItr itr = _retiredRoutes.begin();
+  while (itr != _retiredRoutes.end()) {
+    if ((*itr)->isFollowed()) {
+      ++itr;
+    } else {
+      delete *itr;
+      itr = _retiredRoutes.erase(itr);
+    }
   }
 }
 
@@ -28,8 +28,10 @@
 #include "MengeCore/mengeCommon.h"
 #include "MengeCore/resources/NavMesh.h"
 
+#include <condition_variable>
 #include <list>
 #include <map>
+#include <mutex>
 
 namespace Menge {
 
@@ -80,6 +82,17 @@ class PathPlanner;
  */
 typedef size_t RouteKey;
 
+/*!
+ @brief    Creates unique keys for a route based on start and end nodes.
+
+ Mangles the start and end node identifiers into a RouteKey for using in the map.
+
+ @param    start    ID of start node.
+ @param    end      ID of end node.
+ @returns  A unique node key based on the start and end nodes.
+ */
+MENGE_API RouteKey makeRouteKey(unsigned int start, unsigned int end);
+
 /*!
  @brief    A list of PortalRoute pointers.
  */
@@ -110,6 +123,64 @@ typedef PRouteMap::iterator PRouteMapItr;
  */
 typedef PRouteMap::const_iterator PRouteMapCItr;
 
+/*!
+ @brief    A route computation which is in progress.
+
+ Threads which request a route that is already being computed wait on the pending computation
+ instead of repeating the same search. The waiting uses the standard library rather than SimpleLock,
+ which does nothing without OpenMP; the requests can come from any thread (e.g., simulators stepped
+ on their own threads).
+ */
+struct PendingRoute {
+  /*!
+   @brief    Constructor.
+
+   @param    minWidth    The minimum width for which the route is being computed.
+   */
+  PendingRoute(float minWidth)
+      : _minWidth(minWidth), _route(0x0), _waiting(0), _finished(false), _ready(false) {}
+
+  /*!
+   @brief    The minimum width for which the route is being computed.
+   */
+  float _minWidth;
+
+  /*!
+   @brief    The computed route; null until the computation is finished or if it failed.
+   */
+  PortalRoute* _route;
+
+  /*!
+   @brief    The number of threads waiting on this computation.
+   */
+  size_t _waiting;
+
+  /*!
+   @brief    Reports if the computing thread has finished with this pending route.
+   */
+  bool _finished;
+
+  /*!
+   @brief    Reports if the route is available to the waiting threads; guarded by _readyLock.
+   */
+  bool _ready;
+
+  /*!
+   @brief    Lock for securing _ready.
+   */
+  std::mutex _readyLock;
+
+  /*!
+   @brief    Signaled when the route becomes available.
+   */
+  std::condition_variable _readyCondition;
+};
+
+/*!
+ @brief    A mapping from RouteKey to the list of pending computations for that key.
+ */
+typedef HASH_MAP<RouteKey, std::list<PendingRoute*> > PendingRouteMap;
+
 /*!
  @brief    Class for computing paths through a navigation mesh.
  */
@@ -137,7 +208,119 @@ class MENGE_API PathPlanner {
    */
   PortalRoute* getRoute(unsigned int startID, unsigned int endID, float minWidth);
 
+  /*!
+   @brief    Reports the number of route requests that were satisfied by waiting on an identical
+            computation already in progress.
+   */
+  size_t getCoalescedCount() const { return _coalescedCount; }
+
+  /*!
+   @brief    Changes the traversability of a navigation mesh edge at runtime (e.g., a door closing or
+            opening).
+
+   Blocking an edge invalidates only those cached routes which pass through it; agents following
+   those routes will replan from their current node on their next location update. All other
+   agents keep their routes. Unblocking an edge can only make routes shorter, so the cache is
+   flushed (so that new requests find the better routes) but routes already being followed
+   remain valid.
+
+   This should not be called while agents are being updated in parallel.
+
+   @param    edgeID     The index of the edge in the navigation mesh (see NavMesh::getEdgeIndex() to
+                       map the edge ids in the navigation mesh file).
+   @param    blocked    True if the edge can no longer be traversed.
+   */
+  void setEdgeBlocked(unsigned int edgeID, bool blocked);
+
+  /*!
+   @brief    Changes the width of a navigation mesh edge at runtime.
+
+   Narrowing an edge invalidates the cached routes through the edge which were wider than the new
+   width. Widening it flushes the cache as in setEdgeBlocked().
+
+   This should not be called while agents are being updated in parallel.
+
+   @param    edgeID    The index of the edge in the navigation mesh (see NavMesh::getEdgeIndex()).
+   @param    width     The new width of the edge.
+   */
+  void setEdgeWidth(unsigned int edgeID, float width);
+
+  /*!
+   @brief    Reports the number of routes which have been removed from the cache but are still being
+            followed by at least one path.
+   */
+  size_t getRetiredRouteCount() const { return _retiredRoutes.size(); }
+
  protected:
+  /*!
+   @brief    Finds a cached route between the two nodes which is optimal for the given width.
+
+   @param    key         The key for the start and end nodes.
+   @param    minWidth    The minimum passable width required for the route.
+   @returns  A pointer to the cached route, null if there is no suitable route.
+   */
+  PortalRoute* findCachedRoute(RouteKey key, float minWidth);
+
+  /*!
+   @brief    Finds a route computation in progress whose result would be suitable for the given
+            width.
+
+   Must be called while holding _pendingLock.
+
+   @param    key         The key for the start and end nodes.
+   @param    minWidth    The minimum passable width required for the route.
+   @returns  A pointer to the pending route, null if there is none.
+   */
+  PendingRoute* findPendingRoute(RouteKey key, float minWidth);
+
+  /*!
+   @brief    Registers a route computation as in progress so that identical requests wait on it.
+
+   Must be called while holding _pendingLock. The calling thread must pass the result to
+   finishComputation().
+
+   @param    key         The key for the start and end nodes.
+   @param    minWidth    The minimum passable width for which the route is computed.
+   @returns  The pending computation.
+   */
+  PendingRoute* beginComputation(RouteKey key, float minWidth);
+
+  /*!
+   @brief    Publishes the result of a computation registered with beginComputation() to the
+            requests waiting on it.
+
+   The pending route must not be used by the caller afterwards.
+
+   @param    key        The key for the start and end nodes.
+   @param    pending    The pending computation.
+   @param    route      The computed route, null if the computation failed.
+   */
+  void finishComputation(RouteKey key, PendingRoute* pending, PortalRoute* route);
+
+  /*!
+   @brief    Removes the cached routes which pass through the given edge and are wider than the
+            given width and marks them as invalid.
+
+   @param    edge     The edge whose routes are invalidated.
+   @param    width    Routes whose maximum width exceeds this value are invalidated.
+   */
+  void invalidateRoutes(const NavMeshEdge* edge, float width);
+
+  /*!
+   @brief    Removes all routes from the cache, without invalidating them.
+
+   Agents currently following the routes can continue to do so, but new requests will be planned
+   against the current state of the navigation mesh.
+   */
+  void flushRoutes();
+
+  /*!
+   @brief    Deletes the retired routes which are no longer followed by any path.
+
+   Must be called while holding the write lock on _routeLock and not while agents are being updated.
+   */
+  void reclaimRoutes();
+
   /*!
    @brief    Computes a route (and adds it to the cache) between start and end with the minimum
             clearance given.
@@ -191,6 +374,27 @@ class MENGE_API PathPlanner {
    */
   ReadersWriterLock _routeLock;
 
+  /*!
+   @brief    Routes which have been removed from the cache but may still be referenced by agents'
+            paths. They are deleted by reclaimRoutes() once no path follows them.
+   */
+  PRouteList _retiredRoutes;
+
+  /*!
+   @brief    The route computations currently in progress.
+   */
+  PendingRouteMap _pending;
+
+  /*!
+   @brief    Lock for securing _pending and the counters of the pending computations.
+   */
+  std::mutex _pendingLock;
+
+  /*!
+   @brief    The number of requests that waited on a pending computation (see getCoalescedCount()).
+   */
+  size_t _coalescedCount;
+
   /*!
    @brief    The navigation mesh for planning on.
    */
@@ -60,12 +60,14 @@ namespace Menge {
 PortalPath::PortalPath(const Vector2& startPos, const BFSM::Goal* goal, const PortalRoute* route,
                        float agentRadius)
     : _route(route), _goal(goal), _currPortal(0), _waypoints(0x0), _headings(0x0) {
+  _route->acquire();
   computeCrossing(startPos, agentRadius);
 }
 
 /////////////////////////////////////////////////////////////////////
 
 PortalPath::~PortalPath() {
+  _route->release();
   if (_waypoints) delete[] _waypoints;
   if (_headings) delete[] _headings;
 }
@@ -114,6 +116,7 @@ void PortalPath::setPreferredDirection(const Agents::BaseAgent* agent, float hea
       goalDir /= dist;
       if (goalDir * _headings[_currPortal] < headingCos) {
         // Heading has deviated too far recompute crossing
+        ScratchArena::Scope scope;
         FunnelPlanner planner;
         planner.computeCrossing(agent->_radius, agent->_pos, this, _currPortal);
         goalDir = _waypoints[_currPortal] - agent->_pos;
@@ -155,6 +158,12 @@ unsigned int PortalPath::updateLocation(const Agents::BaseAgent* agent, const Na
   // test current location
   const Vector2& p = agent->_pos;
 
+  if (!_route->isValid()) {
+    // An edge on the route was blocked or narrowed; plan a new route from where the path currently
+    //  places the agent.
+    replan(p, currNodeID, _route->getEndNode(), agent->_radius, planner);
+  }
+
   const unsigned int PORTAL_COUNT = static_cast<unsigned int>(_route->getPortalCount());
   if (!currNode->containsPoint(p)) {
     // test to see if I've progressed to the next
@@ -311,6 +320,7 @@ void PortalPath::computeCrossing(const Vector2& startPos, float agentRadius) {
     _currPortal = 0;
     _waypoints = new Vector2[PORTAL_COUNT];
     _headings = new Vector2[PORTAL_COUNT];
+    ScratchArena::Scope scope;
     FunnelPlanner planner;
     planner.computeCrossing(agentRadius, startPos, this);
   }
@@ -328,6 +338,8 @@ void PortalPath::replan(const Vector2& startPos, unsigned int startNode, unsigne
     _headings = 0x0;
   }
   _currPortal = 0;
+  route->acquire();
+  _route->release();
   _route = route;
   computeCrossing(startPos, agentRadius);
 }
@@ -74,6 +74,13 @@ Resource* ResourceManager::getResource(const std::string& fileName,
 
 /////////////////////////////////////////////////////////////////////
 
+Resource* ResourceManager::findResource(const std::string& fileName, const std::string& suffix) {
+  ResourceMap::iterator itr = _resources.find(fileName + CAT_SYMBOL + suffix);
+  return itr != _resources.end() ? itr->second : 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void ResourceManager::cleanup() {
   ResourceMap::iterator itr = _resources.begin();
   while (itr != _resources.end()) {
@@ -60,6 +60,15 @@ class MENGE_API ResourceManager {
   static Resource* getResource(const std::string& fileName, Resource* (*reader)(const std::string&),
                                const std::string& suffix);
 
+  /*!
+   @brief    Reports a resource which the manager has already loaded, without loading it.
+
+   @param    fileName  The name of the file associated with the resource.
+   @param    suffix    The suffix of the resource's type (see getResource()).
+   @returns  A pointer to the resource, if it is loaded, NULL otherwise.
+   */
+  static Resource* findResource(const std::string& fileName, const std::string& suffix);
+
   /*!
    @brief    Passes through the resources and removes all unreferenced resources.
    */
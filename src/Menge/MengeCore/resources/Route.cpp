@@ -48,7 +48,13 @@ namespace Menge {
 /////////////////////////////////////////////////////////////////////
 
 PortalRoute::PortalRoute(unsigned int start, unsigned int end)
-    : _startNode(start), _endNode(end), _maxWidth(1e6f), _bestSmallest(1e6f), _length(0.f) {}
+    : _startNode(start),
+      _endNode(end),
+      _maxWidth(1e6f),
+      _bestSmallest(1e6f),
+      _length(0.f),
+      _valid(true),
+      _pathCount(0) {}
 
 /////////////////////////////////////////////////////////////////////
 
@@ -77,4 +83,14 @@ bool PortalRoute::isEquivalent(const PortalRoute* route) {
   }
   return false;
 }
+
+/////////////////////////////////////////////////////////////////////
+
+bool PortalRoute::crossesEdge(const NavMeshEdge* edge) const {
+  const size_t PORTAL_COUNT = _portals.size();
+  for (size_t i = 0; i < PORTAL_COUNT; ++i) {
+    if (_portals[i]._edge == edge) return true;
+  }
+  return false;
+}
 }  // namespace Menge
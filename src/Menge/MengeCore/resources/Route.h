@@ -24,6 +24,7 @@
 #ifndef __ROUTE_H__
 #define __ROUTE_H__
 
+#include <atomic>
 #include <vector>
 #include "MengeCore/resources/WayPortal.h"
 
@@ -120,6 +121,43 @@ class MENGE_API PortalRoute {
    */
   float getLength() const { return _length; }
 
+  /*!
+   @brief    Reports if the route can still be followed.
+
+   A route becomes invalid when one of its edges is blocked or narrowed after the route was
+   computed. Paths following an invalid route must request a new one.
+
+   @returns  True if the route is still valid.
+   */
+  inline bool isValid() const { return _valid; }
+
+  /*!
+   @brief    Reports if the route passes through the given edge.
+
+   @param    edge    The edge to test.
+   @returns  True if one of the route's portals is defined by the edge.
+   */
+  bool crossesEdge(const NavMeshEdge* edge) const;
+
+  /*!
+   @brief    Records that a path has started following this route.
+
+   Routes removed from the PathPlanner's cache are only deleted once no path follows them.
+   */
+  inline void acquire() const { ++_pathCount; }
+
+  /*!
+   @brief    Records that a path has stopped following this route (see acquire()).
+   */
+  inline void release() const { --_pathCount; }
+
+  /*!
+   @brief    Reports if any path is following this route.
+
+   @returns  True if at least one path has acquired, and not released, this route.
+   */
+  inline bool isFollowed() const { return _pathCount > 0; }
+
   friend class PathPlanner;
 
  protected:
@@ -148,6 +186,18 @@ class MENGE_API PortalRoute {
    */
   float _length;
 
+  /*!
+   @brief    Indicates if the route is still traversable (see isValid()).
+   */
+  bool _valid;
+
+  /*!
+   @brief    The number of paths following this route (see acquire()).
+
+   Paths are created and replanned while agents are updated in parallel.
+   */
+  mutable std::atomic<int> _pathCount;
+
   /*!
    @brief    The list of portals to pass through along the route
    */
@@ -0,0 +1,163 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeVis/Runtime/ReplayContext.h"
+
+#include "MengeVis/Runtime/ReplaySystem.h"
+
+#include <sstream>
+
+#ifdef _MSC_VER
+#include "windows.h"
+#endif
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include "GL/gl.h"
+#endif
+
+namespace MengeVis {
+namespace Runtime {
+
+using SceneGraph::Context;
+using SceneGraph::ContextResult;
+using SceneGraph::GLCamera;
+using SceneGraph::TextWriter;
+
+namespace {
+// The limits of the playback speed's magnitude, as multiples of the recorded rate.
+const float MIN_SPEED = 1.f / 64.f;
+const float MAX_SPEED = 64.f;
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+//      Implementation of ReplayContext
+////////////////////////////////////////////////////////////////////////////
+
+ReplayContext::ReplayContext(ReplaySystem* system, Context* ctx)
+    : _system(system), _childContext(ctx) {}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplayContext::drawGL(int vWidth, int vHeight) {
+  if (_childContext) _childContext->drawGL(vWidth, vHeight);
+  glPushAttrib(GL_ENABLE_BIT);
+  glDisable(GL_LIGHTING);
+  drawUIGL(vWidth, vHeight);
+  glPopAttrib();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+bool ReplayContext::selectGL(const SceneGraph::GLScene* scene, const GLCamera& camera, int vWidth,
+                             int vHeight, int* selectPoint) {
+  if (_childContext) return _childContext->selectGL(scene, camera, vWidth, vHeight, selectPoint);
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+ContextResult ReplayContext::handleMouse(SDL_Event& e) {
+  if (_childContext) return _childContext->handleMouse(e);
+  return ContextResult(false, false);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+ContextResult ReplayContext::handleKeyboard(SDL_Event& e) {
+  SDL_Keymod mods = SDL_GetModState();
+  bool hasCtrl = (mods & KMOD_CTRL) > 0;
+  bool hasAlt = (mods & KMOD_ALT) > 0;
+  bool hasShift = (mods & KMOD_SHIFT) > 0;
+
+  if (e.type == SDL_KEYDOWN && !(hasCtrl || hasAlt)) {
+    const int FRAME = static_cast<int>(_system->getFrame());
+    const int SKIP = hasShift ? static_cast<int>(_system->getFrameCount() / 10) + 1 : 1;
+    const float SPEED = _system->getSpeed();
+    switch (e.key.keysym.sym) {
+      case SDLK_PERIOD:
+        _system->seek(FRAME + SKIP);
+        return ContextResult(true, true);
+      case SDLK_COMMA:
+        _system->seek(FRAME - SKIP);
+        return ContextResult(true, true);
+      case SDLK_HOME:
+        _system->seek(0);
+        return ContextResult(true, true);
+      case SDLK_END:
+        _system->seek(static_cast<int>(_system->getFrameCount()) - 1);
+        return ContextResult(true, true);
+      case SDLK_RIGHTBRACKET:
+        if (SPEED * 2.f <= MAX_SPEED && SPEED * 2.f >= -MAX_SPEED) _system->setSpeed(SPEED * 2.f);
+        return ContextResult(true, true);
+      case SDLK_LEFTBRACKET:
+        if (SPEED * 0.5f >= MIN_SPEED || SPEED * 0.5f <= -MIN_SPEED) {
+          _system->setSpeed(SPEED * 0.5f);
+        }
+        return ContextResult(true, true);
+      case SDLK_BACKSLASH:
+        _system->setSpeed(-SPEED);
+        return ContextResult(true, true);
+      default:
+        break;
+    }
+  }
+  if (_childContext) return _childContext->handleKeyboard(e);
+  return ContextResult(false, false);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplayContext::update() {
+  if (_childContext) _childContext->update();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplayContext::newGLContext() {
+  if (_childContext) _childContext->newGLContext();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplayContext::activate() {
+  if (_childContext) _childContext->activate();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplayContext::deactivate() {
+  if (_childContext) _childContext->deactivate();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplayContext::drawUIGL(int vWidth, int vHeight, bool select) {
+  if (select) return;
+  std::stringstream ss;
+  ss << "Replay frame " << _system->getFrame() << " of " << _system->getFrameCount();
+  if (_system->getTimeStep() > 0.f) {
+    ss << " (" << _system->getFrame() * _system->getTimeStep() << " s)";
+  }
+  ss << "\nSpeed: " << _system->getSpeed() << "x";
+  writeToScreen(ss.str(), TextWriter::LEFT_BOTTOM, 15, 10.f, 10.f);
+}
+
+////////////////////////////////////////////////////////////////////////////
+}  // namespace Runtime
+}  // namespace MengeVis
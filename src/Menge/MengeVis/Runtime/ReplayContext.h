@@ -0,0 +1,145 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    ReplayContext.h
+ @brief   The definition of a context that controls the playback of a ReplaySystem.
+ */
+
+#ifndef __REPLAY_CONTEXT_H__
+#define __REPLAY_CONTEXT_H__
+
+#include "MengeVis/SceneGraph/Context.h"
+
+namespace MengeVis {
+namespace Runtime {
+// forward declarations
+class ReplaySystem;
+
+/*!
+ @brief   A context that connects user actions to the playback of a ReplaySystem.
+
+ The ReplayContext displays the shown frame, its time and the playback speed, and maps keys to the
+ system's playback controls:
+
+ User Action               | Effect
+ --------------------------|------------------------------------------
+ Press period              | Step forward one frame
+ Press comma               | Step backward one frame
+ Press shift-period        | Skip forward a tenth of the file
+ Press shift-comma         | Skip backward a tenth of the file
+ Press home                | Go to the first frame
+ Press end                 | Go to the last frame
+ Press right bracket       | Double the playback speed
+ Press left bracket        | Halve the playback speed
+ Press backslash           | Reverse the direction of play
+
+ Seeking works whether the viewer is paused or not; the viewer's own pause (space) starts and stops
+ playback. All other events are passed to the child context.
+ */
+class MENGEVIS_API ReplayContext : public SceneGraph::Context {
+ public:
+  /*!
+   @brief   Constructor.
+
+   @param   system    The system whose playback the context controls.
+   @param   ctx       The optional pass-through context.
+   */
+  ReplayContext(ReplaySystem* system, SceneGraph::Context* ctx = nullptr);
+
+  /*!
+   @brief   The draw function for the context.
+
+   @param   vWidth    The width of the viewport (in pixels).
+   @param   vHeight   The height of the viewport (in pixels).
+   */
+  void drawGL(int vWidth, int vHeight) override;
+
+  /*!
+   @brief   Performs selection based on a click on screen space.
+
+   @param   scene         The scene to select in.
+   @param   camera        The camera.
+   @param   vWidth        The width of the viewport.
+   @param   vHeight       The height of the viewport.
+   @param   selectPoint   The point (in screen space) at which object selection should take place.
+   @returns A boolean indicating whether a redraw needs to take place.
+   */
+  bool selectGL(const SceneGraph::GLScene* scene, const SceneGraph::GLCamera& camera, int vWidth,
+                int vHeight, int* selectPoint) override;
+
+  /*!
+   @brief   Give the context the opportunity to respond to a mouse event.
+
+   @param   e   The SDL event with the mouse event data.
+   @returns A ContextResult instance reporting if the event was handled and if redrawing is
+            necessary.
+   */
+  SceneGraph::ContextResult handleMouse(SDL_Event& e) override;
+
+  /*!
+   @brief   Give the context the opportunity to respond to a keyboard event.
+
+   @param   e   The SDL event with the keyboard event data.
+   @returns A ContextResult instance reporting if the event was handled and if redrawing is
+            necessary.
+   */
+  SceneGraph::ContextResult handleKeyboard(SDL_Event& e) override;
+
+  /*!
+   @brief   Allow the context to update any time-dependent state it might have to the given global
+            time.
+   */
+  void update() override;
+
+  /*!
+   @brief   Callback for when the OpenGL context is changed.
+   */
+  void newGLContext() override;
+
+  /*!
+   @brief   Called when the context is activated.
+   */
+  void activate() override;
+
+  /*!
+   @brief   Called when the context is deactivated.
+   */
+  void deactivate() override;
+
+ protected:
+  /*!
+   @brief   Draw UI elements into the context.
+
+   @param   vWidth    The width of the viewport (in pixels).
+   @param   vHeight   The height of the viewport (in pixels).
+   @param   select    Defines if the drawing is being done for selection purposes (true) or
+                      visualization (false).
+   */
+  void drawUIGL(int vWidth, int vHeight, bool select = false) override;
+
+ private:
+  // The system whose playback is controlled.
+  ReplaySystem* _system;
+
+  // The optional child context.
+  SceneGraph::Context* _childContext;
+};
+}  // namespace Runtime
+}  // namespace MengeVis
+#endif  // __REPLAY_CONTEXT_H__
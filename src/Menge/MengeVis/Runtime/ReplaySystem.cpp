@@ -0,0 +1,163 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeVis/Runtime/ReplaySystem.h"
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SCBReader.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Runtime/Logger.h"
+
+#include <cmath>
+#include <sstream>
+
+namespace MengeVis {
+namespace Runtime {
+
+using Menge::logger;
+using Menge::Logger;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::SCBFilter;
+using Menge::Agents::SCBReader;
+using Menge::Agents::SimulatorInterface;
+using SceneGraph::GLScene;
+using SceneGraph::SystemStopException;
+
+////////////////////////////////////////////////////////////////////////////
+//      Implementation of ReplaySystem
+////////////////////////////////////////////////////////////////////////////
+
+ReplaySystem::ReplaySystem(SimulatorInterface* sim, const std::string& scbPath)
+    : SimSystem(sim),
+      _reader(0x0),
+      _cursor(0.0),
+      _speed(1.f),
+      _frame(0),
+      _yIndex(1),
+      _orientIndex(2),
+      _orientIsVector(false),
+      _data(),
+      _ids() {
+  try {
+    _reader = new SCBReader(scbPath);
+  } catch (Menge::MengeException& e) {
+    throw SimSystemFatalException(e.what());
+  }
+  const size_t FLOATS = _reader->getAgentFloatCount();
+  if (_reader->getMajorVersion() == 2 && _reader->getMinorVersion() == 3) {
+    _orientIsVector = true;
+  } else if (_reader->getMajorVersion() == 2 && _reader->getMinorVersion() == 4) {
+    // x, elevation, y, orientation.
+    _yIndex = 2;
+    _orientIndex = 3;
+  } else if (_reader->getMajorVersion() == 3) {
+    if ((_reader->getFields() & SCBFilter::POSITION) == 0) {
+      delete _reader;
+      throw SimSystemFatalException("The scb file doesn't record agent positions: " + scbPath);
+    }
+    if ((_reader->getFields() & SCBFilter::ORIENTATION) == 0) _orientIndex = FLOATS;
+  }
+
+  if (_reader->getAgentCount() != sim->getNumAgents()) {
+    std::stringstream ss;
+    ss << "The scb file records " << _reader->getAgentCount() << " agents but the scene has "
+       << sim->getNumAgents() << ": " << scbPath;
+    delete _reader;
+    throw SimSystemFatalException(ss.str());
+  }
+  logger << Logger::INFO_MSG << "Replaying " << _reader->getFrameCount() << " frames from "
+         << scbPath;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+ReplaySystem::~ReplaySystem() { delete _reader; }
+
+////////////////////////////////////////////////////////////////////////////
+
+bool ReplaySystem::updateScene(float time) {
+  const double LAST = static_cast<double>(getFrameCount()) - 1.0;
+  if (LAST < 0.0 || (_speed > 0.f && _cursor >= LAST) || (_speed < 0.f && _cursor <= 0.0)) {
+    throw SystemStopException();
+  }
+  // The cursor follows the viewer's time, scaled by the speed, at the recorded frame rate. Files
+  // which don't record their time step are assumed to have been recorded with the simulator's.
+  const float ELAPSED = time > _lastUpdate ? time - _lastUpdate : 0.f;
+  _lastUpdate = time;
+  const float STEP = getTimeStep() > 0.f ? getTimeStep() : _sim->getTimeStep();
+  _cursor += STEP > 0.f ? _speed * ELAPSED / STEP : _speed;
+  if (_cursor > LAST) _cursor = LAST;
+  if (_cursor < 0.0) _cursor = 0.0;
+  const size_t FRAME = static_cast<size_t>(_cursor);
+  return FRAME != _frame && showFrame(FRAME);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void ReplaySystem::addAgentsToScene(GLScene* scene) {
+  SimSystem::addAgentsToScene(scene);
+  if (getFrameCount() > 0) showFrame(0);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+bool ReplaySystem::seek(int frame) {
+  if (getFrameCount() == 0) return false;
+  const int LAST = static_cast<int>(getFrameCount()) - 1;
+  if (frame > LAST) frame = LAST;
+  if (frame < 0) frame = 0;
+  _cursor = static_cast<double>(frame);
+  return static_cast<size_t>(frame) != _frame && showFrame(static_cast<size_t>(frame));
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+size_t ReplaySystem::getFrameCount() const { return _reader->getFrameCount(); }
+
+////////////////////////////////////////////////////////////////////////////
+
+float ReplaySystem::getTimeStep() const { return _reader->getTimeStep(); }
+
+////////////////////////////////////////////////////////////////////////////
+
+bool ReplaySystem::showFrame(size_t frame) {
+  if (!_reader->readFrame(frame, _data, &_ids)) {
+    logger << Logger::ERR_MSG << "Unable to read frame " << frame << " of the scb file.";
+    return false;
+  }
+  const size_t FLOATS = _reader->getAgentFloatCount();
+  const int AGT_COUNT = static_cast<int>(_ids.size());
+#pragma omp parallel for
+  for (int a = 0; a < AGT_COUNT; ++a) {
+    BaseAgent* agt = _sim->getAgentById(_ids[a]);
+    const float* values = &_data[a * FLOATS];
+    agt->_pos.set(values[0], values[_yIndex]);
+    if (_orientIsVector) {
+      agt->_orient.set(values[_orientIndex], values[_orientIndex + 1]);
+    } else if (_orientIndex < FLOATS) {
+      agt->_orient.set(std::cos(values[_orientIndex]), std::sin(values[_orientIndex]));
+    }
+  }
+  _frame = frame;
+  updateAgentPosition(static_cast<int>(_sim->getNumAgents()));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+}  // namespace Runtime
+}  // namespace MengeVis
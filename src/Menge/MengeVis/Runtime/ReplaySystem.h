@@ -0,0 +1,190 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    ReplaySystem.h
+ @brief   The system which plays back recorded trajectories instead of running the simulation.
+ */
+
+#ifndef __REPLAY_SYSTEM_H__
+#define __REPLAY_SYSTEM_H__
+
+#include "MengeVis/Runtime/SimSystem.h"
+
+#include <string>
+#include <vector>
+
+// forward declaration
+namespace Menge {
+namespace Agents {
+class SCBReader;
+}
+}  // namespace Menge
+
+namespace MengeVis {
+namespace Runtime {
+/*!
+ @brief   A SimSystem which moves the agents along the trajectories recorded in an scb file.
+
+ The simulator is only used for its scene: its obstacles, elevation and agents (which provide the
+ visual agents). It is never stepped; instead, each update advances a cursor through the file's
+ frames and copies the recorded positions and orientations onto the simulator's agents. So, a replay
+ costs only the reading of the frames. The file is read through Menge::Agents::SCBReader, which maps
+ it into memory; frames are decoded as they are shown, so the cursor can be moved to any frame.
+
+ The cursor follows the viewer's time: each update advances it by the time elapsed since the
+ previous update, divided by the file's time step (the simulator's, if the file doesn't record it)
+ and scaled by the playback speed. So, a speed of one plays the file at the rate it was recorded; a
+ speed can be fractional (slow motion) or negative (reverse). When the cursor reaches either end of
+ the file, the system stops (pausing the viewer); it can be moved again with seek().
+
+ All scb versions are supported. Version 3.1 files must record the agents' positions; agents which
+ a version 3.1 frame doesn't record stay where they were last shown.
+ */
+class MENGEVIS_API ReplaySystem : public SimSystem {
+ public:
+  /*!
+   @brief   Constructor.
+
+   @param   sim       A pointer to the simulator which provides the scene; the system owns it
+                      (even if construction fails).
+   @param   scbPath   The path to the scb file to play.
+   @throws  SimSystemFatalException if the file can't be read or doesn't record the simulator's
+            agents.
+   */
+  ReplaySystem(Menge::Agents::SimulatorInterface* sim, const std::string& scbPath);
+
+  /*!
+   @brief   Destructor.
+   */
+  ~ReplaySystem();
+
+  /*!
+   @brief   Advances the playback cursor by the elapsed time, scaled by the playback speed, and
+            shows the frame it lands on.
+
+   @param   time    The global time of the system; the time elapsed since the previous update is
+                    converted to frames with the recorded time step.
+   @returns True if the system has changed such that it requires a redraw.
+   @throws  SceneGraph::SystemStopException if the cursor was already at the end of the file (in
+            the direction of play).
+   */
+  virtual bool updateScene(float time);
+
+  /*!
+   @brief   Adds the visual agents to the scene, placing them at the first frame.
+
+   @param   scene   The scene which receives nodes for drawing agents.
+   */
+  virtual void addAgentsToScene(SceneGraph::GLScene* scene);
+
+  /*!
+   @brief   Moves the playback cursor to a frame and shows it.
+
+   @param   frame   The index of the frame; it is clamped to the frames of the file.
+   @returns True if the shown frame changed.
+   */
+  bool seek(int frame);
+
+  /*!
+   @brief   Reports the index of the shown frame.
+   */
+  size_t getFrame() const { return _frame; }
+
+  /*!
+   @brief   Reports the number of frames in the file.
+   */
+  size_t getFrameCount() const;
+
+  /*!
+   @brief   Reports the time between frames (zero if the file's version doesn't record it).
+   */
+  float getTimeStep() const;
+
+  /*!
+   @brief   Sets the playback speed.
+
+   @param   speed   The multiple of the recorded rate at which to play (negative plays
+                    backwards).
+   */
+  void setSpeed(float speed) { _speed = speed; }
+
+  /*!
+   @brief   Reports the playback speed, as a multiple of the recorded rate.
+   */
+  float getSpeed() const { return _speed; }
+
+ protected:
+  /*!
+   @brief   Copies a frame's positions and orientations onto the agents and updates the visual
+            agents.
+
+   @param   frame   The index of the frame.
+   @returns True if the frame was read.
+   */
+  bool showFrame(size_t frame);
+
+  /*!
+   @brief   The reader of the scb file.
+   */
+  Menge::Agents::SCBReader* _reader;
+
+  /*!
+   @brief   The playback cursor, in frames.
+   */
+  double _cursor;
+
+  /*!
+   @brief   The playback speed, as a multiple of the recorded rate.
+   */
+  float _speed;
+
+  /*!
+   @brief   The index of the shown frame.
+   */
+  size_t _frame;
+
+  /*!
+   @brief   The index of an agent's y-position among its floats.
+   */
+  size_t _yIndex;
+
+  /*!
+   @brief   The index of an agent's orientation among its floats (the float count, if it isn't
+            recorded).
+   */
+  size_t _orientIndex;
+
+  /*!
+   @brief   Determines if the orientation is recorded as a direction (x, y) rather than an angle.
+   */
+  bool _orientIsVector;
+
+  /*!
+   @brief   The floats of the frame being shown.
+   */
+  std::vector<float> _data;
+
+  /*!
+   @brief   The identifiers of the agents in the frame being shown.
+   */
+  std::vector<size_t> _ids;
+};
+}  // namespace Runtime
+}  // namespace MengeVis
+#endif  // __REPLAY_SYSTEM_H__
@@ -122,7 +122,7 @@ void SimSystem::addObstacleToScene(GLScene* scene) {
 void SimSystem::addAgentsToScene(GLScene* scene) {
   _visAgents = new VisAgent*[_sim->getNumAgents()];
   for (size_t a = 0; a < _sim->getNumAgents(); ++a) {
-    BaseAgent* agt = _sim->getAgent(a);
+    BaseAgent* agt = _sim->getAgentById(a);
     VisAgent* baseNode = VisAgentDB::getInstance(agt);
     VisAgent* agtNode = baseNode->moveToClone();
     float h = _sim->getElevation(agt);
@@ -146,7 +146,9 @@ void SimSystem::populateScene(GLScene* scene) {
 void SimSystem::updateAgentPosition(int agtCount) {
 #pragma omp parallel for
   for (int a = 0; a < agtCount; ++a) {
-    const BaseAgent* agt = _visAgents[a]->getAgent();
+    // The simulator may have moved its agents in memory.
+    const BaseAgent* agt = _sim->getAgentById(a);
+    if (agt != _visAgents[a]->getAgent()) _visAgents[a]->setElement(agt);
     float h = _sim->getElevation(agt);
     _visAgents[a]->setPosition(agt->_pos.x(), agt->_pos.y(), h);
   }
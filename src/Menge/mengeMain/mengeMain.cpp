@@ -36,6 +36,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 */
 
+#include "MengeCore/Agents/SCBWriter.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/Math/RandGenerator.h"
 #include "MengeCore/PluginEngine/CorePluginEngine.h"
@@ -48,6 +49,8 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeVis/Runtime/AgentContext/BaseAgentContext.h"
 #include "MengeVis/Runtime/EventInjectContext.h"
 #include "MengeVis/Runtime/MengeContext.h"
+#include "MengeVis/Runtime/ReplayContext.h"
+#include "MengeVis/Runtime/ReplaySystem.h"
 #include "MengeVis/Runtime/SimSystem.h"
 #include "MengeVis/SceneGraph/ContextSwitcher.h"
 #include "MengeVis/SceneGraph/GLScene.h"
@@ -83,6 +86,14 @@ float SIM_DURATION = 800.f;
 bool VERBOSE = false;
 // The location of the executable - for basic executable resources
 std::string ROOT;
+// The frames, agents and fields written to the scb file
+Agents::SCBFilter SCB_FILTER;
+// The base path of the column output (no column output if empty)
+std::string COLUMN_PATH;
+// The frames and fields written to the column output
+Agents::SCBFilter COLUMN_FILTER;
+// The scb file to replay instead of simulating (no replay if empty)
+std::string REPLAY_PATH;
 
 SimulatorDB simDB;
 
@@ -134,11 +145,60 @@ bool parseCommandParameters(int argc, char* argv[], ProjectSpec* spec, const Sim
                                            "Name of output scb file (Only writes"
                                            " output if file provided)",
                                            false, "", "string", cmd);
-    TCLAP::ValueArg<std::string> versionArg("", "scbVersion",
-                                            "Version of scb file to write "
-                                            "(1.0, 2.0, 2.1, 2.2, 2.3, or 2.4 -- 2.1 is the "
-                                            "default",
-                                            false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> versionArg(
+        "", "scbVersion",
+        "Version of scb file to write: 1.0, 2.0, 2.1, 2.2, 2.3, 2.4, 3.0 or 3.1 (default 2.1)",
+        false, "", "string", cmd);
+    TCLAP::ValueArg<int> scbAsyncArg("", "scbAsync",
+                                     "Write the scb file from a separate thread, letting up to "
+                                     "this many frames wait to be written.  The file contents "
+                                     "are unchanged.",
+                                     false, 0, "int", cmd);
+    TCLAP::ValueArg<float> scbPrecisionArg("", "scbPrecision",
+                                           "The precision (in meters) to which the compressed "
+                                           "scb versions (3.x) quantize positions.  Defaults to "
+                                           "0.001.",
+                                           false, -1.f, "float", cmd);
+    TCLAP::ValueArg<int> scbStrideArg("", "scbStride",
+                                      "Write every n-th simulation step to the scb file.",
+                                      false, 1, "int", cmd);
+    TCLAP::ValueArg<float> scbIntervalArg("", "scbInterval",
+                                          "The minimum simulation time (in seconds) between the "
+                                          "frames written to the scb file.",
+                                          false, 0.f, "float", cmd);
+    TCLAP::ValueArg<std::string> scbClassesArg("", "scbClasses",
+                                               "Only write agents of these classes (e.g., "
+                                               "\"0,2\") to the scb file (requires version 3.1).",
+                                               false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> scbStatesArg("", "scbStates",
+                                              "Only write agents in these states (e.g., "
+                                              "\"Walk,Queue\") to the scb file (requires "
+                                              "version 3.1).",
+                                              false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> scbRegionArg("", "scbRegion",
+                                              "Only write agents inside this box "
+                                              "(\"minX,minY,maxX,maxY\") to the scb file "
+                                              "(requires version 3.1).",
+                                              false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> scbFieldsArg("", "scbFields",
+                                              "The agent values to write to the scb file: a list "
+                                              "of position, orientation, state, velocity, "
+                                              "prefVelocity and elevation (requires version 3.1).",
+                                              false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> columnsArg("", "columns",
+                                            "Also write each recorded field to its own column "
+                                            "file, named <path>.<field>.col, for analytics.  The "
+                                            "frames follow --scbStride and --scbInterval.",
+                                            false, "", "path", cmd);
+    TCLAP::ValueArg<std::string> columnFieldsArg("", "columnFields",
+                                                 "The agent values to write to the column files "
+                                                 "(same names as --scbFields).",
+                                                 false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> replayArg("", "replay",
+                                           "Play back the trajectories recorded in this scb file "
+                                           "(of the same scene) in the viewer instead of "
+                                           "simulating.  No output is written.",
+                                           false, "", "path", cmd);
     TCLAP::ValueArg<float> durationArg("d", "duration",
                                        "Maximum duration of simulation (if "
                                        "final state is not achieved.)  Defaults to 400 seconds.",
@@ -231,6 +291,36 @@ bool parseCommandParameters(int argc, char* argv[], ProjectSpec* spec, const Sim
     temp = versionArg.getValue();
     if (temp != "") spec->setSCBVersion(temp);
 
+    int asyncFrames = scbAsyncArg.getValue();
+    if (asyncFrames > 0) {
+      Agents::SCBWriter::setDefaultAsyncFrames(static_cast<size_t>(asyncFrames));
+    }
+
+    float precision = scbPrecisionArg.getValue();
+    if (precision > 0.f) Agents::SCBWriter::setDefaultPrecision(precision);
+
+    int stride = scbStrideArg.getValue();
+    if (stride > 1) SCB_FILTER._frameStride = static_cast<size_t>(stride);
+    SCB_FILTER._timeInterval = scbIntervalArg.getValue();
+    SCB_FILTER.parseStates(scbStatesArg.getValue());
+    if (!SCB_FILTER.parseClasses(scbClassesArg.getValue())) {
+      logger << Logger::ERR_MSG << "Invalid scb classes: " << scbClassesArg.getValue();
+      valid = false;
+    }
+    temp = scbRegionArg.getValue();
+    if (temp != "" && !SCB_FILTER.parseRegion(temp)) {
+      logger << Logger::ERR_MSG << "Invalid scb region: " << temp;
+      valid = false;
+    }
+    if (!SCB_FILTER.parseFields(scbFieldsArg.getValue())) valid = false;
+
+    COLUMN_PATH = columnsArg.getValue();
+    COLUMN_FILTER._frameStride = SCB_FILTER._frameStride;
+    COLUMN_FILTER._timeInterval = SCB_FILTER._timeInterval;
+    if (!COLUMN_FILTER.parseFields(columnFieldsArg.getValue())) valid = false;
+
+    REPLAY_PATH = replayArg.getValue();
+
     float f = timeStepArg.getValue();
     if (f > 0.f) spec->setTimeStep(f);
 
@@ -292,13 +382,18 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
             const std::string& outFile, const std::string& scbVersion, bool visualize,
             const std::string& viewCfgFile, const std::string& dumpPath) {
   size_t agentCount;
-  if (outFile != "") {
+  const bool replay = REPLAY_PATH != "";
+  if (replay) {
+    logger << Logger::INFO_MSG << "Replaying scb file: " << REPLAY_PATH << "\n";
+  } else if (outFile != "") {
     logger << Logger::INFO_MSG << "Attempting to write scb file: " << outFile << "\n";
   }
 
   using Menge::Agents::SimulatorInterface;
   using MengeVis::Runtime::BaseAgentContext;
   using MengeVis::Runtime::EventInjectionContext;
+  using MengeVis::Runtime::ReplayContext;
+  using MengeVis::Runtime::ReplaySystem;
   using MengeVis::Runtime::SimSystem;
   using MengeVis::SceneGraph::Context;
   using MengeVis::SceneGraph::ContextSwitcher;
@@ -309,11 +404,12 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
 
   SimulatorInterface* sim =
       dbEntry->getSimulator(agentCount, TIME_STEP, SUB_STEPS, SIM_DURATION, behaveFile, sceneFile,
-                            outFile, scbVersion, VERBOSE);
+                            replay ? "" : outFile, scbVersion, VERBOSE, &SCB_FILTER);
 
   if (sim == 0x0) {
     return 1;
   }
+  if (COLUMN_PATH != "" && !replay) sim->setColumnOutput(COLUMN_PATH, &COLUMN_FILTER);
 
   std::cout << "Starting...\n";
 
@@ -359,8 +455,21 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
       std::cerr << "Unable to initialize the viewer\n\n";
       visualize = false;
     } else {
+      // A replay only uses the simulator for its scene; the system moves the agents.
+      ReplaySystem* replaySystem = 0x0;
+      SimSystem* system = 0x0;
+      if (replay) {
+        try {
+          replaySystem = new ReplaySystem(sim, REPLAY_PATH);
+        } catch (MengeVis::Runtime::SimSystemFatalException& e) {
+          logger << Logger::ERR_MSG << e.what();
+          return 1;
+        }
+        system = replaySystem;
+      } else {
+        system = new SimSystem(sim);
+      }
       GLScene* scene = new GLScene();
-      SimSystem* system = new SimSystem(sim);
       system->populateScene(scene);
       scene->addSystem(system);
       view.setScene(scene);
@@ -368,7 +477,11 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
       view.setFixedStep(TIME_STEP);
       view.setBGColor(0.1f, 0.1f, 0.1f);
       MengeVis::Runtime::MengeContext* ctx = new MengeVis::Runtime::MengeContext(sim);
-      scene->setContext(new EventInjectionContext(ctx));
+      if (replay) {
+        scene->setContext(new ReplayContext(replaySystem, ctx));
+      } else {
+        scene->setContext(new EventInjectionContext(ctx));
+      }
       view.newGLContext();
       logger.line();
 
@@ -385,6 +498,9 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
   std::cout << "Simulation time: " << dbEntry->simDuration() << "\n";
   logger << Logger::INFO_MSG << "Simulation time: " << dbEntry->simDuration() << "\n";
 
+  // Otherwise, the SimSystem owns the simulator. Deleting it finishes the trajectory file.
+  if (!visualize) delete sim;
+
   return 0;
 }
 
@@ -425,7 +541,8 @@ int main(int argc, char* argv[]) {
   std::string outFile = projSpec.getOutputName();
 
   std::string viewCfgFile = projSpec.getView();
-  bool useVis = viewCfgFile != "";
+  // Replaying requires the viewer; it uses the default view if none is given.
+  bool useVis = viewCfgFile != "" || REPLAY_PATH != "";
   std::string model(projSpec.getModel());
 
   SimulatorDBEntry* simDBEntry = simDB.getDBEntry(model);
@@ -0,0 +1,666 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    mengePython.cpp
+ @brief   The `menge` Python module: a Python interface to the C API (see menge_c_api.h).
+
+ Each `menge.Simulator` owns a simulator handle and publishes its agents into a process-local
+ snapshot after every step. The agent properties (`positions`, `velocities`, etc.) are read-only
+ NumPy arrays that view the snapshot's latest frame in place, so reading them copies nothing. The
+ snapshot reuses its two buffers, so a view is only valid until the next step; copies of a frame
+ are made on request (`agent_arrays(copy=True)`).
+ */
+
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <Python.h>
+#include <numpy/arrayobject.h>
+
+#include "MengeCore/menge_c_api.h"
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <string>
+
+namespace {
+
+// The snapshot fields (see menge_c_api.h).
+enum SnapshotField {
+  POS_X = 0,
+  ELEVATION = 2,
+  VEL_X = 3,
+  ORIENT_X = 5,
+  STATE = 7,
+};
+
+/*!
+ @brief   An agent array read from the snapshot: one field, or two consecutive fields as columns.
+ */
+struct AgentArray {
+  /*!
+   @brief   The array's name (the property's and the key in `agent_arrays()`).
+   */
+  const char* _name;
+
+  /*!
+   @brief   The array's first field.
+   */
+  int _field;
+
+  /*!
+   @brief   The number of fields (1 or 2).
+   */
+  int _columns;
+
+  /*!
+   @brief   The NumPy type of the fields' 4-byte values.
+   */
+  int _typeNum;
+};
+
+// The agent arrays, in the order of the properties.
+const AgentArray AGENT_ARRAYS[] = {{"positions", POS_X, 2, NPY_FLOAT32},
+                                   {"elevations", ELEVATION, 1, NPY_FLOAT32},
+                                   {"velocities", VEL_X, 2, NPY_FLOAT32},
+                                   {"orientations", ORIENT_X, 2, NPY_FLOAT32},
+                                   {"states", STATE, 1, NPY_UINT32}};
+const size_t AGENT_ARRAY_COUNT = sizeof(AGENT_ARRAYS) / sizeof(AGENT_ARRAYS[0]);
+
+/*!
+ @brief   The Python object wrapping a simulator.
+ */
+struct Simulator {
+  PyObject_HEAD
+
+  /*!
+   @brief   The simulator's handle (null if it failed to initialize).
+   */
+  MengeHandle _handle;
+
+  /*!
+   @brief   The agents' radii (float32), which don't change during the simulation.
+   */
+  PyObject* _radii;
+
+  /*!
+   @brief   The agents' classes (int32), which don't change during the simulation.
+   */
+  PyObject* _classes;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+// Makes an array read-only and ties the lifetime of the memory it views to the simulator.
+PyObject* viewOf(Simulator* self, PyObject* array) {
+  if (array == 0x0) return 0x0;
+  PyArray_CLEARFLAGS(reinterpret_cast<PyArrayObject*>(array), NPY_ARRAY_WRITEABLE);
+  Py_INCREF(self);
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(array),
+                            reinterpret_cast<PyObject*>(self)) != 0) {
+    Py_DECREF(array);
+    return 0x0;
+  }
+  return array;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Reports a view of an agent array in the given frame.
+PyObject* fieldView(Simulator* self, unsigned long long sequence, const AgentArray& info) {
+  const void* snapshot = MengeGetAgentSnapshot(self->_handle);
+  const char* first =
+      static_cast<const char*>(AgentSnapshotField(snapshot, sequence, info._field));
+  const char* second = static_cast<const char*>(
+      AgentSnapshotField(snapshot, sequence, info._field + info._columns - 1));
+  if (first == 0x0 || second == 0x0) {
+    PyErr_SetString(PyExc_RuntimeError, "The agent snapshot is unavailable");
+    return 0x0;
+  }
+  npy_intp dims[2] = {static_cast<npy_intp>(AgentSnapshotAgentCount(snapshot)), info._columns};
+  npy_intp strides[2] = {4, static_cast<npy_intp>(second - first)};
+  PyObject* array = PyArray_New(&PyArray_Type, info._columns > 1 ? 2 : 1, dims, info._typeNum,
+                                strides, const_cast<char*>(first), 0, NPY_ARRAY_ALIGNED, 0x0);
+  return viewOf(self, array);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Copies an agent array of the given frame into a new array. The copy is interleaved, so each row
+// is one agent. Returns false (without setting an error) if the frame is no longer available.
+bool copyField(const void* snapshot, unsigned long long sequence, const AgentArray& info,
+               PyObject* array) {
+  const size_t COUNT = AgentSnapshotAgentCount(snapshot);
+  char* data = static_cast<char*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(array)));
+  for (int c = 0; c < info._columns; ++c) {
+    const char* values =
+        static_cast<const char*>(AgentSnapshotField(snapshot, sequence, info._field + c));
+    if (values == 0x0) return false;
+    if (info._columns == 1) {
+      std::memcpy(data, values, 4 * COUNT);
+    } else {
+      for (size_t i = 0; i < COUNT; ++i) {
+        std::memcpy(data + 4 * (i * info._columns + c), values + 4 * i, 4);
+      }
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Reports every agent array of the latest frame in a dictionary: views, or copies (which later
+// steps leave unchanged).
+PyObject* agentArrays(Simulator* self, bool copy) {
+  const void* snapshot = MengeGetAgentSnapshot(self->_handle);
+  PyObject* arrays[AGENT_ARRAY_COUNT] = {};
+  bool failed = false;
+  if (copy) {
+    npy_intp dims[2] = {static_cast<npy_intp>(AgentSnapshotAgentCount(snapshot)), 0};
+    for (size_t a = 0; a < AGENT_ARRAY_COUNT && !failed; ++a) {
+      dims[1] = AGENT_ARRAYS[a]._columns;
+      arrays[a] =
+          PyArray_SimpleNew(AGENT_ARRAYS[a]._columns > 1 ? 2 : 1, dims, AGENT_ARRAYS[a]._typeNum);
+      failed = arrays[a] == 0x0;
+    }
+    // Only an asynchronous step publishes while the frame is copied, and only into the other
+    // buffer; a frame overwritten anyway is copied again.
+    bool copied = false;
+    while (!failed && !copied) {
+      const unsigned long long SEQUENCE = AgentSnapshotSequence(snapshot);
+      copied = true;
+      for (size_t a = 0; a < AGENT_ARRAY_COUNT && copied; ++a) {
+        copied = copyField(snapshot, SEQUENCE, AGENT_ARRAYS[a], arrays[a]);
+      }
+      copied = copied && AgentSnapshotIsCurrent(snapshot, SEQUENCE);
+    }
+  } else {
+    const unsigned long long SEQUENCE = AgentSnapshotSequence(snapshot);
+    for (size_t a = 0; a < AGENT_ARRAY_COUNT && !failed; ++a) {
+      arrays[a] = fieldView(self, SEQUENCE, AGENT_ARRAYS[a]);
+      failed = arrays[a] == 0x0;
+    }
+  }
+  PyObject* dict = failed ? 0x0 : PyDict_New();
+  for (size_t a = 0; a < AGENT_ARRAY_COUNT; ++a) {
+    if (dict != 0x0 && PyDict_SetItemString(dict, AGENT_ARRAYS[a]._name, arrays[a]) != 0) {
+      Py_CLEAR(dict);
+    }
+    Py_XDECREF(arrays[a]);
+  }
+  return dict;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Runs a call of the C API with the GIL released. The GIL is reacquired even if the call throws;
+// the exception is then reported as a RuntimeError and false is returned.
+template <typename Call>
+bool withoutGil(Call call) {
+  std::string error;
+  PyThreadState* state = PyEval_SaveThread();
+  try {
+    call();
+  } catch (std::exception& e) {
+    error = e.what();
+    if (error.empty()) error = "Unknown error";
+  } catch (...) {
+    error = "Unknown exception";
+  }
+  PyEval_RestoreThread(state);
+  if (!error.empty()) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Reports a read-only copy of a per-agent value, filled by a bulk accessor.
+template <typename T, typename Getter>
+PyObject* agentValues(MengeHandle handle, int typeNum, Getter getter) {
+  npy_intp count = static_cast<npy_intp>(MengeAgentCount(handle));
+  PyObject* array = PyArray_SimpleNew(1, &count, typeNum);
+  if (array == 0x0) return 0x0;
+  getter(handle, 0, count, static_cast<T*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(array))));
+  PyArray_CLEARFLAGS(reinterpret_cast<PyArrayObject*>(array), NPY_ARRAY_WRITEABLE);
+  return array;
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Simulator life cycle
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+  Simulator* self = reinterpret_cast<Simulator*>(type->tp_alloc(type, 0));
+  if (self != 0x0) {
+    self->_handle = 0x0;
+    self->_radii = 0x0;
+    self->_classes = 0x0;
+  }
+  return reinterpret_cast<PyObject*>(self);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+int Simulator_init(Simulator* self, PyObject* args, PyObject* kwds) {
+  static const char* KEYWORDS[] = {"behavior", "scene",       "model",
+                                   "plugin_path", "shared_name", 0x0};
+  const char* behavior;
+  const char* scene;
+  const char* model = "orca";
+  const char* pluginPath = 0x0;
+  const char* sharedName = 0x0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "ss|szz", const_cast<char**>(KEYWORDS), &behavior,
+                                   &scene, &model, &pluginPath, &sharedName)) {
+    return -1;
+  }
+  if (self->_handle != 0x0) {
+    PyErr_SetString(PyExc_RuntimeError, "The simulator is already initialized");
+    return -1;
+  }
+  MengeHandle handle = 0x0;
+  if (!withoutGil([&]() { handle = MengeCreate(behavior, scene, model, pluginPath); })) {
+    return -1;
+  }
+  if (handle == 0x0) {
+    PyErr_Format(PyExc_RuntimeError, "Unable to create a \"%s\" simulator from %s and %s", model,
+                 behavior, scene);
+    return -1;
+  }
+  if (!MengeEnableAgentSnapshot(handle, sharedName)) {
+    MengeDestroy(handle);
+    PyErr_SetString(PyExc_RuntimeError, "Unable to create the agent snapshot");
+    return -1;
+  }
+  self->_handle = handle;
+  self->_radii = agentValues<float>(handle, NPY_FLOAT32, MengeGetAgentRadii);
+  self->_classes = agentValues<int>(handle, NPY_INT32, MengeGetAgentClasses);
+  return self->_radii != 0x0 && self->_classes != 0x0 ? 0 : -1;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Simulator_dealloc(Simulator* self) {
+  if (self->_handle != 0x0) {
+    // Waits for an asynchronous step. A deallocation can't fail; the error is only reported.
+    MengeHandle handle = self->_handle;
+    if (!withoutGil([handle]() { MengeDestroy(handle); })) {
+      PyErr_WriteUnraisable(reinterpret_cast<PyObject*>(self));
+    }
+  }
+  Py_XDECREF(self->_radii);
+  Py_XDECREF(self->_classes);
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Sets an error if the simulator isn't initialized.
+bool isReady(Simulator* self) {
+  if (self->_handle == 0x0) {
+    PyErr_SetString(PyExc_RuntimeError, "The simulator is not initialized");
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Simulator methods
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_step(Simulator* self, PyObject*) {
+  if (!isReady(self)) return 0x0;
+  MengeHandle handle = self->_handle;
+  bool running = false;
+  if (!withoutGil([handle, &running]() { running = MengeStep(handle); })) return 0x0;
+  return PyBool_FromLong(running);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_stepAsync(Simulator* self, PyObject*) {
+  if (!isReady(self)) return 0x0;
+  return PyBool_FromLong(MengeStepAsync(self->_handle));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_waitStep(Simulator* self, PyObject*) {
+  if (!isReady(self)) return 0x0;
+  MengeHandle handle = self->_handle;
+  bool running = false;
+  if (!withoutGil([handle, &running]() { running = MengeWaitStep(handle); })) return 0x0;
+  const char* error = MengeGetStepError(handle);
+  if (error != 0x0) {
+    PyErr_SetString(PyExc_RuntimeError, error);
+    return 0x0;
+  }
+  return PyBool_FromLong(running);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_isStepDone(Simulator* self, PyObject*) {
+  if (!isReady(self)) return 0x0;
+  return PyBool_FromLong(MengeIsStepDone(self->_handle));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_setTimeStep(Simulator* self, PyObject* args) {
+  float timeStep;
+  if (!isReady(self) || !PyArg_ParseTuple(args, "f", &timeStep)) return 0x0;
+  if (timeStep <= 0.f) {
+    PyErr_SetString(PyExc_ValueError, "The time step must be positive");
+    return 0x0;
+  }
+  MengeHandle handle = self->_handle;
+  if (!withoutGil([handle, timeStep]() { MengeSetTimeStep(handle, timeStep); })) return 0x0;
+  Py_RETURN_NONE;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_stateName(Simulator* self, PyObject* args) {
+  Py_ssize_t stateId;
+  if (!isReady(self) || !PyArg_ParseTuple(args, "n", &stateId)) return 0x0;
+  const char* name =
+      stateId >= 0 ? MengeGetStateName(self->_handle, static_cast<size_t>(stateId)) : 0x0;
+  if (name == 0x0) {
+    PyErr_Format(PyExc_IndexError, "Invalid state id: %zd", stateId);
+    return 0x0;
+  }
+  return PyUnicode_FromString(name);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_fireTrigger(Simulator* self, PyObject* args) {
+  const char* name;
+  if (!isReady(self) || !PyArg_ParseTuple(args, "s", &name)) return 0x0;
+  MengeFireExternalTrigger(self->_handle, name);
+  Py_RETURN_NONE;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_prefVelocities(Simulator* self, PyObject*) {
+  if (!isReady(self)) return 0x0;
+  npy_intp dims[2] = {static_cast<npy_intp>(MengeAgentCount(self->_handle)), 2};
+  PyObject* array = PyArray_SimpleNew(2, dims, NPY_FLOAT32);
+  if (array == 0x0) return 0x0;
+  MengeGetAgentPrefVelocities(
+      self->_handle, 0, dims[0],
+      static_cast<float*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(array))));
+  return array;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_obstacles(Simulator* self, PyObject*) {
+  if (!isReady(self)) return 0x0;
+  const size_t COUNT = MengeObstacleCount(self->_handle);
+  npy_intp dims[3] = {static_cast<npy_intp>(COUNT), 2, 2};
+  PyObject* points = PyArray_SimpleNew(3, dims, NPY_FLOAT32);
+  PyObject* next = PyArray_SimpleNew(1, dims, NPY_INTP);
+  if (points == 0x0 || next == 0x0) {
+    Py_XDECREF(points);
+    Py_XDECREF(next);
+    return 0x0;
+  }
+  float* p = static_cast<float*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(points)));
+  npy_intp* n = static_cast<npy_intp*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(next)));
+  for (size_t i = 0; i < COUNT; ++i, p += 4) {
+    float elevation;
+    MengeGetObstacleEndPoints(self->_handle, i, &p[0], &elevation, &p[1], &p[2], &elevation,
+                              &p[3]);
+    n[i] = static_cast<npy_intp>(MengeGetNextObstacle(self->_handle, i));
+  }
+  return Py_BuildValue("(NN)", points, next);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_agentArrays(Simulator* self, PyObject* args, PyObject* kwds) {
+  static const char* KEYWORDS[] = {"copy", 0x0};
+  int copy = 0;
+  if (!isReady(self) ||
+      !PyArg_ParseTupleAndKeywords(args, kwds, "|p", const_cast<char**>(KEYWORDS), &copy)) {
+    return 0x0;
+  }
+  return agentArrays(self, copy != 0);
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Simulator properties
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getTime(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return PyFloat_FromDouble(MengeGetTime(self->_handle));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getAgentCount(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return PyLong_FromSize_t(MengeAgentCount(self->_handle));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getStateCount(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return PyLong_FromSize_t(MengeStateCount(self->_handle));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getTriggers(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  const int COUNT = MengeExternalTriggerCount(self->_handle);
+  PyObject* names = PyList_New(COUNT);
+  for (int i = 0; names != 0x0 && i < COUNT; ++i) {
+    PyObject* name = PyUnicode_FromString(MengeExternalTriggerName(self->_handle, i));
+    if (name == 0x0) {
+      Py_DECREF(names);
+      return 0x0;
+    }
+    PyList_SET_ITEM(names, i, name);
+  }
+  return names;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getPositions(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return fieldView(self, AgentSnapshotSequence(MengeGetAgentSnapshot(self->_handle)),
+                   AGENT_ARRAYS[0]);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getElevations(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return fieldView(self, AgentSnapshotSequence(MengeGetAgentSnapshot(self->_handle)),
+                   AGENT_ARRAYS[1]);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getVelocities(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return fieldView(self, AgentSnapshotSequence(MengeGetAgentSnapshot(self->_handle)),
+                   AGENT_ARRAYS[2]);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getOrientations(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return fieldView(self, AgentSnapshotSequence(MengeGetAgentSnapshot(self->_handle)),
+                   AGENT_ARRAYS[3]);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getStates(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  return fieldView(self, AgentSnapshotSequence(MengeGetAgentSnapshot(self->_handle)),
+                   AGENT_ARRAYS[4]);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getRadii(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  Py_INCREF(self->_radii);
+  return self->_radii;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+PyObject* Simulator_getClasses(Simulator* self, void*) {
+  if (!isReady(self)) return 0x0;
+  Py_INCREF(self->_classes);
+  return self->_classes;
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Type and module definitions
+/////////////////////////////////////////////////////////////////////
+
+PyMethodDef SIMULATOR_METHODS[] = {
+    {"step", reinterpret_cast<PyCFunction>(Simulator_step), METH_NOARGS,
+     "step() -> bool\n\nAdvances the simulation one time step; False once it has finished."},
+    {"step_async", reinterpret_cast<PyCFunction>(Simulator_stepAsync), METH_NOARGS,
+     "step_async() -> bool\n\nStarts a step on a worker thread; False if one is in flight. Until "
+     "it is done, only the agent arrays of the previous frame, fire_trigger(), is_step_done() and "
+     "wait_step() may be used. Views read before the step stay valid until it is done."},
+    {"wait_step", reinterpret_cast<PyCFunction>(Simulator_waitStep), METH_NOARGS,
+     "wait_step() -> bool\n\nWaits for the step started by step_async(); returns its result; "
+     "raises RuntimeError if the step failed."},
+    {"is_step_done", reinterpret_cast<PyCFunction>(Simulator_isStepDone), METH_NOARGS,
+     "is_step_done() -> bool\n\nReports if the step started by step_async() has finished."},
+    {"set_time_step", reinterpret_cast<PyCFunction>(Simulator_setTimeStep), METH_VARARGS,
+     "set_time_step(time_step)\n\nSets the simulation time step (in seconds)."},
+    {"state_name", reinterpret_cast<PyCFunction>(Simulator_stateName), METH_VARARGS,
+     "state_name(state_id) -> str\n\nReports the name of a BFSM state."},
+    {"fire_trigger", reinterpret_cast<PyCFunction>(Simulator_fireTrigger), METH_VARARGS,
+     "fire_trigger(name)\n\nFires an external trigger; it is activated when the next step "
+     "starts."},
+    {"pref_velocities", reinterpret_cast<PyCFunction>(Simulator_prefVelocities), METH_NOARGS,
+     "pref_velocities() -> ndarray\n\nReports a copy of the agents' preferred velocities "
+     "(float32, agent count x 2)."},
+    {"obstacles", reinterpret_cast<PyCFunction>(Simulator_obstacles), METH_NOARGS,
+     "obstacles() -> (ndarray, ndarray)\n\nReports the obstacles' end points (float32, obstacle "
+     "count x 2 points x 2) and the index of each obstacle's next obstacle."},
+    {"agent_arrays", reinterpret_cast<PyCFunction>(Simulator_agentArrays),
+     METH_VARARGS | METH_KEYWORDS,
+     "agent_arrays(copy=False) -> dict\n\nReports the agent arrays (positions, elevations, "
+     "velocities, orientations and states) of one frame, by name. By default they are read-only "
+     "views, valid until the next step, like the properties; with copy=True they are new arrays, "
+     "which later steps leave unchanged."},
+    {0x0, 0x0, 0, 0x0}};
+
+PyGetSetDef SIMULATOR_PROPERTIES[] = {
+    {const_cast<char*>("time"), reinterpret_cast<getter>(Simulator_getTime), 0x0,
+     const_cast<char*>("The simulation time (in seconds)."), 0x0},
+    {const_cast<char*>("agent_count"), reinterpret_cast<getter>(Simulator_getAgentCount), 0x0,
+     const_cast<char*>("The number of agents."), 0x0},
+    {const_cast<char*>("state_count"), reinterpret_cast<getter>(Simulator_getStateCount), 0x0,
+     const_cast<char*>("The number of BFSM states."), 0x0},
+    {const_cast<char*>("external_triggers"), reinterpret_cast<getter>(Simulator_getTriggers), 0x0,
+     const_cast<char*>("The names of the external triggers."), 0x0},
+    {const_cast<char*>("positions"), reinterpret_cast<getter>(Simulator_getPositions), 0x0,
+     const_cast<char*>("The agents' positions (float32, agent count x 2), a read-only view valid "
+                       "until the next step."),
+     0x0},
+    {const_cast<char*>("elevations"), reinterpret_cast<getter>(Simulator_getElevations), 0x0,
+     const_cast<char*>("The agents' elevations (float32), a read-only view valid until the next "
+                       "step."),
+     0x0},
+    {const_cast<char*>("velocities"), reinterpret_cast<getter>(Simulator_getVelocities), 0x0,
+     const_cast<char*>("The agents' velocities (float32, agent count x 2), a read-only view valid "
+                       "until the next step."),
+     0x0},
+    {const_cast<char*>("orientations"), reinterpret_cast<getter>(Simulator_getOrientations), 0x0,
+     const_cast<char*>("The agents' orientations (float32, agent count x 2), a read-only view "
+                       "valid until the next step."),
+     0x0},
+    {const_cast<char*>("states"), reinterpret_cast<getter>(Simulator_getStates), 0x0,
+     const_cast<char*>("The ids of the agents' BFSM states (uint32), a read-only view valid until "
+                       "the next step."),
+     0x0},
+    {const_cast<char*>("radii"), reinterpret_cast<getter>(Simulator_getRadii), 0x0,
+     const_cast<char*>("The agents' radii (float32)."), 0x0},
+    {const_cast<char*>("classes"), reinterpret_cast<getter>(Simulator_getClasses), 0x0,
+     const_cast<char*>("The agents' classes (int32)."), 0x0},
+    {0x0, 0x0, 0x0, 0x0, 0x0}};
+
+const char* SIMULATOR_DOC =
+    "Simulator(behavior, scene, model='orca', plugin_path=None, shared_name=None)\n\n"
+    "A Menge simulation of the given behavior and scene files.\n\n"
+    "The agent arrays (positions, elevations, velocities, orientations and states) are read-only "
+    "views of the frame published by the last step; they copy nothing and are valid until the "
+    "next step, which may overwrite them. To keep a frame, use agent_arrays(copy=True). If "
+    "shared_name is given, the frames are also published in that shared-memory segment for other "
+    "processes.";
+
+PyTypeObject SIMULATOR_TYPE = {PyVarObject_HEAD_INIT(0x0, 0) "menge.Simulator"};
+
+PyModuleDef MENGE_MODULE = {
+    PyModuleDef_HEAD_INIT,
+    "menge",                                                     // m_name
+    "Python bindings of the Menge crowd simulation framework.",  // m_doc
+    -1,                                                          // m_size (no per-module state)
+    0x0,                                                         // m_methods
+    0x0,                                                         // m_slots
+    0x0,                                                         // m_traverse
+    0x0,                                                         // m_clear
+    0x0};                                                        // m_free
+
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+
+PyMODINIT_FUNC PyInit_menge() {
+  import_array();
+  SIMULATOR_TYPE.tp_basicsize = sizeof(Simulator);
+  SIMULATOR_TYPE.tp_flags = Py_TPFLAGS_DEFAULT;
+  SIMULATOR_TYPE.tp_doc = SIMULATOR_DOC;
+  SIMULATOR_TYPE.tp_new = Simulator_new;
+  SIMULATOR_TYPE.tp_init = reinterpret_cast<initproc>(Simulator_init);
+  SIMULATOR_TYPE.tp_dealloc = reinterpret_cast<destructor>(Simulator_dealloc);
+  SIMULATOR_TYPE.tp_methods = SIMULATOR_METHODS;
+  SIMULATOR_TYPE.tp_getset = SIMULATOR_PROPERTIES;
+  if (PyType_Ready(&SIMULATOR_TYPE) < 0) return 0x0;
+
+  PyObject* module = PyModule_Create(&MENGE_MODULE);
+  if (module == 0x0) return 0x0;
+  Py_INCREF(&SIMULATOR_TYPE);
+  if (PyModule_AddObject(module, "Simulator", reinterpret_cast<PyObject*>(&SIMULATOR_TYPE)) < 0) {
+    Py_DECREF(&SIMULATOR_TYPE);
+    Py_DECREF(module);
+    return 0x0;
+  }
+  return module;
+}
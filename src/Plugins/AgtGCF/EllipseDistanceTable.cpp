@@ -0,0 +1,266 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "EllipseDistanceTable.h"
+
+#include "Ellipse.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace GCF {
+
+using Menge::Math::Vector2;
+
+namespace {
+// The tabulated range of the base-two logarithms of the mapped semi-axes.
+const float LOG_MIN = -4.f;
+const float LOG_MAX = 4.f;
+// The range of resolutions of the logarithmic axes considered by build().
+const size_t MIN_RESOLUTION = 16;
+const size_t MAX_RESOLUTION = 64;
+// The sine axis carries most of the curvature of the radius, so it is sampled more densely.
+const size_t SINE_SAMPLES_PER_LOG_SAMPLE = 4;
+// The number of random configurations used to measure the interpolation error.
+const size_t ERROR_SAMPLES = 20000;
+const double HALF_PI = 1.5707963267948966;
+
+// Computes the point on the boundary of the unit disk swept along the ellipse with semi-axes a
+// (along x) and b (along y) whose underlying ellipse point is (a cos t, b sin t).
+void sweptPoint(double a, double b, double t, double& x, double& y) {
+  const double ct = std::cos(t);
+  const double st = std::sin(t);
+  const double len = std::sqrt(b * b * ct * ct + a * a * st * st);
+  x = ct * (a + b / len);
+  y = st * (b + a / len);
+}
+
+// Computes the radius of the unit disk swept along the ellipse with semi-axes a (along x) and b
+// (along y) in the first-quadrant direction with the given sine. The polar angle of the swept
+// point increases monotonically with t, so the parameter of the direction is found with the
+// Illinois variant of regula falsi.
+double sweptRadius(double a, double b, double sinAngle) {
+  const double s = sinAngle;
+  const double c = std::sqrt(std::max(0.0, 1.0 - s * s));
+  if (s <= 0.0) return a + 1.0;
+  if (c <= 0.0) return b + 1.0;
+
+  // f(t) = cross( direction, point ) is positive before the direction and negative after it.
+  double lo = 0.0;
+  double hi = HALF_PI;
+  double fLo = (a + 1.0) * s;
+  double fHi = -(b + 1.0) * c;
+  const double tolerance = 1e-14 * (a + b + 2.0);
+  double x = a + 1.0;
+  double y = 0.0;
+  int side = 0;
+  for (int i = 0; i < 200 && hi - lo > 1e-15; ++i) {
+    const double t = (lo * fHi - hi * fLo) / (fHi - fLo);
+    sweptPoint(a, b, t, x, y);
+    const double f = x * s - y * c;
+    if (std::fabs(f) < tolerance) break;
+    if (f > 0.0) {
+      lo = t;
+      fLo = f;
+      if (side == 1) fHi *= 0.5;
+      side = 1;
+    } else {
+      hi = t;
+      fHi = f;
+      if (side == -1) fLo *= 0.5;
+      side = -1;
+    }
+  }
+  return std::sqrt(x * x + y * y);
+}
+}  // namespace
+
+////////////////////////////////////////////////////////////////
+//					Implementation of EllipseDistanceTable
+////////////////////////////////////////////////////////////////
+
+EllipseDistanceTable::EllipseDistanceTable()
+    : _resolution(0),
+      _sinResolution(0),
+      _logScale(0.f),
+      _rootSinScale(0.f),
+      _errorBound(0.f),
+      _error(0.f),
+      _invRadius() {}
+
+////////////////////////////////////////////////////////////////
+
+float EllipseDistanceTable::build(float maxError) {
+  _errorBound = maxError;
+
+  // The error is measured on a fixed set of configurations (with the larger axis first, as in
+  // the queries) so that the chosen resolution is reproducible.
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> logAxis(LOG_MIN, LOG_MAX);
+  std::uniform_real_distribution<float> sine(0.f, 1.f);
+  std::vector<float> samples(4 * ERROR_SAMPLES);
+  for (size_t i = 0; i < ERROR_SAMPLES; ++i) {
+    float* sample = &samples[4 * i];
+    const float l1 = logAxis(rng);
+    const float l2 = logAxis(rng);
+    sample[0] = std::max(l1, l2);
+    sample[1] = std::min(l1, l2);
+    const float sinAngle = sine(rng);
+    sample[2] = sqrtf(sinAngle);
+    sample[3] = static_cast<float>(
+        sweptRadius(std::exp2(double(sample[0])), std::exp2(double(sample[1])), sinAngle));
+  }
+
+  for (size_t resolution = MIN_RESOLUTION;; resolution *= 2) {
+    fill(resolution);
+    _error = 0.f;
+    for (size_t i = 0; i < ERROR_SAMPLES; ++i) {
+      const float* sample = &samples[4 * i];
+      const float radius = 1.f / lookup(sample[0], sample[1], sample[2]);
+      _error = std::max(_error, std::fabs(radius - sample[3]) / sample[3]);
+    }
+    if (_error <= maxError || resolution >= MAX_RESOLUTION) break;
+  }
+  return _error;
+}
+
+////////////////////////////////////////////////////////////////
+
+void EllipseDistanceTable::fill(size_t resolution) {
+  _resolution = resolution;
+  _sinResolution = SINE_SAMPLES_PER_LOG_SAMPLE * resolution;
+  _logScale = (resolution - 1) / (LOG_MAX - LOG_MIN);
+  _rootSinScale = static_cast<float>(_sinResolution - 1);
+  _invRadius.resize(resolution * resolution * _sinResolution);
+  size_t index = 0;
+  for (size_t i = 0; i < resolution; ++i) {
+    const double a = std::exp2(LOG_MIN + i / double(_logScale));
+    for (size_t j = 0; j < resolution; ++j) {
+      const double b = std::exp2(LOG_MIN + j / double(_logScale));
+      for (size_t k = 0; k < _sinResolution; ++k, ++index) {
+        const double rootSin = k / double(_rootSinScale);
+        _invRadius[index] = static_cast<float>(1.0 / sweptRadius(a, b, rootSin * rootSin));
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////
+
+float EllipseDistanceTable::lookup(float logMajor, float logMinor, float rootSin) const {
+  const float last = static_cast<float>(_resolution - 1);
+  const float x = (logMajor - LOG_MIN) * _logScale;
+  const float y = (logMinor - LOG_MIN) * _logScale;
+  // The negated tests also reject NaN.
+  if (!(x >= 0.f && x <= last && y >= 0.f && y <= last)) return -1.f;
+  const float z = rootSin * _rootSinScale;
+
+  const size_t i = std::min(static_cast<size_t>(x), _resolution - 2);
+  const size_t j = std::min(static_cast<size_t>(y), _resolution - 2);
+  const size_t k = std::min(static_cast<size_t>(z), _sinResolution - 2);
+  const float fx = x - i;
+  const float fy = y - j;
+  const float fz = z - k;
+
+  // The strides of the minor and major axes.
+  const size_t S = _sinResolution;
+  const size_t M = _resolution * S;
+  const float* c = &_invRadius[i * M + j * S + k];
+  const float c00 = c[0] + fz * (c[1] - c[0]);
+  const float c01 = c[S] + fz * (c[S + 1] - c[S]);
+  const float c10 = c[M] + fz * (c[M + 1] - c[M]);
+  const float c11 = c[M + S] + fz * (c[M + S + 1] - c[M + S]);
+  const float c0 = c00 + fy * (c01 - c00);
+  const float c1 = c10 + fy * (c11 - c10);
+  return c0 + fx * (c1 - c0);
+}
+
+////////////////////////////////////////////////////////////////
+
+float EllipseDistanceTable::distanceOfClosestApproach(const Ellipse& e1, const Ellipse& e2) const {
+  const Vector2 u1 = e1.getOrientation();
+  const Vector2 u2 = e2.getOrientation();
+  const Vector2 disp = e2.getCenter() - e1.getCenter();
+  const float invA1 = 1.f / e1.getMajor();
+  const float invB1 = 1.f / e1.getMinor();
+  const float a2 = e2.getMajor();
+  const float b2 = e2.getMinor();
+
+  // Map the second ellipse (its axes are the columns of N) and the displacement into the space in
+  // which the first ellipse is the unit circle.
+  const float cosRel = u1 * u2;
+  const float sinRel = det(u1, u2);
+  const float n00 = a2 * cosRel * invA1;
+  const float n01 = -b2 * sinRel * invA1;
+  const float n10 = a2 * sinRel * invB1;
+  const float n11 = b2 * cosRel * invB1;
+  const float wx = (disp * u1) * invA1;
+  const float wy = det(u1, disp) * invB1;
+  const float wSq = wx * wx + wy * wy;
+
+  // The eigenvalues of N N^T are the squared semi-axes of the mapped ellipse.
+  const float p = n00 * n00 + n01 * n01;
+  const float q = n10 * n10 + n11 * n11;
+  const float r = n00 * n10 + n01 * n11;
+  const float halfDiff = 0.5f * (p - q);
+  const float disc = sqrtf(halfDiff * halfDiff + r * r);
+  const float lambdaMax = 0.5f * (p + q) + disc;
+  const float detN = n00 * n11 - n01 * n10;
+  const float lambdaMin = detN * detN / lambdaMax;
+
+  // The sine of the angle between the mapped displacement and the larger axis follows from the
+  // quadratic form of N N^T; it is irrelevant if the mapped ellipse is a circle.
+  float sinSq = 0.f;
+  if (disc > 1e-6f * lambdaMax) {
+    const float quad = (p * wx * wx + 2.f * r * wx * wy + q * wy * wy) / wSq;
+    sinSq = std::min(std::max((lambdaMax - quad) / (2.f * disc), 0.f), 1.f);
+  }
+
+  const float invRadius =
+      lookup(0.5f * log2f(lambdaMax), 0.5f * log2f(lambdaMin), sqrtf(sqrtf(sinSq)));
+  if (invRadius < 0.f || !(wSq > 0.f)) return e1.distanceOfClosestApproach(e2);
+  return abs(disp) / (invRadius * sqrtf(wSq));
+}
+
+////////////////////////////////////////////////////////////////
+
+size_t EllipseDistanceTable::validate(size_t samples, unsigned int seed, float& maxAbsError,
+                                      float& maxRelError) const {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> axis(0.1f, 1.5f);
+  std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+  maxAbsError = 0.f;
+  maxRelError = 0.f;
+  size_t exceeded = 0;
+  for (size_t i = 0; i < samples; ++i) {
+    const float theta = angle(rng);
+    const Ellipse e1(Vector2(0.f, 0.f), Vector2(axis(rng), axis(rng)), angle(rng));
+    const Ellipse e2(Vector2(3.f * cosf(theta), 3.f * sinf(theta)), Vector2(axis(rng), axis(rng)),
+                     angle(rng));
+    const float exact = e1.distanceOfClosestApproach(e2);
+    const float error = std::fabs(distanceOfClosestApproach(e1, e2) - exact);
+    maxAbsError = std::max(maxAbsError, error);
+    if (exact > 0.f) {
+      maxRelError = std::max(maxRelError, error / exact);
+      if (error > _error * exact) ++exceeded;
+    }
+  }
+  return exceeded;
+}
+}  // namespace GCF
@@ -0,0 +1,175 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+#ifndef __ELLIPSE_DISTANCE_TABLE_H__
+#define __ELLIPSE_DISTANCE_TABLE_H__
+
+/*!
+ @file    EllipseDistanceTable.h
+ @brief   A precomputed, interpolated table of the distance of closest approach between ellipses.
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace GCF {
+// forward declaration
+class Ellipse;
+
+/*!
+ @brief   A lookup table for the distance of closest approach between two ellipses.
+
+ Two ellipses touch when the displacement between their centers lies on the boundary of their
+ Minkowski sum. The linear map which takes the first ellipse onto the unit circle takes the sum onto
+ the unit disk swept along a second ellipse. The radius of that shape in the direction of the
+ (mapped) displacement depends on only three values: the two semi-axes of the mapped ellipse and
+ the angle between the displacement and its larger axis. The table stores the inverse of that
+ radius on a regular grid over the base-two logarithms of the semi-axes and the square root of the
+ sine of the angle; a query maps the ellipses, interpolates and maps the result back. Along the
+ nearly straight sides of an elongated shape the radius behaves like 1 / sin, while its inverse is
+ nearly linear; the square root concentrates the samples near the rounded tip.
+
+ Configurations whose mapped semi-axes lie outside of the tabulated range (axis ratios beyond 16)
+ are evaluated with the exact Ellipse::distanceOfClosestApproach().
+ */
+class EllipseDistanceTable {
+ public:
+  /*!
+   @brief   Constructor. The table is empty until built.
+   */
+  EllipseDistanceTable();
+
+  /*!
+   @brief   Builds the table.
+
+   The resolution of the logarithmic axes starts at 16 samples and is doubled until the largest
+   relative interpolation error, measured on random configurations, is no greater than the given
+   bound or the maximum resolution (64 samples) is reached. The sine axis always has four times as
+   many samples as the logarithmic axes.
+
+   @param   maxError    The largest acceptable relative error.
+   @returns The largest relative error measured at the final resolution.
+   */
+  float build(float maxError);
+
+  /*!
+   @brief   Reports if the table has been built.
+   */
+  bool isBuilt() const { return !_invRadius.empty(); }
+
+  /*!
+   @brief   Reports the error bound the table was last built for.
+   */
+  float getErrorBound() const { return _errorBound; }
+
+  /*!
+   @brief   Reports the largest relative interpolation error measured by the last call to build().
+   */
+  float getError() const { return _error; }
+
+  /*!
+   @brief   Reports the number of samples along each of the logarithmic axes.
+   */
+  size_t getResolution() const { return _resolution; }
+
+  /*!
+   @brief   Reports the size of the table in bytes.
+   */
+  size_t getMemory() const { return _invRadius.size() * sizeof(float); }
+
+  /*!
+   @brief   Computes the distance of closest approach between two ellipses.
+
+   @param   e1    The first ellipse.
+   @param   e2    The second ellipse.
+   @returns The distance between the centers at which the ellipses would touch, if the second were
+            moved along the line connecting the centers.
+   */
+  float distanceOfClosestApproach(const Ellipse& e1, const Ellipse& e2) const;
+
+  /*!
+   @brief   Compares the table against Ellipse::distanceOfClosestApproach() on random pairs of
+            ellipses with semi-axes between 0.1 and 1.5 and arbitrary orientations.
+
+   The closed-form evaluation is itself unreliable for a small fraction of nearly circular
+   configurations, so the largest deviations can exceed the interpolation error; the number of
+   pairs which do so indicates how rare they are.
+
+   @param   samples       The number of ellipse pairs to evaluate.
+   @param   seed          The seed of the random number generator.
+   @param   maxAbsError   Set to the largest absolute deviation.
+   @param   maxRelError   Set to the largest relative deviation.
+   @returns The number of pairs whose relative deviation exceeds the error measured by build().
+   */
+  size_t validate(size_t samples, unsigned int seed, float& maxAbsError, float& maxRelError) const;
+
+ protected:
+  /*!
+   @brief   Fills the table with the given number of samples along the logarithmic axes.
+   */
+  void fill(size_t resolution);
+
+  /*!
+   @brief   Interpolates the inverse radius of the swept disk.
+
+   @param   logMajor    The base-two logarithm of the semi-axis the angle is measured from.
+   @param   logMinor    The base-two logarithm of the other semi-axis.
+   @param   rootSin     The square root of the sine of the angle between the query direction and
+                        the first semi-axis.
+   @returns The inverse of the radius, or a negative value if the semi-axes lie outside of the
+            table.
+   */
+  float lookup(float logMajor, float logMinor, float rootSin) const;
+
+  /*!
+   @brief   The number of samples along each of the logarithmic axes.
+   */
+  size_t _resolution;
+
+  /*!
+   @brief   The number of samples along the sine axis.
+   */
+  size_t _sinResolution;
+
+  /*!
+   @brief   The number of samples per unit of the logarithmic axes.
+   */
+  float _logScale;
+
+  /*!
+   @brief   The number of samples per unit of the square root of the sine.
+   */
+  float _rootSinScale;
+
+  /*!
+   @brief   The error bound passed to the last call to build().
+   */
+  float _errorBound;
+
+  /*!
+   @brief   The largest relative interpolation error measured by the last call to build().
+   */
+  float _error;
+
+  /*!
+   @brief   The tabulated inverse radii, indexed by major axis, minor axis and square root of the
+            sine, in that order of significance.
+   */
+  std::vector<float> _invRadius;
+};
+}  // namespace GCF
+#endif  // __ELLIPSE_DISTANCE_TABLE_H__
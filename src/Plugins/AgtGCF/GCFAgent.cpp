@@ -138,7 +138,9 @@ int Agent::getRepulsionParameters(const Agent* agent, float& effDist, Vector2& f
   const float PREF_SPEED = abs(_velPref.getPreferredVel());
   forceDir = _ellipse.ellipseCenterDisplace(agent->_ellipse);
   float centerDist = abs(forceDir);
-  float dca = _ellipse.distanceOfClosestApproach(agent->_ellipse);
+  float dca = Simulator::USE_DCA_TABLE
+                  ? Simulator::DCA_TABLE->distanceOfClosestApproach(_ellipse, agent->_ellipse)
+                  : _ellipse.distanceOfClosestApproach(agent->_ellipse);
   effDist = centerDist - dca;
 
   float dist = abs(forceDir);
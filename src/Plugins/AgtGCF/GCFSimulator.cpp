@@ -37,10 +37,17 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 */
 
 #include "GCFSimulator.h"
+#include "MengeCore/Runtime/Logger.h"
 #include "MengeCore/Runtime/Utils.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace GCF {
 
+using Menge::logger;
+using Menge::Logger;
 using Menge::toFloat;
 using Menge::UtilException;
 using Menge::Agents::SimulatorBase;
@@ -56,6 +63,10 @@ float Simulator::NU_AGENT = 0.3f;
 float Simulator::MAX_AGENT_DIST = 2.f;
 float Simulator::MAX_AGENT_FORCE = 3.f;
 float Simulator::AGENT_INTERP_WIDTH = 0.12f;
+bool Simulator::USE_DCA_TABLE = false;
+float Simulator::DCA_TABLE_ERROR = 0.01f;
+int Simulator::DCA_TABLE_VALIDATION = 0;
+const EllipseDistanceTable* Simulator::DCA_TABLE = 0x0;
 bool Simulator::SPEED_COLOR = false;
 
 ////////////////////////////////////////////////////////////////
@@ -73,6 +84,12 @@ bool Simulator::setExpParam(const std::string& paramName,
       MAX_AGENT_FORCE = toFloat(value);
     } else if (paramName == "agent_interp_width") {
       AGENT_INTERP_WIDTH = toFloat(value);
+    } else if (paramName == "dca_table") {
+      USE_DCA_TABLE = toInt(value) != 0;
+    } else if (paramName == "dca_table_error") {
+      DCA_TABLE_ERROR = toFloat(value);
+    } else if (paramName == "dca_table_validation") {
+      DCA_TABLE_VALIDATION = toInt(value);
     } else if (paramName == "speed_color") {
       SPEED_COLOR = toInt(value) != 0;
     } else if (!Agents::SimulatorBase<Agent>::setExpParam(paramName, value)) {
@@ -97,5 +114,39 @@ void Simulator::finalize() {
     AGENT_INTERP_WIDTH = thresh * 1.5f;
     // TODO: Log this change
   }
+
+  if (USE_DCA_TABLE) {
+    DCA_TABLE = getDistanceTable(DCA_TABLE_ERROR);
+    if (DCA_TABLE_VALIDATION > 0) {
+      float maxAbsError, maxRelError;
+      const size_t samples = static_cast<size_t>(DCA_TABLE_VALIDATION);
+      const size_t exceeded = DCA_TABLE->validate(samples, 1, maxAbsError, maxRelError);
+      logger << Logger::INFO_MSG << "GCF distance table compared with the exact evaluation on ";
+      logger << DCA_TABLE_VALIDATION << " random ellipse pairs. Largest deviation: " << maxAbsError;
+      logger << " (relative: " << maxRelError << "). " << exceeded << " pairs exceeded the ";
+      logger << "interpolation error.";
+    }
+  }
+}
+////////////////////////////////////////////////////////////////
+
+const EllipseDistanceTable* Simulator::getDistanceTable(float maxError) {
+  // The table only depends on the error bound, so it is shared by all simulators.
+  static std::mutex tableLock;
+  static std::map<float, std::unique_ptr<EllipseDistanceTable> > tables;
+  std::lock_guard<std::mutex> lock(tableLock);
+  std::unique_ptr<EllipseDistanceTable>& table = tables[maxError];
+  if (!table) {
+    table.reset(new EllipseDistanceTable());
+    table->build(maxError);
+    logger << Logger::INFO_MSG << "GCF distance table built with " << table->getResolution();
+    logger << " samples per axis (" << (table->getMemory() >> 10) << " KB); largest ";
+    logger << "relative interpolation error: " << table->getError() << ".";
+    if (table->getError() > maxError) {
+      logger << Logger::WARN_MSG << "The GCF distance table could not achieve the requested ";
+      logger << "error bound of " << maxError << ".";
+    }
+  }
+  return table.get();
 }
 }  // namespace GCF
@@ -25,6 +25,7 @@
             model.
  */
 
+#include "EllipseDistanceTable.h"
 #include "GCFAgent.h"
 #include "MengeCore/Agents/SimulatorBase.h"
 #include "MengeCore/mengeCommon.h"
@@ -47,7 +48,18 @@ class Simulator : public Menge::Agents::SimulatorBase<Agent> {
   /*!
    @brief      Constructor.
    */
-  Simulator() : Menge::Agents::SimulatorBase<Agent>() {}
+  Simulator() : Menge::Agents::SimulatorBase<Agent>() {
+    addModelParameter(&REACTION_TIME);
+    addModelParameter(&NU_AGENT);
+    addModelParameter(&MAX_AGENT_DIST);
+    addModelParameter(&MAX_AGENT_FORCE);
+    addModelParameter(&AGENT_INTERP_WIDTH);
+    addModelParameter(&USE_DCA_TABLE);
+    addModelParameter(&DCA_TABLE_ERROR);
+    addModelParameter(&DCA_TABLE_VALIDATION);
+    addModelParameter(&DCA_TABLE);
+    addModelParameter(&SPEED_COLOR);
+  }
 
   /*!
    @brief			Reports if there are non-common Experiment parameters that this simulator requires in
@@ -112,6 +124,40 @@ class Simulator : public Menge::Agents::SimulatorBase<Agent> {
    */
   static float AGENT_INTERP_WIDTH;
 
+  /*!
+   @brief		If true, the distance of closest approach between agents is interpolated from
+            DCA_TABLE instead of being evaluated exactly.
+   */
+  static bool USE_DCA_TABLE;
+
+  /*!
+   @brief		The largest relative interpolation error the distance table should achieve.
+   */
+  static float DCA_TABLE_ERROR;
+
+  /*!
+   @brief		The number of random ellipse pairs on which the distance table is compared with the
+            exact evaluation after it has been built. Zero skips the comparison.
+   */
+  static int DCA_TABLE_VALIDATION;
+
+  /*!
+   @brief		The table of distances of closest approach; set in finalize() if USE_DCA_TABLE is
+            true (see getDistanceTable()).
+   */
+  static const EllipseDistanceTable* DCA_TABLE;
+
+  /*!
+   @brief		Returns the distance table for the given error bound, building it on first request.
+
+   Each table is built once, under a lock, and kept until the plugin is unloaded; simulators which
+   are finalized concurrently, or one after another, share the tables.
+
+   @param		maxError		The largest relative interpolation error the table should achieve.
+   @returns	The table.
+   */
+  static const EllipseDistanceTable* getDistanceTable(float maxError);
+
  public:
   /*!
    @brief		If true, the agents will be colored based on speed.
@@ -45,6 +45,7 @@ namespace Helbing {
 using Menge::Agents::BaseAgent;
 using Menge::Agents::Obstacle;
 using Menge::Math::Vector2;
+namespace Kernels = Menge::Agents::Kernels;
 
 ////////////////////////////////////////////////////////////////
 //					Implementation of Helbing::Agent
@@ -65,16 +66,66 @@ Agent::~Agent() {}
 
 void Agent::computeNewVelocity() {
   Vector2 force(drivingForce());
-  for (size_t i = 0; i < _nearAgents.size(); ++i) {
-    const BaseAgent* otherBase = _nearAgents[i].agent;
-    const Agent* const other = static_cast<const Agent*>(otherBase);
-
-    force += agentForce(other);
+  // The distances and exponentials are evaluated for all neighbors at once.
+  _agentBatch.gatherAgents(this, 6);
+  const size_t agentCount = _agentBatch.size();
+  float* normalX = _agentBatch.column(0);
+  float* normalY = _agentBatch.column(1);
+  float* dist = _agentBatch.column(2);
+  float* avoidX = _agentBatch.column(3);
+  float* avoidY = _agentBatch.column(4);
+  float* expTerm = _agentBatch.column(5);
+  for (size_t i = 0; i < agentCount; ++i) {
+    Vector2 normal_ij = _pos - Vector2(_agentBatch._posX[i], _agentBatch._posY[i]);
+    normalX[i] = normal_ij._x;
+    normalY[i] = normal_ij._y;
+  }
+  Kernels::length(normalX, normalY, dist, agentCount);
+  for (size_t i = 0; i < agentCount; ++i) {
+    const Agent* const other = static_cast<const Agent*>(_nearAgents[i].agent);
+    Vector2 normal_ij(normalX[i], normalY[i]);
+    normal_ij /= dist[i];
+    Vector2 avoidNorm;
+    expTerm[i] = agentForceExponent(other, normal_ij, dist[i], avoidNorm);
+    normalX[i] = normal_ij._x;
+    normalY[i] = normal_ij._y;
+    avoidX[i] = avoidNorm._x;
+    avoidY[i] = avoidNorm._y;
+  }
+  Kernels::exp(expTerm, expTerm, agentCount);
+  for (size_t i = 0; i < agentCount; ++i) {
+    const Agent* const other = static_cast<const Agent*>(_nearAgents[i].agent);
+    force += agentForce(other, Vector2(normalX[i], normalY[i]), dist[i],
+                        Vector2(avoidX[i], avoidY[i]), expTerm[i]);
   }
 
+  const float D = Simulator::FORCE_DISTANCE;
+  _obstacleBatch.resize(_nearObstacles.size(), 4);
+  float* obstRelX = _obstacleBatch.column(0);
+  float* obstRelY = _obstacleBatch.column(1);
+  float* obstDist = _obstacleBatch.column(2);
+  float* obstExpTerm = _obstacleBatch.column(3);
+  size_t obstCount = 0;
   for (size_t obs = 0; obs < _nearObstacles.size(); ++obs) {
-    const Obstacle* obst = _nearObstacles[obs].obstacle;
-    force += obstacleForce(obst);
+    Vector2 nearPt;  // set by distanceSqToPoint
+    float distSq;    // set by distanceSqToPoint
+    if (_nearObstacles[obs].obstacle->distanceSqToPoint(_pos, nearPt, distSq) == Obstacle::LAST) {
+      continue;
+    }
+    Vector2 relPos = _pos - nearPt;
+    obstRelX[obstCount] = relPos._x;
+    obstRelY[obstCount] = relPos._y;
+    obstDist[obstCount] = distSq;
+    ++obstCount;
+  }
+  Kernels::sqrt(obstDist, obstDist, obstCount);
+  for (size_t i = 0; i < obstCount; ++i) {
+    obstExpTerm[i] = (_radius - obstDist[i]) / D;
+  }
+  Kernels::exp(obstExpTerm, obstExpTerm, obstCount);
+  for (size_t i = 0; i < obstCount; ++i) {
+    Vector2 forceDir(Vector2(obstRelX[i], obstRelY[i]) / obstDist[i]);
+    force += obstacleForce(forceDir, obstDist[i], obstExpTerm[i]);
   }
   Vector2 acc = force / _mass;
   _velNew = _vel + acc * Simulator::TIME_STEP;
@@ -83,6 +134,18 @@ void Agent::computeNewVelocity() {
 ////////////////////////////////////////////////////////////////
 
 Vector2 Agent::agentForce(const Agent* other) const {
+  Vector2 normal_ij = _pos - other->_pos;
+  float distance_ij = abs(normal_ij);
+  normal_ij /= distance_ij;
+  Vector2 avoidNorm;
+  float expTerm = expf(agentForceExponent(other, normal_ij, distance_ij, avoidNorm));
+  return agentForce(other, normal_ij, distance_ij, avoidNorm, expTerm);
+}
+
+////////////////////////////////////////////////////////////////
+
+float Agent::agentForceExponent(const Agent* other, const Vector2& normal_ij, float distance_ij,
+                                Vector2& avoidNorm) const {
   /* compute right of way */
   float rightOfWay = fabs(_priority - other->_priority);
   if (rightOfWay >= 1.f) {
@@ -90,19 +153,15 @@ Vector2 Agent::agentForce(const Agent* other) const {
   }
 
   const float D = Simulator::FORCE_DISTANCE;
-  Vector2 normal_ij = _pos - other->_pos;
-  float distance_ij = abs(normal_ij);
-  normal_ij /= distance_ij;
   float Radii_ij = _radius + other->_radius;
 
-  float AGENT_SCALE = Simulator::AGENT_SCALE;
   float D_AGT = D;
 
   // Right of way-dependent calculations
   // Compute the direction perpinduclar to preferred velocity (on the side
   //		of the normal force.
 
-  Vector2 avoidNorm(normal_ij);
+  avoidNorm.set(normal_ij);
   if (rightOfWay) {
     Vector2 perpDir;
     if (_priority < other->_priority) {
@@ -135,7 +194,16 @@ Vector2 Agent::agentForce(const Agent* other) const {
       avoidNorm.set(slerp(rightOfWay, normal_ij, perpDir, sinTheta));
     }
   }
-  float mag = (AGENT_SCALE * expf((Radii_ij - distance_ij) / D_AGT));
+  return (Radii_ij - distance_ij) / D_AGT;
+}
+
+////////////////////////////////////////////////////////////////
+
+Vector2 Agent::agentForce(const Agent* other, const Vector2& normal_ij, float distance_ij,
+                          const Vector2& avoidNorm, float expTerm) const {
+  float Radii_ij = _radius + other->_radius;
+  float AGENT_SCALE = Simulator::AGENT_SCALE;
+  float mag = (AGENT_SCALE * expTerm);
   const float MAX_FORCE = 1e15f;
   if (mag >= MAX_FORCE) {
     mag = MAX_FORCE;
@@ -160,14 +228,19 @@ Vector2 Agent::agentForce(const Agent* other) const {
 
 Vector2 Agent::obstacleForce(const Obstacle* obst) const {
   const float D = Simulator::FORCE_DISTANCE;
-  const float OBST_MAG = Simulator::OBST_SCALE;
   Vector2 nearPt;  // set by distanceSqToPoint
   float distSq;    // set by distanceSqToPoint
   if (obst->distanceSqToPoint(_pos, nearPt, distSq) == Obstacle::LAST) return Vector2(0.f, 0.f);
   float dist = sqrtf(distSq);
   Vector2 forceDir((_pos - nearPt) / dist);
+  return obstacleForce(forceDir, dist, exp((_radius - dist) / D));
+}
 
-  Vector2 force = forceDir * (OBST_MAG * exp((_radius - dist) / D));
+////////////////////////////////////////////////////////////////
+
+Vector2 Agent::obstacleForce(const Vector2& forceDir, float dist, float expTerm) const {
+  const float OBST_MAG = Simulator::OBST_SCALE;
+  Vector2 force = forceDir * (OBST_MAG * expTerm);
 
   // pushing, friction
   if (dist < _radius) {  // intersection has occurred
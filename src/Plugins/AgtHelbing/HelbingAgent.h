@@ -25,6 +25,7 @@
 #define __HELBING_AGENT_H__
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/InteractionKernels.h"
 
 namespace Helbing {
 /*!
@@ -82,6 +83,51 @@ class Agent : public Menge::Agents::BaseAgent {
    @brief		The mass of the agent.
    */
   float _mass;
+
+ protected:
+  /*!
+   @brief		Computes the exponent of the magnitude of the repulsive force due to another agent.
+   @param		other			A pointer to a neighboring agent.
+   @param		normal_ij		The unit direction from the other agent to this agent.
+   @param		distance_ij		The distance between the agents' centers.
+   @param		avoidNorm		Set to the direction of the repulsive force.
+   @returns	The exponent; the repulsive force has magnitude AGENT_SCALE * exp(exponent).
+   */
+  float agentForceExponent(const Agent* other, const Menge::Math::Vector2& normal_ij,
+                           float distance_ij, Menge::Math::Vector2& avoidNorm) const;
+
+  /*!
+   @brief		Compute the force due to another agent from its precomputed terms.
+   @param		other			A pointer to a neighboring agent.
+   @param		normal_ij		The unit direction from the other agent to this agent.
+   @param		distance_ij		The distance between the agents' centers.
+   @param		avoidNorm		The direction of the repulsive force.
+   @param		expTerm			The exponential of agentForceExponent().
+   @returns	The force imparted by the other agent on this agent.
+   */
+  Menge::Math::Vector2 agentForce(const Agent* other, const Menge::Math::Vector2& normal_ij,
+                                  float distance_ij, const Menge::Math::Vector2& avoidNorm,
+                                  float expTerm) const;
+
+  /*!
+   @brief		Compute the force due to a nearby obstacle from its precomputed terms.
+   @param		forceDir		The unit direction from the nearest point on the obstacle to the agent.
+   @param		dist			The distance to the nearest point on the obstacle.
+   @param		expTerm			exp((_radius - dist) / FORCE_DISTANCE).
+   @returns	The force imparted by the obstacle on this agent.
+   */
+  Menge::Math::Vector2 obstacleForce(const Menge::Math::Vector2& forceDir, float dist,
+                                     float expTerm) const;
+
+  /*!
+   @brief		The scratch storage for the batched evaluation of the agent forces.
+   */
+  Menge::Agents::InteractionBatch _agentBatch;
+
+  /*!
+   @brief		The scratch storage for the batched evaluation of the obstacle forces.
+   */
+  Menge::Agents::InteractionBatch _obstacleBatch;
 };
 }  // namespace Helbing
 
@@ -43,7 +43,14 @@ class Simulator : public Menge::Agents::SimulatorBase<Agent> {
   /*!
    @brief      Constructor.
    */
-  Simulator() : Menge::Agents::SimulatorBase<Agent>() {}
+  Simulator() : Menge::Agents::SimulatorBase<Agent>() {
+    addModelParameter(&AGENT_SCALE);
+    addModelParameter(&OBST_SCALE);
+    addModelParameter(&REACTION_TIME);
+    addModelParameter(&BODY_FORCE);
+    addModelParameter(&FRICTION);
+    addModelParameter(&FORCE_DISTANCE);
+  }
 
   /*!
    @brief			Reports if there are non-common Experiment parameters that this simulator requires in
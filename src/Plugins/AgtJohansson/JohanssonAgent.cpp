@@ -44,6 +44,7 @@ namespace Johansson {
 using Menge::Agents::BaseAgent;
 using Menge::Agents::Obstacle;
 using Menge::Math::Vector2;
+namespace Kernels = Menge::Agents::Kernels;
 
 ////////////////////////////////////////////////////////////////
 //					Implementation of Johansson::Agent
@@ -69,46 +70,88 @@ void Agent::computeNewVelocity() {
   // driving force
   Vector2 force((_velPref.getPreferredVel() - _vel) / TAU);
   // agent forces
+  //  The distances, square roots and exponentials are evaluated for all neighbors at once.
   float A = Simulator::AGENT_SCALE;
-  for (size_t i = 0; i < _nearAgents.size(); ++i) {
-    const BaseAgent* otherBase = _nearAgents[i].agent;
-    const Agent* const other = static_cast<const Agent*>(otherBase);
+  _agentBatch.gatherAgents(this, 8);
+  const size_t agentCount = _agentBatch.size();
+  float* relX = _agentBatch.column(0);
+  float* relY = _agentBatch.column(1);
+  float* offsetX = _agentBatch.column(2);
+  float* offsetY = _agentBatch.column(3);
+  float* dist = _agentBatch.column(4);
+  float* offsetDist = _agentBatch.column(5);
+  float* b = _agentBatch.column(6);
+  float* expTerm = _agentBatch.column(7);
+  for (size_t i = 0; i < agentCount; ++i) {
+    Vector2 relPos = _pos - Vector2(_agentBatch._posX[i], _agentBatch._posY[i]);
+    Vector2 stepOffset = Vector2(_agentBatch._velX[i], _agentBatch._velY[i]) * STEP_TIME;
+    Vector2 relPosOffset = relPos - stepOffset;
+    relX[i] = relPos._x;
+    relY[i] = relPos._y;
+    offsetX[i] = relPosOffset._x;
+    offsetY[i] = relPosOffset._y;
+  }
+  Kernels::length(relX, relY, dist, agentCount);
+  Kernels::length(offsetX, offsetY, offsetDist, agentCount);
+
+  // elliptical term
+  for (size_t i = 0; i < agentCount; ++i) {
+    Vector2 stepOffset = Vector2(_agentBatch._velX[i], _agentBatch._velY[i]) * STEP_TIME;
+    float term1 = dist[i] + offsetDist[i];
+    float offsetDistSq = absSq(stepOffset);
+    b[i] = term1 * term1 - offsetDistSq;
+  }
+  Kernels::sqrt(b, b, agentCount);
+  for (size_t i = 0; i < agentCount; ++i) {
+    b[i] *= 0.5f;
+    expTerm[i] = -b[i] / B;
+  }
+  Kernels::exp(expTerm, expTerm, agentCount);
 
-    Vector2 relPos = _pos - other->_pos;
-    float dist = abs(relPos);
-    Vector2 relDir = relPos / dist;
+  for (size_t i = 0; i < agentCount; ++i) {
+    Vector2 relDir = Vector2(relX[i], relY[i]) / dist[i];
     // directional weight of force
 
     float cosTheta = relDir * _orient;
     float magnitude = A * (_dirWeight + (1.f - _dirWeight) * (1 + cosTheta) * 0.5f);
 
-    // elliptical term
-    Vector2 stepOffset = other->_vel * STEP_TIME;
-    Vector2 relPosOffset = relPos - stepOffset;
-    float relPosOffsetDist = abs(relPosOffset);
-    float term1 = dist + relPosOffsetDist;
-    float offsetDistSq = absSq(stepOffset);
-    float b = 0.5f * sqrtf(term1 * term1 - offsetDistSq);
-    float twoB = 2.f * b;
+    float term1 = dist[i] + offsetDist[i];
+    float twoB = 2.f * b[i];
     // Extra magnitude scaling term
     magnitude *= term1 / twoB;
-    magnitude *= expf(-b / B);
+    magnitude *= expTerm[i];
     // Force direction
-    Vector2 forceDir = 0.5f * (relDir + (relPosOffset / relPosOffsetDist));
+    Vector2 forceDir = 0.5f * (relDir + (Vector2(offsetX[i], offsetY[i]) / offsetDist[i]));
     force += magnitude * forceDir;
   }
 
   // wall forces
   A = Simulator::OBST_SCALE;
+  _obstacleBatch.resize(_nearObstacles.size(), 4);
+  float* obstRelX = _obstacleBatch.column(0);
+  float* obstRelY = _obstacleBatch.column(1);
+  float* obstDist = _obstacleBatch.column(2);
+  float* obstExpTerm = _obstacleBatch.column(3);
+  size_t obstCount = 0;
   for (size_t i = 0; i < _nearObstacles.size(); ++i) {
     Vector2 nearPt;  // set by distanceSqToPoint
     float distSq;    // set by distanceSqToPoint
     if (_nearObstacles[i].obstacle->distanceSqToPoint(_pos, nearPt, distSq) == Obstacle::LAST)
       continue;
-    float dist = sqrtf(distSq);
-
     Vector2 relPos = _pos - nearPt;
-    Vector2 relDir = relPos / dist;
+    obstRelX[obstCount] = relPos._x;
+    obstRelY[obstCount] = relPos._y;
+    obstDist[obstCount] = distSq;
+    ++obstCount;
+  }
+  Kernels::sqrt(obstDist, obstDist, obstCount);
+  for (size_t i = 0; i < obstCount; ++i) {
+    obstExpTerm[i] = -obstDist[i] / B;
+  }
+  Kernels::exp(obstExpTerm, obstExpTerm, obstCount);
+
+  for (size_t i = 0; i < obstCount; ++i) {
+    Vector2 relDir = Vector2(obstRelX[i], obstRelY[i]) / obstDist[i];
     // directional weight of force
 
     float cosTheta = relDir * _orient;
@@ -117,7 +160,7 @@ void Agent::computeNewVelocity() {
     float magnitude = A * (_dirWeight + (1.f - _dirWeight) * (1 - cosTheta) * 0.5f);
 
     // Assuming stationary wall - elliptical term goes to distance
-    magnitude *= expf(-dist / B);
+    magnitude *= obstExpTerm[i];
     // Force direction is just relative direction (for stationary wall)
     force += magnitude * relDir;
   }
@@ -25,6 +25,7 @@
 #define __JOHANSSON_AGENT_H__
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/InteractionKernels.h"
 
 namespace Johansson {
 /*!
@@ -64,6 +65,17 @@ class Agent : public Menge::Agents::BaseAgent {
    @brief		The directional weight - repulsive force depends on direction to agent
    */
   float _dirWeight;
+
+ protected:
+  /*!
+   @brief		The scratch storage for the batched evaluation of the agent forces.
+   */
+  Menge::Agents::InteractionBatch _agentBatch;
+
+  /*!
+   @brief		The scratch storage for the batched evaluation of the obstacle forces.
+   */
+  Menge::Agents::InteractionBatch _obstacleBatch;
 };
 }  // namespace Johansson
 #endif  // __JOHANSSON_AGENT_H__
@@ -48,6 +48,7 @@ namespace Karamouzas {
 using Menge::Agents::BaseAgent;
 using Menge::Agents::Obstacle;
 using Menge::Math::Vector2;
+namespace Kernels = Menge::Agents::Kernels;
 
 ////////////////////////////////////////////////////////////////
 //					Implementation of Karamouzas::Agent
@@ -109,12 +110,30 @@ void Agent::computeNewVelocity() {
   if (VERBOSE) std::cout << "Agent " << _id << "\n";
   float totalTime = 1.f;
   std::list<std::pair<float, const Agent*> > collidingSet;
-  for (size_t j = 0; j < _nearAgents.size(); ++j) {
+  // The times to collision of all neighbors are evaluated at once
+  _agentBatch.gatherAgents(this, 6);
+  const size_t agentCount = _agentBatch.size();
+  float* relVelX = _agentBatch.column(0);
+  float* relVelY = _agentBatch.column(1);
+  float* relPosX = _agentBatch.column(2);
+  float* relPosY = _agentBatch.column(3);
+  float* circRadii = _agentBatch.column(4);
+  float* collisionTimes = _agentBatch.column(5);
+  for (size_t j = 0; j < agentCount; ++j) {
+    Vector2 relVel = desVel - Vector2(_agentBatch._velX[j], _agentBatch._velY[j]);
+    Vector2 relPos = Vector2(_agentBatch._posX[j], _agentBatch._posY[j]) - _pos;
+    relVelX[j] = relVel._x;
+    relVelY[j] = relVel._y;
+    relPosX[j] = relPos._x;
+    relPosY[j] = relPos._y;
+    circRadii[j] = _perSpace + _agentBatch._radius[j];
+  }
+  Kernels::rayCircleTTC(relVelX, relVelY, relPosX, relPosY, circRadii, collisionTimes, agentCount);
+  for (size_t j = 0; j < agentCount; ++j) {
     const BaseAgent* otherBase = _nearAgents[j].agent;
     const Agent* const other = static_cast<const Agent*>(otherBase);
-    float circRadius = _perSpace + other->_radius;
-    Vector2 relVel = desVel - other->_vel;
-    Vector2 relPos = other->_pos - _pos;
+    float circRadius = circRadii[j];
+    Vector2 relPos(relPosX[j], relPosY[j]);
 
     if (absSq(relPos) < circRadius * circRadius) {  /// collision!
       if (!colliding) {
@@ -130,7 +149,7 @@ void Agent::computeNewVelocity() {
     //		If relPos is not within the field of view around preferred direction, continue
     Vector2 relDir = norm(relPos);
     if ((relDir * _orient) < FOV) continue;
-    float tc = rayCircleTTC(relVel, relPos, circRadius);
+    float tc = collisionTimes[j];
     if (tc < _anticipation && !colliding) {
       if (VERBOSE) std::cout << "\tAgent " << other->_id << " t_c: " << tc << "\n";
       // totalTime += tc;
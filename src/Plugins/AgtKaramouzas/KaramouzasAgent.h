@@ -28,6 +28,7 @@
 #define __KARAMOUZAS_AGENT_H__
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/InteractionKernels.h"
 
 namespace Karamouzas {
 /*!
@@ -70,6 +71,12 @@ class Agent : public Menge::Agents::BaseAgent {
    @brief		The anticipation time (in seconds) of the agent
    */
   float _anticipation;
+
+ protected:
+  /*!
+   @brief		The scratch storage for the batched evaluation of the times to collision.
+   */
+  Menge::Agents::InteractionBatch _agentBatch;
 };
 }  // namespace Karamouzas
 #endif  // __KARAMOUZAS_AGENT_H__
@@ -45,7 +45,18 @@ class Simulator : public Menge::Agents::SimulatorBase<Agent> {
   /*!
    @brief      Constructor.
    */
-  Simulator() : Menge::Agents::SimulatorBase<Agent>() {}
+  Simulator() : Menge::Agents::SimulatorBase<Agent>() {
+    addModelParameter(&ORIENT_WEIGHT);
+    addModelParameter(&COS_FOV_ANGLE);
+    addModelParameter(&REACTION_TIME);
+    addModelParameter(&WALL_STEEPNESS);
+    addModelParameter(&WALL_DISTANCE);
+    addModelParameter(&COLLIDING_COUNT);
+    addModelParameter(&D_MIN);
+    addModelParameter(&D_MID);
+    addModelParameter(&D_MAX);
+    addModelParameter(&AGENT_FORCE);
+  }
 
   /*!
    @brief			Reports if there are non-common Experiment parameters that this simulator requires in
@@ -47,6 +47,7 @@ using Menge::INFTY;
 using Menge::Agents::BaseAgent;
 using Menge::Agents::Obstacle;
 using Menge::Math::Vector2;
+namespace Kernels = Menge::Agents::Kernels;
 
 ////////////////////////////////////////////////////////////////
 //					Implementation of Zanlungo::Agent
@@ -77,25 +78,59 @@ void Agent::computeNewVelocity() {
     const float SPEED = abs(_vel);
     const float B = Simulator::FORCE_DISTANCE;
     // const float MAG = Simulator::AGENT_SCALE * SPEED / T_i;
+    //  The exponentials are evaluated for all interacting neighbors at once.
+    _agentBatch.resize(_nearAgents.size(), 4);
+    float* dirX = _agentBatch.column(0);
+    float* dirY = _agentBatch.column(1);
+    float* magnitude = _agentBatch.column(2);
+    float* expTerm = _agentBatch.column(3);
+    size_t forceCount = 0;
     for (size_t j = 0; j < _nearAgents.size(); ++j) {
       // 2. Use T_i to compute the direction
       const BaseAgent* otherBase = _nearAgents[j].agent;
       const Agent* const other = static_cast<const Agent*>(otherBase);
-      force += agentForce(other, T_i);
+      Vector2 D_ij;
+      if (agentForceTerms(other, T_i, D_ij, magnitude[forceCount], expTerm[forceCount])) {
+        dirX[forceCount] = D_ij._x;
+        dirY[forceCount] = D_ij._y;
+        ++forceCount;
+      }
+    }
+    Kernels::exp(expTerm, expTerm, forceCount);
+    for (size_t j = 0; j < forceCount; ++j) {
+      // 3. Compute the force
+      force += Vector2(dirX[j], dirY[j]) * (magnitude[j] * expTerm[j]);
     }
+
     // obstacles
     Vector2 futurePos = _pos + _vel * T_i;
     const float OBST_MAG = Simulator::OBST_SCALE * SPEED / T_i;
+    _obstacleBatch.resize(_nearObstacles.size(), 4);
+    float* obstDirX = _obstacleBatch.column(0);
+    float* obstDirY = _obstacleBatch.column(1);
+    float* obstDist = _obstacleBatch.column(2);
+    float* obstExpTerm = _obstacleBatch.column(3);
+    size_t obstCount = 0;
     for (size_t obs = 0; obs < _nearObstacles.size(); ++obs) {
       Vector2 nearPt;  // set by call to distanceSqToPoint
       float d2;        // set by call to distanceSqToPoint
       if (_nearObstacles[obs].obstacle->distanceSqToPoint(futurePos, nearPt, d2) == Obstacle::LAST)
         continue;
       Vector2 D_ij = futurePos - nearPt;
-      float dist = abs(D_ij);
-      D_ij /= dist;
-      dist -= _radius;
-      force += D_ij * (OBST_MAG * expf(-dist / B));
+      obstDirX[obstCount] = D_ij._x;
+      obstDirY[obstCount] = D_ij._y;
+      ++obstCount;
+    }
+    Kernels::length(obstDirX, obstDirY, obstDist, obstCount);
+    for (size_t obs = 0; obs < obstCount; ++obs) {
+      float dist = obstDist[obs] - _radius;
+      obstExpTerm[obs] = -dist / B;
+    }
+    Kernels::exp(obstExpTerm, obstExpTerm, obstCount);
+    for (size_t obs = 0; obs < obstCount; ++obs) {
+      Vector2 D_ij(obstDirX[obs], obstDirY[obs]);
+      D_ij /= obstDist[obs];
+      force += D_ij * (OBST_MAG * obstExpTerm[obs]);
     }
   }
 
@@ -106,6 +141,18 @@ void Agent::computeNewVelocity() {
 ////////////////////////////////////////////////////////////////
 
 Vector2 Agent::agentForce(const Agent* other, float T_i) const {
+  Vector2 D_ij;
+  float magnitude;
+  float exponent;
+  if (!agentForceTerms(other, T_i, D_ij, magnitude, exponent)) return Vector2(0.f, 0.f);
+  // 3. Compute the force
+  return D_ij * (magnitude * expf(exponent));
+}
+
+////////////////////////////////////////////////////////////////
+
+bool Agent::agentForceTerms(const Agent* other, float T_i, Vector2& D_ij, float& magnitude,
+                            float& exponent) const {
   float D = Simulator::FORCE_DISTANCE;
   // Right of way-dependent calculations
   Vector2 myVel = _vel;
@@ -117,10 +164,10 @@ Vector2 Agent::agentForce(const Agent* other, float T_i) const {
 
   Vector2 futPos = _pos + myVel * T_i;
   Vector2 otherFuturePos = other->_pos + hisVel * T_i;
-  Vector2 D_ij = futPos - otherFuturePos;
+  D_ij = futPos - otherFuturePos;
 
   // If the relative velocity is divergent do nothing
-  if (D_ij * (_vel - other->_vel) > 0.f) return Vector2(0.f, 0.f);
+  if (D_ij * (_vel - other->_vel) > 0.f) return false;
   float dist = abs(D_ij);
   D_ij /= dist;
   if (weight > 1.f) {
@@ -158,14 +205,14 @@ Vector2 Agent::agentForce(const Agent* other, float T_i) const {
     }
   }
   dist -= (_radius + other->_radius);
-  float magnitude = weight * Simulator::AGENT_SCALE * abs(_vel - other->_vel) / T_i;
+  magnitude = weight * Simulator::AGENT_SCALE * abs(_vel - other->_vel) / T_i;
   const float MAX_FORCE = 1e15f;
   if (magnitude >= MAX_FORCE) {
     magnitude = MAX_FORCE;
   }
   // float magnitude = weight * Simulator::AGENT_SCALE * abs( myVel - hisVel ) / T_i;
-  // 3. Compute the force
-  return D_ij * (magnitude * expf(-dist / D));
+  exponent = -dist / D;
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -178,17 +225,31 @@ bool Agent::computeTTI(float& T_i) const {
 #ifdef COLLIDE_PRIORITY
   float t_collision = T_i;
 #endif
-  for (size_t j = 0; j < _nearAgents.size(); ++j) {
+  // Right of way-dependent relative velocities and positions of all neighbors
+  const size_t agentCount = _nearAgents.size();
+  _agentBatch.resize(agentCount, 6);
+  float* relVelX = _agentBatch.column(0);
+  float* relVelY = _agentBatch.column(1);
+  float* centerX = _agentBatch.column(2);
+  float* centerY = _agentBatch.column(3);
+  float* circRadius = _agentBatch.column(4);
+  float* contactTimes = _agentBatch.column(5);
+  for (size_t j = 0; j < agentCount; ++j) {
     const BaseAgent* otherBase = _nearAgents[j].agent;
     const Agent* const other = static_cast<const Agent*>(otherBase);
 
-    // Right of way-dependent calculations
     Vector2 myVel = _vel;
     Vector2 hisVel = other->_vel;
     rightOfWayVel(hisVel, other->_velPref.getPreferredVel(), other->_priority, myVel);
 
     const Vector2 relVel = myVel - hisVel;
     Vector2 relPos = _pos - other->_pos;
+    relVelX[j] = relVel._x;
+    relVelY[j] = relVel._y;
+    centerX[j] = -relPos._x;
+    centerY[j] = -relPos._y;
+    circRadius[j] = _radius + other->_radius;
+  }
 //	This define determines if additional prediction code is executed
 //		The original zanlungo model does not include performing exact collisions
 //		between disks.  It simply estimates the time to interaction based on
@@ -198,9 +259,14 @@ bool Agent::computeTTI(float& T_i) const {
 //		agent with its neighbor.  It makes the respones far more robust.
 #define PRECISE
 #ifdef PRECISE
-    float circRadius = _radius + other->_radius;
-    // first test to see if there's an actual collision imminent
-    float contactT = rayCircleTTC(relVel, -relPos, circRadius);
+  // first test to see if there's an actual collision imminent; all neighbors at once
+  Kernels::rayCircleTTC(relVelX, relVelY, centerX, centerY, circRadius, contactTimes, agentCount);
+#endif  // PRECISE
+  for (size_t j = 0; j < agentCount; ++j) {
+    const Vector2 relVel(relVelX[j], relVelY[j]);
+    Vector2 relPos(-centerX[j], -centerY[j]);
+#ifdef PRECISE
+    float contactT = contactTimes[j];
     // std::cout << "\tColliding with " << other->_id << " at " << contactT << "\n";
 #ifdef COLLIDE_PRIORITY
     if (contactT < t_collision) {
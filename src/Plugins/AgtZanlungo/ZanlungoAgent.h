@@ -28,6 +28,7 @@
 #define __ZANLUNGO_AGENT_H__
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/InteractionKernels.h"
 
 namespace Zanlungo {
 /*!
@@ -101,6 +102,31 @@ class Agent : public Menge::Agents::BaseAgent {
    @brief		The mass of the agent
    */
   float _mass;
+
+ protected:
+  /*!
+   @brief		Computes the terms of the force due to another agent.
+   @param		other			A pointer to a neighboring agent.
+   @param		T_i				The time to interaction.
+   @param		D_ij			Set to the direction of the force.
+   @param		magnitude		Set to the magnitude of the force at zero distance.
+   @param		exponent		Set to the exponent of the distance falloff; the force is
+                        D_ij * magnitude * exp(exponent).
+   @returns	False if the agents are diverging and there is no force; true otherwise.
+   */
+  bool agentForceTerms(const Agent* other, float T_i, Menge::Math::Vector2& D_ij,
+                       float& magnitude, float& exponent) const;
+
+  /*!
+   @brief		The scratch storage for the batched evaluation of the agent interactions. It is
+          mutable so that the time to interaction can be computed in const methods.
+   */
+  mutable Menge::Agents::InteractionBatch _agentBatch;
+
+  /*!
+   @brief		The scratch storage for the batched evaluation of the obstacle forces.
+   */
+  Menge::Agents::InteractionBatch _obstacleBatch;
 };
 }  // namespace Zanlungo
 
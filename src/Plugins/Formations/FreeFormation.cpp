@@ -211,6 +211,11 @@ void FreeFormation::mapAgentsToFormation(const FSM* fsm) {
   _speed = 0.0f;
   _agentRadius = 0.0f;
 
+  // The simulator may have moved its agents in memory since the last step.
+  for (itr = _agents.begin(); itr != _agents.end(); ++itr) {
+    itr->second = Menge::SIMULATOR->getAgentById(itr->first);
+  }
+
   // clear the relationships
   // TODO: Anything that maps agents -> value should NOT clear at each time
   //		step.  The structure of these objects should only change when the
@@ -33,7 +33,7 @@ float DistanceStressFunction::updateStress() {
 
   // increase to distance if greater
   float target = 0.f;
-  float d = sqrt(_region->squaredDistance(_agent->_pos));
+  float d = sqrt(_region->squaredDistance(getAgent()->_pos));
   if (d > _outer)
     target = 0.f;
   else if (d < _inner)
@@ -1,6 +1,7 @@
 #include "StressFunction.h"
 #include "AgentStressor.h"
 
+#include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/Core.h"
 
 namespace StressGAS {
@@ -34,7 +35,7 @@ void StressFunction::processStress() {
     case FINISHED:
       return;
   }
-  _stressor->applyStress(_stressLevel, _agent);
+  _stressor->applyStress(_stressLevel, getAgent());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -49,6 +50,12 @@ void StressFunction::coolDown() {
 
 /////////////////////////////////////////////////////////////////////
 
-void StressFunction::undoStress() { _stressor->applyBaseline(_agent); }
+void StressFunction::undoStress() { _stressor->applyBaseline(getAgent()); }
+
+/////////////////////////////////////////////////////////////////////
+
+Menge::Agents::BaseAgent* StressFunction::getAgent() const {
+  return Menge::SIMULATOR->getAgentById(_agentId);
+}
 
 }  // namespace StressGAS
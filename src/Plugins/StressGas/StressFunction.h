@@ -22,6 +22,8 @@
 #include "AgentStressor.h"
 #include "StressGasConfig.h"
 
+#include "MengeCore/Agents/BaseAgent.h"
+
 // forward declaration
 namespace Menge {
 namespace Agents {
@@ -64,7 +66,7 @@ class EXPORT_API StressFunction {
                           0%.
    */
   StressFunction(Menge::Agents::BaseAgent* agent, AgentStressor* stressor, float coolDuration)
-      : _agent(agent),
+      : _agentId(agent->_id),
         _mode(ACTIVE),
         _stressor(stressor),
         _coolDownRate(1.f / coolDuration),
@@ -138,8 +140,15 @@ class EXPORT_API StressFunction {
   void coolDown();
 
  protected:
-  /*! @brief	The agent to operate on. */
-  Menge::Agents::BaseAgent* _agent;
+  /*!
+   @brief		Reports the agent to operate on.
+
+   The simulator may move its agents in memory, so the agent is looked up by identifier.
+   */
+  Menge::Agents::BaseAgent* getAgent() const;
+
+  /*! @brief	The identifier of the agent to operate on. */
+  size_t _agentId;
 
   /*! @brief	The stressor to apply to the agent. */
   AgentStressor* _stressor;
@@ -28,7 +28,7 @@ StressManager::StressManager() : _stressFunctions(), _lock(){};
 
 StressManager::~StressManager() {
   // delete remaining stress functions
-  HASH_MAP<const BaseAgent*, StressFunction*>::iterator itr = _stressFunctions.begin();
+  HASH_MAP<size_t, StressFunction*>::iterator itr = _stressFunctions.begin();
   for (; itr != _stressFunctions.end(); ++itr) {
     delete itr->second;
   }
@@ -38,15 +38,15 @@ StressManager::~StressManager() {
 
 void StressManager::updateStress() {
   _lock.lockRead();
-  HASH_MAP<const BaseAgent*, StressFunction*>::iterator itr = _stressFunctions.begin();
-  std::set<const BaseAgent*> deleteSet;
+  HASH_MAP<size_t, StressFunction*>::iterator itr = _stressFunctions.begin();
+  std::set<size_t> deleteSet;
   for (; itr != _stressFunctions.end(); ++itr) {
     itr->second->processStress();
     if (itr->second->isFinished()) {
       deleteSet.insert(itr->first);
     }
   }
-  std::set<const BaseAgent*>::iterator aItr = deleteSet.begin();
+  std::set<size_t>::iterator aItr = deleteSet.begin();
   for (; aItr != deleteSet.end(); ++aItr) {
     _stressFunctions.erase(*aItr);
   }
@@ -57,7 +57,7 @@ void StressManager::updateStress() {
 
 StressFunction* StressManager::getStressFunction(const BaseAgent* agent) {
   _lock.lockRead();
-  HASH_MAP<const BaseAgent*, StressFunction*>::iterator itr = _stressFunctions.find(agent);
+  HASH_MAP<size_t, StressFunction*>::iterator itr = _stressFunctions.find(agent->_id);
   StressFunction* func = 0x0;
   if (itr != _stressFunctions.end()) {
     func = itr->second;
@@ -70,11 +70,11 @@ StressFunction* StressManager::getStressFunction(const BaseAgent* agent) {
 
 void StressManager::setStressFunction(const BaseAgent* agent, StressFunction* func) {
   _lock.lockWrite();
-  HASH_MAP<const BaseAgent*, StressFunction*>::iterator itr = _stressFunctions.find(agent);
+  HASH_MAP<size_t, StressFunction*>::iterator itr = _stressFunctions.find(agent->_id);
   if (itr != _stressFunctions.end()) {
     delete itr->second;
   }
-  _stressFunctions[agent] = func;
+  _stressFunctions[agent->_id] = func;
   _lock.releaseWrite();
 }
 
@@ -82,7 +82,7 @@ void StressManager::setStressFunction(const BaseAgent* agent, StressFunction* fu
 
 StressFunction* StressManager::popStressFunction(const BaseAgent* agent) {
   _lock.lockWrite();
-  HASH_MAP<const BaseAgent*, StressFunction*>::iterator itr = _stressFunctions.find(agent);
+  HASH_MAP<size_t, StressFunction*>::iterator itr = _stressFunctions.find(agent->_id);
   StressFunction* func = 0x0;
   if (itr != _stressFunctions.end()) {
     func = itr->second;
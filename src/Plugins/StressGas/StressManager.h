@@ -105,7 +105,7 @@ class StressManager {
 
  protected:
   /*! The set of agents which receive stress and their corresponding stress functions. */
-  HASH_MAP<const Menge::Agents::BaseAgent*, StressFunction*> _stressFunctions;
+  HASH_MAP<size_t, StressFunction*> _stressFunctions;
 
   /*! A lock for managing access to the function map. */
   Menge::ReadersWriterLock _lock;
@@ -0,0 +1,10 @@
+#include <gmock/gmock.h>
+#include "gtest/gtest.h"
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::InitGoogleMock(&argc, argv);
+
+  int ret = RUN_ALL_TESTS();
+  return ret;
+}
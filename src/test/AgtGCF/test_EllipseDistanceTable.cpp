@@ -0,0 +1,101 @@
+#include "MengeCore/Math/Vector2.h"
+#include "Plugins/AgtGCF/Ellipse.h"
+#include "Plugins/AgtGCF/EllipseDistanceTable.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+using GCF::Ellipse;
+using GCF::EllipseDistanceTable;
+using Menge::Math::Vector2;
+
+namespace {
+const float TWO_PI = 6.2831853f;
+
+// Reports if the point lies inside the ellipse.
+bool contains(const Ellipse& e, const Vector2& p) {
+  const Vector2 q = e.toEllipseSpace(p);
+  const float x = q._x / e.getMajor();
+  const float y = q._y / e.getMinor();
+  return x * x + y * y < 1.f;
+}
+
+// Reports if the two ellipses overlap, by testing points on the boundary of the second.
+bool overlap(const Ellipse& e1, const Ellipse& e2) {
+  if (contains(e2, e1.getCenter())) return true;
+  const int SAMPLES = 2000;
+  for (int i = 0; i < SAMPLES; ++i) {
+    const float t = TWO_PI * i / SAMPLES;
+    const Vector2 p(e2.getMajor() * cosf(t), e2.getMinor() * sinf(t));
+    if (contains(e1, e2.fromEllipseSpace(p))) return true;
+  }
+  return false;
+}
+
+// Computes the distance of closest approach by bisecting the distance at which the second ellipse,
+// moved along the line connecting the centers, stops overlapping the first.
+float bisectedDistance(const Ellipse& e1, const Ellipse& e2) {
+  const Vector2 dir = norm(e2.getCenter() - e1.getCenter());
+  Ellipse moved(e2);
+  float inside = 0.f;
+  float outside = e1.getLargerAxis() + e2.getLargerAxis();
+  while (outside - inside > 1e-5f) {
+    const float mid = 0.5f * (inside + outside);
+    moved.setCenter(e1.getCenter() + dir * mid);
+    (overlap(e1, moved) ? inside : outside) = mid;
+  }
+  return 0.5f * (inside + outside);
+}
+}  // namespace
+
+// Over a grid of axes, orientations and directions, the table stays within its error bound of the
+// exact distance of closest approach. The exact evaluation is itself unreliable for some nearly
+// circular pairs; where it disagrees with a bisection of the touching distance, the table is
+// compared with the bisection instead.
+TEST(EllipseDistanceTableTest, errorIsBoundedOverGrid) {
+  const float MAX_ERROR = 0.01f;
+  EllipseDistanceTable table;
+  table.build(MAX_ERROR);
+  ASSERT_TRUE(table.isBuilt());
+  ASSERT_LE(table.getError(), MAX_ERROR);
+
+  const float AXES[] = {0.15f, 0.4f, 0.8f, 1.4f};
+  const int ANGLES = 6;
+  const int DIRECTIONS = 8;
+  int count = 0;
+  int unreliable = 0;
+  for (float a1 : AXES) {
+    for (float b1 : AXES) {
+      if (b1 > a1) continue;
+      for (float a2 : AXES) {
+        for (float b2 : AXES) {
+          if (b2 > a2) continue;
+          for (int phi1 = 0; phi1 < ANGLES; ++phi1) {
+            for (int phi2 = 0; phi2 < ANGLES; ++phi2) {
+              for (int d = 0; d < DIRECTIONS; ++d) {
+                const float theta = TWO_PI * d / DIRECTIONS + 0.1f;
+                const Ellipse e1(Vector2(1.f, -2.f), Vector2(a1, b1), TWO_PI * phi1 / ANGLES);
+                const Ellipse e2(Vector2(1.f + 4.f * cosf(theta), -2.f + 4.f * sinf(theta)),
+                                 Vector2(a2, b2), TWO_PI * phi2 / ANGLES + 0.05f);
+                float reference = e1.distanceOfClosestApproach(e2);
+                const float tabulated = table.distanceOfClosestApproach(e1, e2);
+                float error = std::fabs(tabulated - reference) / reference;
+                if (error > MAX_ERROR) {
+                  reference = bisectedDistance(e1, e2);
+                  error = std::fabs(tabulated - reference) / reference;
+                  ++unreliable;
+                }
+                EXPECT_LE(error, MAX_ERROR)
+                    << "axes (" << a1 << ", " << b1 << ") and (" << a2 << ", " << b2
+                    << "), orientations " << phi1 << " and " << phi2 << ", direction " << d;
+                ++count;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  // The exact evaluation fails rarely.
+  EXPECT_LT(unreliable, count / 50);
+}
@@ -0,0 +1,104 @@
+// Compares the time the C API takes to read every agent's fields with the per-agent accessors
+// against the bulk accessors. Front-ends call the API through a foreign function interface, which
+// adds a cost to every call; this measures the calls themselves, linked directly, so it is the lower
+// bound of the saving.
+//
+// Usage: capiBenchmark behavior.xml scene.xml [model] [frames]
+
+#include "MengeCore/menge_c_api.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+// The fields of every agent, as read each frame by a front-end.
+struct Fields {
+  explicit Fields(size_t count)
+      : positions(3 * count), velocities(3 * count), orients(2 * count), states(count),
+        classes(count) {}
+
+  bool operator==(const Fields& other) const {
+    return positions == other.positions && velocities == other.velocities &&
+           orients == other.orients && states == other.states && classes == other.classes;
+  }
+
+  std::vector<float> positions;
+  std::vector<float> velocities;
+  std::vector<float> orients;
+  std::vector<size_t> states;
+  std::vector<int> classes;
+};
+
+// Reads the fields with one call per agent and field.
+void readPerAgent(Fields& fields) {
+  const size_t COUNT = fields.states.size();
+  for (size_t i = 0; i < COUNT; ++i) {
+    float* p = &fields.positions[3 * i];
+    float* v = &fields.velocities[3 * i];
+    float* o = &fields.orients[2 * i];
+    GetAgentPosition(i, p, p + 1, p + 2);
+    GetAgentVelocity(i, v, v + 1, v + 2);
+    GetAgentOrient(i, o, o + 1);
+    GetAgentState(i, &fields.states[i]);
+    fields.classes[i] = GetAgentClass(i);
+  }
+}
+
+// Reads the fields with one call per field.
+void readBulk(Fields& fields) {
+  const size_t COUNT = fields.states.size();
+  GetAgentPositions(0, COUNT, fields.positions.data());
+  GetAgentVelocities(0, COUNT, fields.velocities.data());
+  GetAgentOrients(0, COUNT, fields.orients.data());
+  GetAgentStates(0, COUNT, fields.states.data());
+  GetAgentClasses(0, COUNT, fields.classes.data());
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "Usage: %s behavior.xml scene.xml [model] [frames]\n", argv[0]);
+    return 1;
+  }
+  const char* model = argc > 3 ? argv[3] : "orca";
+  const int FRAMES = argc > 4 ? std::atoi(argv[4]) : 200;
+  if (!InitSimulator(argv[1], argv[2], model)) {
+    std::fprintf(stderr, "Unable to initialize the simulator.\n");
+    return 1;
+  }
+
+  const size_t COUNT = AgentCount();
+  Fields perAgent(COUNT);
+  Fields bulk(COUNT);
+  double perAgentTime = 0.0;
+  double bulkTime = 0.0;
+  int frames = 0;
+  for (; frames < FRAMES; ++frames) {
+    if (!DoStep()) break;
+    const auto start = std::chrono::steady_clock::now();
+    readPerAgent(perAgent);
+    const auto middle = std::chrono::steady_clock::now();
+    readBulk(bulk);
+    const auto end = std::chrono::steady_clock::now();
+    perAgentTime += std::chrono::duration<double>(middle - start).count();
+    bulkTime += std::chrono::duration<double>(end - middle).count();
+    if (!(perAgent == bulk)) {
+      std::fprintf(stderr, "The bulk accessors disagree with the per-agent accessors.\n");
+      return 1;
+    }
+  }
+
+  if (frames == 0) {
+    std::fprintf(stderr, "The simulation ended before the first frame.\n");
+    return 1;
+  }
+  const double PER_AGENT_MS = 1e3 * perAgentTime / frames;
+  const double BULK_MS = 1e3 * bulkTime / frames;
+  std::printf("\n%zu agents, %d frames\n", COUNT, frames);
+  std::printf("  per-agent: %.4f ms/frame (%zu calls)\n", PER_AGENT_MS, 5 * COUNT);
+  std::printf("  bulk:      %.4f ms/frame (5 calls)\n", BULK_MS);
+  if (BULK_MS > 0.0) std::printf("  speedup:   %.1fx\n", PER_AGENT_MS / BULK_MS);
+  return 0;
+}
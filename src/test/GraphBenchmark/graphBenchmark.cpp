@@ -0,0 +1,129 @@
+// Compares the time the roadmap takes to connect points to its graph (Graph::getClosestVertex())
+// against testing every vertex, as it did before the vertex grid. The points are the scene's agent
+// positions, each jittered a number of times; every point is connected with both clearances, the
+// way an agent's start and goal are. The two searches must agree.
+//
+// Usage: graphBenchmark behavior.xml scene.xml roadmap.txt [model] [rounds]
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/PluginEngine/CorePluginEngine.h"
+#include "MengeCore/Runtime/SimulatorDB.h"
+#include "MengeCore/resources/Graph.h"
+#include "MengeCore/resources/GraphVertex.h"
+#include "test/MengeCore/GraphTester.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Menge::GraphPtr;
+using Menge::GraphTester;
+using Menge::Math::Vector2;
+
+namespace {
+typedef GraphTester::Clearance Clearance;
+
+// Finds the closest connectable vertex by testing every vertex.
+size_t bruteForceClosest(const GraphPtr& graph, const Vector2& point, float radius,
+                         Clearance clearance) {
+  float bestDistSq = 1e30f;
+  size_t bestID = -1;
+  for (size_t i = 0; i < graph->getVertexCount(); ++i) {
+    const Vector2 p = graph->getVertex(i)->getPosition();
+    const float distSq = absSq(p - point);
+    if (distSq < bestDistSq &&
+        ((clearance == Clearance::Full &&
+          Menge::SPATIAL_QUERY->queryVisibility(point, p, radius)) ||
+         Menge::SPATIAL_QUERY->linkIsTraversible(point, p, radius))) {
+      bestDistSq = distSq;
+      bestID = i;
+    }
+  }
+  return bestID;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    std::fprintf(stderr, "Usage: %s behavior.xml scene.xml roadmap.txt [model] [rounds]\n",
+                 argv[0]);
+    return 1;
+  }
+  const std::string model = argc > 4 ? argv[4] : "orca";
+  const int ROUNDS = argc > 5 ? std::atoi(argv[5]) : 40;
+
+  Menge::SimulatorDB simDB;
+  Menge::PluginEngine::CorePluginEngine engine(&simDB);
+  Menge::SimulatorDBEntry* simDBEntry = simDB.getDBEntry(model);
+  if (simDBEntry == 0x0) {
+    std::fprintf(stderr, "Unknown pedestrian model: %s.\n", model.c_str());
+    return 1;
+  }
+  size_t agentCount;
+  float timeStep = 0.1f;
+  size_t subSteps = 0;
+  Menge::Agents::SimulatorInterface* sim =
+      simDBEntry->getSimulator(agentCount, timeStep, subSteps, 1e6f, argv[1], argv[2], "", "",
+                               false);
+  if (sim == 0x0) {
+    std::fprintf(stderr, "Unable to initialize the simulator.\n");
+    return 1;
+  }
+
+  int result = 0;
+  {
+    GraphPtr graph = Menge::loadGraph(argv[3]);
+
+    // The points to connect: every agent's position, jittered.
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> jitter(-1.f, 1.f);
+    std::vector<Vector2> points;
+    std::vector<float> radii;
+    for (int r = 0; r < ROUNDS; ++r) {
+      for (size_t i = 0; i < sim->getNumAgents(); ++i) {
+        const Menge::Agents::BaseAgent* agent = sim->getAgent(i);
+        points.push_back(agent->_pos + Vector2(jitter(rng), jitter(rng)));
+        radii.push_back(agent->_radius);
+      }
+    }
+
+    double gridTime = 0.0;
+    double bruteTime = 0.0;
+    size_t mismatches = 0;
+    for (Clearance clearance : {Clearance::Partial, Clearance::Full}) {
+      std::vector<size_t> grid(points.size());
+      std::vector<size_t> brute(points.size());
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < points.size(); ++i) {
+        grid[i] = GraphTester::getClosestVertex(graph, points[i], radii[i], clearance);
+      }
+      const auto middle = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < points.size(); ++i) {
+        brute[i] = bruteForceClosest(graph, points[i], radii[i], clearance);
+      }
+      const auto end = std::chrono::steady_clock::now();
+      gridTime += std::chrono::duration<double>(middle - start).count();
+      bruteTime += std::chrono::duration<double>(end - middle).count();
+      for (size_t i = 0; i < points.size(); ++i) mismatches += grid[i] != brute[i];
+    }
+
+    if (mismatches > 0) {
+      std::fprintf(stderr, "The grid search disagrees with the brute-force search at %zu points.\n",
+                   mismatches);
+      result = 1;
+    }
+    std::printf("\n%zu vertices, %zu points, 2 clearances\n", graph->getVertexCount(),
+                points.size());
+    std::printf("  brute force: %.3f ms\n", 1e3 * bruteTime);
+    std::printf("  grid:        %.3f ms\n", 1e3 * gridTime);
+    if (gridTime > 0.0) std::printf("  speedup:     %.1fx\n", bruteTime / gridTime);
+  }
+  delete sim;
+  return result;
+}
@@ -0,0 +1,23 @@
+#ifndef __GRAPH_TESTER_H__
+#define __GRAPH_TESTER_H__
+
+#include "MengeCore/resources/Graph.h"
+
+namespace Menge {
+// Gives the graph's tests and benchmark access to its protected queries (see Graph).
+class GraphTester {
+ public:
+  typedef Graph::Clearance Clearance;
+
+  static size_t getClosestVertex(const GraphPtr& graph, const Vector2& point, float radius,
+                                 Clearance clearance) {
+    return graph->getClosestVertex(point, radius, clearance);
+  }
+
+  static RoadMapPath* getPath(const GraphPtr& graph, size_t startID, size_t endID) {
+    return graph->getPath(startID, endID);
+  }
+};
+}  // namespace Menge
+
+#endif  // __GRAPH_TESTER_H__
@@ -0,0 +1,58 @@
+#include "MengeCore/Agents/SpatialQueries/AgentKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/KNearestQuery.h"
+#include "MengeCore/Orca/ORCAAgent.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+using Menge::Agents::AgentKDTree;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::KNearestQuery;
+using Menge::Math::Vector2;
+
+// Querying the agents of a leaf together finds the same neighbors as querying them one at a time.
+TEST(AgentKDTreeTest, leafQueryMatchesAgentQuery) {
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> coord(-20.f, 20.f);
+  std::vector<ORCA::Agent> agents(500);
+  std::vector<BaseAgent*> pointers(agents.size());
+  for (size_t i = 0; i < agents.size(); ++i) {
+    agents[i]._pos.set(coord(rng), coord(rng));
+    pointers[i] = &agents[i];
+  }
+  AgentKDTree tree;
+  tree.setAgents(pointers);
+
+  size_t queried = 0;
+  for (size_t leaf = 0; leaf < tree.getLeafCount(); ++leaf) {
+    const size_t COUNT = tree.getLeafSize(leaf);
+    ASSERT_LE(COUNT, AgentKDTree::MAX_LEAF_SIZE);
+    std::vector<KNearestQuery> batched(COUNT);
+    for (size_t i = 0; i < COUNT; ++i) {
+      batched[i].setMaxAgentResults(5 + i);
+      batched[i].setQueryRangeSq(9.f);
+      batched[i].startQuery();
+      batched[i].setQueryPoint(tree.getLeafAgent(leaf, i)->_pos);
+    }
+    tree.leafQuery(leaf, &batched[0], COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i) {
+      KNearestQuery single;
+      single.setMaxAgentResults(5 + i);
+      single.setQueryRangeSq(9.f);
+      single.startQuery();
+      single.setQueryPoint(tree.getLeafAgent(leaf, i)->_pos);
+      tree.agentQuery(&single);
+
+      ASSERT_EQ(single.agentResultCount(), batched[i].agentResultCount());
+      for (size_t r = 0; r < single.agentResultCount(); ++r) {
+        EXPECT_EQ(single.getAgentResult(r).agent, batched[i].getAgentResult(r).agent);
+        EXPECT_EQ(single.getAgentResult(r).distanceSquared,
+                  batched[i].getAgentResult(r).distanceSquared);
+      }
+    }
+    queried += COUNT;
+  }
+  EXPECT_EQ(agents.size(), queried);
+}
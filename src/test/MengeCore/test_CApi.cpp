@@ -0,0 +1,496 @@
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/Events/EventTrigger.h"
+#include "MengeCore/Agents/Events/EventTriggerDB.h"
+#include "MengeCore/Agents/Events/EventTriggerFactory.h"
+#include "MengeCore/Agents/InteractionKernels.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/PluginEngine/CorePluginEngine.h"
+#include "MengeCore/Runtime/SimulatorDB.h"
+#include "MengeCore/menge_c_api.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// A small scene: two classes of agents in a grid, walking to their mirrored positions around a box.
+const char* SCENE_XML =
+    "<?xml version=\"1.0\"?>\n"
+    "<Experiment version=\"2.0\">\n"
+    "  <SpatialQuery type=\"kd-tree\" test_visibility=\"false\" />\n"
+    "  <Common time_step=\"0.1\" />\n"
+    "  <AgentProfile name=\"group1\">\n"
+    "    <Common max_angle_vel=\"360\" max_neighbors=\"10\" obstacleSet=\"1\" neighbor_dist=\"5\" "
+    "r=\"0.2\" pref_speed=\"1.34\" max_speed=\"2\" max_accel=\"5\" />\n"
+    "    <ORCA tau=\"3.0\" tauObst=\"0.15\" />\n"
+    "  </AgentProfile>\n"
+    "  <AgentProfile name=\"group2\" inherits=\"group1\">\n"
+    "    <Common class=\"2\" r=\"0.3\" />\n"
+    "  </AgentProfile>\n"
+    "  <AgentGroup>\n"
+    "    <ProfileSelector type=\"const\" name=\"group1\" />\n"
+    "    <StateSelector type=\"const\" name=\"Walk\" />\n"
+    "    <Generator type=\"rect_grid\" anchor_x=\"-7\" anchor_y=\"-7\" offset_x=\"-1\" "
+    "offset_y=\"-1\" count_x=\"8\" count_y=\"8\" />\n"
+    "  </AgentGroup>\n"
+    "  <AgentGroup>\n"
+    "    <ProfileSelector type=\"const\" name=\"group2\" />\n"
+    "    <StateSelector type=\"const\" name=\"Walk\" />\n"
+    "    <Generator type=\"rect_grid\" anchor_x=\"7\" anchor_y=\"-7\" offset_x=\"1\" "
+    "offset_y=\"-1\" count_x=\"8\" count_y=\"8\" />\n"
+    "  </AgentGroup>\n"
+    "  <ObstacleSet type=\"explicit\" class=\"1\">\n"
+    "    <Obstacle closed=\"1\">\n"
+    "      <Vertex p_x=\"-1\" p_y=\"-1\" /><Vertex p_x=\"1\" p_y=\"-1\" />\n"
+    "      <Vertex p_x=\"1\" p_y=\"1\" /><Vertex p_x=\"-1\" p_y=\"1\" />\n"
+    "    </Obstacle>\n"
+    "  </ObstacleSet>\n"
+    "</Experiment>\n";
+
+const char* BEHAVIOR_XML =
+    "<?xml version=\"1.0\"?>\n"
+    "<BFSM>\n"
+    "  <State name=\"Walk\" final=\"0\">\n"
+    "    <GoalSelector type=\"mirror\" mirror_x=\"1\" mirror_y=\"1\" />\n"
+    "    <VelComponent type=\"goal\" />\n"
+    "  </State>\n"
+    "  <State name=\"Stop\" final=\"1\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <Transition from=\"Walk\" to=\"Stop\">\n"
+    "    <Condition type=\"goal_reached\" distance=\"0.05\" />\n"
+    "  </Transition>\n"
+    "</BFSM>\n";
+
+void writeFile(const char* path, const char* text) { std::ofstream(path) << text; }
+
+// Determines what the failing trigger throws: a std::exception (true) or an int (false).
+bool throwStdException = true;
+
+// An event trigger whose evaluation fails.
+class FailingTrigger : public Menge::EventTrigger {
+ protected:
+  bool testCondition() {
+    if (throwStdException) throw std::runtime_error("The trigger failed");
+    throw 17;
+  }
+};
+
+// The factory of the failing trigger.
+class FailingTriggerFactory : public Menge::EventTriggerFactory {
+ public:
+  const char* name() const { return "capi_test_failing"; }
+  const char* description() const { return "A trigger whose evaluation throws."; }
+
+ protected:
+  Menge::EventTrigger* instance() const { return new FailingTrigger(); }
+};
+
+// The behavior with an event whose trigger fails every step.
+const char* FAILING_EVENT_XML =
+    "  <EventSystem>\n"
+    "    <Target name=\"walkers\" type=\"named_state_member\" is_member=\"1\" state=\"Walk\" />\n"
+    "    <Effect name=\"stop\" type=\"change_state\" state=\"Stop\" />\n"
+    "    <Event name=\"fail\">\n"
+    "      <Trigger name=\"failing\" type=\"capi_test_failing\" />\n"
+    "      <Response effect=\"stop\" target=\"walkers\" />\n"
+    "    </Event>\n"
+    "  </EventSystem>\n";
+
+// Writes the scene with the agents reordered in memory after every step.
+void writeReorderedScene(const char* path) {
+  std::string scene(SCENE_XML);
+  const std::string COMMON("<Common time_step=\"0.1\"");
+  scene.replace(scene.find(COMMON), COMMON.size(), COMMON + " reorder_interval=\"1\"");
+  writeFile(path, scene.c_str());
+}
+}  // namespace
+
+// The bulk accessors report exactly what the per-agent accessors report, for any range.
+TEST(CApiTest, bulkMatchesPerAgent) {
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  ASSERT_TRUE(InitSimulator("capiTestB.xml", "capiTestS.xml", "orca"));
+  for (int i = 0; i < 20; ++i) DoStep();
+
+  const size_t AGT_COUNT = AgentCount();
+  ASSERT_EQ(128u, AGT_COUNT);
+  const size_t START = 5;
+  const size_t COUNT = AGT_COUNT - START;
+  std::vector<float> pos(3 * COUNT), vel(3 * COUNT), pref(2 * COUNT), orient(2 * COUNT);
+  std::vector<float> radii(COUNT);
+  std::vector<size_t> states(COUNT);
+  std::vector<int> classes(COUNT);
+  // Ranges are clamped to the agents.
+  EXPECT_EQ(COUNT, GetAgentPositions(START, COUNT + 10, pos.data()));
+  EXPECT_EQ(COUNT, GetAgentVelocities(START, COUNT, vel.data()));
+  EXPECT_EQ(COUNT, GetAgentPrefVelocities(START, COUNT, pref.data()));
+  EXPECT_EQ(COUNT, GetAgentOrients(START, COUNT, orient.data()));
+  EXPECT_EQ(COUNT, GetAgentStates(START, COUNT, states.data()));
+  EXPECT_EQ(COUNT, GetAgentClasses(START, COUNT, classes.data()));
+  EXPECT_EQ(COUNT, GetAgentRadii(START, COUNT, radii.data()));
+  EXPECT_EQ(0u, GetAgentPositions(AGT_COUNT, 1, pos.data()));
+
+  for (size_t a = 0; a < COUNT; ++a) {
+    const size_t i = START + a;
+    float x, y, z;
+    size_t state;
+    ASSERT_TRUE(GetAgentPosition(i, &x, &y, &z));
+    EXPECT_EQ(x, pos[3 * a]);
+    EXPECT_EQ(y, pos[3 * a + 1]);
+    EXPECT_EQ(z, pos[3 * a + 2]);
+    ASSERT_TRUE(GetAgentVelocity(i, &x, &y, &z));
+    EXPECT_EQ(x, vel[3 * a]);
+    EXPECT_EQ(y, vel[3 * a + 1]);
+    EXPECT_EQ(z, vel[3 * a + 2]);
+    ASSERT_TRUE(GetAgentPrefVelocity(i, &x, &y));
+    EXPECT_EQ(x, pref[2 * a]);
+    EXPECT_EQ(y, pref[2 * a + 1]);
+    ASSERT_TRUE(GetAgentOrient(i, &x, &y));
+    EXPECT_EQ(x, orient[2 * a]);
+    EXPECT_EQ(y, orient[2 * a + 1]);
+    ASSERT_TRUE(GetAgentState(i, &state));
+    EXPECT_EQ(state, states[a]);
+    EXPECT_EQ(GetAgentClass(i), classes[a]);
+    EXPECT_EQ(GetAgentRadius(i), radii[a]);
+  }
+  EXPECT_EQ(2, classes.back());
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// The snapshot publishes every step's state, in place, in local and shared memory.
+TEST(CApiTest, snapshotMatchesBulk) {
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  ASSERT_TRUE(InitSimulator("capiTestB.xml", "capiTestS.xml", "orca"));
+  const size_t AGT_COUNT = AgentCount();
+  std::vector<float> pos(3 * AGT_COUNT), vel(3 * AGT_COUNT), orient(2 * AGT_COUNT);
+  std::vector<size_t> states(AGT_COUNT);
+
+  int steps = 0;
+  for (const char* name : {"", "/mengeCApiTest"}) {
+    ASSERT_TRUE(EnableAgentSnapshot(name));
+    const void* snapshot = GetAgentSnapshot();
+    ASSERT_NE(nullptr, snapshot);
+    const void* shared = name[0] != '\0' ? OpenAgentSnapshot(name) : snapshot;
+    ASSERT_NE(nullptr, shared);
+    ASSERT_EQ(AGT_COUNT, AgentSnapshotAgentCount(shared));
+
+    const unsigned long long FIRST = AgentSnapshotSequence(shared);
+    EXPECT_EQ(1u, FIRST);
+    for (int i = 0; i < 3; ++i, ++steps) DoStep();
+    const unsigned long long SEQUENCE = AgentSnapshotSequence(shared);
+    EXPECT_EQ(FIRST + 3, SEQUENCE);
+    // The first frame's buffer has been overwritten.
+    EXPECT_FALSE(AgentSnapshotIsCurrent(shared, FIRST));
+    EXPECT_EQ(nullptr, AgentSnapshotField(shared, FIRST, 0));
+    EXPECT_EQ(nullptr, AgentSnapshotField(shared, SEQUENCE, 8));
+
+    GetAgentPositions(0, AGT_COUNT, pos.data());
+    GetAgentVelocities(0, AGT_COUNT, vel.data());
+    GetAgentOrients(0, AGT_COUNT, orient.data());
+    GetAgentStates(0, AGT_COUNT, states.data());
+    const float* fields[7];
+    for (int f = 0; f < 7; ++f) {
+      fields[f] = static_cast<const float*>(AgentSnapshotField(shared, SEQUENCE, f));
+      ASSERT_NE(nullptr, fields[f]);
+    }
+    const unsigned int* stateIds =
+        static_cast<const unsigned int*>(AgentSnapshotField(shared, SEQUENCE, 7));
+    for (size_t i = 0; i < AGT_COUNT; ++i) {
+      EXPECT_EQ(pos[3 * i], fields[0][i]);
+      EXPECT_EQ(pos[3 * i + 2], fields[1][i]);
+      EXPECT_EQ(pos[3 * i + 1], fields[2][i]);
+      EXPECT_EQ(vel[3 * i], fields[3][i]);
+      EXPECT_EQ(vel[3 * i + 2], fields[4][i]);
+      EXPECT_EQ(orient[2 * i], fields[5][i]);
+      EXPECT_EQ(orient[2 * i + 1], fields[6][i]);
+      EXPECT_EQ(states[i], stateIds[i]);
+    }
+    EXPECT_TRUE(AgentSnapshotIsCurrent(shared, SEQUENCE));
+    EXPECT_NEAR(0.1f * steps, AgentSnapshotTime(shared, SEQUENCE), 1e-5f);
+
+    if (shared != snapshot) CloseAgentSnapshot(shared);
+  }
+  DisableAgentSnapshot();
+  EXPECT_EQ(nullptr, GetAgentSnapshot());
+  EXPECT_EQ(nullptr, OpenAgentSnapshot("/mengeCApiTest"));
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// Simulators created from handles are independent, even when they step concurrently.
+TEST(CApiTest, handlesStepConcurrently) {
+  const int STEPS = 30;
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  EXPECT_EQ(nullptr, MengeCreate("capiTestB.xml", "capiTestS.xml", "no_such_model"));
+
+  // The trajectories of a simulator stepped alone.
+  MengeHandle reference = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  ASSERT_NE(nullptr, reference);
+  const size_t AGT_COUNT = MengeAgentCount(reference);
+  for (int i = 0; i < STEPS; ++i) MengeStep(reference);
+  std::vector<float> expected(3 * AGT_COUNT), actual(3 * AGT_COUNT);
+  MengeGetAgentPositions(reference, 0, AGT_COUNT, expected.data());
+  MengeDestroy(reference);
+
+  MengeHandle fast = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  MengeHandle slow = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  ASSERT_NE(nullptr, fast);
+  ASSERT_NE(nullptr, slow);
+  MengeSetTimeStep(slow, 0.05f);
+  std::vector<std::thread> threads;
+  for (MengeHandle handle : {fast, slow}) {
+    threads.emplace_back([handle, STEPS]() {
+      for (int i = 0; i < STEPS; ++i) MengeStep(handle);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_NEAR(0.1f * STEPS, MengeGetTime(fast), 1e-4f);
+  EXPECT_NEAR(0.05f * STEPS, MengeGetTime(slow), 1e-4f);
+  ASSERT_EQ(AGT_COUNT, MengeGetAgentPositions(fast, 0, AGT_COUNT, actual.data()));
+  EXPECT_EQ(expected, actual);
+  MengeGetAgentPositions(slow, 0, AGT_COUNT, actual.data());
+  EXPECT_NE(expected, actual);
+  MengeDestroy(fast);
+  MengeDestroy(slow);
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// A failed asynchronous step is reported by its wait, whatever it throws; a synchronous step lets
+// the exception propagate.
+TEST(CApiTest, asyncStepReportsFailure) {
+  Menge::EventTriggerDB::initialize();
+  Menge::EventTriggerDB::addFactory(new FailingTriggerFactory());
+  std::string behavior(BEHAVIOR_XML);
+  behavior.insert(behavior.find("  <State name=\"Walk\""), FAILING_EVENT_XML);
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestFailB.xml", behavior.c_str());
+  MengeHandle handle = MengeCreate("capiTestFailB.xml", "capiTestS.xml", "orca");
+  ASSERT_NE(nullptr, handle);
+  EXPECT_EQ(nullptr, MengeGetStepError(handle));
+
+  throwStdException = true;
+  ASSERT_TRUE(MengeStepAsync(handle));
+  EXPECT_FALSE(MengeWaitStep(handle));
+  ASSERT_NE(nullptr, MengeGetStepError(handle));
+  EXPECT_EQ(std::string("The trigger failed"), MengeGetStepError(handle));
+
+  throwStdException = false;
+  ASSERT_TRUE(MengeStepAsync(handle));
+  EXPECT_FALSE(MengeWaitStep(handle));
+  ASSERT_NE(nullptr, MengeGetStepError(handle));
+  EXPECT_EQ(std::string("Unknown exception"), MengeGetStepError(handle));
+
+  throwStdException = true;
+  EXPECT_THROW(MengeStep(handle), std::runtime_error);
+  MengeDestroy(handle);
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestFailB.xml");
+}
+
+// Each handle keeps its own values of the parameters the models keep in statics.
+TEST(CApiTest, handlesKeepModelParameters) {
+  std::string scene(SCENE_XML);
+  const std::string COMMON("<Common time_step=\"0.1\"");
+  scene.replace(scene.find(COMMON), COMMON.size(), COMMON + " approximate_exp=\"1\"");
+  writeFile("capiTestApproxS.xml", scene.c_str());
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+
+  MengeHandle approximate = MengeCreate("capiTestB.xml", "capiTestApproxS.xml", "orca");
+  ASSERT_NE(nullptr, approximate);
+  EXPECT_TRUE(Menge::Agents::Kernels::getApproximateExp());
+  // The second simulator parses its parameters from the defaults, not the first one's values.
+  MengeHandle exact = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  ASSERT_NE(nullptr, exact);
+  EXPECT_FALSE(Menge::Agents::Kernels::getApproximateExp());
+
+  // Each step installs its simulator's values.
+  MengeStep(approximate);
+  EXPECT_TRUE(Menge::Agents::Kernels::getApproximateExp());
+  MengeStep(exact);
+  EXPECT_FALSE(Menge::Agents::Kernels::getApproximateExp());
+  MengeStep(approximate);
+  EXPECT_TRUE(Menge::Agents::Kernels::getApproximateExp());
+  MengeDestroy(approximate);
+  MengeDestroy(exact);
+  Menge::Agents::Kernels::setApproximateExp(false);
+
+  std::remove("capiTestApproxS.xml");
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// Asynchronous steps produce the same simulation as synchronous steps, and the last published frame
+// stays readable while they run.
+TEST(CApiTest, asyncStepMatchesSync) {
+  const int STEPS = 20;
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  MengeHandle sync = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  MengeHandle async = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  ASSERT_NE(nullptr, sync);
+  ASSERT_NE(nullptr, async);
+  ASSERT_TRUE(MengeEnableAgentSnapshot(async));
+  const void* snapshot = MengeGetAgentSnapshot(async);
+  const size_t AGT_COUNT = MengeAgentCount(async);
+
+  EXPECT_TRUE(MengeIsStepDone(async));
+  for (int i = 0; i < STEPS; ++i) {
+    MengeStep(sync);
+    const unsigned long long SEQUENCE = AgentSnapshotSequence(snapshot);
+    ASSERT_TRUE(MengeStepAsync(async));
+    // The frame published before the step can be read until the step is done.
+    const float* x = static_cast<const float*>(AgentSnapshotField(snapshot, SEQUENCE, 0));
+    ASSERT_NE(nullptr, x);
+    float sum = 0.f;
+    for (size_t a = 0; a < AGT_COUNT; ++a) sum += x[a];
+    EXPECT_TRUE(AgentSnapshotIsCurrent(snapshot, SEQUENCE)) << sum;
+    EXPECT_TRUE(MengeWaitStep(async));
+    EXPECT_TRUE(MengeIsStepDone(async));
+    EXPECT_EQ(SEQUENCE + 1, AgentSnapshotSequence(snapshot));
+  }
+  EXPECT_TRUE(MengeWaitStep(async));
+
+  std::vector<float> expected(3 * AGT_COUNT), actual(3 * AGT_COUNT);
+  MengeGetAgentPositions(sync, 0, AGT_COUNT, expected.data());
+  MengeGetAgentPositions(async, 0, AGT_COUNT, actual.data());
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(MengeGetTime(sync), MengeGetTime(async));
+  // Destroying a simulator waits for its step.
+  ASSERT_TRUE(MengeStepAsync(async));
+  MengeDestroy(async);
+  MengeDestroy(sync);
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// Reordering the agents in memory moves them to new indices but leaves their identifiers, and
+// therefore everything looked up by identifier, unchanged.
+TEST(CApiTest, reorderedAgentsKeepIdentifiers) {
+  writeReorderedScene("capiTestS.xml");
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  Menge::SimulatorDB simDB;
+  Menge::PluginEngine::CorePluginEngine engine(&simDB);
+  size_t agentCount;
+  float timeStep = 0.1f;
+  Menge::Agents::SimulatorInterface* sim = simDB.getDBEntry("orca")->getSimulator(
+      agentCount, timeStep, 0, 1e6f, "capiTestB.xml", "capiTestS.xml", "", "", false);
+  ASSERT_NE(nullptr, sim);
+  for (int i = 0; i < 5; ++i) sim->step();
+
+  size_t moved = 0;
+  for (size_t i = 0; i < sim->getNumAgents(); ++i) {
+    const Menge::Agents::BaseAgent* agent = sim->getAgent(i);
+    EXPECT_EQ(agent, sim->getAgentById(agent->_id));
+    if (agent->_id != i) ++moved;
+  }
+  EXPECT_GT(moved, 0u);
+  delete sim;
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// The accessors look agents up by identifier, so a simulator which reorders its agents reports the
+// same trajectories as one which doesn't.
+TEST(CApiTest, reorderedAgentsMatchUnordered) {
+  writeReorderedScene("capiTestSr.xml");
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  MengeHandle plain = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  MengeHandle reordered = MengeCreate("capiTestB.xml", "capiTestSr.xml", "orca");
+  ASSERT_NE(nullptr, plain);
+  ASSERT_NE(nullptr, reordered);
+  const size_t AGT_COUNT = MengeAgentCount(plain);
+  ASSERT_EQ(AGT_COUNT, MengeAgentCount(reordered));
+
+  std::vector<float> expected(3 * AGT_COUNT), actual(3 * AGT_COUNT);
+  std::vector<size_t> expectedStates(AGT_COUNT), states(AGT_COUNT);
+  for (int step = 0; step < 40; ++step) {
+    MengeStep(plain);
+    MengeStep(reordered);
+    MengeGetAgentPositions(plain, 0, AGT_COUNT, expected.data());
+    MengeGetAgentPositions(reordered, 0, AGT_COUNT, actual.data());
+    ASSERT_EQ(expected, actual) << "step " << step;
+    MengeGetAgentVelocities(plain, 0, AGT_COUNT, expected.data());
+    MengeGetAgentVelocities(reordered, 0, AGT_COUNT, actual.data());
+    ASSERT_EQ(expected, actual) << "step " << step;
+    MengeGetAgentStates(plain, 0, AGT_COUNT, expectedStates.data());
+    MengeGetAgentStates(reordered, 0, AGT_COUNT, states.data());
+    for (size_t i = 0; i < AGT_COUNT; ++i) {
+      // State identifiers differ between the simulators' state machines; their names don't.
+      const char* expectedName = MengeGetStateName(plain, expectedStates[i]);
+      ASSERT_NE(nullptr, expectedName) << "step " << step;
+      ASSERT_STREQ(expectedName, MengeGetStateName(reordered, states[i])) << "step " << step;
+    }
+  }
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    EXPECT_EQ(MengeGetAgentClass(plain, i), MengeGetAgentClass(reordered, i));
+    EXPECT_EQ(MengeGetAgentRadius(plain, i), MengeGetAgentRadius(reordered, i));
+  }
+  MengeDestroy(plain);
+  MengeDestroy(reordered);
+
+  std::remove("capiTestSr.xml");
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
+
+// A dynamic obstacle added through the API changes the agents' trajectories; it can be moved and
+// removed by its identifier, and isn't among the scene's obstacles.
+TEST(CApiTest, dynamicObstaclesAffectAgents) {
+  writeFile("capiTestS.xml", SCENE_XML);
+  writeFile("capiTestB.xml", BEHAVIOR_XML);
+  MengeHandle plain = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  MengeHandle walled = MengeCreate("capiTestB.xml", "capiTestS.xml", "orca");
+  ASSERT_NE(nullptr, plain);
+  ASSERT_NE(nullptr, walled);
+  const size_t OBST_COUNT = MengeObstacleCount(walled);
+
+  // A double-sided wall across the path of the first group.
+  const float WALL[] = {-6.f, -1.5f, -1.5f, -6.f};
+  size_t id;
+  ASSERT_TRUE(MengeAddDynamicObstacle(walled, WALL, 2, false, 1, &id));
+  EXPECT_EQ(OBST_COUNT, MengeObstacleCount(walled));
+  // A single vertex is not an obstacle.
+  size_t badID;
+  EXPECT_FALSE(MengeAddDynamicObstacle(walled, WALL, 1, false, 1, &badID));
+
+  const size_t AGT_COUNT = MengeAgentCount(plain);
+  std::vector<float> expected(3 * AGT_COUNT), actual(3 * AGT_COUNT);
+  for (int step = 0; step < 40; ++step) {
+    MengeStep(plain);
+    MengeStep(walled);
+  }
+  MengeGetAgentPositions(plain, 0, AGT_COUNT, expected.data());
+  MengeGetAgentPositions(walled, 0, AGT_COUNT, actual.data());
+  EXPECT_NE(expected, actual);
+
+  EXPECT_TRUE(MengeTranslateDynamicObstacle(walled, id, 0.5f, 0.5f));
+  EXPECT_FALSE(MengeTranslateDynamicObstacle(walled, id + 1, 0.5f, 0.5f));
+  EXPECT_TRUE(MengeRemoveDynamicObstacle(walled, id));
+  EXPECT_FALSE(MengeRemoveDynamicObstacle(walled, id));
+  EXPECT_FALSE(MengeTranslateDynamicObstacle(walled, id, 0.5f, 0.5f));
+  MengeStep(walled);
+  MengeDestroy(plain);
+  MengeDestroy(walled);
+
+  std::remove("capiTestS.xml");
+  std::remove("capiTestB.xml");
+}
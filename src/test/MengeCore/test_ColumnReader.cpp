@@ -0,0 +1,114 @@
+#include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/ColumnReader.h"
+#include "MengeCore/Agents/ColumnWriter.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/BFSM/VelocityComponents/VelCompConst.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using Menge::Agents::AgentInitializer;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::ColumnReader;
+using Menge::Agents::ColumnWriter;
+using Menge::Agents::SCBFilter;
+using Menge::BFSM::FSM;
+using Menge::BFSM::State;
+using Menge::BFSM::ZeroVelComponent;
+using Menge::Math::Vector2;
+
+// Each field's column holds exactly the recorded values, and the chunk statistics bound them.
+TEST(ColumnReaderTest, columnsMatchSimulation) {
+  const size_t AGT_COUNT = 50;
+  const size_t FRAME_COUNT = 10;
+  const size_t CHUNK_FRAMES = 4;
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> step(-1.f, 1.f);
+
+  ORCA::Simulator sim;
+  AgentInitializer init;
+  for (size_t i = 0; i < AGT_COUNT; ++i) sim.addAgent(Vector2(step(rng), step(rng)), &init);
+  FSM fsm(&sim);
+  State* state = new State("a");
+  state->setVelComponent(new ZeroVelComponent());
+  fsm.addNode(state);
+
+  // The expected x-positions, frame by frame.
+  std::vector<std::vector<float> > xs;
+  SCBFilter filter;
+  ASSERT_TRUE(filter.parseFields("position,state"));
+  ColumnWriter::setDefaultChunkFrames(CHUNK_FRAMES);
+  {
+    ColumnWriter writer("colTest", &sim, filter);
+    for (size_t f = 0; f < FRAME_COUNT; ++f) {
+      xs.push_back(std::vector<float>());
+      for (size_t i = 0; i < AGT_COUNT; ++i) {
+        BaseAgent* agt = sim.getAgentById(i);
+        agt->_pos += Vector2(step(rng) + f, step(rng));
+        xs.back().push_back(agt->_pos.x());
+      }
+      writer.writeFrame(&fsm);
+    }
+  }
+  ColumnWriter::setDefaultChunkFrames(256);
+
+  EXPECT_THROW(ColumnReader("colTest", SCBFilter::VELOCITY), Menge::Agents::SCBFileException);
+  ColumnReader positions("colTest", SCBFilter::POSITION);
+  ColumnReader states("colTest", SCBFilter::STATE);
+  ASSERT_EQ(FRAME_COUNT, positions.getFrameCount());
+  ASSERT_EQ(AGT_COUNT, positions.getAgentCount());
+  ASSERT_EQ(2u, positions.getComponentCount());
+  ASSERT_EQ(3u, positions.getChunkCount());
+  ASSERT_TRUE(positions.hasStatistics());
+  EXPECT_EQ(1u, states.getComponentCount());
+
+  for (size_t c = 0; c < positions.getChunkCount(); ++c) {
+    float lo = xs[positions.getChunkStart(c)][0];
+    float hi = lo;
+    for (size_t f = positions.getChunkStart(c); f < positions.getChunkEnd(c); ++f) {
+      const float* frame = positions.getFrame(f);
+      ASSERT_NE(nullptr, frame);
+      for (size_t i = 0; i < AGT_COUNT; ++i) {
+        EXPECT_EQ(xs[f][i], frame[i * 2]);
+        EXPECT_EQ(static_cast<float>(state->getID()), states.getFrame(f)[i]);
+        lo = std::min(lo, xs[f][i]);
+        hi = std::max(hi, xs[f][i]);
+      }
+    }
+    EXPECT_EQ(lo, positions.getChunkMin(c, 0));
+    EXPECT_EQ(hi, positions.getChunkMax(c, 0));
+    EXPECT_FALSE(positions.chunkOverlaps(c, 0, hi + 1.f, hi + 2.f));
+  }
+  EXPECT_EQ(nullptr, positions.getFrame(FRAME_COUNT));
+
+  // A file without its trailer (e.g., the simulation was killed) has its frames but no statistics.
+  {
+    std::ifstream in("colTest.position.col", std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream("colTest.partial.col", std::ios::binary).write(bytes.data(), bytes.size() - 4);
+  }
+  {
+    ColumnReader partial("colTest.partial.col");
+    ASSERT_FALSE(partial.hasStatistics());
+    ASSERT_EQ(FRAME_COUNT, partial.getFrameCount());
+    for (size_t c = 0; c < partial.getChunkCount(); ++c) {
+      EXPECT_TRUE(std::isinf(partial.getChunkMin(c, 0)) && partial.getChunkMin(c, 0) < 0.f);
+      EXPECT_TRUE(std::isinf(partial.getChunkMax(c, 1)) && partial.getChunkMax(c, 1) > 0.f);
+      EXPECT_TRUE(partial.chunkOverlaps(c, 0, 1e6f, 2e6f));
+    }
+    EXPECT_EQ(xs[FRAME_COUNT - 1][0], partial.getFrame(FRAME_COUNT - 1)[0]);
+  }
+
+  delete state;
+  std::remove("colTest.partial.col");
+  std::remove("colTest.position.col");
+  std::remove("colTest.state.col");
+}
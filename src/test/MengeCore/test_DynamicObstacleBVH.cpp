@@ -0,0 +1,109 @@
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/SpatialQueries/DynamicObstacleBVH.h"
+#include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <set>
+#include <vector>
+
+using Menge::Agents::BaseAgent;
+using Menge::Agents::DynamicObstacleBVH;
+using Menge::Agents::Obstacle;
+using Menge::Agents::ProximityQuery;
+using Menge::Agents::distSqPointLineSegment;
+using Menge::Math::Vector2;
+
+namespace {
+// Makes the obstacle the segment from p0 to p1.
+void setSegment(Obstacle& obstacle, const Vector2& p0, const Vector2& p1) {
+  obstacle._point = p0;
+  obstacle._length = abs(p1 - p0);
+  obstacle._unitDir = (p1 - p0) / obstacle._length;
+}
+
+// A query which collects every obstacle reported within a fixed range.
+class CollectQuery : public ProximityQuery {
+ public:
+  CollectQuery(const Vector2& point, float range) : _point(point), _rangeSq(range * range) {}
+  void startQuery() { _obstacles.clear(); }
+  Vector2 getQueryPoint() { return _point; }
+  float getMaxAgentRange() { return 0.f; }
+  float getMaxObstacleRange() { return _rangeSq; }
+  void filterAgent(const BaseAgent* agent, float distSq) {}
+  void filterObstacle(const Obstacle* obstacle, float distSq) { _obstacles.insert(obstacle); }
+
+  Vector2 _point;
+  float _rangeSq;
+  std::set<const Obstacle*> _obstacles;
+};
+}  // namespace
+
+// Across random insertions, removals and translations, the hierarchy's queries agree with testing
+// every obstacle in it. The queries share one traversal stack, which starts with stale contents.
+TEST(DynamicObstacleBVHTest, queriesMatchBruteForce) {
+  const size_t COUNT = 200;
+  std::mt19937 rng(23);
+  std::uniform_real_distribution<float> coord(-20.f, 20.f);
+  std::uniform_real_distribution<float> offset(-2.f, 2.f);
+  std::uniform_int_distribution<size_t> pick(0, COUNT - 1);
+
+  std::vector<Obstacle> obstacles(COUNT);
+  for (size_t i = 0; i < COUNT; ++i) {
+    const Vector2 p0(coord(rng), coord(rng));
+    setSegment(obstacles[i], p0, p0 + Vector2(offset(rng), offset(rng)));
+    obstacles[i]._doubleSided = i % 3 == 0;
+  }
+  DynamicObstacleBVH bvh;
+  // The reference: every obstacle in the hierarchy, each in a hierarchy of its own.
+  std::vector<bool> inTree(COUNT, false);
+  std::vector<DynamicObstacleBVH> single(COUNT);
+  for (size_t i = 0; i < COUNT; ++i) single[i].insert(&obstacles[i]);
+
+  std::vector<int> stack(50, 12345);
+  for (int op = 0; op < 300; ++op) {
+    const size_t i = pick(rng);
+    if (!inTree[i]) {
+      bvh.insert(&obstacles[i]);
+      inTree[i] = true;
+    } else if (op % 3 == 0) {
+      EXPECT_TRUE(bvh.remove(&obstacles[i]));
+      inTree[i] = false;
+    } else {
+      obstacles[i]._point += Vector2(offset(rng), offset(rng));
+      EXPECT_TRUE(bvh.refit(&obstacles[i]));
+      single[i].refit(&obstacles[i]);
+    }
+
+    for (int q = 0; q < 20; ++q) {
+      const Vector2 p(coord(rng), coord(rng));
+      CollectQuery query(p, 4.f);
+      bvh.obstacleQuery(&query, stack);
+      std::set<const Obstacle*> expected;
+      for (size_t j = 0; j < COUNT; ++j) {
+        const Obstacle& o = obstacles[j];
+        if (inTree[j] && (o._doubleSided || leftOf(o.getP0(), o.getP1(), p) < 0.f) &&
+            distSqPointLineSegment(o.getP0(), o.getP1(), p) < query._rangeSq) {
+          expected.insert(&o);
+        }
+      }
+      EXPECT_EQ(expected, query._obstacles);
+
+      const Vector2 p2 = p + Vector2(offset(rng), offset(rng)) * 3.f;
+      bool traversible = true;
+      bool visible = true;
+      for (size_t j = 0; j < COUNT; ++j) {
+        if (!inTree[j]) continue;
+        traversible = traversible && single[j].linkIsTraversible(p, p2, 0.3f, stack);
+        visible = visible && single[j].queryVisibility(p, p2, 0.3f, stack);
+      }
+      EXPECT_EQ(traversible, bvh.linkIsTraversible(p, p2, 0.3f, stack));
+      EXPECT_EQ(visible, bvh.queryVisibility(p, p2, 0.3f, stack));
+    }
+  }
+
+  // Obstacles which are not in the hierarchy can be neither removed nor refit.
+  bvh.remove(&obstacles[0]);
+  EXPECT_FALSE(bvh.remove(&obstacles[0]));
+  EXPECT_FALSE(bvh.refit(&obstacles[0]));
+}
@@ -0,0 +1,242 @@
+#include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/resources/Graph.h"
+#include "MengeCore/resources/GraphVertex.h"
+#include "MengeCore/resources/RoadMapPath.h"
+#include "gtest/gtest.h"
+#include "test/MengeCore/GraphTester.h"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <random>
+#include <vector>
+
+using Menge::GraphPtr;
+using Menge::GraphTester;
+using Menge::RoadMapPath;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::ProximityQuery;
+using Menge::Agents::SpatialQuery;
+using Menge::Math::Vector2;
+
+namespace {
+typedef GraphTester::Clearance Clearance;
+
+// Reports if the segment p0-p1 crosses the segment q0-q1.
+bool crosses(const Vector2& p0, const Vector2& p1, const Vector2& q0, const Vector2& q1) {
+  const float d0 = det(p1 - p0, q0 - p0);
+  const float d1 = det(p1 - p0, q1 - p0);
+  const float d2 = det(q1 - q0, p0 - q0);
+  const float d3 = det(q1 - q0, p1 - q0);
+  return d0 * d1 < 0.f && d2 * d3 < 0.f;
+}
+
+// A spatial query without agents whose links are blocked by two walls: a vertical wall blocks
+// traversal and a horizontal wall blocks visibility.
+class WallQuery : public SpatialQuery {
+ public:
+  WallQuery() : SpatialQuery(), _blockAll(false) {}
+  void setAgents(const std::vector<BaseAgent*>& agents) {}
+  void updateAgents() {}
+  void agentQuery(ProximityQuery* query) const {}
+  void processObstacles() {}
+  void obstacleQuery(ProximityQuery* query) const {}
+  bool linkIsTraversible(const Vector2& q1, const Vector2& q2, float radius) const {
+    return !_blockAll && !crosses(q1, q2, Vector2(0.f, -5.f), Vector2(0.f, 5.f));
+  }
+  bool queryVisibility(const Vector2& q1, const Vector2& q2, float radius) const {
+    return !_blockAll && !crosses(q1, q2, Vector2(-5.f, 0.f), Vector2(5.f, 0.f));
+  }
+  bool _blockAll;
+};
+
+// Finds the closest connectable vertex by testing every vertex, as the roadmap used to.
+size_t bruteForceClosest(const GraphPtr& graph, const Vector2& point, float radius,
+                         Clearance clearance) {
+  float bestDistSq = 1e30f;
+  size_t bestID = -1;
+  for (size_t i = 0; i < graph->getVertexCount(); ++i) {
+    const Vector2 p = graph->getVertex(i)->getPosition();
+    const float distSq = absSq(p - point);
+    if (distSq < bestDistSq &&
+        ((clearance == Clearance::Full &&
+          Menge::SPATIAL_QUERY->queryVisibility(point, p, radius)) ||
+         Menge::SPATIAL_QUERY->linkIsTraversible(point, p, radius))) {
+      bestDistSq = distSq;
+      bestID = i;
+    }
+  }
+  return bestID;
+}
+
+// Writes a roadmap of random vertices, each connected to its nearest neighbors.
+void writeRoadmap(const std::string& fileName, size_t count, size_t neighbors) {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> coord(-10.f, 10.f);
+  std::vector<Vector2> points;
+  for (size_t i = 0; i < count; ++i) points.push_back(Vector2(coord(rng), coord(rng)));
+  std::set<std::pair<size_t, size_t> > edges;
+  for (size_t i = 0; i < count; ++i) {
+    std::vector<std::pair<float, size_t> > byDistance;
+    for (size_t j = 0; j < count; ++j) {
+      if (j != i) byDistance.push_back(std::make_pair(absSq(points[j] - points[i]), j));
+    }
+    std::sort(byDistance.begin(), byDistance.end());
+    for (size_t n = 0; n < neighbors; ++n) {
+      const size_t j = byDistance[n].second;
+      edges.insert(std::make_pair(std::min(i, j), std::max(i, j)));
+    }
+  }
+  std::vector<size_t> degree(count, 0);
+  for (const auto& e : edges) ++degree[e.first], ++degree[e.second];
+
+  std::ofstream file(fileName.c_str());
+  file << count << "\n";
+  for (size_t i = 0; i < count; ++i) {
+    file << degree[i] << " " << points[i]._x << " " << points[i]._y << "\n";
+  }
+  file << edges.size() << "\n";
+  for (const auto& e : edges) file << e.first << " " << e.second << "\n";
+}
+
+// Reports if the two paths visit the same way points; two null paths are equal.
+void expectSamePath(const RoadMapPath* expected, const RoadMapPath* path) {
+  ASSERT_EQ(expected == 0x0, path == 0x0);
+  if (expected == 0x0) return;
+  ASSERT_EQ(expected->getWayPointCount(), path->getWayPointCount());
+  for (size_t i = 0; i < path->getWayPointCount(); ++i) {
+    EXPECT_EQ(expected->getWayPoint(i), path->getWayPoint(i));
+  }
+}
+}  // namespace
+
+// The grid search for the closest vertex agrees with testing every vertex, including ties between
+// coincident vertices and query points outside of the roadmap's bounds.
+TEST(GraphTest, closestVertexMatchesBruteForce) {
+  const int COUNT = 300;
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> coord(-10.f, 10.f);
+  std::vector<Vector2> points;
+  for (int i = 0; i < COUNT; ++i) points.push_back(Vector2(coord(rng), coord(rng)));
+  // Coincident vertices with different indices.
+  for (int i = 0; i < 20; ++i) points.push_back(points[i * 7]);
+  // A dense cluster, which puts many vertices in one cell.
+  for (int i = 0; i < 40; ++i) points.push_back(Vector2(3.f + coord(rng) * 0.01f, -2.f));
+  {
+    std::ofstream file("graphTest.txt");
+    file << points.size() << "\n";
+    for (const Vector2& p : points) file << "0 " << p._x << " " << p._y << "\n";
+    file << "0\n";
+  }
+  GraphPtr graph = Menge::loadGraph("graphTest.txt");
+
+  WallQuery* query = new WallQuery();
+  SpatialQuery* oldQuery = Menge::SPATIAL_QUERY;
+  Menge::SPATIAL_QUERY = query;
+  std::uniform_real_distribution<float> queryCoord(-15.f, 15.f);
+  for (int i = 0; i < 500; ++i) {
+    const Vector2 p = i < 40 ? points[i * 8] : Vector2(queryCoord(rng), queryCoord(rng));
+    for (Clearance clearance : {Clearance::Partial, Clearance::Full}) {
+      EXPECT_EQ(bruteForceClosest(graph, p, 0.2f, clearance),
+                GraphTester::getClosestVertex(graph, p, 0.2f, clearance))
+          << "at (" << p._x << ", " << p._y << ")";
+    }
+  }
+
+  // No connectable vertex.
+  query->_blockAll = true;
+  EXPECT_EQ(size_t(-1),
+            GraphTester::getClosestVertex(graph, Vector2(1.f, 1.f), 0.2f, Clearance::Full));
+
+  Menge::SPATIAL_QUERY = oldQuery;
+  query->destroy();
+}
+
+// The route cache keeps the most recently used routes and serves the same paths it computed.
+TEST(GraphTest, routeCacheEvictsLeastRecentlyUsedRoute) {
+  writeRoadmap("graphCacheTest.txt", 100, 4);
+  GraphPtr graph = Menge::loadGraph("graphCacheTest.txt");
+  graph->setRouteCacheSize(3);
+
+  std::vector<RoadMapPath*> computed;
+  for (size_t i = 0; i < 4; ++i) computed.push_back(GraphTester::getPath(graph, i, 50 + i));
+  EXPECT_EQ(3u, graph->getCachedRouteCount());
+  EXPECT_FALSE(graph->isRouteCached(0, 50));
+  for (size_t i = 1; i < 4; ++i) EXPECT_TRUE(graph->isRouteCached(i, 50 + i));
+
+  // Served from the cache; the oldest route becomes the most recently used.
+  RoadMapPath* cached = GraphTester::getPath(graph, 1, 51);
+  EXPECT_EQ(3u, graph->getCachedRouteCount());
+  expectSamePath(computed[1], cached);
+  delete cached;
+
+  // Recomputed, evicting the least recently used route.
+  RoadMapPath* recomputed = GraphTester::getPath(graph, 0, 50);
+  expectSamePath(computed[0], recomputed);
+  delete recomputed;
+  EXPECT_TRUE(graph->isRouteCached(0, 50));
+  EXPECT_TRUE(graph->isRouteCached(1, 51));
+  EXPECT_FALSE(graph->isRouteCached(2, 52));
+
+  // Shrinking the cache discards the least recently used routes.
+  graph->setRouteCacheSize(1);
+  EXPECT_EQ(1u, graph->getCachedRouteCount());
+  EXPECT_TRUE(graph->isRouteCached(0, 50));
+
+  graph->setRouteCacheSize(0);
+  EXPECT_EQ(0u, graph->getCachedRouteCount());
+  delete GraphTester::getPath(graph, 5, 55);
+  EXPECT_EQ(0u, graph->getCachedRouteCount());
+
+  for (RoadMapPath* path : computed) delete path;
+}
+
+// Paths read from shortest-path trees are the paths A* finds, and each goal has one tree.
+TEST(GraphTest, treeRoutesMatchDirectRoutes) {
+  writeRoadmap("graphTreeTest.txt", 150, 3);
+  GraphPtr graph = Menge::loadGraph("graphTreeTest.txt");
+  graph->setRouteCacheSize(0);
+
+  const size_t GOALS[] = {0, 17, 74, 149};
+  for (size_t start = 0; start < graph->getVertexCount(); start += 7) {
+    for (size_t goal : GOALS) {
+      graph->setUseShortestPathTrees(false);
+      RoadMapPath* direct = GraphTester::getPath(graph, start, goal);
+      graph->setUseShortestPathTrees(true);
+      RoadMapPath* fromTree = GraphTester::getPath(graph, start, goal);
+      expectSamePath(direct, fromTree);
+      delete direct;
+      delete fromTree;
+    }
+  }
+  EXPECT_EQ(sizeof(GOALS) / sizeof(GOALS[0]), graph->getShortestPathTreeCount());
+}
+
+// The number of shortest-path trees is bounded; the oldest tree is discarded and paths to its goal
+// are still found.
+TEST(GraphTest, treeLimitEvictsOldestTree) {
+  writeRoadmap("graphTreeLimitTest.txt", 150, 3);
+  GraphPtr graph = Menge::loadGraph("graphTreeLimitTest.txt");
+  graph->setRouteCacheSize(0);
+  graph->setShortestPathTreeLimit(2);
+
+  const size_t GOALS[] = {0, 17, 74, 0, 149};
+  for (size_t goal : GOALS) {
+    graph->setUseShortestPathTrees(false);
+    RoadMapPath* direct = GraphTester::getPath(graph, 31, goal);
+    graph->setUseShortestPathTrees(true);
+    RoadMapPath* fromTree = GraphTester::getPath(graph, 31, goal);
+    expectSamePath(direct, fromTree);
+    delete direct;
+    delete fromTree;
+    EXPECT_LE(graph->getShortestPathTreeCount(), 2u);
+  }
+  EXPECT_EQ(2u, graph->getShortestPathTreeCount());
+
+  graph->setShortestPathTreeLimit(0);
+  EXPECT_EQ(0u, graph->getShortestPathTreeCount());
+  RoadMapPath* untracked = GraphTester::getPath(graph, 31, 17);
+  EXPECT_EQ(0u, graph->getShortestPathTreeCount());
+  delete untracked;
+}
@@ -0,0 +1,80 @@
+#include "MengeCore/Agents/InteractionKernels.h"
+#include "MengeCore/Math/geomQuery.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Compares the batched interaction kernels against the scalar functions.
+
+namespace Kernels = Menge::Agents::Kernels;
+using Menge::Math::Vector2;
+
+namespace {
+// Random exponential arguments, including ones that underflow and overflow.
+std::vector<float> expArguments() {
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> arg(-80.f, 80.f);
+  std::vector<float> x(1003);
+  for (size_t i = 0; i < x.size(); ++i) x[i] = arg(rng);
+  x[0] = 0.f;
+  x[1] = -200.f;
+  x[2] = 200.f;
+  return x;
+}
+}  // namespace
+
+// By default, the exponential kernel produces the values of std::exp.
+TEST(InteractionKernelsTest, expIsExactByDefault) {
+  ASSERT_FALSE(Kernels::getApproximateExp());
+  const std::vector<float> x = expArguments();
+  std::vector<float> result(x.size());
+  Kernels::exp(&x[0], &result[0], x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    EXPECT_EQ(std::exp(x[i]), result[i]) << "exp(" << x[i] << ")";
+  }
+}
+
+// The approximate exponential is accurate to a few units in the last place over the range used by
+// the force models and saturates like std::exp outside of it.
+TEST(InteractionKernelsTest, approximateExpMatchesScalar) {
+  const std::vector<float> x = expArguments();
+  std::vector<float> result(x.size());
+  Kernels::setApproximateExp(true);
+  Kernels::exp(&x[0], &result[0], x.size());
+  Kernels::setApproximateExp(false);
+  for (size_t i = 0; i < x.size(); ++i) {
+    const float expected = std::exp(x[i]);
+    if (std::isinf(expected)) {
+      EXPECT_EQ(expected, result[i]);
+    } else {
+      EXPECT_NEAR(expected, result[i], 4e-7f * expected) << "exp(" << x[i] << ")";
+    }
+  }
+}
+
+// The time-to-collision kernel reproduces the scalar ray-circle test exactly, including misses,
+// divergent rays and rays starting inside the circle.
+TEST(InteractionKernelsTest, rayCircleTTCMatchesScalar) {
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> coord(-3.f, 3.f);
+  std::uniform_real_distribution<float> radius(0.2f, 1.f);
+  const size_t count = 1001;
+  std::vector<float> dirX(count), dirY(count), centerX(count), centerY(count), radii(count);
+  for (size_t i = 0; i < count; ++i) {
+    dirX[i] = coord(rng);
+    dirY[i] = coord(rng);
+    centerX[i] = coord(rng);
+    centerY[i] = coord(rng);
+    radii[i] = radius(rng);
+  }
+  std::vector<float> result(count);
+  Kernels::rayCircleTTC(&dirX[0], &dirY[0], &centerX[0], &centerY[0], &radii[0], &result[0],
+                        count);
+  for (size_t i = 0; i < count; ++i) {
+    const float expected = Menge::Math::rayCircleTTC(Vector2(dirX[i], dirY[i]),
+                                                     Vector2(centerX[i], centerY[i]), radii[i]);
+    EXPECT_EQ(expected, result[i]);
+  }
+}
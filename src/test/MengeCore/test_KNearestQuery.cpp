@@ -0,0 +1,48 @@
+#include "MengeCore/Agents/SpatialQueries/KNearestQuery.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+using Menge::Agents::BaseAgent;
+using Menge::Agents::KNearestQuery;
+
+namespace {
+// Stand-ins for agents; the query never dereferences them.
+const BaseAgent* fakeAgent(const int* id) { return reinterpret_cast<const BaseAgent*>(id); }
+}  // namespace
+
+// The query keeps the k nearest candidates, nearest first, and only limits the search range once it
+// has k results.
+TEST(KNearestQueryTest, keepsNearestInOrder) {
+  const int COUNT = 200;
+  std::vector<int> ids(COUNT);
+  std::vector<float> distances(COUNT);
+  for (int i = 0; i < COUNT; ++i) {
+    ids[i] = i;
+    // A permutation of 0, ..., COUNT - 1, so the distances are distinct.
+    distances[i] = static_cast<float>((i * 7919) % COUNT);
+  }
+
+  for (size_t k = 1; k < 12; ++k) {
+    KNearestQuery query;
+    query.setMaxAgentResults(k);
+    query.setQueryRangeSq(1000.f);
+    query.startQuery();
+    for (int i = 0; i < COUNT; ++i) {
+      if (i < static_cast<int>(k)) {
+        EXPECT_EQ(1000.f, query.getMaxAgentRange());
+      }
+      query.filterAgent(fakeAgent(&ids[i]), distances[i]);
+    }
+
+    std::vector<int> expected(ids);
+    std::sort(expected.begin(), expected.end(),
+            [&distances](int a, int b) { return distances[a] < distances[b]; });
+    ASSERT_EQ(k, query.agentResultCount());
+    for (size_t i = 0; i < k; ++i) {
+      EXPECT_EQ(fakeAgent(&ids[expected[i]]), query.getAgentResult(i).agent);
+    }
+    EXPECT_EQ(distances[expected[k - 1]], query.getMaxAgentRange());
+  }
+}
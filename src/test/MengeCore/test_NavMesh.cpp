@@ -0,0 +1,193 @@
+#include "MengeCore/resources/NavMesh.h"
+#include "MengeCore/resources/NavMeshEdge.h"
+#include "MengeCore/resources/NavMeshNode.h"
+#include "MengeCore/resources/NavMeshObstacle.h"
+#include "MengeCore/resources/PathPlanner.h"
+#include "MengeCore/resources/Resource.h"
+#include "MengeCore/resources/Route.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using Menge::NavMeshPtr;
+using Menge::PathPlanner;
+using Menge::PortalRoute;
+
+namespace {
+const int GRID_SIZE = 8;
+
+// Writes a GRID_SIZE x GRID_SIZE grid of unit squares whose nodes and edges are listed in a
+// shuffled order, so that reordering them for locality changes their indices. The node centers are
+// jittered to give every pair of nodes a unique shortest route. The file is written to the
+// temporary directory; its path is returned. A file can only be in use in one order at a time, so
+// tests which compare the orders write two copies.
+std::string writeShuffledGrid(const std::string& name) {
+  const int N = GRID_SIZE;
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+  auto vertex = [=](int x, int y) { return y * (N + 1) + x; };
+  auto cell = [=](int x, int y) { return y * N + x; };
+
+  // Node file ids, by cell.
+  std::vector<int> nodeID(N * N);
+  for (int i = 0; i < N * N; ++i) nodeID[i] = i;
+  std::shuffle(nodeID.begin(), nodeID.end(), rng);
+
+  // Edges as "v0 v1 n0 n1" with n0 on the right of v0 -> v1, indexed by cell in `cellEdges`.
+  std::vector<std::string> edges;
+  std::vector<std::vector<int>> cellEdges(N * N);
+  auto addEdge = [&](int v0, int v1, int c0, int c1) {
+    std::stringstream line;
+    line << v0 << " " << v1 << " " << nodeID[c0] << " " << nodeID[c1];
+    cellEdges[c0].push_back(static_cast<int>(edges.size()));
+    cellEdges[c1].push_back(static_cast<int>(edges.size()));
+    edges.push_back(line.str());
+  };
+  for (int y = 0; y < N; ++y) {
+    for (int x = 1; x < N; ++x) {
+      addEdge(vertex(x, y + 1), vertex(x, y), cell(x - 1, y), cell(x, y));
+    }
+  }
+  for (int y = 1; y < N; ++y) {
+    for (int x = 0; x < N; ++x) {
+      addEdge(vertex(x, y), vertex(x + 1, y), cell(x, y - 1), cell(x, y));
+    }
+  }
+  std::vector<int> edgeID(edges.size());
+  for (size_t i = 0; i < edges.size(); ++i) edgeID[i] = static_cast<int>(i);
+  std::shuffle(edgeID.begin(), edgeID.end(), rng);
+  std::vector<std::string> fileEdges(edges.size());
+  for (size_t i = 0; i < edges.size(); ++i) fileEdges[edgeID[i]] = edges[i];
+
+  // The boundary, clockwise, as one closed obstacle loop.
+  std::vector<int> loopVerts, loopCells;
+  auto addObstacle = [&](int v, int c) {
+    loopVerts.push_back(v);
+    loopCells.push_back(c);
+  };
+  for (int y = 0; y < N; ++y) addObstacle(vertex(0, y), cell(0, y));
+  for (int x = 0; x < N; ++x) addObstacle(vertex(x, N), cell(x, N - 1));
+  for (int y = N; y > 0; --y) addObstacle(vertex(N, y), cell(N - 1, y - 1));
+  for (int x = N; x > 0; --x) addObstacle(vertex(x, 0), cell(x - 1, 0));
+  const int obstCount = static_cast<int>(loopVerts.size());
+  std::vector<std::vector<int>> cellObstacles(N * N);
+  for (int o = 0; o < obstCount; ++o) cellObstacles[loopCells[o]].push_back(o);
+
+  std::stringstream nav;
+  nav << (N + 1) * (N + 1) << "\n";
+  for (int y = 0; y <= N; ++y) {
+    for (int x = 0; x <= N; ++x) nav << x << " " << y << "\n";
+  }
+  nav << fileEdges.size() << "\n";
+  for (const std::string& e : fileEdges) nav << e << "\n";
+  nav << obstCount << "\n";
+  for (int o = 0; o < obstCount; ++o) {
+    nav << loopVerts[o] << " " << loopVerts[(o + 1) % obstCount] << " ";
+    nav << nodeID[loopCells[o]] << " " << (o + 1) % obstCount << "\n";
+  }
+  std::vector<std::string> nodes(N * N);
+  for (int y = 0; y < N; ++y) {
+    for (int x = 0; x < N; ++x) {
+      const int c = cell(x, y);
+      std::stringstream node;
+      node << (x + 0.5f + jitter(rng)) << " " << (y + 0.5f + jitter(rng)) << "\n";
+      node << "4 " << vertex(x, y) << " " << vertex(x + 1, y) << " " << vertex(x + 1, y + 1) << " "
+           << vertex(x, y + 1) << "\n";
+      node << "0 0 0\n";
+      node << cellEdges[c].size();
+      for (int e : cellEdges[c]) node << " " << edgeID[e];
+      node << "\n" << cellObstacles[c].size();
+      for (int o : cellObstacles[c]) node << " " << o;
+      nodes[nodeID[c]] = node.str() + "\n";
+    }
+  }
+  nav << "grid\n" << N * N << "\n";
+  for (const std::string& n : nodes) nav << n;
+
+  const char* dir = std::getenv("TMPDIR");
+  const std::string fileName = std::string(dir != 0x0 ? dir : "/tmp") + "/" + name;
+  std::ofstream(fileName) << nav.str();
+  return fileName;
+}
+}  // namespace
+
+// A mesh reordered on load has elements which map back to the file ids.
+TEST(NavMeshTest, reorderedMeshMapsFileIDs) {
+  NavMeshPtr fileOrder = Menge::loadNavMesh(writeShuffledGrid("navMeshTestFileOrder.nav"));
+  const std::string fileName = writeShuffledGrid("navMeshTestReordered.nav");
+  NavMeshPtr reordered = Menge::loadNavMesh(fileName, true /*reorder*/);
+  ASSERT_FALSE(fileOrder->isReordered());
+  ASSERT_TRUE(reordered->isReordered());
+  EXPECT_TRUE(reordered == Menge::loadNavMesh(fileName, true /*reorder*/));
+
+  ASSERT_EQ(fileOrder->getNodeCount(), reordered->getNodeCount());
+  size_t moved = 0;
+  for (unsigned int id = 0; id < fileOrder->getNodeCount(); ++id) {
+    EXPECT_EQ(id, fileOrder->getNodeIndex(id));
+    const unsigned int i = reordered->getNodeIndex(id);
+    EXPECT_EQ(id, reordered->getNodeFileID(i));
+    EXPECT_EQ(fileOrder->getNode(id).getCenter(), reordered->getNode(i).getCenter());
+    if (i != id) ++moved;
+  }
+  EXPECT_GT(moved, 0u);
+
+  ASSERT_EQ(fileOrder->getEdgeCount(), reordered->getEdgeCount());
+  for (unsigned int id = 0; id < fileOrder->getEdgeCount(); ++id) {
+    const unsigned int i = reordered->getEdgeIndex(id);
+    EXPECT_EQ(id, reordered->getEdgeFileID(i));
+    EXPECT_EQ(fileOrder->getEdge(id).getP0(), reordered->getEdge(i).getP0());
+    EXPECT_EQ(fileOrder->getEdge(id).getP1(), reordered->getEdge(i).getP1());
+  }
+
+  ASSERT_EQ(fileOrder->getObstacleCount(), reordered->getObstacleCount());
+  for (unsigned int id = 0; id < fileOrder->getObstacleCount(); ++id) {
+    const unsigned int i = reordered->getObstacleIndex(id);
+    EXPECT_EQ(id, reordered->getObstacleFileID(i));
+    EXPECT_EQ(fileOrder->getObstacle(id).getP0(), reordered->getObstacle(i).getP0());
+    EXPECT_EQ(fileOrder->getObstacle(id).getP1(), reordered->getObstacle(i).getP1());
+  }
+}
+
+// Planning on the reordered mesh yields the same routes as planning on the mesh in file order.
+TEST(NavMeshTest, reorderedMeshPlansSameRoutes) {
+  NavMeshPtr fileOrder = Menge::loadNavMesh(writeShuffledGrid("navMeshTestFileOrder.nav"));
+  NavMeshPtr reordered =
+      Menge::loadNavMesh(writeShuffledGrid("navMeshTestReordered.nav"), true /*reorder*/);
+  PathPlanner filePlanner(fileOrder);
+  PathPlanner reorderedPlanner(reordered);
+
+  const unsigned int nodeCount = static_cast<unsigned int>(fileOrder->getNodeCount());
+  for (unsigned int start = 0; start < nodeCount; start += 5) {
+    for (unsigned int end = 0; end < nodeCount; end += 3) {
+      if (start == end) continue;
+      const PortalRoute* expected = filePlanner.getRoute(start, end, 0.2f);
+      const PortalRoute* route = reorderedPlanner.getRoute(reordered->getNodeIndex(start),
+                                                           reordered->getNodeIndex(end), 0.2f);
+      ASSERT_EQ(expected->getPortalCount(), route->getPortalCount());
+      EXPECT_FLOAT_EQ(expected->getLength(), route->getLength());
+      for (size_t p = 0; p < route->getPortalCount(); ++p) {
+        EXPECT_EQ(expected->getPortalNode(p), reordered->getNodeFileID(route->getPortalNode(p)));
+      }
+    }
+  }
+}
+
+// While a file is in use in one order, loading it in the other order fails, so the elements which
+// share the mesh can't disagree on its indices.
+TEST(NavMeshTest, mismatchedReorderingIsRejected) {
+  const std::string fileName = writeShuffledGrid("navMeshTestMismatch.nav");
+  {
+    NavMeshPtr fileOrder = Menge::loadNavMesh(fileName);
+    EXPECT_THROW(Menge::loadNavMesh(fileName, true /*reorder*/), Menge::ResourceException);
+    EXPECT_TRUE(fileOrder == Menge::loadNavMesh(fileName));
+  }
+  // Once the mesh is no longer referenced, the file can be loaded in the other order.
+  NavMeshPtr reordered = Menge::loadNavMesh(fileName, true /*reorder*/);
+  EXPECT_TRUE(reordered->isReordered());
+  EXPECT_THROW(Menge::loadNavMesh(fileName), Menge::ResourceException);
+}
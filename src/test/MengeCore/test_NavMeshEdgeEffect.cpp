@@ -0,0 +1,91 @@
+#include "MengeCore/Agents/Events/NavMeshEdgeEffect.h"
+#include "MengeCore/Agents/Events/NavMeshEdgeTarget.h"
+#include "MengeCore/resources/NavMesh.h"
+#include "MengeCore/resources/NavMeshEdge.h"
+#include "gtest/gtest.h"
+#include "thirdParty/tinyxml.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using Menge::EventEffect;
+using Menge::EventTarget;
+using Menge::NavMeshEdgeEffectFactory;
+using Menge::NavMeshEdgeTarget;
+using Menge::NavMeshEdgeTargetFactory;
+using Menge::NavMeshPtr;
+
+namespace {
+// Two 2x2 squares which share one edge.
+const char* PAIR_NAV =
+    "6\n"
+    "0 0\n2 0\n4 0\n0 2\n2 2\n4 2\n"
+    "1\n"
+    "4 1 0 1\n"
+    "6\n"
+    "0 3 0 1\n3 4 0 2\n4 5 1 3\n5 2 1 4\n2 1 1 5\n1 0 0 0\n"
+    "pair\n"
+    "2\n"
+    "1 1\n4 0 1 4 3\n0 0 0\n1 0\n3 0 1 5\n"
+    "3 1\n4 1 2 5 4\n0 0 0\n1 0\n3 2 3 4\n";
+
+// The directory the test writes its files to.
+std::string tempDir() {
+  const char* dir = std::getenv("TMPDIR");
+  return dir != 0x0 ? dir : "/tmp";
+}
+
+// Parses the xml element.
+TiXmlElement* parse(TiXmlDocument& doc, const std::string& xml) {
+  doc.Parse(xml.c_str());
+  return doc.RootElement();
+}
+}  // namespace
+
+// An effect which only sets the width leaves a blocked edge blocked, and an open edge open.
+TEST(NavMeshEdgeEffectTest, widthOnlyEffectKeepsBlockedState) {
+  const std::string dir = tempDir();
+  const std::string fileName = dir + "/navMeshEdgeEffectTest.nav";
+  std::ofstream(fileName.c_str()) << PAIR_NAV;
+
+  NavMeshEdgeTargetFactory targetFactory;
+  NavMeshEdgeEffectFactory effectFactory;
+  TiXmlDocument targetDoc, closeDoc, openDoc, widenDoc;
+  NavMeshEdgeTarget* target = dynamic_cast<NavMeshEdgeTarget*>(targetFactory.createInstance(
+      parse(targetDoc,
+            "<Target name=\"door\" type=\"nav_mesh_edge\" file_name=\"navMeshEdgeEffectTest.nav\" "
+            "edge=\"0\" />"),
+      dir));
+  ASSERT_NE(nullptr, target);
+  EventEffect* close = effectFactory.createInstance(
+      parse(closeDoc, "<Effect name=\"close\" type=\"nav_mesh_edge\" blocked=\"1\" />"), dir);
+  EventEffect* open = effectFactory.createInstance(
+      parse(openDoc, "<Effect name=\"open\" type=\"nav_mesh_edge\" blocked=\"0\" />"), dir);
+  EventEffect* widen = effectFactory.createInstance(
+      parse(widenDoc, "<Effect name=\"widen\" type=\"nav_mesh_edge\" width=\"1.5\" />"), dir);
+  ASSERT_NE(nullptr, close);
+  ASSERT_NE(nullptr, open);
+  ASSERT_NE(nullptr, widen);
+
+  NavMeshPtr navMesh = Menge::loadNavMesh(fileName);
+  const Menge::NavMeshEdge& edge = navMesh->getEdge(target->getEdgeID());
+
+  close->apply(target);
+  EXPECT_TRUE(edge.isBlocked());
+  widen->apply(target);
+  EXPECT_TRUE(edge.isBlocked());
+  EXPECT_FLOAT_EQ(1.5f, edge.getWidth());
+
+  open->apply(target);
+  EXPECT_FALSE(edge.isBlocked());
+  widen->apply(target);
+  EXPECT_FALSE(edge.isBlocked());
+
+  close->destroy();
+  open->destroy();
+  widen->destroy();
+  target->destroy();
+  std::remove(fileName.c_str());
+}
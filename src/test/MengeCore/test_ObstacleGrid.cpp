@@ -0,0 +1,203 @@
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleGrid.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+using Menge::Agents::BaseAgent;
+using Menge::Agents::Obstacle;
+using Menge::Agents::ObstacleGrid;
+using Menge::Agents::ObstacleKDTree;
+using Menge::Agents::ProximityQuery;
+using Menge::Agents::distSqPointLineSegment;
+using Menge::Math::Vector2;
+
+namespace {
+// Makes a free-standing obstacle of the segment from p0 to p1.
+Obstacle* makeSegment(const Vector2& p0, const Vector2& p1, bool doubleSided) {
+  Obstacle* obstacle = new Obstacle();
+  obstacle->_point = p0;
+  obstacle->_length = abs(p1 - p0);
+  obstacle->_unitDir = (p1 - p0) / obstacle->_length;
+  obstacle->_doubleSided = doubleSided;
+  obstacle->_isConvex = true;
+  return obstacle;
+}
+
+// A query which collects every obstacle reported within a fixed range.
+class CollectQuery : public ProximityQuery {
+ public:
+  CollectQuery(const Vector2& point, float range) : _point(point), _rangeSq(range * range) {}
+  void startQuery() { _obstacles.clear(); }
+  Vector2 getQueryPoint() { return _point; }
+  float getMaxAgentRange() { return 0.f; }
+  float getMaxObstacleRange() { return _rangeSq; }
+  void filterAgent(const BaseAgent* agent, float distSq) {}
+  void filterObstacle(const Obstacle* obstacle, float distSq) {
+    if (distSq < _rangeSq) _obstacles.insert(obstacle);
+  }
+
+  Vector2 _point;
+  float _rangeSq;
+  std::set<const Obstacle*> _obstacles;
+};
+
+// A query which keeps the nearest obstacle, shrinking its range to it as the query proceeds.
+class NearestQuery : public ProximityQuery {
+ public:
+  NearestQuery(const Vector2& point, float range) : _point(point), _rangeSq(range * range) {}
+  void startQuery() {}
+  Vector2 getQueryPoint() { return _point; }
+  float getMaxAgentRange() { return 0.f; }
+  float getMaxObstacleRange() { return _rangeSq; }
+  void filterAgent(const BaseAgent* agent, float distSq) {}
+  void filterObstacle(const Obstacle* obstacle, float distSq) {
+    if (distSq < _rangeSq) _rangeSq = distSq;
+  }
+
+  Vector2 _point;
+  float _rangeSq;
+};
+
+// The obstacles a query at the point should find: those within range whose right side faces the
+// point, and double-sided ones.
+std::set<const Obstacle*> inRange(const std::vector<Obstacle*>& obstacles, const Vector2& point,
+                                  float range) {
+  std::set<const Obstacle*> found;
+  for (const Obstacle* o : obstacles) {
+    if ((o->_doubleSided || leftOf(o->getP0(), o->getP1(), point) < 0.f) &&
+        distSqPointLineSegment(o->getP0(), o->getP1(), point) < range * range) {
+      found.insert(o);
+    }
+  }
+  return found;
+}
+}  // namespace
+
+// The grid reports the same obstacles as testing every obstacle and as the kd-tree. The scene
+// includes segments lying on cell borders and query points on borders and corners; the grid's
+// origin is the obstacles' minimum corner less the range, so with integer coordinates and a unit
+// cell the borders are the integer lines.
+TEST(ObstacleGridTest, queriesMatchBruteForceAndKDTree) {
+  const float RANGE = 2.f;
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> coord(0.f, 20.f);
+  std::uniform_real_distribution<float> offset(-3.f, 3.f);
+  std::uniform_int_distribution<int> lattice(0, 20);
+  std::vector<Obstacle*> obstacles;
+  // Every obstacle lies in [0, 20] x [0, 20]; this one spans it.
+  obstacles.push_back(makeSegment(Vector2(0.f, 0.f), Vector2(20.f, 20.f), true));
+  for (int i = 0; i < 60; ++i) {
+    const Vector2 p(coord(rng), coord(rng));
+    const Vector2 q(std::min(std::max(p._x + offset(rng), 0.f), 20.f),
+                    std::min(std::max(p._y + offset(rng), 0.f), 20.f));
+    obstacles.push_back(makeSegment(p, q, i % 4 == 0));
+  }
+  for (int i = 0; i < 30; ++i) {
+    // Axis-aligned segments on cell borders, facing either way.
+    const float a = static_cast<float>(lattice(rng));
+    const float b = static_cast<float>(lattice(rng));
+    const bool alongX = i % 3 == 0;
+    float length = static_cast<float>(lattice(rng) % 4 + 1);
+    // Alternate the direction (and so the facing), staying in the bounds.
+    const float start = alongX ? a : b;
+    if (!((i % 2 == 0 && start + length <= 20.f) || start - length < 0.f)) length = -length;
+    const Vector2 p0(a, b);
+    const Vector2 p1 = alongX ? Vector2(a + length, b) : Vector2(a, b + length);
+    obstacles.push_back(makeSegment(p0, p1, false));
+  }
+
+  ObstacleGrid grid;
+  grid.build(obstacles, RANGE, 1.f);
+  EXPECT_FLOAT_EQ(RANGE, grid.getRange());
+  EXPECT_EQ(25u * 25u, grid.getCellCount());
+  ObstacleKDTree tree;
+  tree.buildTree(obstacles);
+  // The tree splits obstacles; the grid is built on the same pieces, as the spatial query does.
+  const std::vector<Obstacle*>& pieces = tree.getObstacles();
+  grid.build(pieces, RANGE, 1.f);
+
+  std::uniform_real_distribution<float> queryCoord(-4.f, 24.f);
+  for (int q = 0; q < 3000; ++q) {
+    Vector2 p;
+    if (q % 3 == 0) {
+      // A cell corner.
+      p.set(static_cast<float>(lattice(rng)), static_cast<float>(lattice(rng)));
+    } else if (q % 3 == 1) {
+      // A point on a cell border.
+      p.set(static_cast<float>(lattice(rng)), queryCoord(rng));
+    } else {
+      p.set(queryCoord(rng), queryCoord(rng));
+    }
+    for (float range : {RANGE, 0.75f}) {
+      CollectQuery gridQuery(p, range);
+      EXPECT_TRUE(grid.obstacleQuery(&gridQuery));
+      CollectQuery treeQuery(p, range);
+      tree.obstacleQuery(&treeQuery);
+      EXPECT_EQ(inRange(pieces, p, range), gridQuery._obstacles)
+          << "at (" << p._x << ", " << p._y << ")";
+      EXPECT_EQ(treeQuery._obstacles, gridQuery._obstacles);
+    }
+
+    NearestQuery gridNearest(p, RANGE);
+    EXPECT_TRUE(grid.obstacleQuery(&gridNearest));
+    NearestQuery treeNearest(p, RANGE);
+    tree.obstacleQuery(&treeNearest);
+    EXPECT_EQ(treeNearest._rangeSq, gridNearest._rangeSq);
+  }
+
+  for (Obstacle* o : pieces) delete o;
+}
+
+// Only the obstacles whose right side faces the query point are reported, unless they are
+// double-sided; a point on an obstacle's line sees neither side.
+TEST(ObstacleGridTest, oneSidedObstaclesAreCulled) {
+  // A segment along the x-axis; its right side is y < 0.
+  std::vector<Obstacle*> obstacles(1, makeSegment(Vector2(0.f, 0.f), Vector2(4.f, 0.f), false));
+  ObstacleGrid grid;
+  grid.build(obstacles, 2.f, 1.f);
+
+  const Vector2 below(2.f, -1.f);
+  const Vector2 above(2.f, 1.f);
+  const Vector2 onLine(5.f, 0.f);
+  for (const Vector2& p : {below, above, onLine}) {
+    CollectQuery query(p, 2.f);
+    EXPECT_TRUE(grid.obstacleQuery(&query));
+    EXPECT_EQ(p._y < 0.f ? 1u : 0u, query._obstacles.size()) << "at (" << p._x << ", " << p._y
+                                                               << ")";
+  }
+
+  obstacles[0]->_doubleSided = true;
+  for (const Vector2& p : {below, above, onLine}) {
+    CollectQuery query(p, 2.f);
+    EXPECT_TRUE(grid.obstacleQuery(&query));
+    EXPECT_EQ(1u, query._obstacles.size());
+  }
+  delete obstacles[0];
+}
+
+// A query whose range exceeds the grid's is refused; a point outside the grid finds nothing.
+TEST(ObstacleGridTest, outOfRangeQueries) {
+  std::vector<Obstacle*> obstacles(1, makeSegment(Vector2(0.f, 0.f), Vector2(4.f, 0.f), true));
+  ObstacleGrid grid;
+  grid.build(obstacles, 2.f, 0.f);
+
+  CollectQuery wide(Vector2(2.f, 1.f), 2.5f);
+  EXPECT_FALSE(grid.obstacleQuery(&wide));
+  EXPECT_TRUE(wide._obstacles.empty());
+
+  CollectQuery outside(Vector2(20.f, 20.f), 2.f);
+  EXPECT_TRUE(grid.obstacleQuery(&outside));
+  EXPECT_TRUE(outside._obstacles.empty());
+
+  grid.clear();
+  EXPECT_EQ(0u, grid.getCellCount());
+  CollectQuery cleared(Vector2(2.f, 1.f), 1.f);
+  EXPECT_FALSE(grid.obstacleQuery(&cleared));
+  delete obstacles[0];
+}
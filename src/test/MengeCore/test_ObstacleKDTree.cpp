@@ -0,0 +1,197 @@
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+using Menge::Agents::BaseAgent;
+using Menge::Agents::Obstacle;
+using Menge::Agents::ObstacleKDTree;
+using Menge::Agents::ObstacleTreeNode;
+using Menge::Agents::ProximityQuery;
+using Menge::Agents::distSqPointLineSegment;
+using Menge::Math::Vector2;
+
+namespace {
+// Appends the polygon (or polyline, if it is open) through the given points to the obstacles.
+void addPolygon(const std::vector<Vector2>& points, bool closed,
+                std::vector<Obstacle*>& obstacles) {
+  const size_t FIRST = obstacles.size();
+  const size_t COUNT = closed ? points.size() : points.size() - 1;
+  for (size_t i = 0; i < COUNT; ++i) {
+    Obstacle* obstacle = new Obstacle();
+    const Vector2 next = points[(i + 1) % points.size()];
+    obstacle->_point = points[i];
+    obstacle->_length = abs(next - points[i]);
+    obstacle->_unitDir = (next - points[i]) / obstacle->_length;
+    obstacle->_id = obstacles.size();
+    obstacle->_doubleSided = !closed;
+    obstacle->_isConvex = true;
+    obstacles.push_back(obstacle);
+  }
+  // The last segment of a polyline has no next obstacle; its end is given by its length.
+  for (size_t i = 0; i < COUNT; ++i) {
+    if (!closed && i + 1 == COUNT) break;
+    Obstacle* obstacle = obstacles[FIRST + i];
+    obstacle->_nextObstacle = obstacles[FIRST + (i + 1) % COUNT];
+    obstacle->_nextObstacle->_prevObstacle = obstacle;
+  }
+}
+
+// A query which collects every obstacle reported within a fixed range.
+class CollectQuery : public ProximityQuery {
+ public:
+  CollectQuery(const Vector2& point, float range) : _point(point), _rangeSq(range * range) {}
+  void startQuery() { _obstacles.clear(); }
+  Vector2 getQueryPoint() { return _point; }
+  float getMaxAgentRange() { return 0.f; }
+  float getMaxObstacleRange() { return _rangeSq; }
+  void filterAgent(const BaseAgent* agent, float distSq) {}
+  void filterObstacle(const Obstacle* obstacle, float distSq) {
+    if (distSq < _rangeSq) _obstacles.insert(obstacle);
+  }
+
+  Vector2 _point;
+  float _rangeSq;
+  std::set<const Obstacle*> _obstacles;
+};
+
+// The tree, with the boolean queries evaluated recursively, as the tree of linked nodes did before
+// the nodes were flattened. The segments are read from the obstacles instead of the nodes.
+class RecursiveTree : public ObstacleKDTree {
+ public:
+  bool linkIsTraversibleRecursive(const Vector2& q1, const Vector2& q2, float radius) const {
+    return isClear(q1, q2, radius, _nodes.empty() ? ObstacleTreeNode::NO_CHILD : 0, true);
+  }
+
+  bool queryVisibilityRecursive(const Vector2& q1, const Vector2& q2, float radius) const {
+    return isClear(q1, q2, radius, _nodes.empty() ? ObstacleTreeNode::NO_CHILD : 0, false);
+  }
+
+ private:
+  // The two queries differ only in the test of an obstacle whose line the link crosses from its
+  // right to its left.
+  bool isClear(const Vector2& q1, const Vector2& q2, float radius, int nodeID,
+               bool traversal) const {
+    if (nodeID == ObstacleTreeNode::NO_CHILD) return true;
+    const ObstacleTreeNode& node = _nodes[nodeID];
+    const Vector2 p0 = node._obstacle->getP0();
+    const Vector2 p1 = node._obstacle->getP1();
+    const float radSq = radius * radius;
+    const float q1Left = leftOf(p0, p1, q1);
+    const float q2Left = leftOf(p0, p1, q2);
+    const float invLengthSq = 1.f / absSq(p1 - p0);
+    const bool farFromLine =
+        q1Left * q1Left * invLengthSq >= radSq && q2Left * q2Left * invLengthSq >= radSq;
+
+    if (q1Left >= 0.f && q2Left >= 0.f) {
+      return isClear(q1, q2, radius, node._left, traversal) &&
+             (farFromLine || isClear(q1, q2, radius, node._right, traversal));
+    } else if (q1Left <= 0.f && q2Left <= 0.f) {
+      return isClear(q1, q2, radius, node._right, traversal) &&
+             (farFromLine || isClear(q1, q2, radius, node._left, traversal));
+    } else if (q1Left >= 0.f && q2Left <= 0.f) {
+      return isClear(q1, q2, radius, node._left, traversal) &&
+             isClear(q1, q2, radius, node._right, traversal);
+    }
+    const float p0Left = leftOf(q1, q2, p0);
+    const float p1Left = leftOf(q1, q2, p1);
+    const float invQLengthSq = 1.f / absSq(q2 - q1);
+    const bool clearOfLink =
+        p0Left * p0Left * invQLengthSq > radSq && p1Left * p1Left * invQLengthSq > radSq;
+    const bool leaving = q1Left * q1Left * invLengthSq <= radSq &&
+                         q2Left * q2Left * invLengthSq >= radSq;
+    return p0Left * p1Left >= 0.f && (clearOfLink || (traversal && leaving)) &&
+           isClear(q1, q2, radius, node._left, traversal) &&
+           isClear(q1, q2, radius, node._right, traversal);
+  }
+};
+}  // namespace
+
+// The flattened tree's obstacle queries agree with testing every obstacle in it: they report the
+// obstacles in range whose visible side faces the point. The boxes overlap, so building the tree
+// splits obstacles.
+//
+// The boolean queries agree with the recursive traversal of the same tree. They prune a side of an
+// obstacle's line when the link stays at least the radius away from the line, so they may miss an
+// obstacle which would block the link on its own; every link they block is blocked by a single
+// obstacle.
+TEST(ObstacleKDTreeTest, queriesMatchBruteForce) {
+  std::mt19937 rng(31);
+  std::uniform_real_distribution<float> coord(-20.f, 20.f);
+  std::uniform_real_distribution<float> size(0.5f, 4.f);
+  std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+  std::vector<Obstacle*> obstacles;
+  for (int b = 0; b < 40; ++b) {
+    // A box, counter-clockwise, so its outside is on the right of each edge.
+    const Vector2 c(coord(rng), coord(rng));
+    const float w = size(rng);
+    const float h = size(rng);
+    const float a = angle(rng);
+    const Vector2 u(std::cos(a), std::sin(a));
+    const Vector2 v(-u._y, u._x);
+    std::vector<Vector2> corners = {c - u * w - v * h, c - u * w + v * h, c + u * w + v * h,
+                                    c + u * w - v * h};
+    addPolygon(corners, true, obstacles);
+  }
+  for (int w = 0; w < 10; ++w) {
+    // A double-sided wall of two segments.
+    const Vector2 p(coord(rng), coord(rng));
+    std::vector<Vector2> points = {p, p + Vector2(size(rng), size(rng)),
+                                   p + Vector2(size(rng), -size(rng)) * 2.f};
+    addPolygon(points, false, obstacles);
+  }
+
+  RecursiveTree tree;
+  tree.buildTree(obstacles);
+  const std::vector<Obstacle*>& pieces = tree.getObstacles();
+  EXPECT_GT(pieces.size(), obstacles.size());
+
+  // The reference: every obstacle (and every piece of a split obstacle) in a tree of its own.
+  std::vector<ObstacleKDTree> single(pieces.size());
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    single[i].buildTree(std::vector<Obstacle*>(1, pieces[i]));
+  }
+
+  std::uniform_real_distribution<float> offset(-6.f, 6.f);
+  int blocked = 0;
+  for (int q = 0; q < 2000; ++q) {
+    const Vector2 p(coord(rng), coord(rng));
+    CollectQuery query(p, 5.f);
+    tree.obstacleQuery(&query);
+    std::set<const Obstacle*> expected;
+    for (const Obstacle* o : pieces) {
+      if ((o->_doubleSided || leftOf(o->getP0(), o->getP1(), p) < 0.f) &&
+          distSqPointLineSegment(o->getP0(), o->getP1(), p) < query._rangeSq) {
+        expected.insert(o);
+      }
+    }
+    EXPECT_EQ(expected, query._obstacles);
+
+    const Vector2 p2 = p + Vector2(offset(rng), offset(rng));
+    const bool traversible = tree.linkIsTraversible(p, p2, 0.3f);
+    const bool visible = tree.queryVisibility(p, p2, 0.3f);
+    EXPECT_EQ(tree.linkIsTraversibleRecursive(p, p2, 0.3f), traversible);
+    EXPECT_EQ(tree.queryVisibilityRecursive(p, p2, 0.3f), visible);
+    if (!traversible) {
+      EXPECT_TRUE(std::any_of(single.begin(), single.end(), [&](const ObstacleKDTree& s) {
+        return !s.linkIsTraversible(p, p2, 0.3f);
+      }));
+    }
+    if (!visible) {
+      EXPECT_TRUE(std::any_of(single.begin(), single.end(), [&](const ObstacleKDTree& s) {
+        return !s.queryVisibility(p, p2, 0.3f);
+      }));
+    }
+    blocked += !traversible;
+  }
+  // The links are long enough that many are blocked.
+  EXPECT_GT(blocked, 200);
+
+  for (Obstacle* o : pieces) delete o;
+}
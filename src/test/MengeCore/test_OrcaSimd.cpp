@@ -0,0 +1,90 @@
+#include "MengeCore/Orca/ORCAAgent.h"
+#include "MengeCore/Orca/ORCASimd.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Compares the vectorized ORCA kernels against the scalar kernels on random configurations.
+
+using Menge::Math::Line;
+using Menge::Math::Vector2;
+
+namespace {
+
+const float TOLERANCE = 1e-5f;
+
+// Restores the default instruction set when a test ends.
+class OrcaSimdTest : public ::testing::Test {
+ protected:
+  void TearDown() override { ORCA::setSimdLevel(ORCA::getSupportedSimdLevel()); }
+
+  Vector2 randomVector(float range) {
+    std::uniform_real_distribution<float> coord(-range, range);
+    return Vector2(coord(_rng), coord(_rng));
+  }
+
+  std::mt19937 _rng;
+};
+
+void expectNear(const Vector2& expected, const Vector2& actual) {
+  EXPECT_NEAR(expected._x, actual._x, TOLERANCE * std::max(1.f, std::fabs(expected._x)));
+  EXPECT_NEAR(expected._y, actual._y, TOLERANCE * std::max(1.f, std::fabs(expected._y)));
+}
+}  // namespace
+
+// Every vector level reproduces the scalar agent lines, including the colliding neighbors and the
+// neighbors left over after the last full vector.
+TEST_F(OrcaSimdTest, agentLinesMatchScalar) {
+  std::uniform_real_distribution<float> radius(0.1f, 0.5f);
+  std::uniform_int_distribution<int> count(0, 37);
+  for (int trial = 0; trial < 200; ++trial) {
+    ORCA::NeighborBatch nbrs;
+    const int n = count(_rng);
+    for (int i = 0; i < n; ++i) {
+      nbrs.add(randomVector(3.f), randomVector(2.f), radius(_rng) + radius(_rng));
+    }
+    const Vector2 vel = randomVector(1.5f);
+
+    ORCA::setSimdLevel(ORCA::SIMD_SCALAR);
+    std::vector<Line> expected(nbrs.size());
+    if (n > 0) ORCA::computeAgentLines(nbrs, vel, 1.f / 2.5f, 10.f, &expected[0]);
+
+    for (int level = ORCA::SIMD_SSE; level <= ORCA::getSupportedSimdLevel(); ++level) {
+      ORCA::setSimdLevel(static_cast<ORCA::SimdLevel>(level));
+      std::vector<Line> actual(nbrs.size());
+      if (n > 0) ORCA::computeAgentLines(nbrs, vel, 1.f / 2.5f, 10.f, &actual[0]);
+      for (int i = 0; i < n; ++i) {
+        expectNear(expected[i]._point, actual[i]._point);
+        expectNear(expected[i]._direction, actual[i]._direction);
+      }
+    }
+  }
+}
+
+// The vectorized scans of the two-dimensional linear program find the same velocity and the same
+// failing constraint as the scalar scans.
+TEST_F(OrcaSimdTest, linearProgramMatchesScalar) {
+  std::uniform_int_distribution<int> count(1, 24);
+  std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+  for (int trial = 0; trial < 500; ++trial) {
+    std::vector<Line> lines(count(_rng));
+    for (size_t i = 0; i < lines.size(); ++i) {
+      const float theta = angle(_rng);
+      lines[i] = Line(randomVector(1.f), Vector2(std::cos(theta), std::sin(theta)));
+    }
+    const Vector2 optVel = randomVector(2.f);
+
+    ORCA::setSimdLevel(ORCA::SIMD_SCALAR);
+    Vector2 expected;
+    const size_t expectedFail = ORCA::linearProgram2(lines, 1.5f, optVel, false, expected);
+
+    ORCA::setSimdLevel(ORCA::getSupportedSimdLevel());
+    Vector2 actual;
+    const size_t actualFail = ORCA::linearProgram2(lines, 1.5f, optVel, false, actual);
+
+    EXPECT_EQ(expectedFail, actualFail);
+    expectNear(expected, actual);
+  }
+}
@@ -0,0 +1,146 @@
+#include "MengeCore/resources/NavMesh.h"
+#include "MengeCore/resources/NavMeshEdge.h"
+#include "MengeCore/resources/PathPlanner.h"
+#include "MengeCore/resources/Route.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using Menge::NavMeshPtr;
+using Menge::PathPlanner;
+using Menge::PendingRoute;
+using Menge::PortalRoute;
+
+namespace {
+// Four 2x2 squares around a shared vertex: 0 (bottom-left), 1 (bottom-right), 2 (top-right) and
+// 3 (top-left). Node 2 can be reached from node 0 through node 1 or through node 3.
+const char* RING_NAV =
+    "9\n"
+    "0 0\n2 0\n4 0\n0 2\n2 2\n4 2\n0 4\n2 4\n4 4\n"
+    "4\n"
+    "4 1 0 1\n4 5 1 2\n4 7 2 3\n4 3 3 0\n"
+    "8\n"
+    "0 3 0 1\n3 6 3 2\n6 7 3 3\n7 8 2 4\n8 5 2 5\n5 2 1 6\n2 1 1 7\n1 0 0 0\n"
+    "ring\n"
+    "4\n"
+    "1 1\n4 0 1 4 3\n0 0 0\n2 0 3\n2 0 7\n"
+    "3 1\n4 1 2 5 4\n0 0 0\n2 0 1\n2 5 6\n"
+    "3 3\n4 4 5 8 7\n0 0 0\n2 1 2\n2 3 4\n"
+    "1 3\n4 3 4 7 6\n0 0 0\n2 2 3\n2 1 2\n";
+
+// Writes the ring to a file in the temporary directory and loads it.
+NavMeshPtr loadRing() {
+  const char* dir = std::getenv("TMPDIR");
+  const std::string fileName = std::string(dir != 0x0 ? dir : "/tmp") + "/pathPlannerTest.nav";
+  std::ofstream(fileName.c_str()) << RING_NAV;
+  return Menge::loadNavMesh(fileName);
+}
+
+// The index of the first edge of the mesh which the route crosses.
+unsigned int crossedEdge(const NavMeshPtr& navMesh, const PortalRoute* route) {
+  unsigned int e = 0;
+  while (!route->crossesEdge(&navMesh->getEdge(e))) ++e;
+  return e;
+}
+
+// A planner whose route computations can be held in progress by the test.
+class GatedPlanner : public PathPlanner {
+ public:
+  explicit GatedPlanner(NavMeshPtr navMesh) : PathPlanner(navMesh) {}
+
+  // Registers a computation of the route as getRoute() does, without performing it.
+  PendingRoute* hold(unsigned int start, unsigned int end, float minWidth) {
+    std::lock_guard<std::mutex> lock(_pendingLock);
+    return beginComputation(Menge::makeRouteKey(start, end), minWidth);
+  }
+
+  // Computes the held route and publishes it to the waiting requests.
+  PortalRoute* finish(PendingRoute* pending, unsigned int start, unsigned int end, float minWidth) {
+    PortalRoute* route = computeRoute(start, end, minWidth);
+    finishComputation(Menge::makeRouteKey(start, end), pending, route);
+    return route;
+  }
+
+  // Waits up to a second for a request to wait on the pending computation; reports if one did.
+  bool awaitWaiter(PendingRoute* pending) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (std::chrono::steady_clock::now() < deadline) {
+      {
+        std::lock_guard<std::mutex> lock(_pendingLock);
+        if (pending->_waiting > 0) return true;
+      }
+      std::this_thread::yield();
+    }
+    return false;
+  }
+};
+}  // namespace
+
+// A request which is identical to a computation in progress waits for its result instead of
+// searching again.
+TEST(PathPlannerTest, identicalRequestsAreCoalesced) {
+  GatedPlanner planner(loadRing());
+  PendingRoute* pending = planner.hold(0, 2, 0.5f);
+
+  PortalRoute* waited = 0x0;
+  // Within the cache's width tolerance of the pending computation.
+  std::thread request([&]() { waited = planner.getRoute(0, 2, 0.49f); });
+  EXPECT_TRUE(planner.awaitWaiter(pending));
+  EXPECT_EQ(1u, planner.getCoalescedCount());
+
+  PortalRoute* computed = planner.finish(pending, 0, 2, 0.5f);
+  request.join();
+  EXPECT_EQ(computed, waited);
+
+  // A request too wide for the pending computation does not wait on it.
+  pending = planner.hold(0, 3, 0.5f);
+  EXPECT_NE(0x0, planner.getRoute(0, 3, 0.8f));
+  EXPECT_EQ(1u, planner.getCoalescedCount());
+  planner.finish(pending, 0, 3, 0.5f);
+}
+
+// Blocking an edge invalidates the routes which cross it and the next request goes around it.
+TEST(PathPlannerTest, blockedEdgeIsReplanned) {
+  NavMeshPtr navMesh = loadRing();
+  PathPlanner planner(navMesh);
+
+  PortalRoute* route = planner.getRoute(0, 2, 0.5f);
+  ASSERT_EQ(2u, route->getPortalCount());
+  const unsigned int edge = crossedEdge(navMesh, route);
+  route->acquire();  // As a PortalPath following the route would.
+
+  planner.setEdgeBlocked(edge, true);
+  EXPECT_FALSE(route->isValid());
+  EXPECT_EQ(1u, planner.getRetiredRouteCount());
+
+  PortalRoute* replanned = planner.getRoute(0, 2, 0.5f);
+  EXPECT_NE(route, replanned);
+  EXPECT_TRUE(replanned->isValid());
+  EXPECT_EQ(2u, replanned->getPortalCount());
+  EXPECT_FALSE(replanned->crossesEdge(&navMesh->getEdge(edge)));
+
+  // Once no path follows the retired route, it is reclaimed by the next change to the mesh.
+  route->release();
+  planner.setEdgeBlocked(edge, false);
+  EXPECT_EQ(0u, planner.getRetiredRouteCount());
+}
+
+// Repeatedly toggling an edge does not accumulate routes which no path follows.
+TEST(PathPlannerTest, toggledEdgeDoesNotAccumulateRoutes) {
+  NavMeshPtr navMesh = loadRing();
+  PathPlanner planner(navMesh);
+  const unsigned int edge = crossedEdge(navMesh, planner.getRoute(0, 2, 0.5f));
+
+  for (int i = 0; i < 100; ++i) {
+    planner.setEdgeBlocked(edge, i % 2 == 0);
+    planner.getRoute(0, 2, 0.5f);
+    planner.getRoute(2, 0, 0.5f);
+    planner.setEdgeWidth(edge, i % 2 == 0 ? 1.f : 2.f);
+  }
+  EXPECT_EQ(0u, planner.getRetiredRouteCount());
+}
@@ -0,0 +1,212 @@
+#include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/Elevations/ElevationFlat.h"
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/BFSM/VelocityComponents/VelCompConst.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "MengeVis/Runtime/ReplayContext.h"
+#include "MengeVis/Runtime/ReplaySystem.h"
+#include "MengeVis/SceneGraph/GLScene.h"
+#include "MengeVis/SceneGraph/System.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using Menge::Agents::AgentInitializer;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::FlatElevation;
+using Menge::Agents::SCBWriter;
+using Menge::Agents::SimulatorInterface;
+using Menge::BFSM::FSM;
+using Menge::BFSM::State;
+using Menge::BFSM::ZeroVelComponent;
+using Menge::Math::Vector2;
+using MengeVis::Runtime::ReplayContext;
+using MengeVis::Runtime::ReplaySystem;
+using MengeVis::SceneGraph::ContextResult;
+using MengeVis::SceneGraph::GLScene;
+using MengeVis::SceneGraph::SystemStopException;
+
+namespace {
+const size_t AGT_COUNT = 50;
+const size_t FRAME_COUNT = 11;
+
+// Records FRAME_COUNT frames of random walks into the file and returns the simulator, whose agents
+// are where the last frame put them. The positions of each frame are appended to `positions`.
+SimulatorInterface* record(const std::string& fileName, const char* version,
+                           std::vector<std::vector<Vector2> >& positions) {
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+  ORCA::Simulator* sim = new ORCA::Simulator();
+  sim->setElevationInstance(new FlatElevation());
+  AgentInitializer init;
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    sim->addAgent(Vector2(step(rng) * 50.f, step(rng) * 50.f), &init);
+  }
+  FSM fsm(sim);
+  State* state = new State("walk");
+  state->setVelComponent(new ZeroVelComponent());
+  fsm.addNode(state);
+  {
+    SCBWriter writer(fileName, version, sim);
+    for (size_t f = 0; f < FRAME_COUNT; ++f) {
+      positions.push_back(std::vector<Vector2>());
+      for (size_t i = 0; i < AGT_COUNT; ++i) {
+        BaseAgent* agt = sim->getAgentById(i);
+        agt->_pos += Vector2(step(rng), step(rng));
+        fsm.setCurrentState(agt, 0);
+        positions.back().push_back(agt->_pos);
+      }
+      writer.writeFrame(&fsm);
+    }
+  }
+  delete state;
+  return sim;
+}
+
+// Reports if the simulator's agents are at the recorded positions of the frame, to within the
+// precision of the file.
+void expectFrame(const SimulatorInterface* sim, const std::vector<Vector2>& positions) {
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    const BaseAgent* agt = sim->getAgentById(i);
+    EXPECT_NEAR(positions[i]._x, agt->_pos._x, 1e-5f);
+    EXPECT_NEAR(positions[i]._y, agt->_pos._y, 1e-5f);
+  }
+}
+
+// Sends a key press to the context.
+ContextResult pressKey(ReplayContext& context, SDL_Keycode key) {
+  SDL_Event e;
+  e.type = SDL_KEYDOWN;
+  e.key.keysym.sym = key;
+  e.key.keysym.mod = KMOD_NONE;
+  return context.handleKeyboard(e);
+}
+}  // namespace
+
+// The replayed frames are the recorded frames, and the cursor follows the viewer's time at the
+// recorded rate scaled by the playback speed.
+TEST(ReplaySystemTest, playsRecordedFramesAtRecordedRate) {
+  std::vector<std::vector<Vector2> > positions;
+  SimulatorInterface* sim = record("replayTest2_1.scb", "2.1", positions);
+  const float STEP = sim->getTimeStep();
+  ReplaySystem replay(sim, "replayTest2_1.scb");
+  ASSERT_EQ(FRAME_COUNT, replay.getFrameCount());
+  EXPECT_EQ(STEP, replay.getTimeStep());
+
+  // The visual agents start at the first frame.
+  GLScene scene;
+  replay.addAgentsToScene(&scene);
+  EXPECT_EQ(0u, replay.getFrame());
+  expectFrame(sim, positions[0]);
+
+  // A quarter of a time step doesn't reach the next frame.
+  EXPECT_FALSE(replay.updateScene(0.25f * STEP));
+  EXPECT_EQ(0u, replay.getFrame());
+  EXPECT_TRUE(replay.updateScene(1.25f * STEP));
+  EXPECT_EQ(1u, replay.getFrame());
+  expectFrame(sim, positions[1]);
+  EXPECT_TRUE(replay.updateScene(3.25f * STEP));
+  EXPECT_EQ(3u, replay.getFrame());
+  expectFrame(sim, positions[3]);
+
+  // Double speed advances two frames per time step; negative speed plays backwards.
+  replay.setSpeed(2.f);
+  EXPECT_TRUE(replay.updateScene(4.25f * STEP));
+  EXPECT_EQ(5u, replay.getFrame());
+  expectFrame(sim, positions[5]);
+  replay.setSpeed(-1.f);
+  EXPECT_TRUE(replay.updateScene(6.25f * STEP));
+  EXPECT_EQ(3u, replay.getFrame());
+  expectFrame(sim, positions[3]);
+
+  // Half speed takes two time steps per frame.
+  replay.setSpeed(0.5f);
+  EXPECT_FALSE(replay.updateScene(7.25f * STEP));
+  EXPECT_EQ(3u, replay.getFrame());
+  EXPECT_TRUE(replay.updateScene(8.25f * STEP));
+  EXPECT_EQ(4u, replay.getFrame());
+  expectFrame(sim, positions[4]);
+
+  // Seeking clamps to the file, and playing past either end stops the system.
+  EXPECT_TRUE(replay.seek(100));
+  EXPECT_EQ(FRAME_COUNT - 1, replay.getFrame());
+  expectFrame(sim, positions[FRAME_COUNT - 1]);
+  replay.setSpeed(1.f);
+  EXPECT_THROW(replay.updateScene(9.25f * STEP), SystemStopException);
+  EXPECT_TRUE(replay.seek(-5));
+  EXPECT_EQ(0u, replay.getFrame());
+  expectFrame(sim, positions[0]);
+  replay.setSpeed(-1.f);
+  EXPECT_THROW(replay.updateScene(10.25f * STEP), SystemStopException);
+  EXPECT_FALSE(replay.seek(0));
+
+  std::remove("replayTest2_1.scb");
+}
+
+// Files which don't record their time step are played at the simulator's time step.
+TEST(ReplaySystemTest, unrecordedTimeStepUsesSimulator) {
+  std::vector<std::vector<Vector2> > positions;
+  SimulatorInterface* sim = record("replayTest1_0.scb", "1.0", positions);
+  const float STEP = sim->getTimeStep();
+  ReplaySystem replay(sim, "replayTest1_0.scb");
+  EXPECT_EQ(0.f, replay.getTimeStep());
+  GLScene scene;
+  replay.addAgentsToScene(&scene);
+  EXPECT_TRUE(replay.updateScene(2.5f * STEP));
+  EXPECT_EQ(2u, replay.getFrame());
+  expectFrame(sim, positions[2]);
+
+  std::remove("replayTest1_0.scb");
+}
+
+// The context's keys seek through the file and change the playback speed.
+TEST(ReplayContextTest, keysControlPlayback) {
+  std::vector<std::vector<Vector2> > positions;
+  SimulatorInterface* sim = record("replayTest3_0.scb", "3.0", positions);
+  ReplaySystem replay(sim, "replayTest3_0.scb");
+  GLScene scene;
+  replay.addAgentsToScene(&scene);
+  ReplayContext context(&replay);
+
+  ContextResult result = pressKey(context, SDLK_PERIOD);
+  EXPECT_TRUE(result.isHandled());
+  EXPECT_TRUE(result.needsRedraw());
+  EXPECT_EQ(1u, replay.getFrame());
+  pressKey(context, SDLK_PERIOD);
+  EXPECT_EQ(2u, replay.getFrame());
+  pressKey(context, SDLK_COMMA);
+  EXPECT_EQ(1u, replay.getFrame());
+  pressKey(context, SDLK_END);
+  EXPECT_EQ(FRAME_COUNT - 1, replay.getFrame());
+  pressKey(context, SDLK_PERIOD);
+  EXPECT_EQ(FRAME_COUNT - 1, replay.getFrame());
+  pressKey(context, SDLK_HOME);
+  EXPECT_EQ(0u, replay.getFrame());
+  pressKey(context, SDLK_COMMA);
+  EXPECT_EQ(0u, replay.getFrame());
+
+  EXPECT_EQ(1.f, replay.getSpeed());
+  pressKey(context, SDLK_RIGHTBRACKET);
+  EXPECT_EQ(2.f, replay.getSpeed());
+  pressKey(context, SDLK_BACKSLASH);
+  EXPECT_EQ(-2.f, replay.getSpeed());
+  pressKey(context, SDLK_LEFTBRACKET);
+  pressKey(context, SDLK_LEFTBRACKET);
+  EXPECT_EQ(-0.5f, replay.getSpeed());
+  // The speed's magnitude is limited.
+  for (int i = 0; i < 20; ++i) pressKey(context, SDLK_LEFTBRACKET);
+  EXPECT_EQ(-1.f / 64.f, replay.getSpeed());
+  for (int i = 0; i < 20; ++i) pressKey(context, SDLK_RIGHTBRACKET);
+  EXPECT_EQ(-64.f, replay.getSpeed());
+
+  // Other keys are not handled without a child context.
+  result = pressKey(context, SDLK_a);
+  EXPECT_FALSE(result.isHandled());
+
+  std::remove("replayTest3_0.scb");
+}
@@ -0,0 +1,303 @@
+#include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/Elevations/ElevationFlat.h"
+#include "MengeCore/Agents/SCBReader.h"
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/BFSM/VelocityComponents/VelCompConst.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "MengeCore/Runtime/LZCodec.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using Menge::LZCodec;
+using Menge::Agents::AgentInitializer;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::FlatElevation;
+using Menge::Agents::SCBFilter;
+using Menge::Agents::SCBReader;
+using Menge::Agents::SCBWriter;
+using Menge::BFSM::FSM;
+using Menge::BFSM::State;
+using Menge::BFSM::ZeroVelComponent;
+using Menge::Math::Vector2;
+
+namespace {
+// Reads the whole file.
+std::vector<char> readFile(const std::string& fileName) {
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+}  // namespace
+
+// Blocks decompress to exactly the bytes that were compressed.
+TEST(LZCodecTest, roundTrip) {
+  std::mt19937 rng;
+  std::vector<std::vector<char> > blocks(4);
+  for (int i = 0; i < 100000; ++i) {
+    blocks[1].push_back(static_cast<char>(rng()));      // incompressible
+    blocks[2].push_back(static_cast<char>(i % 7 * 3));  // repetitive
+    blocks[3].push_back(static_cast<char>(rng() % 4 == 0 ? rng() % 3 : 0));
+  }
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    const std::vector<char>& block = blocks[b];
+    std::vector<char> compressed;
+    LZCodec::compress(block.data(), block.size(), compressed);
+    std::vector<char> restored(block.size() + 1);
+    ASSERT_TRUE(LZCodec::decompress(compressed.data(), compressed.size(), restored.data(),
+                                    block.size()));
+    restored.pop_back();
+    EXPECT_EQ(block, restored);
+    if (!block.empty()) {
+      EXPECT_FALSE(LZCodec::decompress(compressed.data(), compressed.size() / 2, restored.data(),
+                                       block.size()));
+    }
+  }
+}
+
+// The compressed version records the same trajectories as the uncompressed version, to within its
+// precision, and its frames can be read in any order.
+TEST(SCBReaderTest, compressedMatchesUncompressed) {
+  const size_t AGT_COUNT = 300;
+  const size_t FRAME_COUNT = 21;
+  const float PRECISION = 0.01f;
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+
+  ORCA::Simulator sim;
+  AgentInitializer init;
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    BaseAgent* agt = sim.addAgent(Vector2(step(rng) * 100.f, step(rng) * 100.f), &init);
+    agt->_class = i % 3;
+  }
+  FSM fsm(&sim);
+  std::vector<State*> states;
+  for (const char* name : {"a", "b"}) {
+    states.push_back(new State(name));
+    states.back()->setVelComponent(new ZeroVelComponent());
+    fsm.addNode(states.back());
+  }
+
+  SCBWriter::setDefaultPrecision(PRECISION);
+  SCBWriter::setDefaultChunkFrames(8);
+  {
+    SCBWriter raw("scbTest2_1.scb", "2.1", &sim);
+    SCBWriter compressed("scbTest3_0.scb", "3.0", &sim);
+    compressed.setAsync(2);
+    for (size_t f = 0; f < FRAME_COUNT; ++f) {
+      for (size_t i = 0; i < AGT_COUNT; ++i) {
+        BaseAgent* agt = sim.getAgentById(i);
+        agt->_pos += Vector2(step(rng), step(rng));
+        agt->_orient = Vector2(step(rng), step(rng)) + Vector2(0.f, 0.01f);
+        agt->_orient.normalize();
+        fsm.setCurrentState(agt, (i + f) % 3 == 0);
+      }
+      raw.writeFrame(&fsm);
+      compressed.writeFrame(&fsm);
+    }
+  }
+  SCBWriter::setDefaultPrecision(0.001f);
+  SCBWriter::setDefaultChunkFrames(64);
+
+  SCBReader raw("scbTest2_1.scb");
+  SCBReader compressed("scbTest3_0.scb");
+  ASSERT_EQ(FRAME_COUNT, raw.getFrameCount());
+  ASSERT_EQ(FRAME_COUNT, compressed.getFrameCount());
+  EXPECT_EQ(3, compressed.getMajorVersion());
+  EXPECT_EQ(AGT_COUNT, compressed.getAgentCount());
+  EXPECT_EQ(raw.getTimeStep(), compressed.getTimeStep());
+  EXPECT_EQ(raw.getAgentFloatCount(), compressed.getAgentFloatCount());
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    EXPECT_EQ(i % 3, compressed.getAgentClass(i));
+  }
+
+  const float ANGLE_TOLERANCE = 3.1416f / 65536.f + 1e-6f;
+  std::vector<float> expected, actual;
+  for (size_t f = FRAME_COUNT; f-- > 0;) {
+    ASSERT_TRUE(raw.readFrame(f, expected));
+    ASSERT_TRUE(compressed.readFrame(f, actual));
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t v = 0; v < expected.size(); v += 4) {
+      EXPECT_NEAR(expected[v], actual[v], 0.5f * PRECISION + 1e-4f);
+      EXPECT_NEAR(expected[v + 1], actual[v + 1], 0.5f * PRECISION + 1e-4f);
+      EXPECT_NEAR(expected[v + 2], actual[v + 2], ANGLE_TOLERANCE);
+      EXPECT_EQ(expected[v + 3], actual[v + 3]);
+    }
+  }
+  EXPECT_FALSE(compressed.readFrame(FRAME_COUNT, actual));
+
+  for (State* state : states) delete state;
+  std::remove("scbTest2_1.scb");
+  std::remove("scbTest3_0.scb");
+}
+
+// The filtered version records exactly the selected frames, agents and fields.
+TEST(SCBReaderTest, filteredMatchesUncompressed) {
+  const size_t AGT_COUNT = 300;
+  const size_t FRAME_COUNT = 21;
+  const size_t STRIDE = 2;
+  const float PRECISION = 0.01f;
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+
+  ORCA::Simulator sim;
+  AgentInitializer init;
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    BaseAgent* agt = sim.addAgent(Vector2(step(rng) * 50.f, step(rng) * 50.f), &init);
+    agt->_class = i % 3;
+  }
+  FSM fsm(&sim);
+  std::vector<State*> states;
+  for (const char* name : {"a", "b"}) {
+    states.push_back(new State(name));
+    states.back()->setVelComponent(new ZeroVelComponent());
+    fsm.addNode(states.back());
+  }
+
+  SCBFilter filter;
+  filter._frameStride = STRIDE;
+  ASSERT_TRUE(filter.parseClasses("0, 1"));
+  filter.parseStates("b");
+  ASSERT_TRUE(filter.parseRegion("-5,-5,5,5"));
+  ASSERT_TRUE(filter.parseFields("position,velocity"));
+  EXPECT_FALSE(filter.parseFields("position,speed"));
+  EXPECT_THROW(SCBWriter("scbTest2_2.scb", "3.0", &sim, filter),
+               Menge::Agents::SCBVersionException);
+
+  SCBWriter::setDefaultPrecision(PRECISION);
+  SCBWriter::setDefaultChunkFrames(4);
+  {
+    SCBWriter raw("scbTest2_2.scb", "2.2", &sim);
+    SCBWriter filtered("scbTest3_1.scb", "3.1", &sim, filter);
+    filtered.setAsync(2);
+    for (size_t f = 0; f < FRAME_COUNT; ++f) {
+      for (size_t i = 0; i < AGT_COUNT; ++i) {
+        BaseAgent* agt = sim.getAgentById(i);
+        agt->_vel.set(step(rng), step(rng));
+        agt->_pos += agt->_vel;
+        fsm.setCurrentState(agt, (i + f) % 2);
+      }
+      if (f % STRIDE == 0) raw.writeFrame(&fsm);
+      filtered.writeFrame(&fsm);
+    }
+  }
+  SCBWriter::setDefaultPrecision(0.001f);
+  SCBWriter::setDefaultChunkFrames(64);
+
+  SCBReader raw("scbTest2_2.scb");
+  SCBReader filtered("scbTest3_1.scb");
+  ASSERT_EQ(FRAME_COUNT / STRIDE + 1, raw.getFrameCount());
+  ASSERT_EQ(raw.getFrameCount(), filtered.getFrameCount());
+  EXPECT_EQ(1, filtered.getMinorVersion());
+  EXPECT_EQ(SCBFilter::POSITION | SCBFilter::VELOCITY, filtered.getFields());
+  EXPECT_EQ(4u, filtered.getAgentFloatCount());
+  EXPECT_FLOAT_EQ(raw.getTimeStep() * STRIDE, filtered.getTimeStep());
+
+  const float STATE_B = static_cast<float>(states[1]->getID());
+  std::vector<float> expected, actual;
+  std::vector<size_t> ids;
+  size_t recorded = 0;
+  for (size_t f = raw.getFrameCount(); f-- > 0;) {
+    ASSERT_TRUE(raw.readFrame(f, expected));
+    ASSERT_TRUE(filtered.readFrame(f, actual, &ids));
+    ASSERT_EQ(ids.size() * 4, actual.size());
+    size_t a = 0;
+    for (size_t i = 0; i < AGT_COUNT; ++i) {
+      const float* agt = &expected[i * 8];
+      if (i % 3 == 2 || agt[3] != STATE_B || std::fabs(agt[0]) > 5.f || std::fabs(agt[1]) > 5.f) {
+        continue;
+      }
+      ASSERT_LT(a, ids.size());
+      EXPECT_EQ(i, ids[a]);
+      EXPECT_NEAR(agt[0], actual[a * 4], 0.5f * PRECISION + 1e-4f);
+      EXPECT_NEAR(agt[1], actual[a * 4 + 1], 0.5f * PRECISION + 1e-4f);
+      EXPECT_NEAR(agt[6], actual[a * 4 + 2], 0.5f * PRECISION + 1e-4f);
+      EXPECT_NEAR(agt[7], actual[a * 4 + 3], 0.5f * PRECISION + 1e-4f);
+      ++a;
+    }
+    EXPECT_EQ(a, ids.size());
+    recorded += a;
+  }
+  EXPECT_GT(recorded, 0u);
+
+  for (State* state : states) delete state;
+  std::remove("scbTest2_2.scb");
+  std::remove("scbTest3_1.scb");
+}
+
+// Every version writes the same bytes whether frames are written synchronously, asynchronously or
+// switching between the two.
+TEST(SCBWriterTest, asyncMatchesSync) {
+  const size_t AGT_COUNT = 200;
+  const size_t FRAME_COUNT = 21;
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+
+  ORCA::Simulator sim;
+  // Version 2.4 records the elevation.
+  sim.setElevationInstance(new FlatElevation());
+  AgentInitializer init;
+  for (size_t i = 0; i < AGT_COUNT; ++i) {
+    BaseAgent* agt = sim.addAgent(Vector2(step(rng) * 50.f, step(rng) * 50.f), &init);
+    agt->_class = i % 3;
+  }
+  FSM fsm(&sim);
+  std::vector<State*> states;
+  for (const char* name : {"a", "b"}) {
+    states.push_back(new State(name));
+    states.back()->setVelComponent(new ZeroVelComponent());
+    fsm.addNode(states.back());
+  }
+  SCBFilter filter;
+  ASSERT_TRUE(filter.parseClasses("0, 2"));
+  ASSERT_TRUE(filter.parseFields("position,orientation"));
+
+  SCBWriter::setDefaultChunkFrames(4);
+  for (const char* version : {"1.0", "2.0", "2.1", "2.2", "2.3", "2.4", "3.0", "3.1"}) {
+    const SCBFilter& versionFilter = std::string(version) == "3.1" ? filter : SCBFilter();
+    const std::string syncName = std::string("scbSync") + version + ".scb";
+    const std::string asyncName = std::string("scbAsync") + version + ".scb";
+    const std::string mixedName = std::string("scbMixed") + version + ".scb";
+    {
+      SCBWriter sync(syncName, version, &sim, versionFilter);
+      SCBWriter async(asyncName, version, &sim, versionFilter);
+      SCBWriter mixed(mixedName, version, &sim, versionFilter);
+      sync.setAsync(0);
+      async.setAsync(3);
+      mixed.setAsync(0);
+      for (size_t f = 0; f < FRAME_COUNT; ++f) {
+        for (size_t i = 0; i < AGT_COUNT; ++i) {
+          BaseAgent* agt = sim.getAgentById(i);
+          agt->_vel.set(step(rng), step(rng));
+          agt->_velPref.setSpeed(1.f + step(rng));
+          agt->_pos += agt->_vel;
+          agt->_orient = Vector2(step(rng), step(rng)) + Vector2(0.f, 0.01f);
+          agt->_orient.normalize();
+          fsm.setCurrentState(agt, (i + f) % 2);
+        }
+        if (f == 5) mixed.setAsync(2);
+        if (f == 14) mixed.setAsync(0);
+        sync.writeFrame(&fsm);
+        async.writeFrame(&fsm);
+        mixed.writeFrame(&fsm);
+      }
+    }
+    const std::vector<char> expected = readFile(syncName);
+    EXPECT_FALSE(expected.empty()) << version;
+    EXPECT_TRUE(expected == readFile(asyncName)) << version;
+    EXPECT_TRUE(expected == readFile(mixedName)) << version;
+    std::remove(syncName.c_str());
+    std::remove(asyncName.c_str());
+    std::remove(mixedName.c_str());
+  }
+  SCBWriter::setDefaultChunkFrames(64);
+
+  for (State* state : states) delete state;
+}
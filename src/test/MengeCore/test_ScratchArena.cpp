@@ -0,0 +1,153 @@
+#include "MengeCore/Runtime/AllocationTracker.h"
+#include "MengeCore/Runtime/ScratchArena.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <set>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using Menge::AllocationTracker;
+using Menge::ScratchAllocator;
+using Menge::ScratchArena;
+
+namespace {
+typedef std::set<int, std::less<int>, ScratchAllocator<int> > ScratchSet;
+typedef std::list<double, ScratchAllocator<double> > ScratchList;
+
+// Fills scratch containers the way the simulation step does and reports a checksum.
+int useContainers(int count) {
+  ScratchArena::Scope scope;
+  ScratchSet set;
+  ScratchList list;
+  for (int i = 0; i < count; ++i) {
+    set.insert((i * 7919) % count);
+    list.push_back(i * 0.5);
+    if (i % 3 == 0) list.pop_front();
+  }
+  return static_cast<int>(set.size() + list.size());
+}
+
+// Performs one heap allocation, which the compiler cannot elide.
+void allocate() {
+  int* volatile value = new int(0);
+  delete value;
+}
+}  // namespace
+
+// Ends a test which counts allocations when counting is compiled out (all counts would be zero).
+// The test's target is built with the definition mengeCore is built with.
+#ifdef MENGE_TRACK_ALLOCATIONS
+#define SKIP_UNLESS_TRACKING() ASSERT_TRUE(AllocationTracker::isEnabled())
+#elif defined(GTEST_SKIP)
+#define SKIP_UNLESS_TRACKING() GTEST_SKIP() << "MENGE_TRACK_ALLOCATIONS is off"
+#else
+#define SKIP_UNLESS_TRACKING()                                               \
+  do {                                                                       \
+    std::cout << "[  SKIPPED ] MENGE_TRACK_ALLOCATIONS is off" << std::endl; \
+    return;                                                                  \
+  } while (0)
+#endif
+
+// Allocations are aligned and a scope returns its memory to the arena.
+TEST(ScratchArenaTest, scopeReleasesMemory) {
+  ScratchArena& arena = ScratchArena::local();
+  void* first;
+  {
+    ScratchArena::Scope scope;
+    first = arena.allocate(3);
+    void* second = arena.allocate(24);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(first) % 16);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second) % 16);
+    EXPECT_NE(first, second);
+    // Requests larger than a block still succeed.
+    EXPECT_NE(static_cast<void*>(0x0), arena.allocate(3 * ScratchArena::BLOCK_SIZE));
+  }
+  ScratchArena::Scope scope;
+  EXPECT_EQ(first, arena.allocate(8));
+}
+
+// Once the arena has grown, repeating a computation reuses its blocks.
+TEST(ScratchArenaTest, steadyStateReusesBlocks) {
+  const int count = 20000;
+  const int expected = useContainers(count);
+  const size_t capacity = ScratchArena::local().getCapacity();
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(expected, useContainers(count));
+  }
+  EXPECT_EQ(capacity, ScratchArena::local().getCapacity());
+}
+
+// Once the arena has grown, repeating a computation performs no heap allocations.
+TEST(ScratchArenaTest, steadyStateDoesNotAllocate) {
+  SKIP_UNLESS_TRACKING();
+  const int count = 20000;
+  const int expected = useContainers(count);
+  const size_t before = AllocationTracker::getCount();
+  // The count sees allocations.
+  allocate();
+  const size_t allocations = AllocationTracker::getCount();
+  EXPECT_EQ(before + 1, allocations);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(expected, useContainers(count));
+  }
+  EXPECT_EQ(allocations, AllocationTracker::getCount());
+}
+
+// Each thread counts its own allocations; another thread's allocations are not attributed to the
+// calling thread or its team.
+TEST(ScratchArenaTest, allocationsAreCountedPerThread) {
+  SKIP_UNLESS_TRACKING();
+  // Starting the thread allocates on this thread, so the other thread waits for the marks.
+  std::atomic<bool> start(false);
+  size_t otherCount = 0;
+  std::thread other([&]() {
+    while (!start) std::this_thread::yield();
+    const size_t mark = AllocationTracker::getThreadCount();
+    for (int i = 0; i < 100; ++i) allocate();
+    otherCount = AllocationTracker::getThreadCount() - mark;
+  });
+  const size_t threadCount = AllocationTracker::getThreadCount();
+  const size_t count = AllocationTracker::getCount();
+  start = true;
+  other.join();
+  allocate();
+  EXPECT_EQ(100u, otherCount);
+  EXPECT_EQ(threadCount + 1, AllocationTracker::getThreadCount());
+  EXPECT_EQ(count + 1, AllocationTracker::getCount());
+}
+
+// Allocations by the members of the calling thread's OpenMP team are included in its count, but not
+// in its thread count.
+TEST(ScratchArenaTest, allocationsOfTheTeamAreCounted) {
+  SKIP_UNLESS_TRACKING();
+#ifdef _OPENMP
+  // A team of several threads, even on a single core.
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(4);
+#endif
+  const size_t threadCount = AllocationTracker::getThreadCount();
+  const size_t count = AllocationTracker::getCount();
+  size_t members = 0;
+#pragma omp parallel reduction(+ : members)
+  {
+    allocate();
+    ++members;
+  }
+  // The team must still be the same when it is counted.
+  const size_t teamCount = AllocationTracker::getCount();
+  const size_t newThreadCount = AllocationTracker::getThreadCount();
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+  EXPECT_EQ(4u, members);
+#endif
+  EXPECT_EQ(count + members, teamCount);
+  EXPECT_EQ(threadCount + 1, newThreadCount);
+}
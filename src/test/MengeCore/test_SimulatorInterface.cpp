@@ -0,0 +1,44 @@
+#include "MengeCore/Agents/InteractionKernels.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "gtest/gtest.h"
+
+namespace Kernels = Menge::Agents::Kernels;
+
+namespace {
+// A static parameter of a model, as the models declare them.
+float testParameter = 1.f;
+
+// A model which registers its static parameter.
+class ParameterSimulator : public ORCA::Simulator {
+ public:
+  ParameterSimulator() : ORCA::Simulator() { addModelParameter(&testParameter); }
+};
+}  // namespace
+
+// Each simulator starts from the parameters' defaults and restores its own values of them.
+TEST(SimulatorInterfaceTest, modelParametersAreSavedPerSimulator) {
+  ParameterSimulator first;
+  testParameter = 2.f;
+  Kernels::setApproximateExp(true);
+  first.saveModelParameters();
+
+  // A new simulator doesn't inherit the values of the previous one.
+  ParameterSimulator second;
+  EXPECT_EQ(1.f, testParameter);
+  EXPECT_FALSE(Kernels::getApproximateExp());
+  testParameter = 3.f;
+  Kernels::setValidation(true);
+  second.saveModelParameters();
+
+  first.restoreModelParameters();
+  EXPECT_EQ(2.f, testParameter);
+  EXPECT_TRUE(Kernels::getApproximateExp());
+  EXPECT_FALSE(Kernels::getValidation());
+  second.restoreModelParameters();
+  EXPECT_EQ(3.f, testParameter);
+  EXPECT_FALSE(Kernels::getApproximateExp());
+  EXPECT_TRUE(Kernels::getValidation());
+
+  Kernels::setValidation(false);
+  testParameter = 1.f;
+}
@@ -0,0 +1,139 @@
+// Times the obstacle kd-tree of a scene: random visibility and traversability queries between
+// points in the scene's bounds, then simulation steps, which run every agent's obstacle query. The
+// queries are repeated against every obstacle on its own; a link the tree blocks must be blocked by
+// one of them.
+//
+// Usage: obstacleBenchmark behavior.xml scene.xml [model] [queries] [steps]
+
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/PluginEngine/CorePluginEngine.h"
+#include "MengeCore/Runtime/SimulatorDB.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Menge::Agents::Obstacle;
+using Menge::Agents::ObstacleKDTree;
+using Menge::Math::Vector2;
+
+namespace {
+// The seconds elapsed since the given time.
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "Usage: %s behavior.xml scene.xml [model] [queries] [steps]\n", argv[0]);
+    return 1;
+  }
+  const std::string model = argc > 3 ? argv[3] : "orca";
+  const int QUERIES = argc > 4 ? std::atoi(argv[4]) : 200000;
+  const int STEPS = argc > 5 ? std::atoi(argv[5]) : 200;
+
+  Menge::SimulatorDB simDB;
+  Menge::PluginEngine::CorePluginEngine engine(&simDB);
+  Menge::SimulatorDBEntry* simDBEntry = simDB.getDBEntry(model);
+  if (simDBEntry == 0x0) {
+    std::fprintf(stderr, "Unknown pedestrian model: %s.\n", model.c_str());
+    return 1;
+  }
+  size_t agentCount;
+  float timeStep = 0.1f;
+  size_t subSteps = 0;
+  Menge::Agents::SimulatorInterface* sim =
+      simDBEntry->getSimulator(agentCount, timeStep, subSteps, 1e6f, argv[1], argv[2], "", "",
+                               false);
+  if (sim == 0x0) {
+    std::fprintf(stderr, "Unable to initialize the simulator.\n");
+    return 1;
+  }
+  const ObstacleKDTree* tree = Menge::SPATIAL_QUERY->getObstacleKDTree();
+  if (tree == 0x0 || tree->getObstacles().empty()) {
+    std::fprintf(stderr, "The scene's obstacles are not in an obstacle kd-tree.\n");
+    delete sim;
+    return 1;
+  }
+
+  // The query links: random points in the obstacles' bounds, a few meters apart.
+  const std::vector<Obstacle*>& obstacles = tree->getObstacles();
+  Vector2 minPt = obstacles[0]->getP0();
+  Vector2 maxPt = minPt;
+  for (const Obstacle* o : obstacles) {
+    for (const Vector2& p : {o->getP0(), o->getP1()}) {
+      minPt.set(std::min(minPt._x, p._x), std::min(minPt._y, p._y));
+      maxPt.set(std::max(maxPt._x, p._x), std::max(maxPt._y, p._y));
+    }
+  }
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> xCoord(minPt._x, maxPt._x);
+  std::uniform_real_distribution<float> yCoord(minPt._y, maxPt._y);
+  std::uniform_real_distribution<float> offset(-3.f, 3.f);
+  std::vector<Vector2> q1(QUERIES);
+  std::vector<Vector2> q2(QUERIES);
+  for (int i = 0; i < QUERIES; ++i) {
+    q1[i].set(xCoord(rng), yCoord(rng));
+    q2[i] = q1[i] + Vector2(offset(rng), offset(rng));
+  }
+  const float RADIUS = 0.2f;
+
+  std::vector<char> visible(QUERIES);
+  std::vector<char> traversible(QUERIES);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) visible[i] = tree->queryVisibility(q1[i], q2[i], RADIUS);
+  const double visTime = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    traversible[i] = tree->linkIsTraversible(q1[i], q2[i], RADIUS);
+  }
+  const double linkTime = secondsSince(start);
+
+  // The reference: every obstacle in a tree of its own.
+  std::vector<ObstacleKDTree> single(obstacles.size());
+  for (size_t i = 0; i < obstacles.size(); ++i) {
+    single[i].buildTree(std::vector<Obstacle*>(1, obstacles[i]));
+  }
+  int result = 0;
+  size_t unjustified = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    bool singleVisible = true;
+    bool singleTraversible = true;
+    for (const ObstacleKDTree& s : single) {
+      singleVisible = singleVisible && s.queryVisibility(q1[i], q2[i], RADIUS);
+      singleTraversible = singleTraversible && s.linkIsTraversible(q1[i], q2[i], RADIUS);
+    }
+    unjustified += (!visible[i] && singleVisible) + (!traversible[i] && singleTraversible);
+  }
+  const double bruteTime = secondsSince(start);
+  if (unjustified > 0) {
+    std::fprintf(stderr, "The tree blocked %zu links which no obstacle blocks.\n", unjustified);
+    result = 1;
+  }
+
+  start = std::chrono::steady_clock::now();
+  int steps = 0;
+  for (; steps < STEPS; ++steps) {
+    if (!sim->step()) break;
+  }
+  const double stepTime = secondsSince(start);
+
+  std::printf("\n%zu obstacles, %zu agents, %d queries, %d steps\n", obstacles.size(),
+              sim->getNumAgents(), QUERIES, steps);
+  std::printf("  visibility:         %.3f s\n", visTime);
+  std::printf("  traversal:          %.3f s\n", linkTime);
+  std::printf("  both, per obstacle: %.3f s\n", bruteTime);
+  std::printf("  steps:              %.3f s\n", stepTime);
+  delete sim;
+  return result;
+}
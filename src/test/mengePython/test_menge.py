@@ -0,0 +1,199 @@
+# Smoke test of the `menge` Python module: creating and stepping simulators, the agent arrays,
+# asynchronous steps and simulators stepped on Python threads.
+#
+# Usage: python3 test_menge.py (with `menge` on PYTHONPATH)
+
+import os
+import shutil
+import tempfile
+import threading
+import unittest
+
+import numpy
+
+import menge
+
+# A small scene without random values, so every simulator of it takes the same steps: two classes
+# of agents in a grid, walking to their mirrored positions around a box.
+SCENE_XML = """<?xml version="1.0"?>
+<Experiment version="2.0">
+  <SpatialQuery type="kd-tree" test_visibility="false" />
+  <Common time_step="0.1" />
+  <AgentProfile name="group1">
+    <Common max_angle_vel="360" max_neighbors="10" obstacleSet="1" neighbor_dist="5" r="0.2"
+            pref_speed="1.34" max_speed="2" max_accel="5" />
+    <ORCA tau="3.0" tauObst="0.15" />
+  </AgentProfile>
+  <AgentProfile name="group2" inherits="group1">
+    <Common class="2" r="0.3" />
+  </AgentProfile>
+  <AgentGroup>
+    <ProfileSelector type="const" name="group1" />
+    <StateSelector type="const" name="Walk" />
+    <Generator type="rect_grid" anchor_x="-7" anchor_y="-7" offset_x="-1" offset_y="-1"
+               count_x="8" count_y="8" />
+  </AgentGroup>
+  <AgentGroup>
+    <ProfileSelector type="const" name="group2" />
+    <StateSelector type="const" name="Walk" />
+    <Generator type="rect_grid" anchor_x="7" anchor_y="-7" offset_x="1" offset_y="-1"
+               count_x="8" count_y="8" />
+  </AgentGroup>
+  <ObstacleSet type="explicit" class="1">
+    <Obstacle closed="1">
+      <Vertex p_x="-1" p_y="-1" /><Vertex p_x="1" p_y="-1" />
+      <Vertex p_x="1" p_y="1" /><Vertex p_x="-1" p_y="1" />
+    </Obstacle>
+  </ObstacleSet>
+</Experiment>
+"""
+
+BEHAVIOR_XML = """<?xml version="1.0"?>
+<BFSM>
+  <State name="Walk" final="0">
+    <GoalSelector type="mirror" mirror_x="1" mirror_y="1" />
+    <VelComponent type="goal" />
+  </State>
+  <State name="Stop" final="1">
+    <GoalSelector type="identity" />
+    <VelComponent type="goal" />
+  </State>
+  <Transition from="Walk" to="Stop">
+    <Condition type="goal_reached" distance="0.05" />
+  </Transition>
+</BFSM>
+"""
+
+SCENE_DIR = None
+
+
+def make_simulator():
+    return menge.Simulator(os.path.join(SCENE_DIR, 'behavior.xml'),
+                           os.path.join(SCENE_DIR, 'scene.xml'), 'orca')
+
+
+def run(sim, steps):
+    for _ in range(steps):
+        if not sim.step():
+            break
+    return sim.positions
+
+
+class SimulatorTest(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        global SCENE_DIR
+        SCENE_DIR = tempfile.mkdtemp()
+        for name, text in [('scene.xml', SCENE_XML), ('behavior.xml', BEHAVIOR_XML)]:
+            with open(os.path.join(SCENE_DIR, name), 'w') as f:
+                f.write(text)
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(SCENE_DIR)
+
+    def test_create(self):
+        sim = make_simulator()
+        self.assertGreater(sim.agent_count, 0)
+        self.assertGreater(sim.state_count, 0)
+        self.assertEqual(0.0, sim.time)
+        self.assertEqual((sim.agent_count,), sim.radii.shape)
+        self.assertEqual(numpy.float32, sim.radii.dtype)
+        self.assertEqual((sim.agent_count,), sim.classes.shape)
+        self.assertEqual(numpy.int32, sim.classes.dtype)
+        with self.assertRaises(RuntimeError):
+            menge.Simulator('missingB.xml', 'missingS.xml')
+
+    def test_step(self):
+        sim = make_simulator()
+        self.assertTrue(sim.step())
+        self.assertGreater(sim.time, 0.0)
+        time = sim.time
+        sim.set_time_step(0.05)
+        sim.step()
+        self.assertAlmostEqual(time + 0.05, sim.time, places=5)
+        self.assertTrue(sim.state_name(int(sim.states[0])))
+        with self.assertRaises(IndexError):
+            sim.state_name(sim.state_count)
+
+    def test_arrays(self):
+        sim = make_simulator()
+        sim.step()
+        count = sim.agent_count
+        names = ['positions', 'elevations', 'velocities', 'orientations', 'states']
+        for name, shape, dtype in zip(names, [(count, 2), (count,), (count, 2), (count, 2),
+                                              (count,)],
+                                      [numpy.float32] * 4 + [numpy.uint32]):
+            array = getattr(sim, name)
+            self.assertEqual(shape, array.shape, name)
+            self.assertEqual(dtype, array.dtype, name)
+            # A read-only view of the snapshot, which keeps the simulator alive.
+            self.assertFalse(array.flags.writeable, name)
+            self.assertIs(sim, array.base, name)
+            with self.assertRaises(ValueError):
+                array[0] = 0
+        self.assertEqual((count, 2), sim.pref_velocities().shape)
+        points, next_obstacle = sim.obstacles()
+        self.assertEqual((len(next_obstacle), 2, 2), points.shape)
+
+        # Until the next step, a view holds the same frame as a copy.
+        views = sim.agent_arrays()
+        copies = sim.agent_arrays(copy=True)
+        self.assertEqual(set(names), set(views))
+        self.assertEqual(set(names), set(copies))
+        for name in names:
+            self.assertIs(sim, views[name].base, name)
+            self.assertIsNone(copies[name].base, name)
+            numpy.testing.assert_array_equal(copies[name], views[name])
+            numpy.testing.assert_array_equal(copies[name], getattr(sim, name))
+
+        # A copy keeps its frame; the properties view the new one.
+        kept = copies['positions'].copy()
+        for _ in range(4):
+            sim.step()
+        numpy.testing.assert_array_equal(kept, copies['positions'])
+        self.assertFalse(numpy.array_equal(copies['positions'], sim.positions))
+
+        # A view outlives the reference to its simulator.
+        positions = make_simulator().positions
+        self.assertEqual((count, 2), positions.shape)
+        self.assertTrue(numpy.isfinite(positions).all())
+
+    def test_async_step(self):
+        sync = make_simulator()
+        run(sync, 5)
+        sim = make_simulator()
+        for _ in range(5):
+            before = sim.positions
+            self.assertTrue(sim.step_async())
+            # The arrays can be read while the step runs; they hold the previous frame, unless the
+            # step has already published its own.
+            during = sim.positions
+            self.assertTrue(sim.wait_step())
+            self.assertTrue(sim.is_step_done())
+            self.assertTrue(numpy.array_equal(before, during) or
+                            numpy.array_equal(sim.positions, during))
+        self.assertEqual(sync.time, sim.time)
+        numpy.testing.assert_array_equal(sync.positions, sim.positions)
+
+    def test_threads(self):
+        steps = 20
+        expected = run(make_simulator(), steps)
+        sims = [make_simulator() for _ in range(4)]
+        results = [None] * len(sims)
+
+        def step(i):
+            results[i] = run(sims[i], steps)
+
+        threads = [threading.Thread(target=step, args=(i,)) for i in range(len(sims))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for positions in results:
+            numpy.testing.assert_array_equal(expected, positions)
+
+
+if __name__ == '__main__':
+    unittest.main()